@@ -38,6 +38,7 @@
 #include "aerod2.h"
 #include "dataman.h"
 #include "drive_.h"
+#include "checkpoint.h"
 
 /* AeroMemory - begin */
 
@@ -62,7 +63,8 @@ AeroMemory::~AeroMemory(void)
 
 #define USE_POLCOE
 void
-AeroMemory::Predict(int i, doublereal alpha, doublereal &alf1, doublereal &alf2)
+AeroMemory::Predict(int i, doublereal alpha, doublereal &alf1, doublereal &alf2,
+	doublereal *dalf)
 {
 	/* FIXME: this should be s, but I don't want a malloc here */
 	doublereal coe[3];
@@ -106,9 +108,22 @@ AeroMemory::Predict(int i, doublereal alpha, doublereal &alf1, doublereal &alf2)
 
 		alf1 = coe[1]+2.*coe[2]*tt[2];
 		alf2 = 2.*coe[2];
+
+		if (dalf != 0) {
+			/* the parabola is linear in aa[2] */
+			doublereal d = 1./((tt[2] - tt[0])*(tt[2] - tt[1]));
+
+			dalf[0] = (2.*tt[2] - tt[1] - tt[0])*d;
+			dalf[1] = 2.*d;
+		}
 	} else {
 		alf1 = 0.;
 		alf2 = 0.;
+
+		if (dalf != 0) {
+			dalf[0] = 0.;
+			dalf[1] = 0.;
+		}
 	}
 }
 
@@ -164,6 +179,28 @@ AeroMemory::GetNumPoints(void) const
 	return iPoints;
 }
 
+void
+AeroMemory::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, numUpdates);
+
+	int s = StorageSize();
+	for (int i = 0; i < 2*s*iPoints; i++) {
+		ChkWrite(out, a[i]);
+	}
+}
+
+void
+AeroMemory::Resume(std::istream& in)
+{
+	ChkRead(in, numUpdates);
+
+	int s = StorageSize();
+	for (int i = 0; i < 2*s*iPoints; i++) {
+		ChkRead(in, a[i]);
+	}
+}
+
 /* AeroMemory - end */
 
 /* C81Data - begin */
@@ -171,16 +208,39 @@ AeroMemory::GetNumPoints(void) const
 C81Data::C81Data(unsigned int uLabel)
 : WithLabel(uLabel)
 {
-	NO_OP;
+	grid = 0;
 }
 
 /* C81Data - end */
 
 /* AeroData - begin */
 
+AeroData::SectionBatch::SectionBatch(void)
+: iNum(0), dOmega(0.)
+{
+	NO_OP;
+}
+
+void
+AeroData::SectionBatch::Resize(int n)
+{
+	iNum = n;
+
+	Abscissa.resize(n);
+	Chord.resize(n);
+	ForcePoint.resize(n);
+	VelocityPoint.resize(n);
+	Twist.resize(n);
+
+	for (int k = 0; k < 6; k++) {
+		W[k].resize(n);
+		TNG[k].resize(n);
+	}
+}
+
 AeroData::AeroData(int i_p, int i_dim,
 	AeroData::UnsteadyModel u, DriveCaller *ptime)
-: AeroMemory(ptime), unsteadyflag(u), Omega(0.)
+: AeroMemory(ptime), unsteadyflag(u), jacobian(JAC_FORWARD_DIFF), Omega(0.)
 {
 	// silence static analyzers
 	VAM.density = -1.;
@@ -358,6 +418,16 @@ AeroData::GetForcesJacCenteredDiff_int(int i, const doublereal* W, doublereal* T
 	return 0;
 }
 
+int
+AeroData::GetForcesJacDiff_int(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA)
+{
+	if (jacobian == JAC_CENTERED_DIFF) {
+		return GetForcesJacCenteredDiff_int(i, W, TNG, J, OUTA);
+	}
+
+	return GetForcesJacForwardDiff_int(i, W, TNG, J, OUTA);
+}
+
 unsigned int
 AeroData::iGetNumDof(void) const
 {
@@ -387,6 +457,54 @@ AeroData::GetForcesJac(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, o
 	throw ErrGeneric(MBDYN_EXCEPT_ARGS);
 }
 
+bool
+AeroData::SetJacobianMethod(AeroData::JacobianMethod m)
+{
+	switch (m) {
+	case JAC_FORWARD_DIFF:
+	case JAC_CENTERED_DIFF:
+		jacobian = m;
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+AeroData::JacobianMethod
+AeroData::GetJacobianMethod(void) const
+{
+	return jacobian;
+}
+
+int
+AeroData::GetForcesBatch(int iFirst, SectionBatch& B, outa_t* OUTA)
+{
+	int rc = 0;
+
+	for (int j = 0; j < B.iNum; j++) {
+		doublereal W[6], TNG[6];
+
+		SetSectionData(B.Abscissa[j], B.Chord[j], B.ForcePoint[j],
+			B.VelocityPoint[j], B.Twist[j], B.dOmega);
+
+		for (int k = 0; k < 6; k++) {
+			W[k] = B.W[k][j];
+		}
+
+		int rcj = GetForces(iFirst + j, W, TNG, OUTA[j]);
+		if (rcj != 0) {
+			rc = rcj;
+		}
+
+		for (int k = 0; k < 6; k++) {
+			B.TNG[k][j] = TNG[k];
+		}
+	}
+
+	return rc;
+}
+
 void
 AeroData::AssRes(SubVectorHandler& WorkVec,
 	doublereal dCoef,
@@ -34,6 +34,8 @@
 
 #include "ac/f2c.h"
 
+#include <vector>
+
 #include "myassert.h"
 #include "withlab.h"
 #include "drive.h"
@@ -72,11 +74,17 @@ public:
 	AeroMemory(DriveCaller *pt);
 	virtual ~AeroMemory(void);
 
+	// dalf, if not null, gets the derivatives of alf1, alf2
+	// with respect to alpha
 	void Predict(int i, doublereal alpha,
-		doublereal &alf1, doublereal &alf2);
+		doublereal &alf1, doublereal &alf2, doublereal *dalf = 0);
 	void Update(int i);
 	void SetNumPoints(int i);
 	int GetNumPoints(void) const;
+
+	// angle of attack history of the unsteady models
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
 };
 
 /* Memory - end */
@@ -94,6 +102,12 @@ public:
 		LAST
 	};
 
+	enum JacobianMethod {
+		JAC_FORWARD_DIFF = 0,
+		JAC_CENTERED_DIFF,
+		JAC_ANALYTICAL
+	};
+
 	enum {
 		VX	= 0,
 		VY	= 1,
@@ -112,8 +126,31 @@ public:
 		MZ	= 5
 	};
 
+	/*
+	 * Sections of an element, evaluated in a single call;
+	 * structure-of-arrays, i.e. W[VX][j] is the VX component
+	 * of the velocity of section j
+	 */
+	struct SectionBatch {
+		int iNum;
+		doublereal dOmega;
+
+		std::vector<doublereal> Abscissa;
+		std::vector<doublereal> Chord;
+		std::vector<doublereal> ForcePoint;
+		std::vector<doublereal> VelocityPoint;
+		std::vector<doublereal> Twist;
+
+		std::vector<doublereal> W[6];
+		std::vector<doublereal> TNG[6];
+
+		SectionBatch(void);
+		void Resize(int n);
+	};
+
 protected:
 	UnsteadyModel unsteadyflag;
+	JacobianMethod jacobian;
 	vam_t VAM;
 	doublereal Omega;
 
@@ -121,6 +158,8 @@ protected:
 
 	int GetForcesJacForwardDiff_int(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA);
 	int GetForcesJacCenteredDiff_int(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA);
+	// forward or centered differences, according to jacobian
+	int GetForcesJacDiff_int(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA);
 
 public:
 	AeroData(int i_p, int i_dim,
@@ -143,6 +182,17 @@ public:
 	virtual int
 	GetForcesJac(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA);
 
+	// how GetForcesJac() computes J; returns false
+	// if the method is not supported by the model
+	virtual bool SetJacobianMethod(JacobianMethod m);
+	JacobianMethod GetJacobianMethod(void) const;
+
+	// sections iFirst ... iFirst + B.iNum - 1, with section data
+	// taken from B; OUTA points to the output of section iFirst.
+	// The default calls SetSectionData() and GetForces() on each
+	virtual int
+	GetForcesBatch(int iFirst, SectionBatch& B, outa_t* OUTA);
+
 	// aerodynamic models with internal states
 	virtual unsigned int iGetNumDof(void) const;
 	virtual DofOrder::Order GetDofType(unsigned int i) const;
@@ -37,6 +37,7 @@
 #include "submat.h"
 #include "aerod2.h"
 #include "c81data.h"
+#include "checkpoint.h"
 
 /* STAHRAeroData - begin */
 
@@ -98,18 +99,76 @@ STAHRAeroData::GetForces(int i, const doublereal* W, doublereal* TNG,
 int
 STAHRAeroData::GetForcesJac(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA)
 {
-	return AeroData::GetForcesJacForwardDiff_int(i, W, TNG, J, OUTA);
+	return AeroData::GetForcesJacDiff_int(i, W, TNG, J, OUTA);
 }
 
 /* STAHRAeroData - end */
 
 /* C81AeroData - begin */
 
+/* steady batched evaluation; pd[j] is the data of section j */
+static int
+c81_get_forces_batch(const vam_t& VAM, AeroData::SectionBatch& B,
+	const c81_data *const *pd, outa_t* OUTA)
+{
+	if (B.iNum == 0) {
+		return 0;
+	}
+
+	const doublereal *W[6];
+	doublereal *TNG[6];
+	for (int k = 0; k < 6; k++) {
+		W[k] = &B.W[k][0];
+		TNG[k] = &B.TNG[k][0];
+	}
+
+	return c81_aerod2_batch(B.iNum, W,
+		VAM.density, VAM.sound_celerity,
+		&B.Chord[0], &B.ForcePoint[0], &B.VelocityPoint[0],
+		TNG, OUTA, pd);
+}
+
+/* analytical Jacobian; the prediction of alf1, alf2 is differentiated
+ * with respect to the incidence, as the finite differences would do */
+static int
+c81_get_forces_jac(AeroMemory& mem, const vam_t& VAM,
+	AeroData::UnsteadyModel unsteadyflag, const c81_data *data,
+	int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA)
+{
+	doublereal dalf[2] = { 0., 0. };
+
+	switch (unsteadyflag) {
+	case AeroData::HARRIS:
+	case AeroData::BIELAWA:
+		mem.Predict(i, atan2(-W[AeroData::VY], W[AeroData::VX]),
+			OUTA.alf1, OUTA.alf2, dalf);
+		break;
+
+	default:
+		break;
+	}
+
+	doublereal dJ[36];
+	int rc = c81_aerod2_u_jac(const_cast<doublereal *>(W), &VAM, TNG, dJ,
+		&OUTA, const_cast<c81_data *>(data), unsteadyflag, dalf);
+	if (rc != 0) {
+		return rc;
+	}
+
+	for (int iRow = 0; iRow < 6; iRow++) {
+		for (int iCol = 0; iCol < 6; iCol++) {
+			J.Put(iRow + 1, iCol + 1, dJ[6*iRow + iCol]);
+		}
+	}
+
+	return 0;
+}
+
 C81AeroData::C81AeroData(int i_p, int i_dim,
 	AeroData::UnsteadyModel u, integer p,
 	const c81_data* d, DriveCaller *ptime)
 : AeroData(i_p, i_dim, u, ptime),
-profile(p), data(d)
+profile(p), data(d), batch_data(i_p*i_dim, d)
 {
 	ASSERT(data != NULL);
 }
@@ -147,7 +206,35 @@ C81AeroData::GetForces(int i, const doublereal* W, doublereal* TNG, outa_t& OUTA
 int
 C81AeroData::GetForcesJac(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA)
 {
-	return AeroData::GetForcesJacForwardDiff_int(i, W, TNG, J, OUTA);
+	if (jacobian != JAC_ANALYTICAL) {
+		return AeroData::GetForcesJacDiff_int(i, W, TNG, J, OUTA);
+	}
+
+	return c81_get_forces_jac(*this, VAM, unsteadyflag, data,
+		i, W, TNG, J, OUTA);
+}
+
+bool
+C81AeroData::SetJacobianMethod(JacobianMethod m)
+{
+	if (m == JAC_ANALYTICAL) {
+		jacobian = m;
+		return true;
+	}
+
+	return AeroData::SetJacobianMethod(m);
+}
+
+int
+C81AeroData::GetForcesBatch(int iFirst, SectionBatch& B, outa_t* OUTA)
+{
+	if (unsteadyflag != AeroData::STEADY) {
+		return AeroData::GetForcesBatch(iFirst, B, OUTA);
+	}
+
+	ASSERT(unsigned(B.iNum) <= batch_data.size());
+
+	return c81_get_forces_batch(VAM, B, &batch_data[0], OUTA);
 }
 
 /* C81AeroData - end */
@@ -162,7 +249,8 @@ C81MultipleAeroData::C81MultipleAeroData(
 	std::vector<const c81_data *>& d,
 	DriveCaller *ptime)
 : AeroData(i_p, i_dim, u, ptime),
-profiles(p), upper_bounds(ub), data(d)
+profiles(p), upper_bounds(ub), data(d), curr_data(0),
+batch_data(i_p*i_dim)
 {
 	ASSERT(!profiles.empty());
 	ASSERT(!upper_bounds.empty());
@@ -201,14 +289,19 @@ C81MultipleAeroData::SetSectionData(
 	AeroData::SetSectionData(abscissa, chord, forcepoint, velocitypoint,
 		twist, omega);
 
+	curr_data = GetDataIndex(abscissa);
+}
+
+integer
+C81MultipleAeroData::GetDataIndex(const doublereal& abscissa) const
+{
 	for (int i = profiles.size() - 1; i--; ) {
 		if (abscissa > upper_bounds[i]) {
-			curr_data = i + 1;
-			return;
+			return i + 1;
 		}
 	}
 
-	curr_data = 0;
+	return 0;
 }
 
 int
@@ -234,7 +327,39 @@ C81MultipleAeroData::GetForces(int i, const doublereal* W, doublereal* TNG, outa
 int
 C81MultipleAeroData::GetForcesJac(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA)
 {
-	return AeroData::GetForcesJacForwardDiff_int(i, W, TNG, J, OUTA);
+	if (jacobian != JAC_ANALYTICAL) {
+		return AeroData::GetForcesJacDiff_int(i, W, TNG, J, OUTA);
+	}
+
+	return c81_get_forces_jac(*this, VAM, unsteadyflag, data[curr_data],
+		i, W, TNG, J, OUTA);
+}
+
+bool
+C81MultipleAeroData::SetJacobianMethod(JacobianMethod m)
+{
+	if (m == JAC_ANALYTICAL) {
+		jacobian = m;
+		return true;
+	}
+
+	return AeroData::SetJacobianMethod(m);
+}
+
+int
+C81MultipleAeroData::GetForcesBatch(int iFirst, SectionBatch& B, outa_t* OUTA)
+{
+	if (unsteadyflag != AeroData::STEADY) {
+		return AeroData::GetForcesBatch(iFirst, B, OUTA);
+	}
+
+	ASSERT(unsigned(B.iNum) <= batch_data.size());
+
+	for (int j = 0; j < B.iNum; j++) {
+		batch_data[j] = data[GetDataIndex(B.Abscissa[j])];
+	}
+
+	return c81_get_forces_batch(VAM, B, &batch_data[0], OUTA);
 }
 
 /* C81MultipleAeroData - end */
@@ -252,7 +377,7 @@ C81InterpolatedAeroData::C81InterpolatedAeroData(
 )
 : AeroData(i_p, i_dim, u, ptime),
 profiles(p), upper_bounds(ub), data(d),
-i_data(i_p*i_dim)
+i_data(i_p*i_dim), batch_data(i_p*i_dim)
 {
 	ASSERT(!profiles.empty());
 	ASSERT(!upper_bounds.empty());
@@ -288,6 +413,8 @@ i_data(i_p*i_dim)
 				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
 			}
 
+			batch_data[i_point] = &i_data[i_point];
+
 			i_point++;
 		} while (GDI.fGetNext(PW));
 	}
@@ -348,7 +475,36 @@ C81InterpolatedAeroData::GetForces(int i, const doublereal* W, doublereal* TNG,
 int
 C81InterpolatedAeroData::GetForcesJac(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA)
 {
-	return AeroData::GetForcesJacForwardDiff_int(i, W, TNG, J, OUTA);
+	if (jacobian != JAC_ANALYTICAL) {
+		return AeroData::GetForcesJacDiff_int(i, W, TNG, J, OUTA);
+	}
+
+	return c81_get_forces_jac(*this, VAM, unsteadyflag, &i_data[i],
+		i, W, TNG, J, OUTA);
+}
+
+bool
+C81InterpolatedAeroData::SetJacobianMethod(JacobianMethod m)
+{
+	if (m == JAC_ANALYTICAL) {
+		jacobian = m;
+		return true;
+	}
+
+	return AeroData::SetJacobianMethod(m);
+}
+
+int
+C81InterpolatedAeroData::GetForcesBatch(int iFirst, SectionBatch& B, outa_t* OUTA)
+{
+	if (unsteadyflag != AeroData::STEADY) {
+		return AeroData::GetForcesBatch(iFirst, B, OUTA);
+	}
+
+	ASSERT(iFirst >= 0);
+	ASSERT(unsigned(iFirst + B.iNum) <= batch_data.size());
+
+	return c81_get_forces_batch(VAM, B, &batch_data[iFirst], OUTA);
 }
 
 /* C81InterpolatedAeroData - end */
@@ -406,6 +562,19 @@ TheodorsenAeroData::SetAirData(const doublereal& rho, const doublereal& c)
 	pAeroData->SetAirData(rho, c);
 }
 
+bool
+TheodorsenAeroData::SetJacobianMethod(JacobianMethod m)
+{
+	// the Jacobian is that of the wrapped model
+	if (!pAeroData->SetJacobianMethod(m)) {
+		return false;
+	}
+
+	jacobian = m;
+
+	return true;
+}
+
 void
 TheodorsenAeroData::SetSectionData(const doublereal& abscissa,
 	const doublereal& chord,
@@ -431,6 +600,42 @@ TheodorsenAeroData::GetDofType(unsigned int i) const
 	return DofOrder::DIFFERENTIAL;
 }
 
+void
+TheodorsenAeroData::AllocStates(void)
+{
+	doublereal *d = 0;
+	SAFENEWARR(d, doublereal, 10*GetNumPoints());
+
+#ifdef HAVE_MEMSET
+	memset(d, '0', 10*GetNumPoints()*sizeof(doublereal));
+#else // ! HAVE_MEMSET
+	for (int i = 0; i < 10*GetNumPoints(); i++) {
+		d[i] = 0.;
+	}
+#endif // ! HAVE_MEMSET
+
+	alpha_pivot = d;
+	d += GetNumPoints();
+	dot_alpha_pivot = d;
+	d += GetNumPoints();
+	dot_alpha = d;
+	d += GetNumPoints();
+	ddot_alpha = d;
+	d += GetNumPoints();
+	cfx_0 = d;
+	d += GetNumPoints();
+	cfy_0 = d;
+	d += GetNumPoints();
+	cmz_0 = d;
+	d += GetNumPoints();
+	clalpha = d;
+	d += GetNumPoints();
+	prev_alpha_pivot = d;
+	d += GetNumPoints();
+	prev_dot_alpha = d;
+	d += GetNumPoints();
+}
+
 void
 TheodorsenAeroData::AssRes(SubVectorHandler& WorkVec,
 	doublereal dCoef,
@@ -441,37 +646,7 @@ TheodorsenAeroData::AssRes(SubVectorHandler& WorkVec,
 {
 	// FIXME: should do it earlier
 	if (alpha_pivot == 0) {
-		doublereal *d = 0;
-		SAFENEWARR(d, doublereal, 10*GetNumPoints());
-
-#ifdef HAVE_MEMSET
-		memset(d, '0', 10*GetNumPoints()*sizeof(doublereal));
-#else // ! HAVE_MEMSET
-		for (int i = 0; i < 10*GetNumPoints(); i++) {
-			d[i] = 0.;
-		}
-#endif // ! HAVE_MEMSET
-
-		alpha_pivot = d;
-		d += GetNumPoints();
-		dot_alpha_pivot = d;
-		d += GetNumPoints();
-		dot_alpha = d;
-		d += GetNumPoints();
-		ddot_alpha = d;
-		d += GetNumPoints();
-		cfx_0 = d;
-		d += GetNumPoints();
-		cfy_0 = d;
-		d += GetNumPoints();
-		cmz_0 = d;
-		d += GetNumPoints();
-		clalpha = d;
-		d += GetNumPoints();
-		prev_alpha_pivot = d;
-		d += GetNumPoints();
-		prev_dot_alpha = d;
-		d += GetNumPoints();
+		AllocStates();
 	}
 
 	doublereal q1 = XCurr(iFirstIndex + 1);
@@ -923,4 +1098,42 @@ TheodorsenAeroData::AfterConvergence(int i,
 	prev_time = pTime->dGet();
 }
 
+void
+TheodorsenAeroData::Checkpoint(std::ostream& out) const
+{
+	AeroData::Checkpoint(out);
+
+	ChkWrite(out, prev_time);
+
+	bool bAlloc = (alpha_pivot != 0);
+	ChkWrite(out, bAlloc);
+	if (bAlloc) {
+		for (int i = 0; i < GetNumPoints(); i++) {
+			ChkWrite(out, prev_alpha_pivot[i]);
+			ChkWrite(out, prev_dot_alpha[i]);
+		}
+	}
+}
+
+void
+TheodorsenAeroData::Resume(std::istream& in)
+{
+	AeroData::Resume(in);
+
+	ChkRead(in, prev_time);
+
+	bool bAlloc;
+	ChkRead(in, bAlloc);
+	if (bAlloc) {
+		if (alpha_pivot == 0) {
+			AllocStates();
+		}
+
+		for (int i = 0; i < GetNumPoints(); i++) {
+			ChkRead(in, prev_alpha_pivot[i]);
+			ChkRead(in, prev_dot_alpha[i]);
+		}
+	}
+}
+
 /* TheodorsenAeroData - end */
@@ -61,6 +61,7 @@ class C81AeroData : public AeroData {
 protected:
 	integer profile;
 	const c81_data* data;
+	std::vector<const c81_data *> batch_data;
 
 public:
 	C81AeroData(
@@ -72,6 +73,8 @@ public:
 	virtual std::ostream& Restart(std::ostream& out) const;
 	virtual int GetForces(int i, const doublereal* W, doublereal* TNG, outa_t& OUTA);
 	virtual int GetForcesJac(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA);
+	virtual bool SetJacobianMethod(JacobianMethod m);
+	virtual int GetForcesBatch(int iFirst, SectionBatch& B, outa_t* OUTA);
 };
 
 /* C81AeroData - end */
@@ -91,6 +94,9 @@ protected:
 	std::vector<doublereal> upper_bounds;
 	std::vector<const c81_data *> data;
 	integer curr_data;
+	std::vector<const c81_data *> batch_data;
+
+	integer GetDataIndex(const doublereal& abscissa) const;
 
 public:
 	C81MultipleAeroData(
@@ -112,6 +118,8 @@ public:
 
 	int GetForces(int i, const doublereal* W, doublereal* TNG, outa_t& OUTA);
 	int GetForcesJac(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA);
+	bool SetJacobianMethod(JacobianMethod m);
+	int GetForcesBatch(int iFirst, SectionBatch& B, outa_t* OUTA);
 };
 
 /* C81MultipleAeroData - end */
@@ -125,6 +133,7 @@ protected:
 	std::vector<const c81_data *> data;
 
 	std::vector<c81_data> i_data;
+	std::vector<const c81_data *> batch_data;
 
 public:
 	C81InterpolatedAeroData(
@@ -147,6 +156,8 @@ public:
 
 	int GetForces(int i, const doublereal* W, doublereal* TNG, outa_t& OUTA);
 	int GetForcesJac(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA);
+	bool SetJacobianMethod(JacobianMethod m);
+	int GetForcesBatch(int iFirst, SectionBatch& B, outa_t* OUTA);
 };
 
 /* C81InterpolatedAeroData - end */
@@ -168,6 +179,8 @@ protected:
 
 	AeroData *pAeroData;
 
+	void AllocStates(void);
+
 public:
 	TheodorsenAeroData(
 		int i_p, int i_dim,
@@ -176,6 +189,7 @@ public:
 
 	virtual std::ostream& Restart(std::ostream& out) const;
 	virtual void SetAirData(const doublereal& rho, const doublereal& c);
+	virtual bool SetJacobianMethod(JacobianMethod m);
 
 	virtual void SetSectionData(const doublereal& abscissa,
 		const doublereal& chord,
@@ -205,6 +219,9 @@ public:
 		int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA);
 	virtual void
 	AfterConvergence( int i, const VectorHandler& X, const VectorHandler& XP );
+
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
 };
 
 /* TheodorsenAeroData - end */
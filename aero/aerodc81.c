@@ -34,6 +34,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include "ac/f2c.h"
 #include "aerodc81.h"
 #include "bisec.h"
@@ -84,8 +85,108 @@ get_stall(int nm, doublereal* m, doublereal* s, doublereal mach,
           doublereal *dcpa, doublereal *dasp, doublereal *dasm);
 #endif /* USE_GET_STALL */
 
+static void
+grid_get(const c81_grid *g, doublereal alpha, doublereal mach,
+		doublereal *c, doublereal *mc);
+
+static void
+get_coef_d(int nm, doublereal* m, int na, doublereal* a,
+		doublereal alpha, doublereal mach,
+		doublereal* c, doublereal* c_a, doublereal* c_m);
+
+static doublereal
+get_dcla_d(int nm, doublereal* m, doublereal* s, doublereal mach,
+		doublereal* dcla_m);
+
+static void
+grid_get_d(const c81_grid *g, doublereal alpha, doublereal mach,
+		doublereal *c, doublereal *c_a, doublereal *c_m,
+		doublereal *mc, doublereal *mc_m);
+
 const outa_t outa_Zero;
 
+/*
+ * Constants from unsteady theory
+ * synthetized by Richard L. Bielawa,
+ * 31th A.H.S. Forum Washington D.C. 
+ * May 1975
+ */
+static const doublereal PN[] = { 
+	-3.464003e-1, 
+	-1.549076e+0, 
+	4.306330e+1, 
+	-5.397529e+1,
+	5.781402e+0,
+	-3.233003e+1,
+	-2.162257e+1,
+	1.866347e+1,
+	4.198390e+1,
+	3.295461e+2,
+};
+
+static const doublereal QN[] = {
+	1.533717e+0,
+	6.977203e+0,
+	1.749010e+3,
+	1.694829e+3,
+	-1.771899e+3,
+	-3.291665e+4,
+	2.969051e+0,
+	-3.632448e+1,
+	-2.268578e+3,
+	6.601995e+3,
+	-9.654208e+3, 
+	8.533930e+4,
+	-1.492624e+0,
+	1.163661e+1
+};
+
+static const doublereal PM[] = {
+	1.970065e+1,
+	-6.751639e+1,
+	7.265269e+2,
+	4.865945e+4,
+	2.086279e+4,
+	6.024672e+3,
+	1.446334e+2,
+	8.586896e+2,
+	-7.550329e+2,
+	-1.021613e+1,
+	2.247664e+1,
+};
+
+static const doublereal QM[] = {
+	-2.322808e+0,
+	-1.322257e+0,
+	-2.633891e+0,
+	-2.180321e-1,
+	4.580014e+0,
+	3.125497e-1,
+	-2.828806e+1,
+	-4.396734e+0,
+	2.565870e+2,
+	-1.204976e+1,
+	-1.157802e+2,
+	8.612138e+0,
+};
+
+enum {
+	U_1 = 0,
+	U_2 = 1,
+	U_3 = 2,
+	U_4 = 3,
+	U_5 = 4,
+	U_6 = 5,
+	U_7 = 6,
+	U_8 = 7,
+	U_9 = 8,
+	U10 = 9,
+	U11 = 10,
+	U12 = 11,
+	U13 = 12,
+	U14 = 13
+};
+
 doublereal
 c81_data_get_coef(int nm, doublereal* m, int na, doublereal* a, doublereal alpha, doublereal mach)
 {
@@ -181,14 +282,27 @@ c81_aerod2(doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUTA, c81_d
 	/*
 	 * Note: all angles in c81 files MUST be in degrees
 	 */
-	get_coef(data->NML, data->ml, data->NAL, data->al,
-			OUTA->alpha, mach, &cl, &cl0);
-	get_coef(data->NMD, data->md, data->NAD, data->ad,
-			OUTA->alpha, mach, &cd, &cd0);
-	get_coef(data->NMM, data->mm, data->NAM, data->am,
-			OUTA->alpha, mach, &cm, NULL);
+	if (data->grid != NULL) {
+		doublereal c[C81_GRID_NC], mc[C81_GRID_NMC];
 
-	dcla = get_dcla(data->NML, data->ml, data->stall, mach);
+		grid_get(data->grid, OUTA->alpha, mach, c, mc);
+		cl = c[C81_GRID_CL];
+		cd = c[C81_GRID_CD];
+		cm = c[C81_GRID_CM];
+		cl0 = mc[C81_GRID_CL0];
+		cd0 = mc[C81_GRID_CD0];
+		dcla = mc[C81_GRID_DCLA];
+
+	} else {
+		get_coef(data->NML, data->ml, data->NAL, data->al,
+				OUTA->alpha, mach, &cl, &cl0);
+		get_coef(data->NMD, data->md, data->NAD, data->ad,
+				OUTA->alpha, mach, &cd, &cd0);
+		get_coef(data->NMM, data->mm, data->NAM, data->am,
+				OUTA->alpha, mach, &cm, NULL);
+
+		dcla = get_dcla(data->NML, data->ml, data->stall, mach);
+	}
 	
 /*
  * da COE0 (aerod2.f):
@@ -339,14 +453,27 @@ c81_aerod2_u(doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUTA,
 		/*
 		 * Note: all angles in c81 files MUST be in degrees
 		 */
-		get_coef(data->NML, data->ml, data->NAL, data->al, 
-				OUTA->alpha, mach, &cl, &cl0);
-		get_coef(data->NMD, data->md, data->NAD, data->ad, 
-				OUTA->alpha, mach, &cd, &cd0);
-		get_coef(data->NMM, data->mm, data->NAM, data->am, 
-				OUTA->alpha, mach, &cm, NULL);
+		if (data->grid != NULL) {
+			doublereal c[C81_GRID_NC], mc[C81_GRID_NMC];
 
-		dcla = get_dcla(data->NML, data->ml, data->stall, mach);
+			grid_get(data->grid, OUTA->alpha, mach, c, mc);
+			cl = c[C81_GRID_CL];
+			cd = c[C81_GRID_CD];
+			cm = c[C81_GRID_CM];
+			cl0 = mc[C81_GRID_CL0];
+			cd0 = mc[C81_GRID_CD0];
+			dcla = mc[C81_GRID_DCLA];
+
+		} else {
+			get_coef(data->NML, data->ml, data->NAL, data->al, 
+					OUTA->alpha, mach, &cl, &cl0);
+			get_coef(data->NMD, data->md, data->NAD, data->ad, 
+					OUTA->alpha, mach, &cd, &cd0);
+			get_coef(data->NMM, data->mm, data->NAM, data->am, 
+					OUTA->alpha, mach, &cm, NULL);
+
+			dcla = get_dcla(data->NML, data->ml, data->stall, mach);
+		}
 	
 /*
  * da COE0 (aerod2.f):
@@ -382,10 +509,7 @@ c81_aerod2_u(doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUTA,
 	case 2: {
 
 		/*
-		 * Constants from unsteady theory
-		 * synthetized by Richard L. Bielawa,
-		 * 31th A.H.S. Forum Washington D.C. 
-		 * May 1975
+		 * Bielawa's unsteady theory; see PN, QN, PM, QM above
 		 */
 		doublereal A, B, A2, B2, ETA, ASN, ASM, 
 			SGN, SGM, SGMAX, 
@@ -394,82 +518,6 @@ c81_aerod2_u(doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUTA,
 			dcma, dclatan, ALF1, ALF2,
 			cn;
 		
-		const doublereal PN[] = { 
-			-3.464003e-1, 
-			-1.549076e+0, 
-			4.306330e+1, 
-			-5.397529e+1,
-			5.781402e+0,
-			-3.233003e+1,
-			-2.162257e+1,
-			1.866347e+1,
-			4.198390e+1,
-			3.295461e+2,
-		};
-	
-		const doublereal QN[] = {
-			1.533717e+0,
-			6.977203e+0,
-			1.749010e+3,
-			1.694829e+3,
-			-1.771899e+3,
-			-3.291665e+4,
-			2.969051e+0,
-			-3.632448e+1,
-			-2.268578e+3,
-			6.601995e+3,
-			-9.654208e+3, 
-			8.533930e+4,
-			-1.492624e+0,
-			1.163661e+1
-		};
-
-		const doublereal PM[] = {
-			1.970065e+1,
-			-6.751639e+1,
-			7.265269e+2,
-			4.865945e+4,
-			2.086279e+4,
-			6.024672e+3,
-			1.446334e+2,
-			8.586896e+2,
-			-7.550329e+2,
-			-1.021613e+1,
-			2.247664e+1,
-		};
-	
-		const doublereal QM[] = {
-			-2.322808e+0,
-			-1.322257e+0,
-			-2.633891e+0,
-			-2.180321e-1,
-			4.580014e+0,
-			3.125497e-1,
-			-2.828806e+1,
-			-4.396734e+0,
-			2.565870e+2,
-			-1.204976e+1,
-			-1.157802e+2,
-			8.612138e+0,
-		};
-
-		enum {
-			U_1 = 0,
-			U_2 = 1,
-			U_3 = 2,
-			U_4 = 3,
-			U_5 = 4,
-			U_6 = 5,
-			U_7 = 6,
-			U_8 = 7,
-			U_9 = 8,
-			U10 = 9,
-			U11 = 10,
-			U12 = 11,
-			U13 = 12,
-			U14 = 13
-		};
-
 		/*
 		 * This is the static stall angle for Mach = 0
 		 * (here a symmetric airfoil is assumed; the real
@@ -553,17 +601,33 @@ c81_aerod2_u(doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUTA,
 		}
 
 		alphaN = (alpha - DAN)*RAD2DEG;
-		get_coef(data->NML, data->ml, data->NAL, data->al, 
-				alphaN, mach, &cl, &cl0);
-		get_coef(data->NMD, data->md, data->NAD, data->ad, 
-				alphaN, mach, &cd, &cd0);
-
 		alphaM = (alpha - DAM)*RAD2DEG;
-		get_coef(data->NMM, data->mm, data->NAM, data->am, 
-				alphaM, mach, &cm, NULL);
+		if (data->grid != NULL) {
+			doublereal c[C81_GRID_NC], mc[C81_GRID_NMC];
 
-		dcla = get_dcla(data->NML, data->ml, data->stall, mach);
-		dcma = get_dcla(data->NMM, data->mm, data->mstall, mach);
+			grid_get(data->grid, alphaN, mach, c, mc);
+			cl = c[C81_GRID_CL];
+			cd = c[C81_GRID_CD];
+			cl0 = mc[C81_GRID_CL0];
+			cd0 = mc[C81_GRID_CD0];
+			dcla = mc[C81_GRID_DCLA];
+			dcma = mc[C81_GRID_DCMA];
+
+			grid_get(data->grid, alphaM, mach, c, NULL);
+			cm = c[C81_GRID_CM];
+
+		} else {
+			get_coef(data->NML, data->ml, data->NAL, data->al, 
+					alphaN, mach, &cl, &cl0);
+			get_coef(data->NMD, data->md, data->NAD, data->ad, 
+					alphaN, mach, &cd, &cd0);
+
+			get_coef(data->NMM, data->mm, data->NAM, data->am, 
+					alphaM, mach, &cm, NULL);
+
+			dcla = get_dcla(data->NML, data->ml, data->stall, mach);
+			dcma = get_dcla(data->NMM, data->mm, data->mstall, mach);
+		}
 
 		/* note: cl/alpha in 1/deg */
 		dclatan = dcla;
@@ -624,6 +688,671 @@ c81_aerod2_u(doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUTA,
 	return 0;
 }
 
+/*
+ * coefficients for c81_aerod2_u_jac(): cl, cd at alpha, cm at alpham
+ * (deg), per-Mach data (C81_GRID_* indices) and their partial
+ * derivatives with respect to alpha (_a, 1/deg) and mach (_m)
+ */
+static void
+get_coef_all_d(c81_data *data, doublereal alpha, doublereal alpham,
+		doublereal mach,
+		doublereal *c, doublereal *c_a, doublereal *c_m,
+		doublereal *mc, doublereal *mc_m)
+{
+	if (data->grid != NULL) {
+		grid_get_d(data->grid, alpha, mach, c, c_a, c_m, mc, mc_m);
+		if (alpham != alpha) {
+			doublereal cc[C81_GRID_NC], cc_a[C81_GRID_NC],
+				cc_m[C81_GRID_NC];
+
+			grid_get_d(data->grid, alpham, mach, cc, cc_a, cc_m,
+				NULL, NULL);
+			c[C81_GRID_CM] = cc[C81_GRID_CM];
+			c_a[C81_GRID_CM] = cc_a[C81_GRID_CM];
+			c_m[C81_GRID_CM] = cc_m[C81_GRID_CM];
+		}
+
+	} else {
+		doublereal dummy;
+
+		get_coef_d(data->NML, data->ml, data->NAL, data->al,
+			alpha, mach, &c[C81_GRID_CL],
+			&c_a[C81_GRID_CL], &c_m[C81_GRID_CL]);
+		get_coef_d(data->NMD, data->md, data->NAD, data->ad,
+			alpha, mach, &c[C81_GRID_CD],
+			&c_a[C81_GRID_CD], &c_m[C81_GRID_CD]);
+		get_coef_d(data->NMM, data->mm, data->NAM, data->am,
+			alpham, mach, &c[C81_GRID_CM],
+			&c_a[C81_GRID_CM], &c_m[C81_GRID_CM]);
+
+		get_coef_d(data->NML, data->ml, data->NAL, data->al,
+			0., mach, &mc[C81_GRID_CL0], &dummy, &mc_m[C81_GRID_CL0]);
+		get_coef_d(data->NMD, data->md, data->NAD, data->ad,
+			0., mach, &mc[C81_GRID_CD0], &dummy, &mc_m[C81_GRID_CD0]);
+
+		mc[C81_GRID_DCLA] = get_dcla_d(data->NML, data->ml,
+			data->stall, mach, &mc_m[C81_GRID_DCLA]);
+		mc[C81_GRID_DCMA] = get_dcla_d(data->NMM, data->mm,
+			data->mstall, mach, &mc_m[C81_GRID_DCMA]);
+	}
+}
+
+/* dx = a*dy */
+static void
+jac_set(doublereal *dx, doublereal a, const doublereal *dy)
+{
+	int k;
+
+	for (k = 0; k < 6; k++) {
+		dx[k] = a*dy[k];
+	}
+}
+
+/* dx += a*dy */
+static void
+jac_add(doublereal *dx, doublereal a, const doublereal *dy)
+{
+	int k;
+
+	for (k = 0; k < 6; k++) {
+		dx[k] += a*dy[k];
+	}
+}
+
+/*
+ * forces as c81_aerod2_u() and their Jacobian with respect to W,
+ * J[6*i + j] = d TNG[i]/d W[j], consistent with the interpolation
+ * of the tables (the derivatives are those of the piecewise linear
+ * interpolants, zero where the tables are clamped).
+ *
+ * For the Bielawa model, dalf[0] and dalf[1] are the derivatives
+ * of OUTA->alf1 and OUTA->alf2 with respect to the incidence
+ * atan2(-W[1], W[0]) passed to the prediction.
+ */
+int
+c81_aerod2_u_jac(doublereal* W, const vam_t *VAM, doublereal* TNG,
+		doublereal* J, outa_t* OUTA, c81_data* data,
+		long unsteadyflag, const doublereal *dalf)
+{
+	doublereal rho = VAM->density;
+	doublereal cs = VAM->sound_celerity;
+	doublereal chord = VAM->chord;
+	doublereal ca = VAM->force_position;
+	doublereal c34 = VAM->bc_position;
+
+	const doublereal RAD2DEG = 180.*M_1_PI;
+	const doublereal M_PI_3 = M_PI/3.;
+
+	enum { V_X = 0, V_Y = 1, V_Z = 2, W_X = 3, W_Y = 4, W_Z = 5 };
+
+	doublereal vx, vy, vz, vp, vp2, vtot, alpha, gamma, cosgam, mach;
+	doublereal cl, cd, cm, cl0, cd0, h;
+	doublereal c[C81_GRID_NC], c_a[C81_GRID_NC], c_m[C81_GRID_NC];
+	doublereal mc[C81_GRID_NMC], mc_m[C81_GRID_NMC];
+
+	/* derivatives with respect to W */
+	doublereal dvx[6] = { 0. }, dvy[6] = { 0. }, dvz[6] = { 0. };
+	doublereal dvp[6], dvp2[6], dvtot[6], dalpha[6], dgamma[6] = { 0. };
+	doublereal dcosgam[6], dmach[6] = { 0. };
+	doublereal dcl[6], dcd[6], dcm[6], dcl0[6], dcd0[6], dh[6];
+	doublereal dT[6][6];
+	int i, rc;
+
+	rc = c81_aerod2_u(W, VAM, TNG, OUTA, data, unsteadyflag);
+	if (rc != 0) {
+		return rc;
+	}
+
+	for (i = 0; i < 36; i++) {
+		J[i] = 0.;
+	}
+
+	vx = W[V_X];
+	vy = W[V_Y] + c34*W[W_Z];
+	vz = W[V_Z] - c34*W[W_Y];
+
+	dvx[V_X] = 1.;
+	dvy[V_Y] = 1.;
+	dvy[W_Z] = c34;
+	dvz[V_Z] = 1.;
+	dvz[W_Y] = -c34;
+
+	vp2 = vx*vx + vy*vy;
+	vp = sqrt(vp2);
+	vtot = sqrt(vp2 + vz*vz);
+
+	/* below threshold c81_aerod2_u() returns zero forces */
+	if (vp/cs < 1.e-6) {
+		return 0;
+	}
+
+	jac_set(dvp2, 2.*vx, dvx);
+	jac_add(dvp2, 2.*vy, dvy);
+	jac_set(dvp, .5/vp, dvp2);
+	jac_set(dvtot, .5/vtot, dvp2);
+	jac_add(dvtot, vz/vtot, dvz);
+
+	alpha = atan2(-vy, vx);
+	jac_set(dalpha, vy/vp2, dvx);
+	jac_add(dalpha, -vx/vp2, dvy);
+
+	gamma = atan2(-vz, fabs(vx));
+	if (fabs(gamma) > M_PI_3) {
+		gamma = M_PI_3;
+
+	} else if (vx != 0. || vz != 0.) {
+		doublereal r2 = vx*vx + vz*vz;
+
+		jac_set(dgamma, (vx < 0. ? -vz : vz)/r2, dvx);
+		jac_add(dgamma, -fabs(vx)/r2, dvz);
+	}
+
+	cosgam = cos(gamma);
+	jac_set(dcosgam, -sin(gamma), dgamma);
+
+	mach = (vtot*sqrt(cosgam))/cs;
+	if (mach > .99) {
+		mach = .99;
+
+	} else {
+		jac_set(dmach, sqrt(cosgam)/cs, dvtot);
+		jac_add(dmach, vtot/(2.*sqrt(cosgam)*cs), dcosgam);
+	}
+
+	switch (unsteadyflag) {
+	case 0: {
+		doublereal dcla;
+
+		get_coef_all_d(data, alpha*RAD2DEG, alpha*RAD2DEG, mach,
+			c, c_a, c_m, mc, mc_m);
+
+		cl = c[C81_GRID_CL];
+		jac_set(dcl, c_a[C81_GRID_CL]*RAD2DEG, dalpha);
+		jac_add(dcl, c_m[C81_GRID_CL], dmach);
+		cd = c[C81_GRID_CD];
+		jac_set(dcd, c_a[C81_GRID_CD]*RAD2DEG, dalpha);
+		jac_add(dcd, c_m[C81_GRID_CD], dmach);
+		cm = c[C81_GRID_CM];
+		jac_set(dcm, c_a[C81_GRID_CM]*RAD2DEG, dalpha);
+		jac_add(dcm, c_m[C81_GRID_CM], dmach);
+		cl0 = mc[C81_GRID_CL0];
+		jac_set(dcl0, mc_m[C81_GRID_CL0], dmach);
+		cd0 = mc[C81_GRID_CD0];
+		jac_set(dcd0, mc_m[C81_GRID_CD0], dmach);
+		dcla = mc[C81_GRID_DCLA]*RAD2DEG;
+
+		/* secant correction: cl = cl0 + (cl - cl0)/cosgam */
+		if (fabs(alpha) > 1.e-6
+			&& (cl - cl0)/(alpha*cosgam) < dcla)
+		{
+			doublereal dcl1[6];
+			int k;
+
+			for (k = 0; k < 6; k++) {
+				dcl1[k] = dcl0[k] + (dcl[k] - dcl0[k])/cosgam
+					- (cl - cl0)/(cosgam*cosgam)*dcosgam[k];
+			}
+			cl = cl0 + (cl - cl0)/cosgam;
+			jac_set(dcl, 1., dcl1);
+		}
+		break;
+	}
+
+	case 2: {
+		doublereal A, B, A2, B2, ETA, ASN, ASM, SGN, SGM, SGMAX,
+			DAN, DCN, DAM, DCM, S2, alphaN, alphaM, C1,
+			dcla, dcma, dclatan, cn, E1, E2, I, pA, pB, pS,
+			r, x;
+		doublereal dA[6], dB[6], dETA[6] = { 0. }, dASN[6], dASM[6],
+			dSGN[6], dSGM[6], dSGMAX[6] = { 0. },
+			dDAN[6], dDCN[6], dDAM[6], dDCM[6],
+			dalphaN[6], dalphaM[6], dC1[6],
+			ddcla[6], ddcma[6], ddclatan[6], dcn[6],
+			dalphap[6] = { 0. };
+		const doublereal ASN0 = .22689, ASM0 = .22689;
+		int k;
+
+		/* incidence used by the prediction of alf1, alf2 */
+		x = W[V_X]*W[V_X] + W[V_Y]*W[V_Y];
+		if (x > 0.) {
+			dalphap[V_X] = W[V_Y]/x;
+			dalphap[V_Y] = -W[V_X]/x;
+		}
+
+		A = .5*chord*OUTA->alf1/vp;
+		jac_set(dA, .5*chord*dalf[0]/vp, dalphap);
+		jac_add(dA, -A/vp, dvp);
+
+		B = .25*chord*chord*OUTA->alf2/vp2;
+		jac_set(dB, .25*chord*chord*dalf[1]/vp2, dalphap);
+		jac_add(dB, -B/vp2, dvp2);
+
+		ETA = sqrt(pow(A/.048, 2) + pow(B/.016, 2));
+		if (ETA > 0.) {
+			jac_set(dETA, A/(.048*.048*ETA), dA);
+			jac_add(dETA, B/(.016*.016*ETA), dB);
+		}
+
+		if (alpha < 0.) {
+			A = -A;
+			B = -B;
+			jac_set(dA, -1., dA);
+			jac_set(dB, -1., dB);
+		}
+
+		if (ETA > 1.) {
+			A /= ETA;
+			B /= ETA;
+			for (k = 0; k < 6; k++) {
+				dA[k] = (dA[k] - A*dETA[k])/ETA;
+				dB[k] = (dB[k] - B*dETA[k])/ETA;
+			}
+		}
+
+		A2 = A*A;
+		B2 = B*B;
+
+		ASN = ASN0*(1. - mach);
+		jac_set(dASN, -ASN0, dmach);
+		ASM = ASM0*(1. - mach);
+		jac_set(dASM, -ASM0, dmach);
+
+		r = alpha/ASN;
+		SGN = fabs(r);
+		jac_set(dSGN, (r < 0. ? -1. : 1.)/ASN, dalpha);
+		jac_add(dSGN, -(r < 0. ? -1. : 1.)*r/ASN, dASN);
+
+		r = alpha/ASM;
+		SGM = fabs(r);
+		jac_set(dSGM, (r < 0. ? -1. : 1.)/ASM, dalpha);
+		jac_add(dSGM, -(r < 0. ? -1. : 1.)*r/ASM, dASM);
+
+		SGMAX = 1.839 - 70.33*fabs(B);
+		if (SGMAX > 1.86) {
+			SGMAX = 1.86;
+
+		} else {
+			jac_set(dSGMAX, B < 0. ? 70.33 : -70.33, dB);
+		}
+		if (SGN > SGMAX) {
+			SGN = SGMAX;
+			jac_set(dSGN, 1., dSGMAX);
+		}
+		if (SGM > SGMAX) {
+			SGM = SGMAX;
+			jac_set(dSGM, 1., dSGMAX);
+		}
+
+		/* DAN = I*ASN; pA, pB, pS partials of I */
+		E1 = exp(-1072.52*A2);
+		E2 = exp(-40316.42*B2);
+		x = A*(PN[U_3] + PN[U_7]*SGN) + A2*(PN[U_9] + PN[U10]*SGN);
+		I = A*(PN[U_1] + PN[U_5]*SGN) + B*(PN[U_2] + PN[U_6]*SGN)
+			+ E1*x + E2*B*(PN[U_4] + PN[U_8]*SGN);
+		pA = PN[U_1] + PN[U_5]*SGN
+			+ E1*(PN[U_3] + PN[U_7]*SGN
+				+ 2.*A*(PN[U_9] + PN[U10]*SGN))
+			- 2.*1072.52*A*E1*x;
+		pB = PN[U_2] + PN[U_6]*SGN
+			+ E2*(PN[U_4] + PN[U_8]*SGN)*(1. - 2.*40316.42*B2);
+		pS = A*PN[U_5] + B*PN[U_6] + E1*(A*PN[U_7] + A2*PN[U10])
+			+ E2*B*PN[U_8];
+		DAN = I*ASN;
+		jac_set(dDAN, pA*ASN, dA);
+		jac_add(dDAN, pB*ASN, dB);
+		jac_add(dDAN, pS*ASN, dSGN);
+		jac_add(dDAN, I, dASN);
+
+		DCN = A*(QN[U_1] + QN[U_3]*A2 + SGN*(QN[U_7] + QN[U_9]*A2 + QN[U13]*SGN)
+				+ B2*(QN[U_5] + QN[U11]*SGN))
+			+ B*(QN[U_2] + QN[U_4]*A2
+					+ SGN*(QN[U_8] + QN[U10]*A2 + QN[U14]*SGN)
+					+ B2*(QN[U_6] + QN[U12]*SGN));
+		pA = QN[U_1] + 3.*QN[U_3]*A2
+			+ SGN*(QN[U_7] + 3.*QN[U_9]*A2 + QN[U13]*SGN)
+			+ B2*(QN[U_5] + QN[U11]*SGN)
+			+ 2.*A*B*(QN[U_4] + QN[U10]*SGN);
+		pB = 2.*A*B*(QN[U_5] + QN[U11]*SGN)
+			+ QN[U_2] + QN[U_4]*A2
+			+ SGN*(QN[U_8] + QN[U10]*A2 + QN[U14]*SGN)
+			+ 3.*B2*(QN[U_6] + QN[U12]*SGN);
+		pS = A*(QN[U_7] + QN[U_9]*A2 + 2.*QN[U13]*SGN + QN[U11]*B2)
+			+ B*(QN[U_8] + QN[U10]*A2 + 2.*QN[U14]*SGN + QN[U12]*B2);
+		jac_set(dDCN, pA, dA);
+		jac_add(dDCN, pB, dB);
+		jac_add(dDCN, pS, dSGN);
+
+		I = A*(PM[U_1] + PM[U_3]*A2 + PM[U_5]*B2 + PM[U10]*SGM + PM[U_7]*A)
+			+ B*(PM[U_2] + PM[U_4]*B2 + PM[U_6]*A2
+				+ PM[U11]*SGM + PM[U_8]*B + PM[U_9]*A);
+		pA = PM[U_1] + 3.*PM[U_3]*A2 + PM[U_5]*B2 + PM[U10]*SGM
+			+ 2.*PM[U_7]*A + B*(2.*PM[U_6]*A + PM[U_9]);
+		pB = 2.*PM[U_5]*A*B + PM[U_2] + 3.*PM[U_4]*B2 + PM[U_6]*A2
+			+ PM[U11]*SGM + 2.*PM[U_8]*B + PM[U_9]*A;
+		pS = A*PM[U10] + B*PM[U11];
+		DAM = I*ASM;
+		jac_set(dDAM, pA*ASM, dA);
+		jac_add(dDAM, pB*ASM, dB);
+		jac_add(dDAM, pS*ASM, dSGM);
+		jac_add(dDAM, I, dASM);
+
+		S2 = SGM*SGM;
+		DCM = A*(QM[U_2] + QM[U_8]*A + SGM*(QM[U_4] + QM[U10]*A)
+				+ S2*(QM[U_6] + QM[U12]*A))
+			+ B*(QM[U_1] + QM[U_7]*B + SGM*(QM[U_3] + QM[U_9]*B)
+					+ S2*(QM[U_5] + QM[U11]*B));
+		pA = QM[U_2] + 2.*QM[U_8]*A + SGM*(QM[U_4] + 2.*QM[U10]*A)
+			+ S2*(QM[U_6] + 2.*QM[U12]*A);
+		pB = QM[U_1] + 2.*QM[U_7]*B + SGM*(QM[U_3] + 2.*QM[U_9]*B)
+			+ S2*(QM[U_5] + 2.*QM[U11]*B);
+		pS = A*(QM[U_4] + QM[U10]*A + 2.*SGM*(QM[U_6] + QM[U12]*A))
+			+ B*(QM[U_3] + QM[U_9]*B + 2.*SGM*(QM[U_5] + QM[U11]*B));
+		jac_set(dDCM, pA, dA);
+		jac_add(dDCM, pB, dB);
+		jac_add(dDCM, pS, dSGM);
+
+		if (alpha < 0.) {
+			DAN = -DAN;
+			DCN = -DCN;
+			DAM = -DAM;
+			DCM = -DCM;
+			jac_set(dDAN, -1., dDAN);
+			jac_set(dDCN, -1., dDCN);
+			jac_set(dDAM, -1., dDAM);
+			jac_set(dDCM, -1., dDCM);
+		}
+
+		alphaN = (alpha - DAN)*RAD2DEG;
+		jac_set(dalphaN, RAD2DEG, dalpha);
+		jac_add(dalphaN, -RAD2DEG, dDAN);
+		alphaM = (alpha - DAM)*RAD2DEG;
+		jac_set(dalphaM, RAD2DEG, dalpha);
+		jac_add(dalphaM, -RAD2DEG, dDAM);
+
+		get_coef_all_d(data, alphaN, alphaM, mach,
+			c, c_a, c_m, mc, mc_m);
+
+		cl = c[C81_GRID_CL];
+		jac_set(dcl, c_a[C81_GRID_CL], dalphaN);
+		jac_add(dcl, c_m[C81_GRID_CL], dmach);
+		cd = c[C81_GRID_CD];
+		jac_set(dcd, c_a[C81_GRID_CD], dalphaN);
+		jac_add(dcd, c_m[C81_GRID_CD], dmach);
+		cm = c[C81_GRID_CM];
+		jac_set(dcm, c_a[C81_GRID_CM], dalphaM);
+		jac_add(dcm, c_m[C81_GRID_CM], dmach);
+		cl0 = mc[C81_GRID_CL0];
+		jac_set(dcl0, mc_m[C81_GRID_CL0], dmach);
+		cd0 = mc[C81_GRID_CD0];
+		jac_set(dcd0, mc_m[C81_GRID_CD0], dmach);
+		dcla = mc[C81_GRID_DCLA];
+		jac_set(ddcla, mc_m[C81_GRID_DCLA], dmach);
+		dcma = mc[C81_GRID_DCMA];
+		jac_set(ddcma, mc_m[C81_GRID_DCMA], dmach);
+
+		/* note: cl/alpha in 1/deg */
+		dclatan = dcla;
+		jac_set(ddclatan, 1., ddcla);
+		if (fabs(alphaN) > 1.e-6) {
+			x = alphaN*cosgam;
+			dclatan = (cl - cl0)/x;
+			for (k = 0; k < 6; k++) {
+				ddclatan[k] = (dcl[k] - dcl0[k])/x
+					- dclatan*(dalphaN[k]*cosgam
+						+ alphaN*dcosgam[k])/x;
+			}
+		}
+		cl = cl0 + dclatan*alphaN;
+		jac_set(dcl, 1., dcl0);
+		jac_add(dcl, alphaN, ddclatan);
+		jac_add(dcl, dclatan, dalphaN);
+
+		/* back to 1/rad */
+		dcla *= RAD2DEG;
+		jac_set(ddcla, RAD2DEG, ddcla);
+		dcma *= RAD2DEG;
+		jac_set(ddcma, RAD2DEG, ddcma);
+
+		C1 = .9457/sqrt(1. - mach*mach);
+		jac_set(dC1, C1*mach/(1. - mach*mach), dmach);
+
+		cn = dcla*DAN + DCN*C1;
+		jac_set(dcn, DAN, ddcla);
+		jac_add(dcn, dcla, dDAN);
+		jac_add(dcn, C1, dDCN);
+		jac_add(dcn, DCN, dC1);
+
+		/* cl += cn*vx/vp, cd -= cn*vy/vp */
+		jac_add(dcl, vx/vp, dcn);
+		jac_add(dcl, cn/vp, dvx);
+		jac_add(dcl, -cn*vx/vp2, dvp);
+		cl += cn*vx/vp;
+
+		jac_add(dcd, -vy/vp, dcn);
+		jac_add(dcd, -cn/vp, dvy);
+		jac_add(dcd, cn*vy/vp2, dvp);
+		cd -= cn*vy/vp;
+
+		jac_add(dcm, DAM, ddcma);
+		jac_add(dcm, dcma, dDAM);
+		jac_add(dcm, C1, dDCM);
+		jac_add(dcm, DCM, dC1);
+		cm += dcma*DAM + DCM*C1;
+		break;
+	}
+
+	default:
+		return -1;
+	}
+
+	/*
+	 * forces as in c81_aerod2_u(), with h = q/vp:
+	 * TNG[V_X] = -h*(cl*vy + cd*vx), TNG[V_Y] = h*(cl*vx - cd*vy),
+	 * TNG[V_Z] = -h*cd0*vz, TNG[W_Y] = -ca*TNG[V_Z],
+	 * TNG[W_Z] = q*chord*cm + ca*TNG[V_Y]
+	 */
+	h = .5*rho*chord*vp;
+	jac_set(dh, .5*rho*chord, dvp);
+
+	jac_set(dT[V_X], -(cl*vy + cd*vx), dh);
+	jac_add(dT[V_X], -h*vy, dcl);
+	jac_add(dT[V_X], -h*cl, dvy);
+	jac_add(dT[V_X], -h*vx, dcd);
+	jac_add(dT[V_X], -h*cd, dvx);
+
+	jac_set(dT[V_Y], cl*vx - cd*vy, dh);
+	jac_add(dT[V_Y], h*vx, dcl);
+	jac_add(dT[V_Y], h*cl, dvx);
+	jac_add(dT[V_Y], -h*vy, dcd);
+	jac_add(dT[V_Y], -h*cd, dvy);
+
+	jac_set(dT[V_Z], -cd0*vz, dh);
+	jac_add(dT[V_Z], -h*vz, dcd0);
+	jac_add(dT[V_Z], -h*cd0, dvz);
+
+	jac_set(dT[W_X], 0., dh);
+
+	jac_set(dT[W_Y], -ca, dT[V_Z]);
+
+	/* q*chord*cm = h*vp*chord*cm */
+	jac_set(dT[W_Z], chord*cm*vp, dh);
+	jac_add(dT[W_Z], chord*cm*h, dvp);
+	jac_add(dT[W_Z], h*vp*chord, dcm);
+	jac_add(dT[W_Z], ca, dT[V_Y]);
+
+	for (i = 0; i < 6; i++) {
+		int k;
+
+		for (k = 0; k < 6; k++) {
+			J[6*i + k] = dT[i][k];
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * batched steady evaluation of n sections; same model as
+ * c81_aerod2_u() with unsteadyflag == 0.
+ *
+ * Inputs and outputs are structure-of-arrays: W[k][j] and TNG[k][j]
+ * are the k-th component of section j; chord, ca, c34 and data are
+ * per section.  Sections are processed in blocks of C81_BATCH_BLOCK:
+ * kinematics and forces are computed in straight loops over the block,
+ * only the table lookups are done point by point.
+ */
+int
+c81_aerod2_batch(int n, const doublereal *const W[6],
+		doublereal rho, doublereal cs,
+		const doublereal *chord, const doublereal *ca, const doublereal *c34,
+		doublereal *const TNG[6], outa_t *OUTA,
+		const c81_data *const *data)
+{
+	const doublereal RAD2DEG = 180.*M_1_PI;
+	const doublereal SQRT3 = sqrt(3.);
+
+	enum { V_X = 0, V_Y = 1, V_Z = 2, W_X = 3, W_Y = 4, W_Z = 5 };
+
+	doublereal ch[C81_BATCH_BLOCK], xa[C81_BATCH_BLOCK];
+	doublereal vx[C81_BATCH_BLOCK], vy[C81_BATCH_BLOCK], vz[C81_BATCH_BLOCK];
+	doublereal vp[C81_BATCH_BLOCK], vp2[C81_BATCH_BLOCK];
+	doublereal alpha[C81_BATCH_BLOCK];
+	doublereal cosgam[C81_BATCH_BLOCK], mach[C81_BATCH_BLOCK];
+	doublereal cl[C81_BATCH_BLOCK], cl0[C81_BATCH_BLOCK];
+	doublereal cd[C81_BATCH_BLOCK], cd0[C81_BATCH_BLOCK];
+	doublereal cm[C81_BATCH_BLOCK], dcla[C81_BATCH_BLOCK];
+	doublereal t[6][C81_BATCH_BLOCK];
+	int j0, k;
+
+	for (j0 = 0; j0 < n; j0 += C81_BATCH_BLOCK) {
+		int nb = n - j0 < C81_BATCH_BLOCK ? n - j0 : C81_BATCH_BLOCK;
+		int j;
+
+		/*
+		 * velocity at the boundary condition point; the cosine
+		 * of the sweep angle gamma = atan2(-vz, |vx|), limited
+		 * to 60 deg, is computed without trigonometric functions
+		 * so that this loop vectorizes
+		 */
+		for (j = 0; j < nb; j++) {
+			doublereal vt, vxz, s, g;
+
+			ch[j] = chord[j0 + j];
+			xa[j] = ca[j0 + j];
+
+			vx[j] = W[V_X][j0 + j];
+			vy[j] = W[V_Y][j0 + j] + c34[j0 + j]*W[W_Z][j0 + j];
+			vz[j] = W[V_Z][j0 + j] - c34[j0 + j]*W[W_Y][j0 + j];
+
+			vp2[j] = vx[j]*vx[j] + vy[j]*vy[j];
+			vp[j] = sqrt(vp2[j]);
+			vt = sqrt(vp2[j] + vz[j]*vz[j]);
+
+			/* s = 1 when vx = vz = 0, i.e. gamma = 0;
+			 * g = 1 when |gamma| > 60 deg */
+			vxz = sqrt(vx[j]*vx[j] + vz[j]*vz[j]);
+			s = vxz > 0. ? 0. : 1.;
+			g = fabs(vz[j]) > SQRT3*fabs(vx[j]) ? 1. : 0.;
+			cosgam[j] = .5*g + (1. - g)*(fabs(vx[j]) + s)/(vxz + s);
+			mach[j] = (vt*sqrt(cosgam[j]))/cs;
+		}
+
+		/* coefficients (mach cannot be more than .99) */
+		for (j = 0; j < nb; j++) {
+			const c81_data *d = data[j0 + j];
+			doublereal a, m;
+
+			alpha[j] = atan2(-vy[j], vx[j]);
+			a = alpha[j]*RAD2DEG;
+			m = mach[j] > .99 ? .99 : mach[j];
+
+			if (d->grid != NULL) {
+				doublereal c[C81_GRID_NC], mc[C81_GRID_NMC];
+
+				grid_get(d->grid, a, m, c, mc);
+				cl[j] = c[C81_GRID_CL];
+				cd[j] = c[C81_GRID_CD];
+				cm[j] = c[C81_GRID_CM];
+				cl0[j] = mc[C81_GRID_CL0];
+				cd0[j] = mc[C81_GRID_CD0];
+				dcla[j] = mc[C81_GRID_DCLA];
+
+			} else {
+				c81_data *dd = (c81_data *)d;
+
+				get_coef(dd->NML, dd->ml, dd->NAL, dd->al,
+						a, m, &cl[j], &cl0[j]);
+				get_coef(dd->NMD, dd->md, dd->NAD, dd->ad,
+						a, m, &cd[j], &cd0[j]);
+				get_coef(dd->NMM, dd->mm, dd->NAM, dd->am,
+						a, m, &cm[j], NULL);
+				dcla[j] = get_dcla(dd->NML, dd->ml, dd->stall, m);
+			}
+		}
+
+		/* secant correction for sweep, see c81_aerod2_u() */
+		for (j = 0; j < nb; j++) {
+			int a = fabs(alpha[j]) > 1.e-6;
+			doublereal d = dcla[j]*RAD2DEG;
+			doublereal dclatmp = (cl[j] - cl0[j])
+				/(alpha[j]*cosgam[j] + (a ? 0. : 1.));
+			doublereal clsec = cl0[j] + dclatmp*alpha[j];
+			int u = a & (dclatmp < d);
+
+			dcla[j] = u ? dclatmp : d;
+			cl[j] = u ? clsec : cl[j];
+		}
+
+		/*
+		 * airfoil forces and moments in the airfoil frame;
+		 * z = 0 zeroes sections below the velocity threshold
+		 */
+		for (j = 0; j < nb; j++) {
+			doublereal z = vp[j]/cs < 1.e-6 ? 0. : 1.;
+			doublereal q = .5*rho*ch[j]*vp2[j]*z;
+			doublereal qv = q/(vp[j] + 1. - z);
+
+			t[V_X][j] = -qv*(cl[j]*vy[j] + cd[j]*vx[j]);
+			t[V_Y][j] = qv*(cl[j]*vx[j] - cd[j]*vy[j]);
+			t[V_Z][j] = -qv*cd0[j]*vz[j];
+			t[W_X][j] = 0.;
+			t[W_Y][j] = -xa[j]*t[V_Z][j];
+			t[W_Z][j] = q*ch[j]*cm[j] + xa[j]*t[V_Y][j];
+		}
+
+		/* separate stores, so that the loop above needs
+		 * no aliasing checks among the output arrays */
+		for (k = 0; k < 6; k++) {
+			memcpy(&TNG[k][j0], t[k], nb*sizeof(doublereal));
+		}
+
+		for (j = 0; j < nb; j++) {
+			outa_t *o = &OUTA[j0 + j];
+
+			if (vp[j]/cs < 1.e-6) {
+				o->alpha = 0.;
+				o->gamma = 0.;
+				o->mach = 0.;
+				o->cl = 0.;
+				o->cd = 0.;
+				o->cm = 0.;
+				o->clalpha = 0.;
+
+			} else {
+				o->alpha = alpha[j]*RAD2DEG;
+				o->gamma = atan2(-vz[j], fabs(vx[j]))*RAD2DEG;
+				o->mach = mach[j];
+				o->cl = cl[j];
+				o->cd = cd[j];
+				o->cm = cm[j];
+				o->clalpha = dcla[j];
+			}
+		}
+	}
+
+	return 0;
+}
+
 /*
  * trova un coefficiente dato l'angolo ed il numero di Mach
  *
@@ -795,6 +1524,99 @@ get_dcla(int nm, doublereal* m, doublereal* s, doublereal mach)
 	}
 }
 
+/*
+ * same interpolation as get_coef(), with the partial derivatives
+ * with respect to alpha (1/deg) and mach; the derivatives are zero
+ * where the tables are clamped
+ */
+static void
+get_coef_d(int nm, doublereal* m, int na, doublereal* a,
+		doublereal alpha, doublereal mach,
+		doublereal* c, doublereal* c_a, doublereal* c_m)
+{
+	int im, im1, ia, ia1;
+	doublereal tm = 0., tm_m = 0., ta = 0., ta_a = 0.;
+	doublereal c00, c01, c10, c11, a0, a1;
+
+	while (alpha < -180.) {
+		alpha += 360.;
+	}
+
+	while (alpha >= 180.) {
+		alpha -= 360.;
+	}
+
+	mach = fabs(mach);
+
+	im = bisec_d(m, mach, 0, nm - 1);
+	if (im == nm - 1) {
+		im1 = im;
+
+	} else if (im == -1) {
+		im = im1 = 0;
+
+	} else {
+		im1 = im + 1;
+		tm_m = 1./(m[im1] - m[im]);
+		tm = (mach - m[im])*tm_m;
+	}
+
+	ia = bisec_d(a, alpha, 0, na - 1);
+	if (ia == na - 1) {
+		ia1 = ia;
+
+	} else if (ia == -1) {
+		ia = ia1 = 0;
+
+	} else {
+		ia1 = ia + 1;
+		ta_a = 1./(a[ia1] - a[ia]);
+		ta = (alpha - a[ia])*ta_a;
+	}
+
+	c00 = a[na*(im + 1) + ia];
+	c01 = a[na*(im + 1) + ia1];
+	c10 = a[na*(im1 + 1) + ia];
+	c11 = a[na*(im1 + 1) + ia1];
+
+	a0 = (1. - ta)*c00 + ta*c01;
+	a1 = (1. - ta)*c10 + ta*c11;
+
+	*c = (1. - tm)*a0 + tm*a1;
+	*c_a = ((1. - tm)*(c01 - c00) + tm*(c11 - c10))*ta_a;
+	*c_m = (a1 - a0)*tm_m;
+}
+
+/* get_dcla() and its derivative with respect to mach */
+static doublereal
+get_dcla_d(int nm, doublereal* m, doublereal* s, doublereal mach,
+		doublereal *dcla_m)
+{
+	int im;
+
+	mach = fabs(mach);
+
+	im = bisec_d(m, mach, 0, nm - 1);
+
+	if (im == nm - 1) {
+		*dcla_m = 0.;
+		return s[3*nm - 1];
+
+	} else if (im == -1) {
+		*dcla_m = 0.;
+		return s[2*nm];
+
+	} else {
+		doublereal d;
+
+		im++;
+		*dcla_m = (s[2*nm + im] - s[2*nm + im - 1])/(m[im] - m[im - 1]);
+		d = (mach - m[im - 1])/(m[im] - m[im - 1]);
+
+		return (1. - d)*s[2*nm + im - 1] + d*s[2*nm + im];
+	}
+}
+
 #ifdef USE_GET_STALL
 static int
 get_stall(int nm, doublereal* m, doublereal* s, doublereal mach,
@@ -829,3 +1651,324 @@ get_stall(int nm, doublereal* m, doublereal* s, doublereal mach,
 }
 #endif /* USE_GET_STALL */
 
+
+/*
+ * uniform grid
+ *
+ * the grid is sampled from the original tables using get_coef()
+ * and get_dcla(), so between nodes it reproduces them exactly
+ * wherever they are linear; the error is confined to the cells
+ * that contain a breakpoint of the original tables, and is
+ * reported by c81_data_grid_check().
+ */
+
+/* locates x in nodes x0 + k/dx_inv, k = 0..n-1 (n >= 2) */
+static int
+grid_locate(doublereal x, doublereal x0, doublereal dx_inv, int n, doublereal *t)
+{
+	doublereal f = (x - x0)*dx_inv;
+	int k;
+
+	if (f <= 0.) {
+		*t = 0.;
+		return 0;
+	}
+
+	if (f >= (doublereal)(n - 1)) {
+		*t = 1.;
+		return n - 2;
+	}
+
+	k = (int)f;
+	*t = f - k;
+
+	return k;
+}
+
+static void
+grid_get(const c81_grid *g, doublereal alpha, doublereal mach,
+		doublereal *c, doublereal *mc)
+{
+	doublereal ta, tm;
+	int ia, im, k;
+	const doublereal *c00, *c01, *c10, *c11;
+
+	/* same normalization as get_coef(), without loops */
+	if (alpha < -180. || alpha >= 180.) {
+		alpha -= 360.*floor((alpha + 180.)/360.);
+	}
+
+	mach = fabs(mach);
+
+	ia = grid_locate(alpha, -180., g->da_inv, g->NA, &ta);
+	im = grid_locate(mach, g->m0, g->dm_inv, g->NM, &tm);
+
+	c00 = &g->c[(im*g->NA + ia)*C81_GRID_NC];
+	c01 = c00 + C81_GRID_NC;
+	c10 = c00 + g->NA*C81_GRID_NC;
+	c11 = c10 + C81_GRID_NC;
+
+	for (k = 0; k < C81_GRID_NC; k++) {
+		c[k] = (1. - tm)*((1. - ta)*c00[k] + ta*c01[k])
+			+ tm*((1. - ta)*c10[k] + ta*c11[k]);
+	}
+
+	if (mc != NULL) {
+		const doublereal *m0 = &g->mc[im*C81_GRID_NMC];
+		const doublereal *m1 = m0 + C81_GRID_NMC;
+
+		for (k = 0; k < C81_GRID_NMC; k++) {
+			mc[k] = (1. - tm)*m0[k] + tm*m1[k];
+		}
+	}
+}
+
+/* grid_get() with the partial derivatives with respect to alpha and mach */
+static void
+grid_get_d(const c81_grid *g, doublereal alpha, doublereal mach,
+		doublereal *c, doublereal *c_a, doublereal *c_m,
+		doublereal *mc, doublereal *mc_m)
+{
+	doublereal ta, tm, ta_a, tm_m;
+	int ia, im, k;
+	const doublereal *c00, *c01, *c10, *c11;
+
+	if (alpha < -180. || alpha >= 180.) {
+		alpha -= 360.*floor((alpha + 180.)/360.);
+	}
+
+	mach = fabs(mach);
+
+	ia = grid_locate(alpha, -180., g->da_inv, g->NA, &ta);
+	im = grid_locate(mach, g->m0, g->dm_inv, g->NM, &tm);
+
+	/* clamped outside the grid */
+	ta_a = (alpha > -180. && alpha < 180.) ? g->da_inv : 0.;
+	tm_m = (mach > g->m0 && mach < g->m0 + (g->NM - 1)*g->dm) ? g->dm_inv : 0.;
+
+	c00 = &g->c[(im*g->NA + ia)*C81_GRID_NC];
+	c01 = c00 + C81_GRID_NC;
+	c10 = c00 + g->NA*C81_GRID_NC;
+	c11 = c10 + C81_GRID_NC;
+
+	for (k = 0; k < C81_GRID_NC; k++) {
+		doublereal a0 = (1. - ta)*c00[k] + ta*c01[k];
+		doublereal a1 = (1. - ta)*c10[k] + ta*c11[k];
+
+		c[k] = (1. - tm)*a0 + tm*a1;
+		c_a[k] = ((1. - tm)*(c01[k] - c00[k]) + tm*(c11[k] - c10[k]))*ta_a;
+		c_m[k] = (a1 - a0)*tm_m;
+	}
+
+	if (mc != NULL) {
+		const doublereal *m0 = &g->mc[im*C81_GRID_NMC];
+		const doublereal *m1 = m0 + C81_GRID_NMC;
+
+		for (k = 0; k < C81_GRID_NMC; k++) {
+			mc[k] = (1. - tm)*m0[k] + tm*m1[k];
+			mc_m[k] = (m1[k] - m0[k])*tm_m;
+		}
+	}
+}
+
+static void
+grid_sample(const c81_data *data, doublereal alpha, doublereal mach,
+		doublereal *c, doublereal *mc)
+{
+	c81_data *d = (c81_data *)data;
+
+	get_coef(d->NML, d->ml, d->NAL, d->al, alpha, mach,
+		&c[C81_GRID_CL], mc ? &mc[C81_GRID_CL0] : NULL);
+	get_coef(d->NMD, d->md, d->NAD, d->ad, alpha, mach,
+		&c[C81_GRID_CD], mc ? &mc[C81_GRID_CD0] : NULL);
+	get_coef(d->NMM, d->mm, d->NAM, d->am, alpha, mach,
+		&c[C81_GRID_CM], NULL);
+	c[C81_GRID_NC - 1] = 0.;
+
+	if (mc != NULL) {
+		mc[C81_GRID_DCLA] = get_dcla(d->NML, d->ml, d->stall, mach);
+		mc[C81_GRID_DCMA] = get_dcla(d->NMM, d->mm, d->mstall, mach);
+	}
+}
+
+int
+c81_data_grid_build(c81_data *data, doublereal da, doublereal dm)
+{
+	c81_grid *g;
+	doublereal m0, m1;
+	size_t nc, nmc;
+	char *p;
+	int i, j;
+
+	if (data == NULL || da <= 0. || dm <= 0.
+		|| data->NML <= 0 || data->NMD <= 0 || data->NMM <= 0)
+	{
+		return -1;
+	}
+
+	c81_data_grid_destroy(data);
+
+	g = (c81_grid *)malloc(sizeof(c81_grid));
+	if (g == NULL) {
+		return -1;
+	}
+
+	/* the nodes hit -180 and 180 exactly */
+	g->NA = (int)ceil(360./da) + 1;
+	g->da = 360./(g->NA - 1);
+	g->da_inv = 1./g->da;
+
+	m0 = data->ml[0];
+	if (data->md[0] < m0) {
+		m0 = data->md[0];
+	}
+	if (data->mm[0] < m0) {
+		m0 = data->mm[0];
+	}
+	if (m0 < 0.) {
+		m0 = 0.;
+	}
+
+	m1 = data->ml[data->NML - 1];
+	if (data->md[data->NMD - 1] > m1) {
+		m1 = data->md[data->NMD - 1];
+	}
+	if (data->mm[data->NMM - 1] > m1) {
+		m1 = data->mm[data->NMM - 1];
+	}
+
+	g->m0 = m0;
+	if (m1 > m0) {
+		g->NM = (int)ceil((m1 - m0)/dm) + 1;
+		if (g->NM < 2) {
+			g->NM = 2;
+		}
+		g->dm = (m1 - m0)/(g->NM - 1);
+
+	} else {
+		/* single Mach number: two identical rows */
+		g->NM = 2;
+		g->dm = 1.;
+	}
+	g->dm_inv = 1./g->dm;
+
+	nc = (size_t)g->NA*g->NM*C81_GRID_NC;
+	nmc = (size_t)g->NM*C81_GRID_NMC;
+	g->mem = malloc((nc + nmc)*sizeof(doublereal) + 64);
+	if (g->mem == NULL) {
+		free(g);
+		return -1;
+	}
+
+	p = (char *)g->mem;
+	p += (64 - ((size_t)p % 64)) % 64;
+	g->c = (doublereal *)p;
+	g->mc = g->c + nc;
+
+	for (j = 0; j < g->NM; j++) {
+		doublereal mach = (j == g->NM - 1 && m1 > m0) ? m1 : m0 + j*g->dm;
+		doublereal c[C81_GRID_NC];
+
+		grid_sample(data, 0., mach, c, &g->mc[j*C81_GRID_NMC]);
+
+		for (i = 0; i < g->NA; i++) {
+			doublereal alpha = -180. + i*g->da;
+
+			/* get_coef() maps 180 to -180; take the limit from below */
+			if (i == g->NA - 1) {
+				alpha = nextafter(180., 0.);
+			}
+
+			grid_sample(data, alpha, mach, &g->c[(j*g->NA + i)*C81_GRID_NC], NULL);
+		}
+	}
+
+	data->grid = g;
+
+	return 0;
+}
+
+void
+c81_data_grid_destroy(c81_data *data)
+{
+	if (data != NULL && data->grid != NULL) {
+		free(data->grid->mem);
+		free(data->grid);
+		data->grid = NULL;
+	}
+}
+
+/*
+ * max absolute difference between the grid and the original tables,
+ * at the center of each grid cell and at all the breakpoints
+ * of the original tables
+ */
+static void
+grid_check_one(const c81_data *data, doublereal alpha, doublereal mach,
+		doublereal *err)
+{
+	doublereal c[C81_GRID_NC], c0[C81_GRID_NC], mc[C81_GRID_NMC];
+	doublereal cg[C81_GRID_NC], mcg[C81_GRID_NMC];
+	int k;
+
+	grid_sample(data, alpha, mach, c, NULL);
+	grid_sample(data, 0., mach, c0, mc);
+	grid_get(data->grid, alpha, mach, cg, mcg);
+
+	for (k = 0; k < C81_GRID_NC - 1; k++) {
+		doublereal e = fabs(cg[k] - c[k]);
+		if (e > err[k]) {
+			err[k] = e;
+		}
+	}
+
+	for (k = 0; k < C81_GRID_NMC; k++) {
+		doublereal e = fabs(mcg[k] - mc[k]);
+		if (e > err[C81_GRID_NC + k]) {
+			err[C81_GRID_NC + k] = e;
+		}
+	}
+}
+
+int
+c81_data_grid_check(const c81_data *data, doublereal *err)
+{
+	const c81_grid *g;
+	const doublereal *va[3], *vm[3];
+	int na[3], nm[3];
+	int i, j, k, l;
+
+	if (data == NULL || data->grid == NULL) {
+		return -1;
+	}
+
+	g = data->grid;
+
+	for (k = 0; k < C81_GRID_NERR; k++) {
+		err[k] = 0.;
+	}
+
+	for (j = 0; j < g->NM - 1; j++) {
+		doublereal mach = g->m0 + (j + .5)*g->dm;
+
+		for (i = 0; i < g->NA - 1; i++) {
+			grid_check_one(data, -180. + (i + .5)*g->da, mach, err);
+		}
+	}
+
+	va[0] = data->al; na[0] = data->NAL; vm[0] = data->ml; nm[0] = data->NML;
+	va[1] = data->ad; na[1] = data->NAD; vm[1] = data->md; nm[1] = data->NMD;
+	va[2] = data->am; na[2] = data->NAM; vm[2] = data->mm; nm[2] = data->NMM;
+
+	for (l = 0; l < 3; l++) {
+		for (j = 0; j < nm[l]; j++) {
+			for (i = 0; i < na[l]; i++) {
+				if (va[l][i] > -180. && va[l][i] < 180.) {
+					grid_check_one(data, va[l][i], vm[l][j], err);
+				}
+			}
+		}
+	}
+
+	return 0;
+}
@@ -113,6 +113,52 @@ typedef struct vam_t {
 	doublereal twist;
 } vam_t;
 
+/*
+ * optional resampling of c81 data on a uniform alpha x Mach grid;
+ * alpha nodes span [-180, 180] deg, Mach nodes the range of the
+ * original tables.  Lookups are direct-index bilinear interpolation.
+ * Node values are interleaved (cl, cd, cm, pad), Mach-major, so the
+ * four nodes of a lookup lie in two cache lines; per-Mach data
+ * (coefficients at zero incidence, stall slopes) are precomputed.
+ */
+enum {
+	C81_GRID_CL = 0,
+	C81_GRID_CD,
+	C81_GRID_CM,
+
+	C81_GRID_NC = 4
+};
+
+enum {
+	C81_GRID_CL0 = 0,
+	C81_GRID_CD0,
+	C81_GRID_DCLA,
+	C81_GRID_DCMA,
+
+	C81_GRID_NMC = 4
+};
+
+/* errors reported by c81_data_grid_check(): C81_GRID_CL..CM,
+ * then C81_GRID_NC + C81_GRID_CL0..DCMA */
+#define C81_GRID_NERR	(C81_GRID_NC + C81_GRID_NMC)
+
+typedef struct c81_grid {
+	int NA;
+	int NM;
+	doublereal da;
+	doublereal da_inv;
+	doublereal m0;
+	doublereal dm;
+	doublereal dm_inv;
+
+	/* NM*NA nodes, C81_GRID_NC values each, 64-byte aligned */
+	doublereal *c;
+	/* NM nodes, C81_GRID_NMC values each */
+	doublereal *mc;
+
+	void *mem;
+} c81_grid;
+
 /* 
  * dati in formato c81;
  * le array mX contengono gli NMX numeri di mach;
@@ -166,8 +212,18 @@ typedef struct c81_data {
    	int NAM;
    	doublereal *mm;
    	doublereal *am;
+
+	/* uniform grid, or NULL */
+	c81_grid *grid;
 } c81_data;
 
+extern int
+c81_data_grid_build(c81_data *data, doublereal da, doublereal dm);
+extern void
+c81_data_grid_destroy(c81_data *data);
+extern int
+c81_data_grid_check(const c81_data *data, doublereal *err);
+
 extern int 
 c81_aerod2(doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUTA, c81_data* data);
 
@@ -175,6 +231,27 @@ extern int
 c81_aerod2_u(doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUTA, 
 		c81_data* data, long unsteadyflag);
 
+/*
+ * c81_aerod2_u() and the Jacobian of TNG with respect to W,
+ * J[6*i + j] = dTNG[i]/dW[j]; dalf[0], dalf[1] are the derivatives
+ * of OUTA->alf1, OUTA->alf2 with respect to the predicted incidence
+ * (unsteady models only).  Returns -1 for unsupported models
+ */
+extern int
+c81_aerod2_u_jac(doublereal* W, const vam_t *VAM, doublereal* TNG,
+		doublereal* J, outa_t* OUTA, c81_data* data,
+		long unsteadyflag, const doublereal *dalf);
+
+/* sections per block in c81_aerod2_batch() */
+#define C81_BATCH_BLOCK	16
+
+extern int
+c81_aerod2_batch(int n, const doublereal *const W[6],
+		doublereal rho, doublereal cs,
+		const doublereal *chord, const doublereal *ca, const doublereal *c34,
+		doublereal *const TNG[6], outa_t *OUTA,
+		const c81_data *const *data);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -42,6 +42,7 @@
 #include "aerodc81.h"
 #include "c81data.h"
 #include "Rot.hh"
+#include "checkpoint.h"
 
 #include <sstream>
 
@@ -185,12 +186,17 @@ Twist(pT),
 TipLoss(pTL),
 GDI(iN),
 OUTA(iNN*iN, outa_Zero),
+Kin(iNN*iN),
+XIndVel(iNN*iN),
+VIndVel(iNN*iN),
 bJacobian(bUseJacobian)
 {
 	DEBUGCOUTFNAME("Aerodynamic2DElem::Aerodynamic2DElem");
 
 	ASSERT(iNN >= 1 && iNN <= 3);
 	ASSERT(aerodata != 0);
+
+	Batch.Resize(iNN*iN);
 }
 
 template <unsigned iNN>
@@ -426,6 +432,20 @@ Aerodynamic2DElem<iNN>::AfterConvergence(
 	}
 }
 
+template <unsigned iNN>
+void
+Aerodynamic2DElem<iNN>::Checkpoint(std::ostream& out) const
+{
+	aerodata->Checkpoint(out);
+}
+
+template <unsigned iNN>
+void
+Aerodynamic2DElem<iNN>::Resume(std::istream& in)
+{
+	aerodata->Resume(in);
+}
+
 /* Dimensioni del workspace */
 template <unsigned iNN>
 void
@@ -1048,10 +1068,28 @@ AerodynamicBody::AssVec(SubVectorHandler& WorkVec,
 		}
 	}
 
-	/* Ciclo sui punti di Gauss */
+	/*
+	 * Se l'elemento e' collegato ad un rotore, la velocita' indotta
+	 * viene valutata in un'unica chiamata su tutti i punti di Gauss
+	 */
+	if (pIndVel != 0) {
+		PntWght PW = GDI.GetFirst();
+		unsigned uPnt = 0;
+		do {
+			XIndVel[uPnt] = Xn + Rn*(f + Ra3*(dHalfSpan*PW.dGetPnt()));
+			uPnt++;
+		} while (GDI.fGetNext(PW));
+
+		pIndVel->GetInducedVelocityBatch(GetElemType(), GetLabel(),
+			0, uPnt, &XIndVel[0], &VIndVel[0]);
+	}
+
+	/* Ciclo sui punti di Gauss: cinematica delle sezioni */
 	PntWght PW = GDI.GetFirst();
 	int iPnt = 0;
 	do {
+		SectionKinematics& K = Kin[iPnt];
+
 		doublereal dCsi = PW.dGetPnt();
 		Vec3 Xr(Rn*(f + Ra3*(dHalfSpan*dCsi)));
 		Vec3 Xnr = Xn + Xr;
@@ -1068,18 +1106,16 @@ AerodynamicBody::AssVec(SubVectorHandler& WorkVec,
 		 * aggiunge alla velocita' la velocita' indotta
 		 */
 		if (pIndVel != 0) {
-	 		Vr += pIndVel->GetInducedVelocity(GetElemType(),
-				GetLabel(), iPnt, Xnr);
+	 		Vr += VIndVel[iPnt];
 		}
 
 		/* Copia i dati nel vettore di lavoro dVAM */
 		doublereal dTw = Twist.dGet(dCsi) + dGet();
-		aerodata->SetSectionData(dCsi,
-			Chord.dGet(dCsi),
-			ForcePoint.dGet(dCsi),
-			VelocityPoint.dGet(dCsi),
-			dTw,
-			dOmega);
+		Batch.Abscissa[iPnt] = dCsi;
+		Batch.Chord[iPnt] = Chord.dGet(dCsi);
+		Batch.ForcePoint[iPnt] = ForcePoint.dGet(dCsi);
+		Batch.VelocityPoint[iPnt] = VelocityPoint.dGet(dCsi);
+		Batch.Twist[iPnt] = dTw;
 
 		/*
 		 * Lo svergolamento non viene piu' trattato in aerod2_; quindi
@@ -1110,8 +1146,19 @@ AerodynamicBody::AssVec(SubVectorHandler& WorkVec,
 		Vec3 WTmp = RRloc.MulTV(Wn);
 		WTmp.PutTo(&dW[3]);
 
-		/* Funzione di calcolo delle forze aerodinamiche */
+		for (int k = 0; k < 6; k++) {
+			Batch.W[k][iPnt] = dW[k];
+		}
+
+		/* Modelli con stati interni: forze punto per punto */
 		if (iNumDof) {
+			aerodata->SetSectionData(dCsi,
+				Batch.Chord[iPnt],
+				Batch.ForcePoint[iPnt],
+				Batch.VelocityPoint[iPnt],
+				dTw,
+				dOmega);
+
 			aerodata->AssRes(WorkVec, dCoef, XCurr, XPrimeCurr,
                 		iFirstEq, iFirstSubEq, iPnt, dW, dTng, OUTA[iPnt]);
 
@@ -1119,34 +1166,58 @@ AerodynamicBody::AssVec(SubVectorHandler& WorkVec,
 			iFirstEq += iNumDof;
 			iFirstSubEq += iNumDof;
 
-		} else {
-			aerodata->GetForces(iPnt, dW, dTng, OUTA[iPnt]);
+			for (int k = 0; k < 6; k++) {
+				Batch.TNG[k][iPnt] = dTng[k];
+			}
+		}
+
+		K.X = Xr;
+		K.V = Vr;
+		K.W = Wn;
+		K.R = RRloc;
+		K.dCsi = dCsi;
+		K.dWght = dHalfSpan*PW.dGetWght();
+
+		iPnt++;
+
+	} while (GDI.fGetNext(PW));
+
+	/* Funzione di calcolo delle forze aerodinamiche */
+	if (!iNumDof) {
+		Batch.dOmega = dOmega;
+		aerodata->GetForcesBatch(0, Batch, &OUTA[0]);
+	}
+
+	/* Ciclo sui punti di Gauss: assemblaggio delle forze */
+	for (iPnt = 0; iPnt < GDI.iGetNum(); iPnt++) {
+		const SectionKinematics& K = Kin[iPnt];
+
+		for (int k = 0; k < 6; k++) {
+			dTng[k] = Batch.TNG[k][iPnt];
+			dW[k] = Batch.W[k][iPnt];
 		}
 
 		/* Dimensionalizza le forze */
-		doublereal dWght = dHalfSpan*PW.dGetWght();
-		dTng[1] *= TipLoss.dGet(dCsi);
-		Vec3 FTmp(RRloc*(Vec3(&dTng[0])));
-		Vec3 MTmp(RRloc*(Vec3(&dTng[3])));
+		doublereal dWght = K.dWght;
+		dTng[1] *= TipLoss.dGet(K.dCsi);
+		Vec3 FTmp(K.R*(Vec3(&dTng[0])));
+		Vec3 MTmp(K.R*(Vec3(&dTng[3])));
 
 		// Se e' definito il rotore, aggiungere il contributo alla trazione
-		AddSectionalForce_int(iPnt, FTmp, MTmp, dWght, Xnr, RRloc, Vr, Wn);
+		AddSectionalForce_int(iPnt, FTmp, MTmp, dWght, Xn + K.X, K.R, K.V, K.W);
 
 		FTmp *= dWght;
 		MTmp *= dWght;
 
 		F += FTmp;
 		M += MTmp;
-		M += Xr.Cross(FTmp);
+		M += K.X.Cross(FTmp);
 
 		// specific for Gauss points force output
 		if (fToBeOutput()) {
-			SetData(VTmp, dTng, Xr, RRloc, Vr, Wn, FTmp, MTmp);
+			SetData(Vec3(&dW[0]), dTng, K.X, K.R, K.V, K.W, FTmp, MTmp);
 		}
-
-		iPnt++;
-
-	} while (GDI.fGetNext(PW));
+	}
 
 	// Se e' definito il rotore, aggiungere il contributo alla trazione
 	AddForce_int(pNode, F, M, Xn);
@@ -1357,6 +1428,53 @@ ReadOptionalAerodynamicCustomOutput(DataManager* pDM, MBDynParser& HP, unsigned
 	}
 }
 
+/*
+ * jacobian, { yes | no } [ , { analytical | forward difference | centered difference } ]
+ */
+static bool
+ReadAerodynamicJacobian(MBDynParser& HP, unsigned int uLabel,
+	const char *sName, AeroData *aerodata)
+{
+	bool bUseJacobian(false);
+	if (HP.IsKeyWord("jacobian")) {
+		bUseJacobian = HP.GetYesNoOrBool(bDefaultUseJacobian);
+
+		if (bUseJacobian && HP.IsArg()) {
+			bool bMethod(true);
+			AeroData::JacobianMethod m = AeroData::JAC_FORWARD_DIFF;
+			if (HP.IsKeyWord("analytical")) {
+				m = AeroData::JAC_ANALYTICAL;
+
+			} else if (HP.IsKeyWord("forward" "difference")) {
+				m = AeroData::JAC_FORWARD_DIFF;
+
+			} else if (HP.IsKeyWord("centered" "difference")) {
+				m = AeroData::JAC_CENTERED_DIFF;
+
+			} else {
+				bMethod = false;
+			}
+
+			if (bMethod && !aerodata->SetJacobianMethod(m)) {
+				silent_cerr(sName << "(" << uLabel << "): "
+					"Jacobian method not supported "
+					"by aerodynamic model at line " << HP.GetLineData()
+					<< std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+	}
+
+	if (aerodata->iGetNumDof() > 0 && !bUseJacobian) {
+		silent_cerr(sName << "(" << uLabel << "): "
+			"aerodynamic model needs \"jacobian, yes\" at line " << HP.GetLineData()
+			<< std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	return bUseJacobian;
+}
+
 Elem *
 ReadAerodynamicBody(DataManager* pDM,
 	MBDynParser& HP,
@@ -1397,17 +1515,8 @@ ReadAerodynamicBody(DataManager* pDM,
 		&pChord, &pForce, &pVelocity, &pTwist, &pTipLoss,
 		&iNumber, &pDC, &aerodata);
 
-	bool bUseJacobian(false);
-	if (HP.IsKeyWord("jacobian")) {
-		bUseJacobian = HP.GetYesNoOrBool(bDefaultUseJacobian);
-	}
-
-	if (aerodata->iGetNumDof() > 0 && !bUseJacobian) {
-		silent_cerr("AerodynamicBody(" << uLabel << "): "
-			"aerodynamic model needs \"jacobian, yes\" at line " << HP.GetLineData()
-			<< std::endl);
-		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-	}
+	bool bUseJacobian = ReadAerodynamicJacobian(HP, uLabel,
+		"AerodynamicBody", aerodata);
 
 	OrientationDescription od = UNKNOWN_ORIENTATION_DESCRIPTION;
 	unsigned uFlags = AerodynamicOutput::OUTPUT_NONE;
@@ -2072,12 +2181,32 @@ AerodynamicBeam::AssVec(SubVectorHandler& WorkVec,
 		}
 	}
 
-	for (int iNode = 0; iNode < LASTNODE; iNode++) {
+	/*
+	 * Se l'elemento e' collegato ad un rotore, la velocita' indotta
+	 * viene valutata in un'unica chiamata su tutti i punti di Gauss
+	 */
+	if (pIndVel != 0) {
+		unsigned uPnt = 0;
+		for (int iNode = 0; iNode < LASTNODE; iNode++) {
+			doublereal dsm = (pdsf3[iNode] + pdsi3[iNode])/2.;
+			doublereal dsdCsi = (pdsf3[iNode] - pdsi3[iNode])/2.;
+
+			PntWght PW = GDI.GetFirst();
+			do {
+				doublereal ds = dsm + dsdCsi*PW.dGetPnt();
+				XIndVel[uPnt] = X1Tmp*ShapeFunc3N(ds, 1)
+					+ X2Tmp*ShapeFunc3N(ds, 2)
+					+ X3Tmp*ShapeFunc3N(ds, 3);
+				uPnt++;
+			} while (GDI.fGetNext(PW));
+		}
 
-		/* Resetta le forze */
-		F[iNode].Reset();
-		M[iNode].Reset();
+		pIndVel->GetInducedVelocityBatch(GetElemType(), GetLabel(),
+			0, uPnt, &XIndVel[0], &VIndVel[0]);
+	}
 
+	/* Cinematica delle sezioni */
+	for (int iNode = 0; iNode < LASTNODE; iNode++) {
 		doublereal dsi = pdsi3[iNode];
 		doublereal dsf = pdsf3[iNode];
 
@@ -2087,6 +2216,8 @@ AerodynamicBeam::AssVec(SubVectorHandler& WorkVec,
 		/* Ciclo sui punti di Gauss */
 		PntWght PW = GDI.GetFirst();
 		do {
+			SectionKinematics& K = Kin[iPnt];
+
 			doublereal dCsi = PW.dGetPnt();
 			doublereal ds = dsm + dsdCsi*dCsi;
 			doublereal dXds = DxDcsi3N(ds,
@@ -2111,8 +2242,7 @@ AerodynamicBeam::AssVec(SubVectorHandler& WorkVec,
 			 * aggiunge alla velocita' la velocita' indotta
 			 */
 			if (pIndVel != 0) {
-				Vr += pIndVel->GetInducedVelocity(GetElemType(),
-				GetLabel(), iPnt, Xr);
+				Vr += VIndVel[iPnt];
 			}
 
 			/* Copia i dati nel vettore di lavoro dVAM */
@@ -2120,12 +2250,11 @@ AerodynamicBeam::AssVec(SubVectorHandler& WorkVec,
 			/* Contributo dell'eventuale sup. mobile */
 			dTw += dGet();
 
-			aerodata->SetSectionData(dCsi,
-				Chord.dGet(ds),
-				ForcePoint.dGet(ds),
-				VelocityPoint.dGet(ds),
-				dTw,
-				dOmega);
+			Batch.Abscissa[iPnt] = dCsi;
+			Batch.Chord[iPnt] = Chord.dGet(ds);
+			Batch.ForcePoint[iPnt] = ForcePoint.dGet(ds);
+			Batch.VelocityPoint[iPnt] = VelocityPoint.dGet(ds);
+			Batch.Twist[iPnt] = dTw;
 
 			/*
 			 * Lo svergolamento non viene piu' trattato in aerod2_;
@@ -2160,8 +2289,19 @@ AerodynamicBeam::AssVec(SubVectorHandler& WorkVec,
 			Vec3 WTmp = RRloc.MulTV(Wr);
 			WTmp.PutTo(&dW[3]);
 
-			/* Funzione di calcolo delle forze aerodinamiche */
+			for (int k = 0; k < 6; k++) {
+				Batch.W[k][iPnt] = dW[k];
+			}
+
+			/* Modelli con stati interni: forze punto per punto */
 			if (iNumDof) {
+				aerodata->SetSectionData(dCsi,
+					Batch.Chord[iPnt],
+					Batch.ForcePoint[iPnt],
+					Batch.VelocityPoint[iPnt],
+					dTw,
+					dOmega);
+
 				aerodata->AssRes(WorkVec, dCoef, XCurr, XPrimeCurr,
                 			iFirstEq, iFirstSubEq, iPnt, dW, dTng, OUTA[iPnt]);
 
@@ -2169,33 +2309,67 @@ AerodynamicBeam::AssVec(SubVectorHandler& WorkVec,
 				iFirstEq += iNumDof;
 				iFirstSubEq += iNumDof;
 
-			} else {
-				aerodata->GetForces(iPnt, dW, dTng, OUTA[iPnt]);
+				for (int k = 0; k < 6; k++) {
+					Batch.TNG[k][iPnt] = dTng[k];
+				}
+			}
+
+			K.X = Xr;
+			K.V = Vr;
+			K.W = Wr;
+			K.R = RRloc;
+			K.dCsi = dCsi;
+			K.dWght = dXds*dsdCsi*PW.dGetWght();
+
+			iPnt++;
+
+		} while (GDI.fGetNext(PW));
+	}
+
+	/* Funzione di calcolo delle forze aerodinamiche */
+	if (!iNumDof) {
+		Batch.dOmega = dOmega;
+		aerodata->GetForcesBatch(0, Batch, &OUTA[0]);
+	}
+
+	iPnt = 0;
+	for (int iNode = 0; iNode < LASTNODE; iNode++) {
+
+		/* Resetta le forze */
+		F[iNode].Reset();
+		M[iNode].Reset();
+
+		for (int iCnt = 0; iCnt < GDI.iGetNum(); iCnt++, iPnt++) {
+			const SectionKinematics& K = Kin[iPnt];
+
+			doublereal dW[6];
+			doublereal dTng[6];
+
+			for (int k = 0; k < 6; k++) {
+				dTng[k] = Batch.TNG[k][iPnt];
+				dW[k] = Batch.W[k][iPnt];
 			}
 
 			/* Dimensionalizza le forze */
-			doublereal dWght = dXds*dsdCsi*PW.dGetWght();
-			dTng[1] *= TipLoss.dGet(dCsi);
-			Vec3 FTmp(RRloc*(Vec3(&dTng[0])));
-			Vec3 MTmp(RRloc*(Vec3(&dTng[3])));
+			doublereal dWght = K.dWght;
+			dTng[1] *= TipLoss.dGet(K.dCsi);
+			Vec3 FTmp(K.R*(Vec3(&dTng[0])));
+			Vec3 MTmp(K.R*(Vec3(&dTng[3])));
 
 			// Se e' definito il rotore, aggiungere il contributo alla trazione
-			AddSectionalForce_int(iPnt, FTmp, MTmp, dWght, Xr, RRloc, Vr, Wr);
+			AddSectionalForce_int(iPnt, FTmp, MTmp, dWght, K.X, K.R, K.V, K.W);
 
 			FTmp *= dWght;
 			MTmp *= dWght;
 			F[iNode] += FTmp;
 			M[iNode] += MTmp;
-			M[iNode] += (Xr - Xn[iNode]).Cross(FTmp);
+			M[iNode] += (K.X - Xn[iNode]).Cross(FTmp);
 
 			// specific for Gauss points force output
 			if (fToBeOutput()) {
-				SetData(VTmp, dTng, Xr, RRloc, Vr, Wr, FTmp, MTmp);
+				SetData(Vec3(&dW[0]), dTng, K.X, K.R, K.V, K.W, FTmp, MTmp);
 			}
-
-			iPnt++;
-
-		} while (GDI.fGetNext(PW));
+		}
 
 		// Se e' definito il rotore, aggiungere il contributo alla trazione
 		AddForce_int(pNode[iNode], F[iNode], M[iNode], Xn[iNode]);
@@ -2358,17 +2532,8 @@ ReadAerodynamicBeam(DataManager* pDM,
 		&pChord, &pForce, &pVelocity, &pTwist, &pTipLoss,
 		&iNumber, &pDC, &aerodata);
 
-	bool bUseJacobian(false);
-	if (HP.IsKeyWord("jacobian")) {
-		bUseJacobian = HP.GetYesNoOrBool(bDefaultUseJacobian);
-	}
-
-	if (aerodata->iGetNumDof() > 0 && !bUseJacobian) {
-		silent_cerr("AerodynamicBeam3(" << uLabel << "): "
-			"aerodynamic model needs \"jacobian, yes\" at line " << HP.GetLineData()
-			<< std::endl);
-		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-	}
+	bool bUseJacobian = ReadAerodynamicJacobian(HP, uLabel,
+		"AerodynamicBeam3", aerodata);
 
 	OrientationDescription od = UNKNOWN_ORIENTATION_DESCRIPTION;
 	unsigned uFlags = AerodynamicOutput::OUTPUT_NONE;
@@ -2982,12 +3147,31 @@ AerodynamicBeam2::AssVec(SubVectorHandler& WorkVec,
 		}
 	}
 
-	for (int iNode = 0; iNode < LASTNODE; iNode++) {
+	/*
+	 * Se l'elemento e' collegato ad un rotore, la velocita' indotta
+	 * viene valutata in un'unica chiamata su tutti i punti di Gauss
+	 */
+	if (pIndVel != 0) {
+		unsigned uPnt = 0;
+		for (int iNode = 0; iNode < LASTNODE; iNode++) {
+			doublereal dsm = (pdsf2[iNode] + pdsi2[iNode])/2.;
+			doublereal dsdCsi = (pdsf2[iNode] - pdsi2[iNode])/2.;
+
+			PntWght PW = GDI.GetFirst();
+			do {
+				doublereal ds = dsm + dsdCsi*PW.dGetPnt();
+				XIndVel[uPnt] = X1Tmp*ShapeFunc2N(ds, 1)
+					+ X2Tmp*ShapeFunc2N(ds, 2);
+				uPnt++;
+			} while (GDI.fGetNext(PW));
+		}
 
-		/* Resetta i dati */
-		F[iNode].Reset();
-		M[iNode].Reset();
+		pIndVel->GetInducedVelocityBatch(GetElemType(), GetLabel(),
+			0, uPnt, &XIndVel[0], &VIndVel[0]);
+	}
 
+	/* Cinematica delle sezioni */
+	for (int iNode = 0; iNode < LASTNODE; iNode++) {
 		doublereal dsi = pdsi2[iNode];
 		doublereal dsf = pdsf2[iNode];
 
@@ -2997,6 +3181,8 @@ AerodynamicBeam2::AssVec(SubVectorHandler& WorkVec,
 		/* Ciclo sui punti di Gauss */
 		PntWght PW = GDI.GetFirst();
 		do {
+			SectionKinematics& K = Kin[iPnt];
+
 			doublereal dCsi = PW.dGetPnt();
 			doublereal ds = dsm + dsdCsi*dCsi;
 			doublereal dXds = DxDcsi2N(ds, Xn[NODE1], Xn[NODE2]);
@@ -3020,19 +3206,17 @@ AerodynamicBeam2::AssVec(SubVectorHandler& WorkVec,
 			 * aggiunge alla velocita' la velocita' indotta
 			 */
 			if (pIndVel != 0) {
-				Vr += pIndVel->GetInducedVelocity(GetElemType(),
-				GetLabel(), iPnt, Xr);
+				Vr += VIndVel[iPnt];
 			}
 
 			/* Copia i dati nel vettore di lavoro dVAM */
 			doublereal dTw = Twist.dGet(ds);
 			dTw += dGet(); /* Contributo dell'eventuale sup. mobile */
-			aerodata->SetSectionData(dCsi,
-				Chord.dGet(ds),
-				ForcePoint.dGet(ds),
-				VelocityPoint.dGet(ds),
-				dTw,
-				dOmega);
+			Batch.Abscissa[iPnt] = dCsi;
+			Batch.Chord[iPnt] = Chord.dGet(ds);
+			Batch.ForcePoint[iPnt] = ForcePoint.dGet(ds);
+			Batch.VelocityPoint[iPnt] = VelocityPoint.dGet(ds);
+			Batch.Twist[iPnt] = dTw;
 
 			/*
 			 * Lo svergolamento non viene piu' trattato in aerod2_; quindi
@@ -3063,8 +3247,19 @@ AerodynamicBeam2::AssVec(SubVectorHandler& WorkVec,
 			Vec3 WTmp = RRloc.MulTV(Wr);
 			WTmp.PutTo(&dW[3]);
 
-			/* Funzione di calcolo delle forze aerodinamiche */
+			for (int k = 0; k < 6; k++) {
+				Batch.W[k][iPnt] = dW[k];
+			}
+
+			/* Modelli con stati interni: forze punto per punto */
 			if (iNumDof) {
+				aerodata->SetSectionData(dCsi,
+					Batch.Chord[iPnt],
+					Batch.ForcePoint[iPnt],
+					Batch.VelocityPoint[iPnt],
+					dTw,
+					dOmega);
+
 				aerodata->AssRes(WorkVec, dCoef, XCurr, XPrimeCurr,
                 			iFirstEq, iFirstSubEq, iPnt, dW, dTng, OUTA[iPnt]);
 
@@ -3072,33 +3267,64 @@ AerodynamicBeam2::AssVec(SubVectorHandler& WorkVec,
 				iFirstEq += iNumDof;
 				iFirstSubEq += iNumDof;
 
-			} else {
-				aerodata->GetForces(iPnt, dW, dTng, OUTA[iPnt]);
+				for (int k = 0; k < 6; k++) {
+					Batch.TNG[k][iPnt] = dTng[k];
+				}
+			}
+
+			K.X = Xr;
+			K.V = Vr;
+			K.W = Wr;
+			K.R = RRloc;
+			K.dCsi = dCsi;
+			K.dWght = dXds*dsdCsi*PW.dGetWght();
+
+			iPnt++;
+
+		} while (GDI.fGetNext(PW));
+	}
+
+	/* Funzione di calcolo delle forze aerodinamiche */
+	if (!iNumDof) {
+		Batch.dOmega = dOmega;
+		aerodata->GetForcesBatch(0, Batch, &OUTA[0]);
+	}
+
+	iPnt = 0;
+	for (int iNode = 0; iNode < LASTNODE; iNode++) {
+
+		/* Resetta i dati */
+		F[iNode].Reset();
+		M[iNode].Reset();
+
+		for (int iCnt = 0; iCnt < GDI.iGetNum(); iCnt++, iPnt++) {
+			const SectionKinematics& K = Kin[iPnt];
+
+			for (int k = 0; k < 6; k++) {
+				dTng[k] = Batch.TNG[k][iPnt];
+				dW[k] = Batch.W[k][iPnt];
 			}
 
 			/* Dimensionalizza le forze */
-			doublereal dWght = dXds*dsdCsi*PW.dGetWght();
-			dTng[1] *= TipLoss.dGet(dCsi);
-			Vec3 FTmp(RRloc*(Vec3(&dTng[0])));
-			Vec3 MTmp(RRloc*(Vec3(&dTng[3])));
+			doublereal dWght = K.dWght;
+			dTng[1] *= TipLoss.dGet(K.dCsi);
+			Vec3 FTmp(K.R*(Vec3(&dTng[0])));
+			Vec3 MTmp(K.R*(Vec3(&dTng[3])));
 
 			// Se e' definito il rotore, aggiungere il contributo alla trazione
-			AddSectionalForce_int(iPnt, FTmp, MTmp, dWght, Xr, RRloc, Vr, Wr);
+			AddSectionalForce_int(iPnt, FTmp, MTmp, dWght, K.X, K.R, K.V, K.W);
 
 			FTmp *= dWght;
 			MTmp *= dWght;
 			F[iNode] += FTmp;
 			M[iNode] += MTmp;
-			M[iNode] += (Xr - Xn[iNode]).Cross(FTmp);
+			M[iNode] += (K.X - Xn[iNode]).Cross(FTmp);
 
 			// specific for Gauss points force output
 			if (fToBeOutput()) {
-				SetData(VTmp, dTng, Xr, RRloc, Vr, Wr, FTmp, MTmp);
+				SetData(Vec3(&dW[0]), dTng, K.X, K.R, K.V, K.W, FTmp, MTmp);
 			}
-
-			iPnt++;
-
-		} while (GDI.fGetNext(PW));
+		}
 
 		// Se e' definito il rotore, aggiungere il contributo alla trazione
 		AddForce_int(pNode[iNode], F[iNode], M[iNode], Xn[iNode]);
@@ -3247,17 +3473,8 @@ ReadAerodynamicBeam2(DataManager* pDM,
 		&pChord, &pForce, &pVelocity, &pTwist, &pTipLoss,
 		&iNumber, &pDC, &aerodata);
 
-	bool bUseJacobian(false);
-	if (HP.IsKeyWord("jacobian")) {
-		bUseJacobian = HP.GetYesNoOrBool(bDefaultUseJacobian);
-	}
-
-	if (aerodata->iGetNumDof() > 0 && !bUseJacobian) {
-		silent_cerr("AerodynamicBeam2(" << uLabel << "): "
-			"aerodynamic model needs \"jacobian, yes\" at line " << HP.GetLineData()
-			<< std::endl);
-		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-	}
+	bool bUseJacobian = ReadAerodynamicJacobian(HP, uLabel,
+		"AerodynamicBeam2", aerodata);
 
 	OrientationDescription od = UNKNOWN_ORIENTATION_DESCRIPTION;
 	unsigned uFlags = AerodynamicOutput::OUTPUT_NONE;
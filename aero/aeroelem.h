@@ -163,6 +163,25 @@ protected:
 	GaussDataIterator GDI;	/* Iteratore sui punti di Gauss */
 	std::vector<outa_t> OUTA;
 
+	/*
+	 * AssVec() computes the kinematics of all the sections first,
+	 * then evaluates them with a single AeroData::GetForcesBatch()
+	 * call, then assembles the forces
+	 */
+	struct SectionKinematics {
+		Vec3 X;			/* punto di calcolo */
+		Vec3 V;			/* velocita' relativa all'aria */
+		Vec3 W;			/* velocita' angolare */
+		Mat3x3 R;		/* sistema aerodinamico (svergolato) */
+		doublereal dCsi;	/* ascissa adimensionale */
+		doublereal dWght;	/* peso di integrazione */
+	};
+	std::vector<SectionKinematics> Kin;
+	AeroData::SectionBatch Batch;
+
+	/* punti e velocita' indotte per InducedVelocity::GetInducedVelocityBatch() */
+	std::vector<Vec3> XIndVel, VIndVel;
+
 	// used for Jacobian with internal states
 	Mat3xN vx, wx, fq, cq;
 
@@ -221,6 +240,9 @@ public:
 	virtual void AfterConvergence(const VectorHandler& X,
 			const VectorHandler& XP);
 
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
 	/* Dimensioni del workspace */
 	virtual void
 	WorkSpaceDim(integer* piNumRows, integer* piNumCols) const;
@@ -153,6 +153,9 @@ public:
 	virtual void AfterConvergence(const VectorHandler& X, 
 			const VectorHandler& XP) { NO_OP; };
 
+	/* the state of the external solver cannot be checkpointed */
+	virtual bool bCheckpointable(void) const { return false; };
+
 	/*
 	 * output; si assume che ogni tipo di elemento sappia, attraverso
 	 * l'OutputHandler, dove scrivere il proprio output
@@ -282,6 +285,9 @@ public:
 			const VectorHandler& XP)
 			{ NO_OP; };
 
+	/* the state of the external solver cannot be checkpointed */
+	virtual bool bCheckpointable(void) const { return false; };
+
 	/*
 	 * output; si assume che ogni tipo di elemento sappia, attraverso
 	 * l'OutputHandler, dove scrivere il proprio output
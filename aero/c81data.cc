@@ -286,6 +286,8 @@ c81_data_destroy(c81_data* data)
 
 	delete[] data->stall;
 	delete[] data->mstall;
+
+	c81_data_grid_destroy(data);
 }
 
 extern "C" int
@@ -603,6 +605,15 @@ c81_data_merge(
 	// FIXME: maybe this is not the best place
 	c81_data_do_stall(i_data, dcltol);
 
+	/* resample the merged data if the sources are resampled */
+	i_data->grid = 0;
+	if (data[from]->grid != 0 && data[to]->grid != 0) {
+		if (c81_data_grid_build(i_data, data[from]->grid->da, data[from]->grid->dm)) {
+			silent_cerr("unable to build uniform grid for C81 data at point xi=" << dCsi << std::endl);
+			return -1;
+		}
+	}
+
 	return 0;
 }
 
@@ -51,6 +51,10 @@ extern "C" {
 
 #include "indvel.h"
 #include "dataman.h"
+#include "checkpoint.h"
+#ifdef USE_MULTITHREAD
+#include "mtdataman.h"
+#endif // USE_MULTITHREAD
 
 /* InducedVelocity - begin */
 
@@ -80,12 +84,6 @@ ppRes(ppres)
    		IndVelComm = MBDynComm.Dup();
 	}
 #endif /* USE_MPI */
-
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_init(&induced_velocity_mutex, NULL);
-	pthread_cond_init(&induced_velocity_cond, NULL);
-	pthread_mutex_init(&forces_mutex, NULL);
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
 }
 
 InducedVelocity::~InducedVelocity(void)
@@ -94,12 +92,6 @@ InducedVelocity::~InducedVelocity(void)
 	SAFEDELETEARR(pTmpVecR);
 	SAFEDELETEARR(pTmpVecS);
 #endif /* USE_MPI */
-
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_destroy(&induced_velocity_mutex);
-	pthread_cond_destroy(&induced_velocity_cond);
-	pthread_mutex_destroy(&forces_mutex);
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
 }
 
 bool
@@ -108,6 +100,35 @@ InducedVelocity::bSectionalForces(void) const
 	return false;
 }
 
+void
+InducedVelocity::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, Res.Force());
+	ChkWrite(out, Res.Moment());
+	ChkWrite(out, Res.Pole());
+	for (int i = 0; ppRes && ppRes[i]; i++) {
+		ChkWrite(out, ppRes[i]->pRes->Force());
+		ChkWrite(out, ppRes[i]->pRes->Moment());
+	}
+}
+
+void
+InducedVelocity::Resume(std::istream& in)
+{
+	Vec3 F, M, X;
+
+	ChkRead(in, F);
+	ChkRead(in, M);
+	ChkRead(in, X);
+	Res.PutPole(X);
+	Res.PutForces(F, M);
+	for (int i = 0; ppRes && ppRes[i]; i++) {
+		ChkRead(in, F);
+		ChkRead(in, M);
+		ppRes[i]->pRes->PutForces(F, M);
+	}
+}
+
 unsigned int
 InducedVelocity::iGetNumPrivData(void) const {
 	return 6;
@@ -163,10 +184,7 @@ void
 InducedVelocity::AfterConvergence(const VectorHandler& /* X */ ,
 		const VectorHandler& /* XP */ )
 {
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	ASSERT(bDone);
-	bDone = false;
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
+	NO_OP;
 }
 
 /* assemblaggio jacobiano (nullo per tutti tranne che per il DynamicInflow) */
@@ -240,11 +258,39 @@ InducedVelocity::ExchangeVelocity(void)
 }
 #endif // USE_MPI
 
+ResForces&
+InducedVelocity::ResCurr(void)
+{
+#ifdef USE_MULTITHREAD
+	unsigned s = MultiThreadDataManager::GetChunkSlot();
+	if (s > 0) {
+		ASSERT(s < ResPartials.size());
+		return ResPartials[s].Res;
+	}
+#endif // USE_MULTITHREAD
+
+	return Res;
+}
+
 // Somma alla trazione il contributo di forza di un elemento generico
 void
 InducedVelocity::AddForce(const Elem *pEl, const StructNode *pNode,
 	const Vec3& F, const Vec3& M, const Vec3& X)
 {
+#ifdef USE_MULTITHREAD
+	unsigned s = MultiThreadDataManager::GetChunkSlot();
+	if (s > 0) {
+		ASSERT(s < ResPartials.size());
+		std::vector<ExternResForces>& SetRes = ResPartials[s].SetRes;
+		for (int i = 0; ppRes && ppRes[i]; i++) {
+			if (ppRes[i]->is_in(pEl->GetLabel())) {
+				SetRes[i].AddForces(F, M, X);
+			}
+		}
+		return;
+	}
+#endif // USE_MULTITHREAD
+
 	for (int i = 0; ppRes && ppRes[i]; i++) {
 		if (ppRes[i]->is_in(pEl->GetLabel())) {
 			ppRes[i]->pRes->AddForces(F, M, X);
@@ -265,6 +311,16 @@ InducedVelocity::AddSectionalForce(Elem::Type type,
 	InducedVelocity::AddForce(pEl, 0, F*dW, M*dW, X);
 }
 
+void
+InducedVelocity::GetInducedVelocityBatch(Elem::Type type,
+	unsigned uLabel, unsigned uPnt, unsigned n,
+	const Vec3 *X, Vec3 *V) const
+{
+	for (unsigned i = 0; i < n; i++) {
+		V[i] = GetInducedVelocity(type, uLabel, uPnt + i, X[i]);
+	}
+}
+
 void
 InducedVelocity::ResetForce(void)
 {
@@ -272,30 +328,54 @@ InducedVelocity::ResetForce(void)
 	for (int i = 0; ppRes && ppRes[i]; i++) {
 		ppRes[i]->pRes->Reset();
 	}
-}
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-void
-InducedVelocity::Wait(void) const
-{
-	pthread_mutex_lock(&induced_velocity_mutex);
-	if (!bDone) {
-		pthread_cond_wait(&induced_velocity_cond,
-				&induced_velocity_mutex);
+#ifdef USE_MULTITHREAD
+	// called by the main thread before the other elements
+	// are assembled, so the partials can be resized here
+	unsigned nSlots = MultiThreadDataManager::GetNumChunkSlots();
+	if (ResPartials.size() != nSlots) {
+		unsigned nSets = 0;
+		while (ppRes && ppRes[nSets]) {
+			nSets++;
+		}
+
+		ResPartials.resize(nSlots);
+		for (unsigned s = 1; s < nSlots; s++) {
+			ResPartials[s].SetRes.resize(nSets);
+		}
+	}
+
+	for (unsigned s = 1; s < ResPartials.size(); s++) {
+		ResPartial& p = ResPartials[s];
+
+		p.Res.Reset(Res.Pole());
+		for (unsigned i = 0; i < p.SetRes.size(); i++) {
+			p.SetRes[i].Reset(ppRes[i]->pRes->Pole());
+		}
 	}
-	pthread_mutex_unlock(&induced_velocity_mutex);
+#endif // USE_MULTITHREAD
 }
 
 void
-InducedVelocity::Done(void) const
+InducedVelocity::ReduceForces(void)
 {
-	pthread_mutex_lock(&induced_velocity_mutex);
-	ASSERT(!bDone);
-	bDone = true;
-	pthread_cond_broadcast(&induced_velocity_cond);
-	pthread_mutex_unlock(&induced_velocity_mutex);
+#ifdef USE_MULTITHREAD
+	// in slot order, so that the sum does not depend
+	// on which thread assembled which chunk
+	for (unsigned s = 1; s < ResPartials.size(); s++) {
+		ResPartial& p = ResPartials[s];
+
+		Res.AddForces(p.Res.Force(), p.Res.Moment(), p.Res.Pole());
+		p.Res.Reset();
+
+		for (unsigned i = 0; i < p.SetRes.size(); i++) {
+			ppRes[i]->pRes->AddForces(p.SetRes[i].Force(),
+				p.SetRes[i].Moment(), p.SetRes[i].Pole());
+			p.SetRes[i].Reset();
+		}
+	}
+#endif // USE_MULTITHREAD
 }
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
 
 /* InducedVelocity - end */
 
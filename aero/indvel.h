@@ -33,6 +33,7 @@
 #define INDVEL_H
 
 #include <cfloat>
+#include <vector>
 
 #include "ac/pthread.h"
 #ifdef USE_MPI
@@ -97,16 +98,28 @@ protected:
 	MPI::Datatype* pIndVelDataType;
 #endif // USE_MPI
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	mutable pthread_mutex_t forces_mutex;
-
-	mutable pthread_mutex_t induced_velocity_mutex;
-	mutable pthread_cond_t induced_velocity_cond;
-	mutable bool bDone;
-
-	void Wait(void) const;
-	void Done(void) const;
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
+#ifdef USE_MULTITHREAD
+	// per-chunk partial resultants, about the same poles as Res
+	// and as the extra sets; the elements assembled serially add
+	// to Res directly, those of chunk c of the parallel residual
+	// phase to ResPartials[c + 1] (see
+	// MultiThreadDataManager::GetChunkSlot()), so no lock is required,
+	// and the partials can be summed in a fixed order.
+	// No handshake is required either with the elements that add
+	// forces or use the induced velocity, since the induced velocity
+	// elements are assembled first, by the main thread alone
+	// (see Elem::INDUCEDVELOCITY flags in DataManager::ElemManager());
+	// the partials are summed in slot order by ReduceForces()
+	// at the end of the residual phase
+	struct ResPartial {
+		ExternResForces Res;
+		std::vector<ExternResForces> SetRes;
+
+		// keep partials on separate cache lines
+		char pad[64];
+	};
+	std::vector<ResPartial> ResPartials;
+#endif // USE_MULTITHREAD
 
 	const StructNode* pCraft;
 
@@ -115,6 +128,9 @@ protected:
 	// extra forces
 	ResForceSet **ppRes;
 
+	// resultant the calling element adds to
+	ResForces& ResCurr(void);
+
 public:
 	InducedVelocity(unsigned int uL,
 		const StructNode* pCraft,
@@ -133,6 +149,11 @@ public:
 	// Return "true" if sectional forces are needed
 	virtual bool bSectionalForces(void) const;
 
+	// the resultants of the last assembly, which the model
+	// uses before the elements contribute again
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
 	/* Il metodo iGetNumDof() serve a ritornare il numero di gradi di liberta'
 	 * propri che l'elemento definisce. Non e' virtuale in quanto serve a
 	 * ritornare 0 per gli elementi che non possiedono gradi di liberta'.
@@ -161,16 +182,10 @@ public:
 	};
 
 	virtual inline const Vec3& GetForces(void) const {
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-		Wait();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
 		return Res.Force();
 	};
 
 	virtual inline const Vec3& GetMoments(void) const {
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-		Wait();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
 		return Res.Moment();
 	};
 
@@ -198,11 +213,22 @@ public:
 
 	virtual void ResetForce(void);
 
+	// sums the per-chunk partial resultants, if any;
+	// called by the main thread at the end of the residual phase
+	virtual void ReduceForces(void);
+
 	// Restituisce ad un elemento la velocita' indotta
 	// in base alla posizione azimuthale
 	virtual Vec3 GetInducedVelocity(Elem::Type type,
 		unsigned uLabel, unsigned uPnt, const Vec3& X) const = 0;
 
+	// Induced velocity V[i] at the points X[i], i = 0 ... n - 1,
+	// numbered uPnt ... uPnt + n - 1 by the element;
+	// the default calls GetInducedVelocity() on each
+	virtual void GetInducedVelocityBatch(Elem::Type type,
+		unsigned uLabel, unsigned uPnt, unsigned n,
+		const Vec3 *X, Vec3 *V) const;
+
 	// Dimensioni del workspace
 	virtual void
 	WorkSpaceDim(integer* piNumRows, integer* piNumCols) const {
@@ -51,6 +51,7 @@ extern "C" {
 
 #include "rotor.h"
 #include "dataman.h"
+#include "checkpoint.h"
 
 static const doublereal dVTipTreshold = 1e-6;
 
@@ -179,6 +180,56 @@ Rotor::AfterConvergence(const VectorHandler& X,
 	InducedVelocity::AfterConvergence(X, XP);
 }
 
+void
+Rotor::Checkpoint(std::ostream& out) const
+{
+	InducedVelocity::Checkpoint(out);
+
+	ChkWrite(out, dUMean);
+	ChkWrite(out, dUMeanRef);
+	ChkWrite(out, dUMeanPrev);
+	ChkWrite(out, iCurrIter);
+	ChkWrite(out, bUMeanRefConverged);
+	ChkWrite(out, dWeight);
+	ChkWrite(out, RRotTranspose);
+	ChkWrite(out, RRot3);
+	ChkWrite(out, VCraft);
+	ChkWrite(out, dPsi0);
+	ChkWrite(out, dSinAlphad);
+	ChkWrite(out, dCosAlphad);
+	ChkWrite(out, dMu);
+	ChkWrite(out, dLambda);
+	ChkWrite(out, dChi);
+	ChkWrite(out, dVelocity);
+	ChkWrite(out, dOmega);
+	ChkWrite(out, iNumSteps);
+}
+
+void
+Rotor::Resume(std::istream& in)
+{
+	InducedVelocity::Resume(in);
+
+	ChkRead(in, dUMean);
+	ChkRead(in, dUMeanRef);
+	ChkRead(in, dUMeanPrev);
+	ChkRead(in, iCurrIter);
+	ChkRead(in, bUMeanRefConverged);
+	ChkRead(in, dWeight);
+	ChkRead(in, RRotTranspose);
+	ChkRead(in, RRot3);
+	ChkRead(in, VCraft);
+	ChkRead(in, dPsi0);
+	ChkRead(in, dSinAlphad);
+	ChkRead(in, dCosAlphad);
+	ChkRead(in, dMu);
+	ChkRead(in, dLambda);
+	ChkRead(in, dChi);
+	ChkRead(in, dVelocity);
+	ChkRead(in, dOmega);
+	ChkRead(in, iNumSteps);
+}
+
 void
 Rotor::Output(OutputHandler& OH) const
 {
@@ -316,6 +367,29 @@ Rotor::GetPos(const Vec3& X, doublereal& dr, doublereal& dp) const
 	dp = atan2(d2, d1) - dPsi0;
 }
 
+void
+Rotor::GetFirstHarmonicInducedVelocity(doublereal dV0,
+	doublereal dVS, doublereal dVC,
+	unsigned n, const Vec3 *X, Vec3 *V) const
+{
+	/*
+	 * with XRel = RRotTranspose*(X - Pole) and dp = psi - dPsi0,
+	 * dr*R*cos(dp) = XRel(1)*cos(dPsi0) + XRel(2)*sin(dPsi0)
+	 * dr*R*sin(dp) = XRel(2)*cos(dPsi0) - XRel(1)*sin(dPsi0)
+	 */
+	doublereal dCosP = cos(dPsi0);
+	doublereal dSinP = sin(dPsi0);
+
+	Vec3 G(RRotTranspose.MulTV(Vec3(dVC*dCosP - dVS*dSinP,
+		dVC*dSinP + dVS*dCosP, 0.)*dOmega));
+	doublereal dVm = dV0*dRadius*dOmega;
+	const Vec3& P = Res.Pole();
+
+	for (unsigned i = 0; i < n; i++) {
+		V[i] = RRot3*(dVm + G.Dot(X[i] - P));
+	}
+}
+
 /* Calcola vari parametri geometrici
  * A partire dai corpi che identificano il velivolo ed il rotore
  */
@@ -634,10 +708,6 @@ NoRotor::AssRes(SubVectorHandler& WorkVec,
 	ResetForce();
 	WorkVec.Resize(0);
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	Done();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
-
 	return WorkVec;
 }
 
@@ -662,19 +732,12 @@ NoRotor::AddForce(const Elem *pEl, const StructNode *pNode,
 	}
 #endif // USE_MPI
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_lock(&forces_mutex);
-	Wait();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
+	ResForces& r = ResCurr();
 
 	if (fToBeOutput()) {
-		Res.AddForces(F, M, X);
+		r.AddForces(F, M, X);
 		InducedVelocity::AddForce(pEl, pNode, F, M, X);
 	}
-
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_unlock(&forces_mutex);
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
 }
 
 /* Restituisce ad un elemento la velocita' indotta in base alla posizione
@@ -831,10 +894,6 @@ UniformRotor::AssRes(SubVectorHandler& WorkVec,
 	/* Non tocca il residuo */
 	WorkVec.Resize(0);
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	Done();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
-
 	return WorkVec;
 }
 
@@ -860,22 +919,15 @@ UniformRotor::AddForce(const Elem *pEl, const StructNode *pNode,
 	}
 #endif /* USE_MPI */
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_lock(&forces_mutex);
-	Wait();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
+	ResForces& r = ResCurr();
 
 	/* Solo se deve fare l'output calcola anche il momento */
 	if (fToBeOutput()) {
-		Res.AddForces(F, M, X);
+		r.AddForces(F, M, X);
 		InducedVelocity::AddForce(pEl, pNode, F, M, X);
 	} else {
-		Res.AddForce(F);
+		r.AddForce(F);
 	}
-
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_unlock(&forces_mutex);
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
 }
 
 /* Restituisce ad un elemento la velocita' indotta in base alla posizione
@@ -884,10 +936,6 @@ Vec3
 UniformRotor::GetInducedVelocity(Elem::Type type,
 	unsigned uLabel, unsigned uPnt, const Vec3& X) const
 {
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	Wait();
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
-
 	return RRot3*dUMeanPrev;
 };
 
@@ -947,25 +995,18 @@ UniformRotor2::AddSectionalForce(Elem::Type type,
 	}
 #endif /* USE_MPI */
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_lock(&forces_mutex);
-	Wait();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
+	ResForces& r = ResCurr();
 
 	/* Solo se deve fare l'output calcola anche il momento */
 	if (fToBeOutput()) {
 		Vec3 FTmp(F*dW);
 		Vec3 MTmp(M*dW);
-		Res.AddForces(FTmp, MTmp, X);
+		r.AddForces(FTmp, MTmp, X);
 		InducedVelocity::AddForce(pEl, 0, FTmp, MTmp, X);
 
 	} else {
-		Res.AddForce(F*dW);
+		r.AddForce(F*dW);
 	}
-
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_unlock(&forces_mutex);
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
 }
 
 /* UniformRotor - end */
@@ -1103,10 +1144,6 @@ GlauertRotor::AssRes(SubVectorHandler& WorkVec,
 	/* Non tocca il residuo */
 	WorkVec.Resize(0);
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	Done();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
-
 	return WorkVec;
 }
 
@@ -1133,22 +1170,15 @@ GlauertRotor::AddForce(const Elem *pEl, const StructNode *pNode,
 	}
 #endif /* USE_MPI */
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_lock(&forces_mutex);
-	Wait();
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
+	ResForces& r = ResCurr();
 
 	/* Solo se deve fare l'output calcola anche il momento */
 	if (fToBeOutput()) {
-		Res.AddForces(F, M, X);
+		r.AddForces(F, M, X);
 		InducedVelocity::AddForce(pEl, pNode, F, M, X);
 	} else {
-		Res.AddForce(F);
+		r.AddForce(F);
 	}
-
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_unlock(&forces_mutex);
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
 }
 
 
@@ -1164,10 +1194,6 @@ GlauertRotor::GetInducedVelocity(Elem::Type type,
 		return Zero3;
 	}
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	Wait();
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
-
 	if (std::abs(dLambda) < 1.e-9) {
 		return RRot3*dUMeanPrev;
 	}
@@ -1375,10 +1401,6 @@ ManglerRotor::AssRes(SubVectorHandler& WorkVec,
 	/* Non tocca il residuo */
 	WorkVec.Resize(0);
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	Done();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
-
 	return WorkVec;
 }
 
@@ -1404,22 +1426,15 @@ ManglerRotor::AddForce(const Elem *pEl, const StructNode *pNode,
 	}
 #endif /* USE_MPI */
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_lock(&forces_mutex);
-	Wait();
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
+	ResForces& r = ResCurr();
 
 	/* Solo se deve fare l'output calcola anche il momento */
 	if (fToBeOutput()) {
-		Res.AddForces(F, M, X);
+		r.AddForces(F, M, X);
 		InducedVelocity::AddForce(pEl, pNode, F, M, X);
 	} else {
-		Res.AddForce(F);
+		r.AddForce(F);
 	}
-
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_unlock(&forces_mutex);
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
 }
 
 
@@ -1433,10 +1448,6 @@ ManglerRotor::GetInducedVelocity(Elem::Type type,
 		return ::Zero3;
 	}
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	Wait();
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
-
 	doublereal dr, dp;
 	GetPos(X, dr, dp);
 
@@ -1924,10 +1935,6 @@ DynamicInflowRotor::AssRes(SubVectorHandler& WorkVec,
 	/* Ora la trazione non serve piu' */
 	ResetForce();
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	Done();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
-
      	return WorkVec;
 }
 
@@ -1984,19 +1991,12 @@ DynamicInflowRotor::AddForce(const Elem *pEl, const StructNode *pNode,
 	}
 #endif /* USE_MPI */
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_lock(&forces_mutex);
-	Wait();
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
+	ResForces& r = ResCurr();
 
-	Res.AddForces(F, M, X);
+	r.AddForces(F, M, X);
 	if (fToBeOutput()) {
 		InducedVelocity::AddForce(pEl, pNode, F, M, X);
 	}
-
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_unlock(&forces_mutex);
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
 }
 
 
@@ -2006,16 +2006,20 @@ Vec3
 DynamicInflowRotor::GetInducedVelocity(Elem::Type type,
 	unsigned uLabel, unsigned uPnt, const Vec3& X) const
 {
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	Wait();
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
-
 	doublereal dr, dp;
 	GetPos(X, dr, dp);
 
 	return RRot3*((dVConst + dr*(dVCosine*cos(dp) + dVSine*sin(dp)))*dRadius*dOmega);
 };
 
+void
+DynamicInflowRotor::GetInducedVelocityBatch(Elem::Type type,
+	unsigned uLabel, unsigned uPnt, unsigned n,
+	const Vec3 *X, Vec3 *V) const
+{
+	GetFirstHarmonicInducedVelocity(dVConst, dVSine, dVCosine, n, X, V);
+}
+
 /* DynamicInflowRotor - end */
 
 
@@ -2442,10 +2446,6 @@ PetersHeRotor::AssRes(SubVectorHandler& WorkVec,
 	/* Ora la trazione non serve piu' */
 	ResetForce();
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	Done();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
-
      	return WorkVec;
 }
 
@@ -2502,19 +2502,12 @@ PetersHeRotor::AddForce(const Elem *pEl, const StructNode *pNode,
 	}
 #endif /* USE_MPI */
 
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_lock(&forces_mutex);
-	Wait();
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
+	ResForces& r = ResCurr();
 
-	Res.AddForces(F, M, X);
+	r.AddForces(F, M, X);
 	if (fToBeOutput()) {
 		InducedVelocity::AddForce(pEl, pNode, F, M, X);
 	}
-
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	pthread_mutex_unlock(&forces_mutex);
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
 }
 
 
@@ -2524,16 +2517,20 @@ Vec3
 PetersHeRotor::GetInducedVelocity(Elem::Type type,
 	unsigned uLabel, unsigned uPnt, const Vec3& X) const
 {
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-	Wait();
-#endif /* USE_MULTITHREAD && MBDYN_X_MT_ASSRES */
-
 	doublereal dr, dp;
 	GetPos(X, dr, dp);
 
 	return RRot3*((dVConst + dr*(dVCosine*cos(dp) + dVSine*sin(dp)))*dRadius*dOmega);
 };
 
+void
+PetersHeRotor::GetInducedVelocityBatch(Elem::Type type,
+	unsigned uLabel, unsigned uPnt, unsigned n,
+	const Vec3 *X, Vec3 *V) const
+{
+	GetFirstHarmonicInducedVelocity(dVConst, dVSine, dVCosine, n, X, V);
+}
+
 /* PetersHeRotor - end */
 
 
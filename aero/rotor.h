@@ -102,6 +102,14 @@ protected:
 	// Combina i due ...
 	virtual void GetPos(const Vec3& X, doublereal& dr, doublereal& dp) const;
 
+	// Induced velocity RRot3*(dV0 + dr*(dVC*cos(dp) + dVS*sin(dp)))*R*Omega
+	// at n points, as GetPos(); dr*cos(dp) and dr*sin(dp) are linear
+	// in the position of the point, so the distribution is evaluated
+	// as an affine function of X, without trigonometric functions
+	void GetFirstHarmonicInducedVelocity(doublereal dV0,
+		doublereal dVS, doublereal dVC,
+		unsigned n, const Vec3 *X, Vec3 *V) const;
+
 	// Calcola la velocita' di traslazione del rotore
 	virtual void InitParam(bool bComputeMeanInducedVelocity = true);
 
@@ -138,6 +146,10 @@ public:
 	// Contributo al file di Restart
 	virtual std::ostream& Restart(std::ostream& out) const;
 
+	// mean induced velocity history and rotor parameters
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
 	// Relativo ai ...WithDofs
 	virtual void SetInitialValue(VectorHandler& /* X */ ) {
 		NO_OP;
@@ -149,37 +161,22 @@ public:
 
 	// accesso a dati
 	virtual inline doublereal dGetOmega(void) const {
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-		Wait();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
 		return dOmega;
 	};
 
 	virtual inline doublereal dGetRadius(void) const {
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-		Wait();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
 		return dRadius;
 	};
 
 	virtual inline doublereal dGetMu(void) const {
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-		Wait();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
 		return dMu;
 	};
 
 	virtual inline const Vec3& GetForces(void) const {
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-		Wait();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
 		return Res.Force();
 	};
 
 	virtual inline const Vec3& GetMoments(void) const {
-#if defined(USE_MULTITHREAD) && defined(MBDYN_X_MT_ASSRES)
-		Wait();
-#endif // USE_MULTITHREAD && MBDYN_X_MT_ASSRES
 		return Res.Moment();
 	};
 
@@ -645,6 +642,9 @@ public:
 	// in base alla posizione azimuthale
 	virtual Vec3 GetInducedVelocity(Elem::Type type,
 		unsigned uLabel, unsigned uPnt, const Vec3& X) const;
+	virtual void GetInducedVelocityBatch(Elem::Type type,
+		unsigned uLabel, unsigned uPnt, unsigned n,
+		const Vec3 *X, Vec3 *V) const;
 };
 
 /* DynamicInflowRotor - end */
@@ -770,6 +770,9 @@ public:
 	// in base alla posizione azimuthale
 	virtual Vec3 GetInducedVelocity(Elem::Type type,
 		unsigned uLabel, unsigned uPnt, const Vec3& X) const;
+	virtual void GetInducedVelocityBatch(Elem::Type type,
+		unsigned uLabel, unsigned uPnt, unsigned n,
+		const Vec3 *X, Vec3 *V) const;
 };
 
 /* PetersHeRotor - end */
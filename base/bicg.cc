@@ -60,8 +60,9 @@ BiCGStab::BiCGStab(const Preconditioner::PrecondType PType,
 		integer MaxIt,
 		doublereal etaMx,
 		doublereal T,
-		const NonlinearSolverOptions& options)
-: MatrixFreeSolver(PType, iPStep, ITol, MaxIt, etaMx, T, options)
+		const NonlinearSolverOptions& options,
+		const Preconditioner::Parameters& PParams)
+: MatrixFreeSolver(PType, iPStep, ITol, MaxIt, etaMx, T, options, PParams)
 {
 	NO_OP;
 }
@@ -149,6 +150,7 @@ BiCGStab::Solve(const NonlinearProblem* pNLP,
 		
 		pRes->Reset();
 		try {
+			SolverStats::Timer timer(pS->pGetSolverStats(), SolverStats::RESIDUAL);
 	      		pNLP->Residual(pRes);
 		}
 		catch (SolutionDataManager::ChangedEquationStructure) {
@@ -205,6 +207,9 @@ BiCGStab::Solve(const NonlinearProblem* pNLP,
 		Fnorm = dErr*dErr;
 		
       		iIterCnt++;
+		if (pS->pGetSolverStats()) {
+			pS->pGetSolverStats()->Inc(SolverStats::ITERATIONS);
+		}
 
 		/* inner iteration to solve the linear system */	
 	
@@ -253,6 +258,7 @@ rebuild_matrix:;
 			bBuildMat = false;
 			TotalIter = 0;
 			TotJac++;
+			PrecondReset(pS);
 
 #ifdef DEBUG_ITERATIVE			
 			std::cerr << "Jacobian " << std::endl;
@@ -264,6 +270,7 @@ rebuild_matrix:;
 		std::cerr << "rho_1 " << rho_1 << std::endl;
 #endif /* DEBUG_ITERATIVE */
 
+		integer iStartIter = TotalIter;
 		int It = 0;
         	while ((resid > LocTol) && (It++ < MaxLinIt)) {
 			if (It == 1) {
@@ -356,6 +363,9 @@ rebuild_matrix:;
 					<< std::endl);
 			}
 		}
+		integer iLinIters = TotalIter - iStartIter;
+		PrecondStats(iLinIters);
+
 		/* se ha impiegato troppi passi riassembla lo jacobiano */
 		
 		if (TotalIter >= PrecondIter && PrecondIter) {
@@ -389,6 +399,8 @@ rebuild_matrix:;
 			if (!bParallel || MBDynComm.Get_rank() == 0)
 #endif /* USE_MPI */
 			{
+				silent_cout("\t\tLinIters " << iLinIters
+						<< std::endl);
 				silent_cout("\t\tSolErr " << dSolErr
 						<< std::endl);
 			}
@@ -54,7 +54,9 @@ public:
 			integer MaxIt,
 			doublereal etaMx,
 			doublereal T,
-			const NonlinearSolverOptions& options);
+			const NonlinearSolverOptions& options,
+			const Preconditioner::Parameters& PParams
+				= Preconditioner::Parameters());
 	~BiCGStab(void);
 	
 	virtual void Solve(const NonlinearProblem* NLP,
@@ -0,0 +1,181 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2014
+ *
+ * Pierangelo Masarati	<masarati@aero.polimi.it>
+ * Paolo Mantegazza	<mantegazza@aero.polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* binary checkpoint helpers */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <iostream>
+
+#include "myassert.h"
+#include "except.h"
+#include "matvec3.h"
+#include "matvec6.h"
+#include "vh.h"
+
+/*
+ * Raw, native-endian binary dump; a checkpoint is only meant
+ * to be resumed by the same executable on the same architecture.
+ * Resume() must read exactly what Checkpoint() wrote.
+ */
+
+const char sCheckpointMagic[] = "MBDynChk";
+const unsigned uCheckpointVersion = 2;
+
+class ErrCheckpoint : public MBDynErrBase {
+public:
+	ErrCheckpoint(MBDYN_EXCEPT_ARGS_DECL) : MBDynErrBase(MBDYN_EXCEPT_ARGS_PASSTHRU) {};
+};
+
+template <class T>
+inline void
+ChkWrite(std::ostream& out, const T& t)
+{
+	out.write((const char *)&t, sizeof(T));
+}
+
+template <class T>
+inline void
+ChkRead(std::istream& in, T& t)
+{
+	in.read((char *)&t, sizeof(T));
+	if (!in) {
+		silent_cerr("checkpoint: unexpected end of file" << std::endl);
+		throw ErrCheckpoint(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+inline void
+ChkWrite(std::ostream& out, const Vec3& v)
+{
+	for (unsigned short i = 1; i <= 3; i++) {
+		ChkWrite(out, v(i));
+	}
+}
+
+inline void
+ChkRead(std::istream& in, Vec3& v)
+{
+	for (unsigned short i = 1; i <= 3; i++) {
+		ChkRead(in, v(i));
+	}
+}
+
+inline void
+ChkWrite(std::ostream& out, const Vec6& v)
+{
+	ChkWrite(out, v.GetVec1());
+	ChkWrite(out, v.GetVec2());
+}
+
+inline void
+ChkRead(std::istream& in, Vec6& v)
+{
+	Vec3 v1, v2;
+	ChkRead(in, v1);
+	ChkRead(in, v2);
+	v = Vec6(v1, v2);
+}
+
+inline void
+ChkWrite(std::ostream& out, const Mat3x3& m)
+{
+	for (unsigned short i = 1; i <= 3; i++) {
+		for (unsigned short j = 1; j <= 3; j++) {
+			ChkWrite(out, m(i, j));
+		}
+	}
+}
+
+inline void
+ChkRead(std::istream& in, Mat3x3& m)
+{
+	for (unsigned short i = 1; i <= 3; i++) {
+		for (unsigned short j = 1; j <= 3; j++) {
+			ChkRead(in, m(i, j));
+		}
+	}
+}
+
+/* not overloads of ChkWrite/ChkRead, which would match
+ * derived handlers as raw objects */
+inline void
+ChkWriteVector(std::ostream& out, const VectorHandler& v)
+{
+	integer iSize = v.iGetSize();
+	ChkWrite(out, iSize);
+	out.write((const char *)v.pdGetVec(), iSize*sizeof(doublereal));
+}
+
+inline void
+ChkReadVector(std::istream& in, VectorHandler& v)
+{
+	integer iSize;
+	ChkRead(in, iSize);
+	if (iSize != v.iGetSize()) {
+		silent_cerr("checkpoint: vector size " << iSize
+			<< " does not match the model (" << v.iGetSize() << ")"
+			<< std::endl);
+		throw ErrCheckpoint(MBDYN_EXCEPT_ARGS);
+	}
+	in.read((char *)v.pdGetVec(), iSize*sizeof(doublereal));
+	if (!in) {
+		silent_cerr("checkpoint: unexpected end of file" << std::endl);
+		throw ErrCheckpoint(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+/* entity framing: type and label must match the model */
+inline void
+ChkWriteTag(std::ostream& out, int iType, unsigned uLabel)
+{
+	ChkWrite(out, iType);
+	ChkWrite(out, uLabel);
+}
+
+inline void
+ChkReadTag(std::istream& in, int iType, unsigned uLabel)
+{
+	int iT;
+	unsigned uL;
+	ChkRead(in, iT);
+	ChkRead(in, uL);
+	if (iT != iType || uL != uLabel) {
+		silent_cerr("checkpoint: found entity " << iT << "(" << uL << ") "
+			"while expecting " << iType << "(" << uLabel << "); "
+			"the model does not match the checkpoint" << std::endl);
+		throw ErrCheckpoint(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+#endif /* CHECKPOINT_H */
+
@@ -373,6 +373,18 @@ public:
 	virtual std::ostream& OutputAppend(std::ostream& out) const {
 		return pConstLaw->OutputAppend(out);
 	};
+
+	virtual void Checkpoint(std::ostream& out) const {
+		pConstLaw->Checkpoint(out);
+	};
+
+	virtual void Resume(std::istream& in) {
+		pConstLaw->Resume(in);
+	};
+
+	virtual bool bCheckpointable(void) const {
+		return pConstLaw->bCheckpointable();
+	};
 };
 
 typedef ConstitutiveLawOwner<doublereal, doublereal> ConstitutiveLaw1DOwner;
@@ -121,6 +121,13 @@ public:
 		Update(Eps, EpsPrime, ANN_FEEDBACK_UPDATE);
 	};
 
+	// the feedback history is kept by the network
+	virtual bool
+	bCheckpointable(void) const
+	{
+		return false;
+	};
+
 	virtual ConstitutiveLaw<T, Tder>* pCopy(void) const {
 		ConstitutiveLaw<T, Tder>* pCL = NULL;
 
@@ -213,6 +220,13 @@ public:
 		Update(Eps, EpsPrime, ANN_FEEDBACK_UPDATE);
 	};
 
+	// the feedback history is kept by the network
+	virtual bool
+	bCheckpointable(void) const
+	{
+		return false;
+	};
+
 	virtual ConstitutiveLaw<doublereal, doublereal>* pCopy(void) const {
 		ConstitutiveLaw<doublereal, doublereal>* pCL = NULL;
 
@@ -100,6 +100,18 @@ public:
 	virtual void AfterConvergence(const Vec3& Eps, const Vec3& EpsPrime = mb_zero<Vec3>()) {
 		m_pCL->AfterConvergence(m_v*Eps, m_v*EpsPrime);
 	};
+
+	virtual void Checkpoint(std::ostream& out) const {
+		m_pCL->Checkpoint(out);
+	};
+
+	virtual void Resume(std::istream& in) {
+		m_pCL->Resume(in);
+	};
+
+	virtual bool bCheckpointable(void) const {
+		return m_pCL->bCheckpointable();
+	};
 };
 
 struct AxialCLR : public ConstitutiveLawRead<Vec3, Mat3x3> {
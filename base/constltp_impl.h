@@ -43,6 +43,7 @@
 #include "constltp.h"
 #include "hint_impl.h"
 #include "elem.h"
+#include "checkpoint.h"
 
 /* ConstitutiveLawArray - begin */
 
@@ -146,6 +147,27 @@ public:
 		}
 	};
 
+	virtual void Checkpoint(std::ostream& out) const {
+		for (typename std::vector<ConstitutiveLaw<T, Tder> *>::const_iterator i = m_clv.begin(); i != m_clv.end(); i++) {
+			(*i)->Checkpoint(out);
+		}
+	};
+
+	virtual void Resume(std::istream& in) {
+		for (typename std::vector<ConstitutiveLaw<T, Tder> *>::iterator i = m_clv.begin(); i != m_clv.end(); i++) {
+			(*i)->Resume(in);
+		}
+	};
+
+	virtual bool bCheckpointable(void) const {
+		for (typename std::vector<ConstitutiveLaw<T, Tder> *>::const_iterator i = m_clv.begin(); i != m_clv.end(); i++) {
+			if (!(*i)->bCheckpointable()) {
+				return false;
+			}
+		}
+		return true;
+	};
+
 	virtual std::ostream& OutputAppend(std::ostream& out) const {
 		for (typename std::vector<ConstitutiveLaw<T, Tder> *>::const_iterator i = m_clv.begin(); i != m_clv.end(); i++) {
 			(*i)->OutputAppend(out);
@@ -2264,6 +2286,22 @@ public:
 		}
 	};
 
+	virtual void Checkpoint(std::ostream& out) const {
+		ChkWrite(out, m_status);
+		ChkWrite(out, m_EpsRef);
+		m_pCL->Checkpoint(out);
+	};
+
+	virtual void Resume(std::istream& in) {
+		ChkRead(in, m_status);
+		ChkRead(in, m_EpsRef);
+		m_pCL->Resume(in);
+	};
+
+	virtual bool bCheckpointable(void) const {
+		return m_pCL->bCheckpointable();
+	};
+
 	// FIXME: OutputAppend() ?
 };
 
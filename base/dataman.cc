@@ -69,6 +69,7 @@ extern "C" {
 
 // To handle cleanups
 #include "cleanup.h"
+#include "checkpoint.h"
 
 /* DataManager - begin */
 
@@ -98,6 +99,8 @@ DataManager::DataManager(MBDynParser& HP,
 SolverDiagnostics(OF),
 #ifdef USE_MULTITHREAD
 nThreads(0),
+MTJacAssembly(MT_JAC_COPY),
+MTJacSum(MT_SUM_AUTO),
 #endif /* USE_MULTITHREAD */
 MBPar(HP),
 MathPar(HP.GetMathParser()),
@@ -141,8 +144,15 @@ iCurrRestartIter(0),
 dLastRestartTime(dInitialTime),
 saveXSol(false),
 solArrFileName(0),
+bBinaryRestart(false),
+bCheckpointPending(false),
 pOutputMeter(0),
 iOutputCount(0),
+bElemProfile(false),
+pElemProf(0),
+bJacPatternCache(false),
+pJacPattern(0),
+uJacPatternGen(0),
 #ifdef MBDYN_FDJAC
 pFDJacMeter(0),
 #endif // MBDYN_FDJAC
@@ -430,6 +440,22 @@ DofIter()
 		HP.OutputFrames(OutHdl.ReferenceFrames());
 	}
 
+	if (bElemProfile && !Elems.empty()) {
+		SAFENEWWITHCONSTRUCTOR(pElemProf, ElemProfile, ElemProfile(Elems));
+		OutHdl.Open(OutputHandler::PROFILE);
+	}
+
+	if (bJacPatternCache && !Elems.empty()) {
+		SAFENEWWITHCONSTRUCTOR(pJacPattern, JacPatternCache,
+			JacPatternCache(Elems));
+	}
+
+	/* refuse a binary restart up front rather than
+	 * silently dropping the state of an element */
+	if (bBinaryRestart) {
+		CheckpointSanity();
+	}
+
 	/* fine lettura elementi */
 
 	// if output is defined and at least one node wants to output,
@@ -657,7 +683,7 @@ DataManager::~DataManager(void)
 	 * crea il file e forza gli oggetti a scrivere il loro contributo nel modo
 	 * opportuno
 	 */
-	if (RestartEvery == ATEND) {
+	if (RestartEvery == ATEND && !bBinaryRestart) {
 		MakeRestart();
 	}
 
@@ -683,6 +709,17 @@ DataManager::~DataManager(void)
 		pOutputMeter = 0;
 	}
 
+	if (pElemProf) {
+		pElemProf->Report(OutHdl.Log(), OutHdl.Profile());
+		SAFEDELETE(pElemProf);
+		pElemProf = 0;
+	}
+
+	if (pJacPattern) {
+		SAFEDELETE(pJacPattern);
+		pJacPattern = 0;
+	}
+
 #ifdef MBDYN_FDJAC
 	if (pFDJacMeter) {
 		SAFEDELETE(pFDJacMeter);
@@ -736,6 +773,13 @@ DataManager::bOutput(ResType t) const
 
 void DataManager::MakeRestart(void)
 {
+	/* the solver writes the checkpoint at the beginning
+	 * of the next step, when its own state is consistent */
+	if (bBinaryRestart) {
+		bCheckpointPending = true;
+		return;
+	}
+
 	silent_cout("Making restart file ..." << std::endl);
 	OutHdl.RestartOpen(saveXSol);
 	/* Inizializzazione del file di restart */
@@ -872,6 +916,143 @@ void DataManager::MakeRestart(void)
 	OutHdl.Close(OutputHandler::RESTART);
 }
 
+bool
+DataManager::bCheckpointRequested(bool bAtEnd) const
+{
+	return bCheckpointPending
+		|| (bAtEnd && bBinaryRestart && RestartEvery == ATEND);
+}
+
+std::ostream&
+DataManager::CheckpointOpen(void)
+{
+	OutHdl.CheckpointOpen();
+	return OutHdl.Checkpoint();
+}
+
+void
+DataManager::CheckpointClose(void)
+{
+	if (!OutHdl.CheckpointClose()) {
+		silent_cerr("unable to write checkpoint file "
+			"\"" << OutHdl.sCheckpointName() << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	bCheckpointPending = false;
+}
+
+void
+DataManager::CheckpointSanity(void) const
+{
+	for (ElemVecType::const_iterator i = Elems.begin(); i != Elems.end(); ++i) {
+		if (!(*i)->bCheckpointable()) {
+			silent_cerr(psElemNames[(*i)->GetElemType()]
+				<< "(" << (*i)->GetLabel() << ") "
+				"keeps state that cannot be checkpointed; "
+				"binary restart is not available "
+				"for this model" << std::endl);
+			throw ErrCheckpoint(MBDYN_EXCEPT_ARGS);
+		}
+	}
+}
+
+void
+DataManager::Checkpoint(std::ostream& out) const
+{
+	/* sizes first, so that a different model is detected early */
+	ChkWrite(out, iTotDrive);
+	ChkWrite(out, Nodes.size());
+	ChkWrite(out, Elems.size());
+
+	DrvHdl.Checkpoint(out);
+
+	for (unsigned int i = 0; i < iTotDrive; i++) {
+		ChkWriteTag(out, ppDrive[i]->GetDriveType(), ppDrive[i]->GetLabel());
+		ppDrive[i]->Checkpoint(out);
+	}
+
+	for (NodeVecType::const_iterator i = Nodes.begin(); i != Nodes.end(); ++i) {
+		ChkWriteTag(out, (*i)->GetNodeType(), (*i)->GetLabel());
+		(*i)->Checkpoint(out);
+	}
+
+	for (ElemVecType::const_iterator i = Elems.begin(); i != Elems.end(); ++i) {
+		ChkWriteTag(out, (*i)->GetElemType(), (*i)->GetLabel());
+		(*i)->Checkpoint(out);
+	}
+
+	ChkWriteTag(out, -1, 0);
+}
+
+void
+DataManager::Resume(std::istream& in)
+{
+	unsigned int iTD;
+	NodeVecType::size_type nN;
+	ElemVecType::size_type nE;
+
+	CheckpointSanity();
+
+	ChkRead(in, iTD);
+	ChkRead(in, nN);
+	ChkRead(in, nE);
+	if (iTD != iTotDrive || nN != Nodes.size() || nE != Elems.size()) {
+		silent_cerr("checkpoint: " << iTD << " drives, "
+			<< nN << " nodes, " << nE << " elements; "
+			"the model has " << iTotDrive << " drives, "
+			<< Nodes.size() << " nodes, "
+			<< Elems.size() << " elements" << std::endl);
+		throw ErrCheckpoint(MBDYN_EXCEPT_ARGS);
+	}
+
+	DrvHdl.Resume(in);
+
+	/* the entity whose record is bad is reported */
+	for (unsigned int i = 0; i < iTotDrive; i++) {
+		try {
+			ChkReadTag(in, ppDrive[i]->GetDriveType(), ppDrive[i]->GetLabel());
+			ppDrive[i]->Resume(in);
+		}
+		catch (ErrCheckpoint) {
+			silent_cerr("checkpoint: while resuming "
+				<< psDriveNames[ppDrive[i]->GetDriveType()]
+				<< "(" << ppDrive[i]->GetLabel() << ")"
+				<< std::endl);
+			throw;
+		}
+	}
+
+	for (NodeVecType::iterator i = Nodes.begin(); i != Nodes.end(); ++i) {
+		try {
+			ChkReadTag(in, (*i)->GetNodeType(), (*i)->GetLabel());
+			(*i)->Resume(in);
+		}
+		catch (ErrCheckpoint) {
+			silent_cerr("checkpoint: while resuming "
+				<< psNodeNames[(*i)->GetNodeType()]
+				<< "(" << (*i)->GetLabel() << ")"
+				<< std::endl);
+			throw;
+		}
+	}
+
+	for (ElemVecType::iterator i = Elems.begin(); i != Elems.end(); ++i) {
+		try {
+			ChkReadTag(in, (*i)->GetElemType(), (*i)->GetLabel());
+			(*i)->Resume(in);
+		}
+		catch (ErrCheckpoint) {
+			silent_cerr("checkpoint: while resuming "
+				<< psElemNames[(*i)->GetElemType()]
+				<< "(" << (*i)->GetLabel() << ")"
+				<< std::endl);
+			throw;
+		}
+	}
+
+	ChkReadTag(in, -1, 0);
+}
+
 NamedValue *
 DataManager::InsertSym(const char* const s, const Real& v, int redefine)
 {
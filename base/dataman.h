@@ -69,6 +69,8 @@
 #include "nonlin.h"
 #include "linsol.h"
 #include "converged.h"
+#include "elemprof.h"
+#include "jacpattern.h"
 #include "invdyn.h"
 
 #ifdef USE_SOCKET
@@ -91,6 +93,18 @@ protected:
 #ifdef USE_MULTITHREAD
 	/* from input file, or auto-detected */
 	unsigned int nThreads;
+
+	/* multithreaded assembly options, from input file */
+	enum MTJacobianAssembly {
+		MT_JAC_COPY,		/* per-thread copies of the matrix */
+		MT_JAC_COLORING		/* elements colored by rows */
+	} MTJacAssembly;
+	enum MTJacobianSum {
+		MT_SUM_AUTO,
+		MT_SUM_SERIAL,
+		MT_SUM_PARALLEL,	/* by slices of the nonzeros */
+		MT_SUM_TREE		/* by slices, pairwise */
+	} MTJacSum;
 #endif /* USE_MULTITHREAD */
 
 	/* Handler vari */
@@ -175,10 +189,25 @@ protected:
 	bool saveXSol;
 	char * solArrFileName;
 
+	/* binary checkpoint in place of the text restart file */
+	bool bBinaryRestart;
+	mutable bool bCheckpointPending;
+
 	/* raw output stuff */
 	DriveCaller *pOutputMeter;
 	mutable integer iOutputCount;
 
+	/* element assembly profiling */
+	bool bElemProfile;
+	ElemProfile *pElemProf;
+
+	/* Jacobian matrix pattern caching */
+	bool bJacPatternCache;
+	JacPatternCache *pJacPattern;
+
+	/* changes any time the pattern of the Jacobian matrix changes */
+	unsigned uJacPatternGen;
+
 #ifdef MBDYN_FDJAC
 protected:
 	DriveCaller *pFDJacMeter;
@@ -325,6 +354,18 @@ public:
 	/* Restituisce il numero di dof per la costruzione delle matrici ecc. */
 	integer iGetNumDofs(void) const { return iTotDofs; };
 
+	/* first index (0-based) of the dofs of each DofOwner,
+	 * in ascending order, followed by the total number of dofs */
+	void GetDofBlocks(std::vector<integer>& Blocks) const;
+
+	/* generation of the pattern of the Jacobian matrix; as long as
+	 * it does not change, the solution manager may reuse the symbolic
+	 * factorization and keep the matrix in compact form */
+	unsigned GetJacPatternGeneration(void) const { return uJacPatternGen; };
+	/* to be called when the assembly throws ErrRebuildMatrix
+	 * or ChangedEquationStructure */
+	void JacPatternChanged(void);
+
 	/* Restituisce il puntatore alla struttura dei dof */
 	VecIter<Dof>& GetDofIterator(void) /* const */ { return DofIter; };
 
@@ -335,6 +376,8 @@ public:
 
 	/* required for binary NetCDF output access */
 	const OutputHandler* pGetOutHdl(void) const { return &OutHdl; };
+	/* for output files owned by the solver */
+	OutputHandler* pGetOutHdl(void) { return &OutHdl; };
 
 	/* default orientation description */
 	void SetOrientationDescription(OrientationDescription);
@@ -459,12 +502,30 @@ public:
 
 	/* Funzioni di aggiornamento dati durante la simulazione */
 	virtual void MakeRestart(void);
+
+	/* binary checkpoint; the solver decides when it is safe to write */
+	bool bCheckpointRequested(bool bAtEnd = false) const;
+	std::ostream& CheckpointOpen(void);
+	void CheckpointClose(void);
+	void CheckpointSanity(void) const;
+	void Checkpoint(std::ostream& out) const;
+	void Resume(std::istream& in);
 	virtual void DerivativesUpdate(void) const;
 	virtual void BeforePredict(VectorHandler& X, VectorHandler& XP,
 			VectorHandler& XPrev, VectorHandler& XPPrev) const;
 	virtual void AfterPredict(void) const;
 	virtual void Update(void) const;
 	virtual void AfterConvergence(void) const;
+
+	/* runs pTask(pData, iTask) for iTask = 0, ..., nTasks - 1,
+	 * in any order and on the assembly threads, if any;
+	 * the tasks must be independent; if any throws, the exception
+	 * of the lowest iTask is rethrown once all tasks are done */
+	virtual void RunTasks(void (*pTask)(void *, unsigned),
+			void *pData, unsigned nTasks) const;
+
+	/* restart, if required, after convergence */
+	void AfterConvergenceRestart(void) const;
 	
 	/* Inverse Dynamics: */
 	virtual void Update(InverseDynamics::Order iOrder) const;
@@ -533,7 +594,9 @@ public:
 		TOBEUSEDINASSEMBLY	= 0x02U,
 		GENERATESINERTIAFORCES	= 0x04U,
 		USESAIRPROPERTIES	= 0x08U,
-		DEFAULTOUT		= 0x10U
+		DEFAULTOUT		= 0x10U,
+		MTSERIAL		= 0x20U,
+		MTSERIALPHASES		= 0x40U
 	};
 
 	/* element read functional object prototype */
@@ -574,12 +637,16 @@ protected:
 		void GeneratesInertiaForces(bool b) { if (b) { uFlags |= GENERATESINERTIAFORCES; } else { uFlags &= ~GENERATESINERTIAFORCES; } };
 		void UsesAirProperties(bool b) { if (b) { uFlags |= USESAIRPROPERTIES; } else { uFlags &= ~USESAIRPROPERTIES; } };
 		void DefaultOut(bool b) { if (b) { uFlags |= DEFAULTOUT; } else { uFlags &= ~DEFAULTOUT; } };
+		void MTSerial(bool b) { if (b) { uFlags |= MTSERIAL; } else { uFlags &= ~MTSERIAL; } };
+		void MTSerialPhases(bool b) { if (b) { uFlags |= MTSERIALPHASES; } else { uFlags &= ~MTSERIALPHASES; } };
 
 		bool bIsUnique(void) const { return (uFlags & ISUNIQUE) == ISUNIQUE; };
 		bool bToBeUsedInAssembly(void) const { return (uFlags & TOBEUSEDINASSEMBLY) == TOBEUSEDINASSEMBLY; };
 		bool bGeneratesInertiaForces(void) const { return (uFlags & GENERATESINERTIAFORCES) == GENERATESINERTIAFORCES; };
 		bool bUsesAirProperties(void) const { return (uFlags & USESAIRPROPERTIES) == USESAIRPROPERTIES; };
 		bool bDefaultOut(void) const { return (uFlags & DEFAULTOUT) == DEFAULTOUT; };
+		bool bMTSerial(void) const { return (uFlags & MTSERIAL) == MTSERIAL; };
+		bool bMTSerialPhases(void) const { return (uFlags & MTSERIALPHASES) == MTSERIALPHASES; };
 
 		/* element read map */
 		ElemReadType ElemRead;
@@ -35,6 +35,7 @@
 #include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
 
 #include <set>
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 // #include <typeinfo>
@@ -1370,6 +1371,24 @@ DataManager::DofOwnerSet(void)
 	}
 } /* end of DofOwnerSet() */
 
+void
+DataManager::GetDofBlocks(std::vector<integer>& Blocks) const
+{
+	Blocks.clear();
+	for (integer i = 0; i < iTotDofOwners; i++) {
+		if (pDofOwners[i].iNumDofs > 0) {
+			Blocks.push_back(pDofOwners[i].iFirstIndex);
+		}
+	}
+
+	std::sort(Blocks.begin(), Blocks.end());
+	Blocks.erase(std::unique(Blocks.begin(), Blocks.end()), Blocks.end());
+	if (Blocks.empty() || Blocks.front() != 0) {
+		Blocks.insert(Blocks.begin(), 0);
+	}
+	Blocks.push_back(iTotDofs);
+}
+
 
 void
 DataManager::SetValue(VectorHandler& X, VectorHandler& XP)
@@ -1510,6 +1529,7 @@ DataManager::Output(long lStep,
 #endif /* USE_MOTIONVIEW */
 
 	OutHdl.IncCurrentStep();
+	OutHdl.StepFlush();
 #ifdef USE_NETCDF
 	if (bNetCDFsync) {
 		OutHdl.pGetBinFile()->sync();
@@ -1641,6 +1661,22 @@ DataManager::AfterConvergence(void) const
 		} while (ElemIter.bGetNext(pEl));
 	}
 
+	AfterConvergenceRestart();
+}
+
+void
+DataManager::RunTasks(void (*pTask)(void *, unsigned),
+	void *pData, unsigned nTasks) const
+{
+	/* serially, the first exception is also that of the lowest iTask */
+	for (unsigned i = 0; i < nTasks; i++) {
+		pTask(pData, i);
+	}
+}
+
+void
+DataManager::AfterConvergenceRestart(void) const
+{
 	/* Restart condizionato */
 	switch (RestartEvery) {
 	case NEVER:
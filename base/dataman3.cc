@@ -130,6 +130,8 @@ DataManager::ReadControl(MBDynParser& HP,
 		"linear" "solver",
 
 		"print",
+		"profile",
+		"jacobian" "pattern" "cache",
 
 		"title",
 		"make" "restart" "file",
@@ -137,6 +139,7 @@ DataManager::ReadControl(MBDynParser& HP,
 		"output" "precision",
 		"output" "frequency", /* deprecated */
 		"output" "meter",
+		"output" "buffer",
 		"output" "results",
 		"default" "output",
 			"all",
@@ -159,6 +162,8 @@ DataManager::ReadControl(MBDynParser& HP,
 
 		"rigid" "body" "kinematics",
 
+		"multithread",
+
 		0
 	};
 
@@ -220,6 +225,8 @@ DataManager::ReadControl(MBDynParser& HP,
 		LINEARSOLVER,
 
 		PRINT,
+		PROFILE,
+		JACOBIANPATTERNCACHE,
 
 		TITLE,
 		MAKERESTARTFILE,
@@ -227,6 +234,7 @@ DataManager::ReadControl(MBDynParser& HP,
 		OUTPUTPRECISION,
 		OUTPUTFREQUENCY,
 		OUTPUTMETER,
+		OUTPUTBUFFER,
 
 		OUTPUTRESULTS,
 		DEFAULTOUTPUT,
@@ -249,6 +257,8 @@ DataManager::ReadControl(MBDynParser& HP,
 		MODEL,
 		RIGIDBODYKINEMATICS,
 
+		MULTITHREAD,
+
 		LASTKEYWORD
 	};
 
@@ -796,6 +806,30 @@ EndOfUse:
 			}
 			break;
 
+		case PROFILE:
+			while (HP.IsArg()) {
+				if (HP.IsKeyWord("elements")) {
+					bElemProfile = true;
+
+				} else if (HP.IsKeyWord("none")) {
+					bElemProfile = false;
+
+				} else {
+					silent_cerr("unknown profile flag at line "
+						<< HP.GetLineData() << std::endl);
+					throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+				}
+			}
+			break;
+
+		case JACOBIANPATTERNCACHE:
+			if (!HP.GetYesNo(bJacPatternCache)) {
+				silent_cerr("Invalid option at line "
+					<< HP.GetLineData() << std::endl);
+				throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+			break;
+
 		case SOLVER:
 			silent_cerr("\"solver\" keyword at line "
 				<< HP.GetLineData() << " is deprecated; "
@@ -861,6 +895,10 @@ EndOfUse:
 			if (HP.IsKeyWord("with" "solution" "array")) {
 				saveXSol = true;
 			}
+
+			if (HP.IsKeyWord("binary")) {
+				bBinaryRestart = true;
+			}
 			break;
 
 		case OUTPUTFILENAME:
@@ -901,6 +939,89 @@ EndOfUse:
 			pOutputMeter = HP.GetDriveCaller(false);
 			break;
 
+		case OUTPUTBUFFER:
+			while (HP.IsArg()) {
+				if (HP.IsKeyWord("size")) {
+					integer iSize = HP.GetInt();
+					if (iSize < 1024) {
+						silent_cerr("Illegal output buffer size " << iSize
+							<< " (must be at least 1024) "
+							"at line " << HP.GetLineData() << std::endl);
+						throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+					}
+					OutHdl.SetBufferSize(iSize);
+
+				} else if (HP.IsKeyWord("flush")) {
+					if (HP.IsKeyWord("line")) {
+						OutHdl.SetFlushPolicy(OutputHandler::FLUSH_LINE);
+
+					} else if (HP.IsKeyWord("step")) {
+						OutHdl.SetFlushPolicy(OutputHandler::FLUSH_STEP);
+
+					} else if (HP.IsKeyWord("every")) {
+						integer iSteps = HP.GetInt();
+						if (iSteps < 1) {
+							silent_cerr("Illegal output buffer flush interval " << iSteps
+								<< " at line " << HP.GetLineData() << std::endl);
+							throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+						}
+						OutHdl.SetFlushPolicy(OutputHandler::FLUSH_STEP, iSteps);
+
+					} else if (HP.IsKeyWord("none")) {
+						OutHdl.SetFlushPolicy(OutputHandler::FLUSH_NONE);
+
+					} else {
+						silent_cerr("unknown output buffer flush policy "
+							"at line " << HP.GetLineData() << std::endl);
+						throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+					}
+
+				} else if (HP.IsKeyWord("binary")) {
+					while (HP.IsArg()) {
+						if (HP.IsKeyWord("structural" "nodes")) {
+							OutHdl.SetBinary(OutputHandler::STRNODES);
+
+						} else if (HP.IsKeyWord("joints")) {
+							OutHdl.SetBinary(OutputHandler::JOINTS);
+
+						} else if (HP.IsKeyWord("forces")) {
+							OutHdl.SetBinary(OutputHandler::FORCES);
+
+						} else {
+							break;
+						}
+					}
+
+				} else if (HP.IsKeyWord("asynchronous")) {
+					/* only the file I/O of the text and binary
+					 * streams is offloaded; NetCDF is not */
+					bool bAsync;
+					if (!HP.GetYesNo(bAsync)) {
+						silent_cerr("Invalid option at line "
+							<< HP.GetLineData() << std::endl);
+						throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+					}
+
+					integer iQueue = 0;
+					if (HP.IsKeyWord("queue" "size")) {
+						iQueue = HP.GetInt();
+						if (iQueue < 1) {
+							silent_cerr("Illegal output queue size " << iQueue
+								<< " at line " << HP.GetLineData() << std::endl);
+							throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+						}
+					}
+
+					OutHdl.SetAsync(bAsync, iQueue);
+
+				} else {
+					silent_cerr("unknown output buffer option "
+						"at line " << HP.GetLineData() << std::endl);
+					throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+				}
+			}
+			break;
+
 		case OUTPUTRESULTS:
 			while (HP.IsArg()) {
 				/* require support for ADAMS/View .res output */
@@ -1278,6 +1399,76 @@ EndOfUse:
 			}
 			break;
 
+		case MULTITHREAD:
+			while (HP.IsArg()) {
+				if (HP.IsKeyWord("jacobian")) {
+					if (HP.IsKeyWord("copy")) {
+#ifdef USE_MULTITHREAD
+						MTJacAssembly = MT_JAC_COPY;
+#endif // USE_MULTITHREAD
+
+					} else if (HP.IsKeyWord("coloring")) {
+#ifdef USE_MULTITHREAD
+						MTJacAssembly = MT_JAC_COLORING;
+#endif // USE_MULTITHREAD
+
+					} else {
+						silent_cerr("unknown \"multithread\" "
+							"jacobian assembly mode at line "
+							<< HP.GetLineData() << std::endl);
+						throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+					}
+
+				} else if (HP.IsKeyWord("sum")) {
+					/* sum of per-thread jacobian matrices */
+#ifdef USE_MULTITHREAD
+					MTJacobianSum s;
+#endif // USE_MULTITHREAD
+					if (HP.IsKeyWord("auto")) {
+#ifdef USE_MULTITHREAD
+						s = MT_SUM_AUTO;
+#endif // USE_MULTITHREAD
+
+					} else if (HP.IsKeyWord("serial")) {
+#ifdef USE_MULTITHREAD
+						s = MT_SUM_SERIAL;
+#endif // USE_MULTITHREAD
+
+					} else if (HP.IsKeyWord("parallel")) {
+#ifdef USE_MULTITHREAD
+						s = MT_SUM_PARALLEL;
+#endif // USE_MULTITHREAD
+
+					} else if (HP.IsKeyWord("tree")) {
+#ifdef USE_MULTITHREAD
+						s = MT_SUM_TREE;
+#endif // USE_MULTITHREAD
+
+					} else {
+						silent_cerr("unknown \"multithread\" "
+							"sum mode at line "
+							<< HP.GetLineData() << std::endl);
+						throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+					}
+#ifdef USE_MULTITHREAD
+					MTJacSum = s;
+#endif // USE_MULTITHREAD
+
+				} else {
+					silent_cerr("unknown \"multithread\" "
+						"option at line " << HP.GetLineData()
+						<< std::endl);
+					throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+				}
+			}
+#ifndef USE_MULTITHREAD
+			silent_cerr("warning: \"multithread\" ignored at line "
+				<< HP.GetLineData() << "; configure with "
+				"--enable-multithread for multithreaded assembly"
+				<< std::endl);
+#endif // ! USE_MULTITHREAD
+			break;
+
 		case RIGIDBODYKINEMATICS: {
 			if (HP.IsKeyWord("const")) {
 				Vec3 X(Zero3);
@@ -34,6 +34,7 @@
 #include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
 
 #include "drive.h"
+#include "checkpoint.h"
 
 doublereal Drive::dReturnValue = 0.;
 doublereal DriveHandler::dDriveHandlerReturnValue = 0.;
@@ -51,6 +52,18 @@ Drive::~Drive(void) {
 	NO_OP;
 }
 
+void
+Drive::Checkpoint(std::ostream& out) const
+{
+	NO_OP;
+}
+
+void
+Drive::Resume(std::istream& in)
+{
+	NO_OP;
+}
+
 /* Drive - end */
 
 
@@ -451,6 +464,148 @@ DriveHandler::MySH::dGetVal0(void) const
 	return dVal0;
 }
 
+void
+DriveHandler::MyMeter::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, iCurr);
+}
+
+void
+DriveHandler::MyMeter::Resume(std::istream& in)
+{
+	ChkRead(in, iCurr);
+}
+
+void
+DriveHandler::MyRand::Checkpoint(std::ostream& out) const
+{
+	MyMeter::Checkpoint(out);
+	ChkWrite(out, iRand);
+}
+
+void
+DriveHandler::MyRand::Resume(std::istream& in)
+{
+	MyMeter::Resume(in);
+	ChkRead(in, iRand);
+}
+
+void
+DriveHandler::MyClosestNext::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, bMustSetNext);
+	ChkWrite(out, dNext);
+}
+
+void
+DriveHandler::MyClosestNext::Resume(std::istream& in)
+{
+	ChkRead(in, bMustSetNext);
+	ChkRead(in, dNext);
+}
+
+void
+DriveHandler::MySH::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, dVal);
+}
+
+void
+DriveHandler::MySH::Resume(std::istream& in)
+{
+	ChkRead(in, dVal);
+}
+
+void
+DriveHandler::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, dGetTime());
+	ChkWrite(out, dGetTimeStep());
+	ChkWrite(out, iCurrStep);
+
+	/* sizes are checked on resume */
+	ChkWrite(out, Meter.size());
+	for (std::vector<MyMeter *>::const_iterator i = Meter.begin();
+		i != Meter.end(); ++i)
+	{
+		(*i)->Checkpoint(out);
+	}
+
+	ChkWrite(out, Rand.size());
+	for (std::vector<MyRand *>::const_iterator i = Rand.begin();
+		i != Rand.end(); ++i)
+	{
+		(*i)->Checkpoint(out);
+	}
+
+	ChkWrite(out, ClosestNext.size());
+	for (std::vector<MyClosestNext *>::const_iterator i = ClosestNext.begin();
+		i != ClosestNext.end(); ++i)
+	{
+		(*i)->Checkpoint(out);
+	}
+
+	ChkWrite(out, SH.size());
+	for (std::vector<MySH *>::const_iterator i = SH.begin();
+		i != SH.end(); ++i)
+	{
+		(*i)->Checkpoint(out);
+	}
+}
+
+static void
+ChkReadSize(std::istream& in, size_t size, const char *sWhat)
+{
+	size_t s;
+	ChkRead(in, s);
+	if (s != size) {
+		silent_cerr("checkpoint: " << s << " " << sWhat << " drivers "
+			"while the model has " << size << std::endl);
+		throw ErrCheckpoint(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+void
+DriveHandler::Resume(std::istream& in)
+{
+	doublereal dt, dts;
+	ChkRead(in, dt);
+	ChkRead(in, dts);
+	ChkRead(in, iCurrStep);
+
+	pTime->SetVal(dt);
+	pTimeStep->SetVal(dts);
+	pStep->SetVal(iCurrStep);
+
+	ChkReadSize(in, Meter.size(), "meter");
+	for (std::vector<MyMeter *>::iterator i = Meter.begin();
+		i != Meter.end(); ++i)
+	{
+		(*i)->Resume(in);
+	}
+
+	ChkReadSize(in, Rand.size(), "random");
+	for (std::vector<MyRand *>::iterator i = Rand.begin();
+		i != Rand.end(); ++i)
+	{
+		(*i)->Resume(in);
+	}
+
+	ChkReadSize(in, ClosestNext.size(), "closest next");
+	for (std::vector<MyClosestNext *>::iterator i = ClosestNext.begin();
+		i != ClosestNext.end(); ++i)
+	{
+		(*i)->Resume(in);
+	}
+
+	ChkReadSize(in, SH.size(), "sample and hold");
+	for (std::vector<MySH *>::iterator i = SH.begin();
+		i != SH.end(); ++i)
+	{
+		(*i)->Resume(in);
+	}
+}
+
 /* DriveHandler - end */
 
 /* DriveCaller - begin */
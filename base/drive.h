@@ -119,6 +119,10 @@ public:
 	virtual std::ostream& Restart(std::ostream& out) const = 0;
 
 	virtual void ServePending(const doublereal& t) = 0;
+
+	/* binary checkpoint of the private state; by default there is none */
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
 };
 
 /* Drive - end */
@@ -206,6 +210,9 @@ private:
 		inline integer iGetSteps(void) const;
 		inline bool bGetMeter(void) const;
 		virtual inline void Set(void);
+
+		virtual void Checkpoint(std::ostream& out) const;
+		virtual void Resume(std::istream& in);
 	};
 
 	/* For random drivers */
@@ -220,6 +227,9 @@ private:
 		inline integer iGetSteps(void) const;
 		inline integer iGetRand(void) const;
 		virtual inline void Set(void);
+
+		virtual void Checkpoint(std::ostream& out) const;
+		virtual void Resume(std::istream& in);
 	};
 
 	/* For closest next drivers */
@@ -237,6 +247,9 @@ private:
 
 		inline bool bGetClosestNext(void) const;
 		virtual inline void Set(void);
+
+		void Checkpoint(std::ostream& out) const;
+		void Resume(std::istream& in);
 	};
 
 	/* For sample'n'hold */
@@ -259,6 +272,9 @@ private:
 		const DriveCaller *pGetFunc(void) const;
 		const DriveCaller *pGetTrigger(void) const;
 		const doublereal dGetVal0(void) const;
+
+		void Checkpoint(std::ostream& out) const;
+		void Resume(std::istream& in);
 	};
 
 	std::vector<MyMeter *> Meter;
@@ -297,6 +313,12 @@ public:
 	const DriveCaller *pGetSHFunc(integer iNumber) const;
 	const DriveCaller *pGetSHTrigger(integer iNumber) const;
 	const doublereal dGetSHVal0(integer iNumber) const;
+
+	/* time, step and the state of meters, random, closest next
+	 * and sample'n'hold drivers; the sequence of rand() is not
+	 * restored, only the current random values */
+	void Checkpoint(std::ostream& out) const;
+	void Resume(std::istream& in);
 };
 
 
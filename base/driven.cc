@@ -40,6 +40,7 @@
 
 #include "driven.h"
 #include "joint.h"
+#include "checkpoint.h"
 
 DrivenElem::DrivenElem(DataManager *pdm,
 		const DriveCaller* pDC, const Elem* pE,
@@ -247,6 +248,20 @@ DrivenElem::AfterConvergence(const VectorHandler& X, const VectorHandler& XP)
 	}
 }
 
+void
+DrivenElem::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, bActive);
+	NestedElem::Checkpoint(out);
+}
+
+void
+DrivenElem::Resume(std::istream& in)
+{
+	ChkRead(in, bActive);
+	NestedElem::Resume(in);
+}
+
 /* assemblaggio jacobiano */
 VariableSubMatrixHandler&
 DrivenElem::AssJac(VariableSubMatrixHandler& WorkMat,
@@ -86,6 +86,9 @@ public:
 	virtual void AfterConvergence(const VectorHandler& X,
      			const VectorHandler& XP);
 
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
 	/* assemblaggio jacobiano */
 	virtual VariableSubMatrixHandler&
 	AssJac(VariableSubMatrixHandler& WorkMat,
@@ -0,0 +1,212 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2014
+ *
+ * Pierangelo Masarati	<masarati@aero.polimi.it>
+ * Paolo Mantegazza	<mantegazza@aero.polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <algorithm>
+#include <iomanip>
+
+#include "elemprof.h"
+
+static double
+elemprof_wall_time(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return double(ts.tv_sec) + 1e-9*double(ts.tv_nsec);
+}
+
+ElemProfile::ElemProfile(const std::vector<Elem *>& Elems)
+: Counters(Elems.size())
+{
+	for (unsigned e = 0; e < Elems.size(); e++) {
+		Counters[e].pEl = Elems[e];
+		for (unsigned k = 0; k < LASTKIND; k++) {
+			Counters[e].c[k].ticks = 0;
+			Counters[e].c[k].calls = 0;
+		}
+	}
+
+	std::sort(Counters.begin(), Counters.end());
+
+	dStartTime = elemprof_wall_time();
+	StartTicks = GetTicks();
+}
+
+ElemProfile::~ElemProfile(void)
+{
+	NO_OP;
+}
+
+ElemProfile::ElemCounter *
+ElemProfile::pFind(const Elem *pEl)
+{
+	ElemCounter ec;
+	ec.pEl = pEl;
+
+	std::vector<ElemCounter>::iterator i
+		= std::lower_bound(Counters.begin(), Counters.end(), ec);
+	if (i == Counters.end() || i->pEl != pEl) {
+		return 0;
+	}
+
+	return &(*i);
+}
+
+/* sorts by decreasing total ticks */
+struct ElemProfileRank {
+	const std::vector<ElemProfile::Ticks>& Total;
+
+	ElemProfileRank(const std::vector<ElemProfile::Ticks>& Total)
+	: Total(Total) {};
+
+	bool operator () (unsigned i, unsigned j) const {
+		return Total[i] > Total[j];
+	};
+};
+
+void
+ElemProfile::Report(std::ostream& log, std::ostream& out) const
+{
+	/* seconds per tick, from the elapsed time since construction */
+	Ticks DeltaTicks = GetTicks() - StartTicks;
+	double dDeltaTime = elemprof_wall_time() - dStartTime;
+	double dTick = DeltaTicks > 0 ? dDeltaTime/double(DeltaTicks) : 0.;
+
+	std::vector<Ticks> Total(Counters.size());
+	std::vector<unsigned> Rank(Counters.size());
+	Ticks AllTicks = 0;
+	for (unsigned e = 0; e < Counters.size(); e++) {
+		Total[e] = 0;
+		for (unsigned k = 0; k < LASTKIND; k++) {
+			Total[e] += Counters[e].c[k].ticks;
+		}
+		AllTicks += Total[e];
+		Rank[e] = e;
+	}
+
+	std::stable_sort(Rank.begin(), Rank.end(), ElemProfileRank(Total));
+
+	/* by element type */
+	std::vector<Ticks> TypeTicks(Elem::LASTELEMTYPE, 0);
+	std::vector<unsigned long> TypeCalls(Elem::LASTELEMTYPE, 0);
+	for (unsigned e = 0; e < Counters.size(); e++) {
+		Elem::Type t = Counters[e].pEl->GetElemType();
+		TypeTicks[t] += Total[e];
+		for (unsigned k = 0; k < LASTKIND; k++) {
+			TypeCalls[t] += Counters[e].c[k].calls;
+		}
+	}
+
+	std::vector<unsigned> TypeRank(Elem::LASTELEMTYPE);
+	for (unsigned t = 0; t < TypeRank.size(); t++) {
+		TypeRank[t] = t;
+	}
+	std::stable_sort(TypeRank.begin(), TypeRank.end(), ElemProfileRank(TypeTicks));
+
+	double dAll = AllTicks*dTick;
+
+	std::ios::fmtflags flags = log.flags();
+	std::streamsize precision = log.precision();
+
+	log << "element assembly profile: total " << dAll << " s" << std::endl;
+
+	log << "element assembly profile by type:" << std::endl
+		<< std::setw(24) << "type"
+		<< std::setw(12) << "calls"
+		<< std::setw(14) << "time [s]"
+		<< std::setw(8) << "%" << std::endl;
+	for (unsigned r = 0; r < TypeRank.size(); r++) {
+		unsigned t = TypeRank[r];
+		if (TypeCalls[t] == 0) {
+			continue;
+		}
+
+		double d = TypeTicks[t]*dTick;
+		log << std::setw(24) << psElemNames[t]
+			<< std::setw(12) << TypeCalls[t]
+			<< std::setw(14) << d
+			<< std::setw(8) << std::fixed << std::setprecision(2)
+				<< (dAll > 0. ? 100.*d/dAll : 0.)
+			<< std::resetiosflags(std::ios::fixed) << std::setprecision(6)
+			<< std::endl;
+	}
+
+	log << "element assembly profile by element:" << std::endl
+		<< std::setw(6) << "rank"
+		<< std::setw(24) << "type"
+		<< std::setw(10) << "label"
+		<< std::setw(10) << "jac calls"
+		<< std::setw(14) << "jac [s]"
+		<< std::setw(10) << "res calls"
+		<< std::setw(14) << "res [s]"
+		<< std::setw(10) << "mats calls"
+		<< std::setw(14) << "mats [s]"
+		<< std::setw(8) << "%" << std::endl;
+	for (unsigned r = 0; r < Rank.size(); r++) {
+		const ElemCounter& ec = Counters[Rank[r]];
+		double d = Total[Rank[r]]*dTick;
+
+		log << std::setw(6) << r + 1
+			<< std::setw(24) << psElemNames[ec.pEl->GetElemType()]
+			<< std::setw(10) << ec.pEl->GetLabel()
+			<< std::setw(10) << ec.c[JAC].calls
+			<< std::setw(14) << ec.c[JAC].ticks*dTick
+			<< std::setw(10) << ec.c[RES].calls
+			<< std::setw(14) << ec.c[RES].ticks*dTick
+			<< std::setw(10) << ec.c[MATS].calls
+			<< std::setw(14) << ec.c[MATS].ticks*dTick
+			<< std::setw(8) << std::fixed << std::setprecision(2)
+				<< (dAll > 0. ? 100.*d/dAll : 0.)
+			<< std::resetiosflags(std::ios::fixed) << std::setprecision(6)
+			<< std::endl;
+	}
+
+	log.flags(flags);
+	log.precision(precision);
+
+	/* machine-readable: one line per element, in rank order */
+	out << "# rank type label jac_calls jac_time res_calls res_time mats_calls mats_time" << std::endl;
+	for (unsigned r = 0; r < Rank.size(); r++) {
+		const ElemCounter& ec = Counters[Rank[r]];
+
+		out << r + 1
+			<< " \"" << psElemNames[ec.pEl->GetElemType()] << "\""
+			<< " " << ec.pEl->GetLabel()
+			<< " " << ec.c[JAC].calls
+			<< " " << ec.c[JAC].ticks*dTick
+			<< " " << ec.c[RES].calls
+			<< " " << ec.c[RES].ticks*dTick
+			<< " " << ec.c[MATS].calls
+			<< " " << ec.c[MATS].ticks*dTick
+			<< std::endl;
+	}
+}
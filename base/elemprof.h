@@ -0,0 +1,122 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2014
+ *
+ * Pierangelo Masarati	<masarati@aero.polimi.it>
+ * Paolo Mantegazza	<mantegazza@aero.polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* profiling of the assembly cost of the elements */
+
+#ifndef ELEMPROF_H
+#define ELEMPROF_H
+
+#include <time.h>
+#include <iostream>
+#include <vector>
+
+#include "elem.h"
+
+/*
+ * Accumulates ticks and calls per element for Jacobian matrix,
+ * eigenanalysis matrices and residual assembly.  Each element is assembled by one thread
+ * at a time, and different ops are separated by the thread
+ * synchronization, so the counters need no locking.
+ */
+class ElemProfile {
+public:
+	enum Kind {
+		JAC = 0,
+		RES,
+		MATS,
+
+		LASTKIND
+	};
+
+	typedef unsigned long long Ticks;
+
+	/* low-overhead counter; only differences are meaningful */
+	static inline Ticks GetTicks(void);
+
+protected:
+	struct Counter {
+		Ticks ticks;
+		unsigned long calls;
+	};
+
+	struct ElemCounter {
+		const Elem *pEl;
+		Counter c[LASTKIND];
+
+		bool operator < (const ElemCounter& ec) const {
+			return pEl < ec.pEl;
+		};
+	};
+
+	/* sorted by element address */
+	std::vector<ElemCounter> Counters;
+
+	/* for tick to second conversion */
+	Ticks StartTicks;
+	double dStartTime;
+
+	ElemCounter *pFind(const Elem *pEl);
+
+public:
+	ElemProfile(const std::vector<Elem *>& Elems);
+	virtual ~ElemProfile(void);
+
+	inline void Add(Kind k, const Elem *pEl, Ticks t);
+
+	/* ranked table to log, one line per element and kind to out */
+	void Report(std::ostream& log, std::ostream& out) const;
+};
+
+inline ElemProfile::Ticks
+ElemProfile::GetTicks(void)
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	unsigned lo, hi;
+	__asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+	return (Ticks(hi) << 32) | lo;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return Ticks(ts.tv_sec)*1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+inline void
+ElemProfile::Add(Kind k, const Elem *pEl, Ticks t)
+{
+	ElemCounter *p = pFind(pEl);
+	if (p != 0) {
+		p->c[k].ticks += t;
+		p->c[k].calls++;
+	}
+}
+
+#endif /* ELEMPROF_H */
@@ -184,6 +184,21 @@ DataManager::ElemManager(void)
 	ElemData[Elem::LOADABLE].UsesAirProperties(true);
 	ElemData[Elem::EXTERNAL].UsesAirProperties(true);
 
+	/* Aggiungere qui se un tipo deve essere processato dal solo
+	 * thread principale, prima degli altri, nell'assemblaggio
+	 * multithread: gli elementi di velocita' indotta devono
+	 * calcolare i loro parametri prima che gli elementi
+	 * aerodinamici vi sommino le forze; gli elementi esterni
+	 * comunicano durante l'assemblaggio del residuo */
+	ElemData[Elem::AIRPROPERTIES].MTSerial(true);
+	ElemData[Elem::INDUCEDVELOCITY].MTSerial(true);
+	ElemData[Elem::EXTERNAL].MTSerial(true);
+
+	/* elementi i cui BeforePredict, AfterPredict, Update
+	 * e AfterConvergence non possono essere eseguiti in parallelo */
+	ElemData[Elem::LOADABLE].MTSerialPhases(true);
+	ElemData[Elem::SOCKETSTREAM_OUTPUT].MTSerialPhases(true);
+
 	/* Reset della struttura DriveData */
 	for (int i = 0; i < Drive::LASTDRIVETYPE; i++) {
 		DriveData[i].ppFirstDrive = NULL;
@@ -396,7 +411,27 @@ DataManager::AssJac(MatrixHandler& JacHdl, doublereal dCoef)
 	ASSERT(pWorkMat != NULL);
 	ASSERT(Elems.begin() != Elems.end());
 
-	AssJac(JacHdl, dCoef, ElemIter, *pWorkMat);
+	if (pJacPattern) {
+		pJacPattern->pCheck(JacHdl, GetJacPatternGeneration());
+	}
+
+	try {
+		AssJac(JacHdl, dCoef, ElemIter, *pWorkMat);
+	}
+	catch (MatrixHandler::ErrRebuildMatrix) {
+		JacPatternChanged();
+		throw;
+	}
+}
+
+void
+DataManager::JacPatternChanged(void)
+{
+	uJacPatternGen++;
+
+	if (pJacPattern) {
+		pJacPattern->Invalidate();
+	}
 }
 
 void
@@ -420,12 +455,29 @@ DataManager::AssJac(MatrixHandler& JacHdl, doublereal dCoef,
 	}
 #endif
 
+	/* the pattern cache must have been checked against JacHdl */
+	CompactSparseMatrixHandler *pCCJacHdl = 0;
+	if (pJacPattern) {
+		pCCJacHdl = dynamic_cast<CompactSparseMatrixHandler *>(&JacHdl);
+	}
+
 	Elem* pTmpEl = NULL;
 	if (Iter.bGetFirst(pTmpEl)) {
 		do {
+			ElemProfile::Ticks t0 = 0;
+			if (pElemProf) {
+				t0 = ElemProfile::GetTicks();
+			}
+
 			try {
-				JacHdl += pTmpEl->AssJac(WorkMat, dCoef,
-						*pXCurr, *pXPrimeCurr);
+				VariableSubMatrixHandler& WM = pTmpEl->AssJac(WorkMat,
+						dCoef, *pXCurr, *pXPrimeCurr);
+				if (pCCJacHdl) {
+					pJacPattern->Add(*pCCJacHdl, pTmpEl, WM);
+
+				} else {
+					JacHdl += WM;
+				}
 			}
 			catch (ErrDivideByZero) {
 				silent_cerr("AssJac: divide by zero "
@@ -435,6 +487,11 @@ DataManager::AssJac(MatrixHandler& JacHdl, doublereal dCoef,
 				throw ErrDivideByZero(MBDYN_EXCEPT_ARGS);
 			}
 
+			if (pElemProf) {
+				pElemProf->Add(ElemProfile::JAC, pTmpEl,
+					ElemProfile::GetTicks() - t0);
+			}
+
 #if 0
 			silent_cerr("### " << psElemNames[pTmpEl->GetElemType()] << "(" << pTmpEl->GetLabel() <<"):" << std::endl);
 			silent_cerr(JacHdl << std::endl);
@@ -485,10 +542,20 @@ DataManager::AssMats(MatrixHandler& A_Hdl, MatrixHandler& B_Hdl,
 
 		/* Con VariableSubMatrixHandler */
 		do {
+			ElemProfile::Ticks t0 = 0;
+			if (pElemProf) {
+				t0 = ElemProfile::GetTicks();
+			}
+
 			pTmpEl->AssMats(WorkMatA, WorkMatB,
 					*pXCurr, *pXPrimeCurr);
 			A_Hdl += WorkMatA;
 			B_Hdl += WorkMatB;
+
+			if (pElemProf) {
+				pElemProf->Add(ElemProfile::MATS, pTmpEl,
+					ElemProfile::GetTicks() - t0);
+			}
 		} while (Iter.bGetNext(pTmpEl));
 	}
 }
@@ -515,6 +582,11 @@ DataManager::AssRes(VectorHandler& ResHdl, doublereal dCoef,
 	bool ChangedEqStructure(false);
 	if (Iter.bGetFirst(pTmpEl)) {
 		do {
+			ElemProfile::Ticks t0 = 0;
+			if (pElemProf) {
+				t0 = ElemProfile::GetTicks();
+			}
+
 			try {
 				ResHdl += pTmpEl->AssRes(WorkVec, dCoef,
 					*pXCurr, *pXPrimeCurr);
@@ -531,6 +603,11 @@ DataManager::AssRes(VectorHandler& ResHdl, doublereal dCoef,
 				throw ErrDivideByZero(MBDYN_EXCEPT_ARGS);
 			}
 
+			if (pElemProf) {
+				pElemProf->Add(ElemProfile::RES, pTmpEl,
+					ElemProfile::GetTicks() - t0);
+			}
+
 #if 0
 			silent_cerr("### " << psElemNames[pTmpEl->GetElemType()] << "(" << pTmpEl->GetLabel() <<"):" << std::endl);
 			PrintResidual(ResHdl, -1);
@@ -539,6 +616,7 @@ DataManager::AssRes(VectorHandler& ResHdl, doublereal dCoef,
 		} while (Iter.bGetNext(pTmpEl));
 	}
 	if (ChangedEqStructure) {
+		JacPatternChanged();
 		throw ChangedEquationStructure(MBDYN_EXCEPT_ARGS);
 	}
 }
@@ -250,6 +250,11 @@ public:
 
 	virtual void AfterPredict(VectorHandler& X, VectorHandler& XP);
 
+	/* the state of the peer cannot be checkpointed */
+	virtual bool bCheckpointable(void) const {
+		return false;
+	};
+
 	virtual void
 	InitialWorkSpaceDim(integer* piNumRows, integer* piNumCols) const;
    
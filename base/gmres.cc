@@ -60,8 +60,9 @@ Gmres::Gmres(const Preconditioner::PrecondType PType,
 		integer MaxIt,
 		doublereal etaMx,
 		doublereal T,
-		const NonlinearSolverOptions& options)
-: MatrixFreeSolver(PType, iPStep, ITol, MaxIt, etaMx, T, options),
+		const NonlinearSolverOptions& options,
+		const Preconditioner::Parameters& PParams)
+: MatrixFreeSolver(PType, iPStep, ITol, MaxIt, etaMx, T, options, PParams),
 v(NULL),
 s(MaxLinIt + 1), cs(MaxLinIt + 1), sn(MaxLinIt + 1)
 {
@@ -188,6 +189,7 @@ Gmres::Solve(const NonlinearProblem* pNLP,
 #endif /* USE_EXTERNAL */
 		pRes->Reset();
 		try {
+			SolverStats::Timer timer(pS->pGetSolverStats(), SolverStats::RESIDUAL);
 	      		pNLP->Residual(pRes);
 		}
 		catch (SolutionDataManager::ChangedEquationStructure) {
@@ -249,6 +251,9 @@ Gmres::Solve(const NonlinearProblem* pNLP,
 		Fnorm = dErr*dErr;
 		
       		iIterCnt++;
+		if (pS->pGetSolverStats()) {
+			pS->pGetSolverStats()->Inc(SolverStats::ITERATIONS);
+		}
 
 		/* inner iteration to solve the linear system */	
 	
@@ -291,6 +296,7 @@ rebuild_matrix:;
 			bBuildMat = false;
 			TotalIter = 0;
 			TotJac++;
+			PrecondReset(pS);
 			
 #ifdef DEBUG_ITERATIVE
 			std::cerr << "Jacobian " << std::endl;
@@ -459,6 +465,8 @@ rebuild_matrix:;
 		        silent_cerr("Iterative inner solver didn't converge."
 				<< " Continuing..." << std::endl);
 		}
+		integer iLinIters = (i < MaxLinIt) ? i + 1 : MaxLinIt;
+		PrecondStats(iLinIters);
 
 		/* se ha impiegato troppi passi riassembla lo jacobiano */
 		
@@ -492,6 +500,8 @@ rebuild_matrix:;
 			if (!bParallel || MBDynComm.Get_rank() == 0)
 #endif /* USE_MPI */
 			{
+				silent_cout("\t\tLinIters "
+					<< iLinIters << std::endl);
 				silent_cout("\t\tSolErr "
 					<< dSolErr << std::endl);
 			}
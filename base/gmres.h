@@ -57,7 +57,9 @@ public:
 			integer MaxIt,
 			doublereal etaMx,
 			doublereal T,
-			const NonlinearSolverOptions& options);
+			const NonlinearSolverOptions& options,
+			const Preconditioner::Parameters& PParams
+				= Preconditioner::Parameters());
 	
 	~Gmres(void);
 	
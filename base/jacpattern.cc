@@ -0,0 +1,284 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2014
+ *
+ * Pierangelo Masarati	<masarati@aero.polimi.it>
+ * Paolo Mantegazza	<mantegazza@aero.polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <algorithm>
+
+#include "jacpattern.h"
+
+/* offset of coefficients that are zero and not in the pattern */
+static const integer JACPATTERN_NONE = -1;
+
+/*
+ * offset of coefficient (i, j) in the array of the nonzeros;
+ * like the assembly by MatrixHandler::operator+=(), which skips
+ * zero coefficients, a zero coefficient need not be in the pattern
+ */
+static integer
+jacpattern_offset(CompactSparseMatrixHandler& MH, const doublereal *pd,
+	integer i, integer j, const doublereal& d)
+{
+	if (d != 0.) {
+		/* throws ErrRebuildMatrix if not in pattern */
+		return &MH(i, j) - pd;
+	}
+
+	try {
+		return &MH(i, j) - pd;
+	}
+	catch (MatrixHandler::ErrRebuildMatrix) {
+		return JACPATTERN_NONE;
+	}
+}
+
+JacPatternCache::JacPatternCache(const std::vector<Elem *>& Elems)
+: Patterns(Elems.size()), pMH(0), iNz(0), uGen(0)
+{
+	for (unsigned e = 0; e < Elems.size(); e++) {
+		Patterns[e].pEl = Elems[e];
+		Patterns[e].bValid = false;
+		Patterns[e].bFull = false;
+	}
+
+	std::sort(Patterns.begin(), Patterns.end());
+}
+
+JacPatternCache::~JacPatternCache(void)
+{
+	NO_OP;
+}
+
+JacPatternCache::ElemPattern *
+JacPatternCache::pFind(const Elem *pEl)
+{
+	ElemPattern ep;
+	ep.pEl = pEl;
+
+	std::vector<ElemPattern>::iterator i
+		= std::lower_bound(Patterns.begin(), Patterns.end(), ep);
+	if (i == Patterns.end() || i->pEl != pEl) {
+		return 0;
+	}
+
+	return &(*i);
+}
+
+void
+JacPatternCache::Invalidate(void)
+{
+	for (std::vector<ElemPattern>::iterator i = Patterns.begin();
+		i != Patterns.end(); ++i)
+	{
+		i->bValid = false;
+	}
+
+	pMH = 0;
+	iNz = 0;
+}
+
+CompactSparseMatrixHandler *
+JacPatternCache::pCheck(MatrixHandler& JacHdl, unsigned uPatternGen)
+{
+	CompactSparseMatrixHandler *pCC
+		= dynamic_cast<CompactSparseMatrixHandler *>(&JacHdl);
+	if (pCC == 0) {
+		return 0;
+	}
+
+	if (pCC != pMH || pCC->Nz() != iNz || uPatternGen != uGen) {
+		Invalidate();
+		pMH = pCC;
+		iNz = pCC->Nz();
+		uGen = uPatternGen;
+	}
+
+	return pCC;
+}
+
+bool
+JacPatternCache::bMatch(const ElemPattern& ep,
+	const VariableSubMatrixHandler& WorkMat) const
+{
+	if (!ep.bValid) {
+		return false;
+	}
+
+	if (WorkMat.bIsFull()) {
+		if (!ep.bFull) {
+			return false;
+		}
+
+		const FullSubMatrixHandler& WM = WorkMat.GetFull();
+		if (unsigned(WM.iGetNumRows()) != ep.Rows.size()
+			|| unsigned(WM.iGetNumCols()) != ep.Cols.size())
+		{
+			return false;
+		}
+
+		for (integer i = 1; i <= WM.iGetNumRows(); i++) {
+			if (WM.iGetRowIndex(i) != ep.Rows[i - 1]) {
+				return false;
+			}
+		}
+
+		for (integer j = 1; j <= WM.iGetNumCols(); j++) {
+			if (WM.iGetColIndex(j) != ep.Cols[j - 1]) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	if (WorkMat.bIsSparse()) {
+		if (ep.bFull) {
+			return false;
+		}
+
+		const SparseSubMatrixHandler& WM = WorkMat.GetSparse();
+		if (unsigned(WM.iGetNumRows()) != ep.Rows.size()) {
+			return false;
+		}
+
+		for (integer i = 1; i <= WM.iGetNumRows(); i++) {
+			if (WM.iGetRowIndex(i) != ep.Rows[i - 1]
+				|| WM.iGetColIndex(i) != ep.Cols[i - 1])
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/* null submatrix: nothing to add */
+	return ep.Rows.empty() && ep.Cols.empty();
+}
+
+void
+JacPatternCache::Record(ElemPattern& ep, CompactSparseMatrixHandler& MH,
+	const VariableSubMatrixHandler& WorkMat)
+{
+	ep.bValid = false;
+	ep.Rows.clear();
+	ep.Cols.clear();
+	ep.Offsets.clear();
+
+	const doublereal *pd = MH.pdGetMat();
+
+	if (WorkMat.bIsFull()) {
+		const FullSubMatrixHandler& WM = WorkMat.GetFull();
+		ep.bFull = true;
+
+		for (integer i = 1; i <= WM.iGetNumRows(); i++) {
+			ep.Rows.push_back(WM.iGetRowIndex(i));
+		}
+
+		for (integer j = 1; j <= WM.iGetNumCols(); j++) {
+			ep.Cols.push_back(WM.iGetColIndex(j));
+		}
+
+		/* column-major, as scattered by Add() */
+		for (unsigned j = 0; j < ep.Cols.size(); j++) {
+			for (unsigned i = 0; i < ep.Rows.size(); i++) {
+				ep.Offsets.push_back(jacpattern_offset(MH, pd,
+					ep.Rows[i], ep.Cols[j], WM(i + 1, j + 1)));
+			}
+		}
+
+	} else if (WorkMat.bIsSparse()) {
+		const SparseSubMatrixHandler& WM = WorkMat.GetSparse();
+		ep.bFull = false;
+
+		for (integer i = 1; i <= WM.iGetNumRows(); i++) {
+			ep.Rows.push_back(WM.iGetRowIndex(i));
+			ep.Cols.push_back(WM.iGetColIndex(i));
+			ep.Offsets.push_back(jacpattern_offset(MH, pd,
+				ep.Rows.back(), ep.Cols.back(), WM(i, 1)));
+		}
+
+	} else {
+		ep.bFull = false;
+	}
+
+	ep.bValid = true;
+}
+
+void
+JacPatternCache::Add(CompactSparseMatrixHandler& MH, const Elem *pEl,
+	const VariableSubMatrixHandler& WorkMat)
+{
+	ElemPattern *pEP = pFind(pEl);
+	if (pEP == 0) {
+		MH += WorkMat;
+		return;
+	}
+
+	if (!bMatch(*pEP, WorkMat)) {
+		Record(*pEP, MH, WorkMat);
+	}
+
+	doublereal *pd = MH.pdGetMat();
+	const integer *pi = pEP->Offsets.empty() ? 0 : &pEP->Offsets[0];
+
+	if (WorkMat.bIsFull()) {
+		const FullSubMatrixHandler& WM = WorkMat.GetFull();
+		integer nr = WM.iGetNumRows();
+		integer nc = WM.iGetNumCols();
+
+		for (integer j = 1; j <= nc; j++) {
+			for (integer i = 1; i <= nr; i++, pi++) {
+				if (*pi != JACPATTERN_NONE) {
+					pd[*pi] += WM(i, j);
+
+				} else if (WM(i, j) != 0.) {
+					/* not in pattern */
+					throw MatrixHandler::ErrRebuildMatrix(MBDYN_EXCEPT_ARGS);
+				}
+			}
+		}
+
+	} else if (WorkMat.bIsSparse()) {
+		const SparseSubMatrixHandler& WM = WorkMat.GetSparse();
+		integer n = WM.iGetNumRows();
+
+		for (integer i = 1; i <= n; i++, pi++) {
+			if (*pi != JACPATTERN_NONE) {
+				pd[*pi] += WM(i, 1);
+
+			} else if (WM(i, 1) != 0.) {
+				/* not in pattern */
+				throw MatrixHandler::ErrRebuildMatrix(MBDYN_EXCEPT_ARGS);
+			}
+		}
+	}
+}
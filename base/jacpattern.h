@@ -0,0 +1,111 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2014
+ *
+ * Pierangelo Masarati	<masarati@aero.polimi.it>
+ * Paolo Mantegazza	<mantegazza@aero.polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* cache of the positions of the element contributions
+ * in compact sparse Jacobian matrices */
+
+#ifndef JACPATTERN_H
+#define JACPATTERN_H
+
+#include <vector>
+
+#include "elem.h"
+#include "spmh.h"
+
+/*
+ * For each element, records the indices of the last submatrix
+ * it contributed, and the offsets of its coefficients in the array
+ * of the nonzeros of a compact sparse matrix.  As long as the element
+ * contributes a submatrix with the same indices, it is scattered
+ * by offset, without looking up the coefficients in the matrix.
+ *
+ * The offsets are valid for any matrix with the same pattern
+ * (e.g. the per-thread copies of the multithreaded assembly).
+ * Each element is assembled by one thread at a time, so Add()
+ * can be called concurrently for different elements; Check()
+ * and Invalidate() must be called by one thread, outside the assembly.
+ */
+class JacPatternCache {
+protected:
+	struct ElemPattern {
+		const Elem *pEl;
+		bool bValid;
+		bool bFull;
+
+		/* full: row and column indices;
+		 * sparse: row and column index of each coefficient */
+		std::vector<integer> Rows;
+		std::vector<integer> Cols;
+
+		std::vector<integer> Offsets;
+
+		bool operator < (const ElemPattern& ep) const {
+			return pEl < ep.pEl;
+		};
+	};
+
+	/* sorted by element address */
+	std::vector<ElemPattern> Patterns;
+
+	/* pattern the offsets refer to */
+	const CompactSparseMatrixHandler *pMH;
+	integer iNz;
+	unsigned uGen;
+
+	ElemPattern *pFind(const Elem *pEl);
+	bool bMatch(const ElemPattern& ep,
+		const VariableSubMatrixHandler& WorkMat) const;
+	void Record(ElemPattern& ep, CompactSparseMatrixHandler& MH,
+		const VariableSubMatrixHandler& WorkMat);
+
+public:
+	JacPatternCache(const std::vector<Elem *>& Elems);
+	virtual ~JacPatternCache(void);
+
+	/* forgets all offsets */
+	void Invalidate(void);
+
+	/* returns the compact matrix, if JacHdl is one, after forgetting
+	 * the offsets if the matrix is not the one they refer to,
+	 * or if the pattern generation of the DataManager (see
+	 * DataManager::GetJacPatternGeneration()) changed */
+	CompactSparseMatrixHandler *pCheck(MatrixHandler& JacHdl,
+		unsigned uPatternGen);
+
+	/* adds the contribution of an element to a compact matrix
+	 * with the cached pattern; may throw ErrRebuildMatrix
+	 * if a nonzero coefficient is not in the pattern
+	 * (zero coefficients need not be) */
+	void Add(CompactSparseMatrixHandler& MH, const Elem *pEl,
+		const VariableSubMatrixHandler& WorkMat);
+};
+
+#endif /* JACPATTERN_H */
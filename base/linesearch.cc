@@ -146,6 +146,7 @@ LineSearchSolver::Residual(doublereal& f, integer iIterCnt)
 	pRes->Reset();
 
 	try {
+		SolverStats::Timer timer(pS->pGetSolverStats(), SolverStats::RESIDUAL);
     	pNLP->Residual(pRes);
 	}
 	catch (const SolutionDataManager::ChangedEquationStructure&) {
@@ -163,6 +164,7 @@ void
 LineSearchSolver::Jacobian()
 {
 	SolutionManager *const pSM = pS->pGetSolutionManager();
+	SolverStats::Timer timer(pS->pGetSolverStats(), SolverStats::JACOBIAN);
 
 	const integer iMaxIterRebuild = 10;
 
@@ -378,6 +380,10 @@ LineSearchSolver::LineSearch(doublereal stpmax, doublereal fold,
 			} else {
 				lambda *= dLambdaFactMin;
 			}
+
+			if (pS->pGetSolverStats()) {
+				pS->pGetSolverStats()->Inc(SolverStats::BACKTRACKS);
+			}
 		}
 
 		if (mbdyn_stop_at_end_of_iteration()) {
@@ -469,7 +475,10 @@ LineSearchSolver::Solve(const NonlinearProblem *pNonLinProblem,
 		g.Reset();
 		pSM->pMatHdl()->MatTVecDecMul(g, *pRes); // compute gradient g = \nabla f = fjac^T \, fvec = -Jac^T \, pRes
 		const doublereal fold = f;
-		pSM->Solve();
+		{
+			SolverStats::Timer timer(pS->pGetSolverStats(), SolverStats::SOLVE);
+			pSM->Solve();
+		}
 
    		if (outputSol()) {
 			pS->PrintSolution(*pSol, iIterCnt);
@@ -483,6 +492,9 @@ LineSearchSolver::Solve(const NonlinearProblem *pNonLinProblem,
 		}
 
 		iIterCnt++;
+		if (pS->pGetSolverStats()) {
+			pS->pGetSolverStats()->Inc(SolverStats::ITERATIONS);
+		}
 
 #ifdef USE_MPI
 		if (!bParallel || MBDynComm.Get_rank() == 0)
@@ -297,6 +297,11 @@ public:
    	virtual void AfterConvergence(const VectorHandler& X,
 			const VectorHandler& XP);   
 
+	/* the module interface has no checkpoint calls */
+	virtual bool bCheckpointable(void) const {
+		return false;
+	};
+
    	virtual unsigned int iGetInitialNumDof(void) const;
    	virtual void 
 	InitialWorkSpaceDim(integer* piNumRows, integer* piNumCols) const;
@@ -626,6 +626,53 @@ MBDynParser::C81Data_int(void)
 			"warning, CM mach[0]=" << data->mm[0] << " > 0" << std::endl);
 	}
 
+	if (IsKeyWord("uniform" "grid")) {
+		doublereal da = 0.25;
+		if (IsKeyWord("alpha" "step")) {
+			da = GetReal();
+			if (da <= 0. || da > 10.) {
+				silent_cerr("C81Data(" << uLabel << "): "
+					"invalid alpha step " << da << " "
+					"at line " << GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+
+		doublereal dm = 0.01;
+		if (IsKeyWord("mach" "step")) {
+			dm = GetReal();
+			if (dm <= 0.) {
+				silent_cerr("C81Data(" << uLabel << "): "
+					"invalid Mach step " << dm << " "
+					"at line " << GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+
+		if (c81_data_grid_build(data, da, dm) != 0) {
+			silent_cerr("C81Data(" << uLabel << "): "
+				"unable to build uniform grid "
+				"at line " << GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+
+		doublereal err[C81_GRID_NERR];
+		c81_data_grid_check(data, err);
+		silent_cout("C81Data(" << uLabel << "): "
+			"uniform grid " << data->grid->NA << "x" << data->grid->NM
+			<< " (alpha step " << data->grid->da
+			<< " deg, Mach step " << data->grid->dm << "); "
+			"max error"
+			" cl=" << err[C81_GRID_CL]
+			<< " cd=" << err[C81_GRID_CD]
+			<< " cm=" << err[C81_GRID_CM]
+			<< " cl0=" << err[C81_GRID_NC + C81_GRID_CL0]
+			<< " cd0=" << err[C81_GRID_NC + C81_GRID_CD0]
+			<< " dcl/da=" << err[C81_GRID_NC + C81_GRID_DCLA]
+			<< " dcm/da=" << err[C81_GRID_NC + C81_GRID_DCMA]
+			<< std::endl);
+	}
+
 	if (IsKeyWord("echo")) {
 		const char *sOutName = GetFileName();
 		if (sOutName == NULL) {
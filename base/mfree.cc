@@ -41,6 +41,7 @@
 
 #include "precond_.h"
 #include "mfree.h"
+#include "solver.h"
 
 const doublereal defaultGamma = 0.9;
 
@@ -51,7 +52,8 @@ MatrixFreeSolver::MatrixFreeSolver(
 		integer MaxIt,
 		doublereal etaMx,
 		doublereal T,
-		const NonlinearSolverOptions& options)
+		const NonlinearSolverOptions& options,
+		const Preconditioner::Parameters& PParams)
 : NonlinearSolver(options),
 pPM(NULL),
 pRes(NULL),
@@ -62,13 +64,28 @@ gamma(defaultGamma),
 etaMax(etaMx),
 PrecondIter(iPStep),
 bBuildMat(true),
-pPrevNLP(NULL)
+pPrevNLP(NULL),
+iPrecNewtonIters(0),
+iPrecLinIters(0)
 {
 	
 	switch(PType) {
 	case Preconditioner::FULLJACOBIANMATRIX:
 		SAFENEW(pPM, FullJacobianPr);
 		break;
+
+	case Preconditioner::ILU:
+		SAFENEWWITHCONSTRUCTOR(pPM, ILUPr, ILUPr(PParams.iFill));
+		break;
+
+	case Preconditioner::ILUT:
+		SAFENEWWITHCONSTRUCTOR(pPM, ILUTPr,
+			ILUTPr(PParams.dDropTol, PParams.iFill));
+		break;
+
+	case Preconditioner::BLOCKJACOBI:
+		SAFENEW(pPM, BlockJacobiPr);
+		break;
 	
 	default:
 		silent_cerr("Unknown Preconditioner type; aborting"
@@ -79,6 +96,27 @@ pPrevNLP(NULL)
 
 MatrixFreeSolver::~MatrixFreeSolver(void)
 {
-	NO_OP;
+	if (pPM != 0) {
+		SAFEDELETE(pPM);
+	}
+}
+
+void
+MatrixFreeSolver::PrecondReset(Solver *pS)
+{
+	const DataManager *pDM = pS->pGetDataManager();
+
+	if (iPrecNewtonIters > 0) {
+		pDM->GetLogFile() << "preconditioner used for "
+			<< iPrecNewtonIters << " nonlinear iterations, "
+			<< iPrecLinIters << " linear iterations ("
+			<< doublereal(iPrecLinIters)/iPrecNewtonIters
+			<< " per nonlinear iteration)" << std::endl;
+	}
+
+	iPrecNewtonIters = 0;
+	iPrecLinIters = 0;
+
+	pPM->MatrReset(pDM);
 }
 
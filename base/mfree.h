@@ -68,6 +68,18 @@ protected:
 	integer PrecondIter; 
 	bool bBuildMat;
 	const NonlinearProblem* pPrevNLP;
+
+	/* linear iterations since the last preconditioner update */
+	integer iPrecNewtonIters;
+	integer iPrecLinIters;
+
+	/* logs the statistics of the current preconditioner
+	 * and resets it after the Jacobian has been reassembled */
+	void PrecondReset(Solver *pS);
+	void PrecondStats(integer iLinIters) {
+		iPrecNewtonIters++;
+		iPrecLinIters += iLinIters;
+	};
 	
 public:
 	MatrixFreeSolver(const Preconditioner::PrecondType PType, 
@@ -76,7 +88,9 @@ public:
 			integer MaxIt,
 			doublereal etaMx,
 			doublereal T,
-			const NonlinearSolverOptions& options);
+			const NonlinearSolverOptions& options,
+			const Preconditioner::Parameters& PParams
+				= Preconditioner::Parameters());
 
 	~MatrixFreeSolver(void);
 };
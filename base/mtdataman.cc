@@ -53,15 +53,35 @@ extern "C" {
 }
 
 #include <cerrno>
+#include <cstdlib>
+#include <algorithm>
 
 #include "mtdataman.h"
 #include "spmapmh.h"
+#include "fullmh.h"
 #include "task2cpu.h"
+#include "indvel.h"
+
+/* hint to the CPU that the caller is spinning, so that it does not
+ * starve the other hardware thread of the core and saves power */
+static inline void
+mt_cpu_relax(void)
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	__builtin_ia32_pause();
+#elif defined(__GNUC__) && (defined(__aarch64__) || defined(__arm__))
+	__asm__ __volatile__ ("yield" ::: "memory");
+#elif defined(HAVE_SCHED_H)
+	sched_yield();
+#endif
+}
 
 static inline void
 do_lock(volatile AO_TS_t *p)
 {
-	while (mbdyn_test_and_set(p) == AO_TS_SET);
+	while (mbdyn_test_and_set(p) == AO_TS_SET) {
+		mt_cpu_relax();
+	}
 }
 	
 static inline void
@@ -70,6 +90,125 @@ do_unlock(AO_TS_t *p)
 	AO_CLEAR(p);
 }
 
+/* wall-clock time, for per-thread busy/idle statistics */
+static inline doublereal
+mt_wall_time(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return doublereal(ts.tv_sec) + 1e-9*doublereal(ts.tv_nsec);
+}
+
+/* ThreadData of the calling thread, see GetChunkSlot() */
+static pthread_key_t mt_thread_key;
+static pthread_once_t mt_thread_key_once = PTHREAD_ONCE_INIT;
+static unsigned mt_num_chunk_slots = 1;
+
+static void
+mt_thread_key_create(void)
+{
+	(void)pthread_key_create(&mt_thread_key, NULL);
+}
+
+/* number of polls of the op counter before parking on the condition;
+ * with mt_cpu_relax() between polls, this is from some
+ * to a hundred microseconds, depending on the CPU */
+static const unsigned MT_SPIN_COUNT = 2000;
+
+/* number of chunks the elements are split into;
+ * it must not depend on the number of threads */
+static const unsigned MT_NUM_CHUNKS = 512;
+
+/* number of blocks of rows per thread for the residual reduction */
+static const unsigned MT_ROW_BLOCKS_PER_THREAD = 4;
+
+/* from this number of threads on, the per-thread Jacobian matrices
+ * are summed by a tree reduction when the sum mode is "auto" */
+static const unsigned MT_TREE_SUM_THREADS = 8;
+
+/* number of nodes or elements claimed at once in the per-step phases */
+static const unsigned MT_PHASE_BLOCK = 16;
+
+/* max number of colors for colored Jacobian assembly
+ * (one bit of an unsigned per color) */
+static const unsigned MT_MAX_COLORS = 32;
+
+/* colors with less elements than this are assembled by the main thread */
+static const unsigned MT_MIN_COLOR_SIZE = 16;
+
+/* number of elements of a color claimed at once by a thread */
+static const unsigned MT_COLOR_BLOCK = 4;
+
+/* adds the rows written by a Jacobian submatrix */
+static void
+GetSubMatrixRows(VariableSubMatrixHandler& WorkMat, std::vector<integer>& Rows)
+{
+	if (WorkMat.bIsFull()) {
+		FullSubMatrixHandler& WM = WorkMat.GetFull();
+		for (integer i = 1; i <= WM.iGetNumRows(); i++) {
+			Rows.push_back(WM.iGetRowIndex(i));
+		}
+
+	} else if (WorkMat.bIsSparse()) {
+		SparseSubMatrixHandler& WM = WorkMat.GetSparse();
+		for (integer i = 1; i <= WM.iGetNumRows(); i++) {
+			Rows.push_back(WM.iGetRowIndex(i));
+		}
+	}
+}
+
+/* adds the rows of the degrees of freedom of an element
+ * and of its connected nodes */
+static void
+GetElemDofRows(const Elem *pEl, std::vector<integer>& Rows)
+{
+	std::vector<const Node *> ConnectedNodes;
+	pEl->GetConnectedNodes(ConnectedNodes);
+	for (std::vector<const Node *>::const_iterator n = ConnectedNodes.begin();
+		n != ConnectedNodes.end(); ++n)
+	{
+		integer iFirstIndex = (*n)->iGetFirstRowIndex();
+		integer iNumDof = (*n)->iGetNumDof();
+		for (integer i = 1; i <= iNumDof; i++) {
+			Rows.push_back(iFirstIndex + i);
+		}
+	}
+
+	const ElemWithDofs *pEWD = dynamic_cast<const ElemWithDofs *>(pEl);
+	if (pEWD != 0) {
+		integer iFirstIndex = pEWD->iGetFirstIndex();
+		integer iNumDof = pEl->iGetNumDof();
+		for (integer i = 1; i <= iNumDof; i++) {
+			Rows.push_back(iFirstIndex + i);
+		}
+	}
+}
+
+/* true if a Jacobian submatrix only writes the given (sorted) rows */
+static bool
+bSubMatrixRowsIn(VariableSubMatrixHandler& WorkMat,
+	const std::vector<integer>& Rows)
+{
+	if (WorkMat.bIsFull()) {
+		FullSubMatrixHandler& WM = WorkMat.GetFull();
+		for (integer i = 1; i <= WM.iGetNumRows(); i++) {
+			if (!std::binary_search(Rows.begin(), Rows.end(), WM.iGetRowIndex(i))) {
+				return false;
+			}
+		}
+
+	} else if (WorkMat.bIsSparse()) {
+		SparseSubMatrixHandler& WM = WorkMat.GetSparse();
+		for (integer i = 1; i <= WM.iGetNumRows(); i++) {
+			if (!std::binary_search(Rows.begin(), Rows.end(), WM.iGetRowIndex(i))) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
 static void
 naivepsad(doublereal **ga, integer **gri, 
 		integer *gnzr, integer **gci, integer *gnzc, char **gnz,
@@ -114,6 +253,189 @@ naivepsad(doublereal **ga, integer **gri,
 
 /* MultiThreadDataManager - begin */
 
+MultiThreadDataManager::ElemChunkSched::ElemChunkSched(void)
+: ppElems(0),
+pQueues(0),
+nQueues(0)
+{
+	NO_OP;
+}
+
+MultiThreadDataManager::ElemChunkSched::~ElemChunkSched(void)
+{
+	if (pQueues) {
+		SAFEDELETEARR(pQueues);
+	}
+}
+
+void
+MultiThreadDataManager::ElemChunkSched::Init(Elem **pp,
+	const std::vector<doublereal>& Cost,
+	const std::vector<unsigned>& Breaks,
+	unsigned nThreads, unsigned nChunks)
+{
+	ASSERT(nThreads > 0);
+	ASSERT(nChunks > 0);
+
+	ppElems = pp;
+
+	doublereal dTotCost = 0.;
+	for (unsigned e = 0; e < Cost.size(); e++) {
+		dTotCost += Cost[e];
+	}
+
+	/* split elements in chunks of about the same cost;
+	 * a chunk also starts at each (increasing) break */
+	doublereal dChunkCost = dTotCost/nChunks;
+
+	ChunkOffset.clear();
+	ChunkOffset.push_back(0);
+	doublereal dCurrCost = 0.;
+	std::vector<unsigned>::const_iterator b = Breaks.begin();
+	for (unsigned e = 0; e < Cost.size(); e++) {
+		if (b != Breaks.end() && *b == e) {
+			if (ChunkOffset.back() != e) {
+				ChunkOffset.push_back(e);
+				dCurrCost = 0.;
+			}
+			++b;
+		}
+
+		dCurrCost += Cost[e];
+		if (dCurrCost >= dChunkCost) {
+			ChunkOffset.push_back(e + 1);
+			dCurrCost = 0.;
+		}
+	}
+	if (ChunkOffset.back() != Cost.size()) {
+		ChunkOffset.push_back(Cost.size());
+	}
+
+	/* assign each thread a contiguous range of chunks
+	 * of about the same cost */
+	if (pQueues) {
+		SAFEDELETEARR(pQueues);
+	}
+	nQueues = nThreads;
+	SAFENEWARRNOFILL(pQueues, Queue, nQueues);
+
+	unsigned c = 0;
+	doublereal dThreadCost = dTotCost/nThreads;
+	for (unsigned t = 0; t < nQueues; t++) {
+		pQueues[t].lock = AO_TS_INITIALIZER;
+		pQueues[t].iFirst = c;
+
+		if (t == nQueues - 1) {
+			c = iGetNumChunks();
+
+		} else {
+			dCurrCost = 0.;
+			while (c < iGetNumChunks() && dCurrCost < dThreadCost) {
+				for (unsigned e = ChunkOffset[c]; e < ChunkOffset[c + 1]; e++) {
+					dCurrCost += Cost[e];
+				}
+				c++;
+			}
+		}
+
+		pQueues[t].iLast = c;
+	}
+
+	Reset();
+}
+
+void
+MultiThreadDataManager::ElemChunkSched::Reset(void)
+{
+	for (unsigned t = 0; t < nQueues; t++) {
+		pQueues[t].iNext = pQueues[t].iFirst;
+		pQueues[t].iEnd = pQueues[t].iLast;
+	}
+}
+
+bool
+MultiThreadDataManager::ElemChunkSched::bClaim(unsigned iThread,
+	unsigned& iChunk)
+{
+	ASSERT(iThread < nQueues);
+
+	/* own range, from the head */
+	Queue& q = pQueues[iThread];
+	do_lock(&q.lock);
+	if (q.iNext < q.iEnd) {
+		iChunk = q.iNext++;
+		do_unlock(&q.lock);
+		return true;
+	}
+	do_unlock(&q.lock);
+
+	/* steal from the tail of the other ranges */
+	for (unsigned i = 1; i < nQueues; i++) {
+		Queue& v = pQueues[(iThread + i) % nQueues];
+		do_lock(&v.lock);
+		if (v.iNext < v.iEnd) {
+			iChunk = --v.iEnd;
+			do_unlock(&v.lock);
+			return true;
+		}
+		do_unlock(&v.lock);
+	}
+
+	return false;
+}
+
+MultiThreadDataManager::ElemChunkIter::ElemChunkIter(void)
+: pSched(0),
+iThread(0),
+ppCurr(0),
+ppEnd(0)
+{
+	NO_OP;
+}
+
+MultiThreadDataManager::ElemChunkIter::~ElemChunkIter(void)
+{
+	NO_OP;
+}
+
+void
+MultiThreadDataManager::ElemChunkIter::Init(ElemChunkSched *p, unsigned i)
+{
+	pSched = p;
+	iThread = i;
+	ppCurr = 0;
+	ppEnd = 0;
+}
+
+bool
+MultiThreadDataManager::ElemChunkIter::bGetFirst(Elem *& pE) const
+{
+	ppCurr = 0;
+	ppEnd = 0;
+
+	return bGetNext(pE);
+}
+
+bool
+MultiThreadDataManager::ElemChunkIter::bGetNext(Elem *& pE) const
+{
+	ASSERT(pSched != 0);
+
+	/* skip empty chunks */
+	while (ppCurr == ppEnd) {
+		unsigned iChunk;
+		if (!pSched->bClaim(iThread, iChunk)) {
+			pE = 0;
+			return false;
+		}
+		ppCurr = pSched->ppGetFirst(iChunk);
+		ppEnd = pSched->ppGetEnd(iChunk);
+	}
+
+	pE = *ppCurr++;
+	return true;
+}
+
 
 /*
  * costruttore: inizializza l'oggetto, legge i dati e crea le strutture di
@@ -134,8 +456,36 @@ AssMode(ASS_UNKNOWN),
 CCReady(CC_NO),
 thread_data(0),
 op(MultiThreadDataManager::OP_UNKNOWN),
+nResLogSlots(0),
+nRowBlocks(0),
+iRowBlockSize(0),
+res_block(0),
+pCurrColor(0),
+pColorJacHdl(0),
+pColorCCJacHdl(0),
+color_next(0),
+nMatLogMats(0),
+mat_block(0),
+CurrPhaseStage(PHASE_NODES),
+phase_next(0),
+iPhaseEnd(0),
+pPhaseX(0),
+pPhaseXP(0),
+pPhaseXPrev(0),
+pPhaseXPPrev(0),
+pTaskFunc(0),
+pTaskData(0),
+nTaskEnd(0),
+task_next(0),
+iCCSumNz(0),
+uCCSumDist(0),
 thread_count(0),
-propagate_ErrMatrixRebuild(AO_TS_INITIALIZER)
+op_gen(0),
+dOpStartTime(0.),
+propagate_ErrMatrixRebuild(AO_TS_INITIALIZER),
+propagate_ChangedEquationStructure(AO_TS_INITIALIZER),
+propagate_ErrDivideByZero(AO_TS_INITIALIZER),
+propagate_ErrGeneric(AO_TS_INITIALIZER)
 {
 	DataManager::nThreads = nThreads;
 
@@ -182,6 +532,18 @@ propagate_ErrMatrixRebuild(AO_TS_INITIALIZER)
 		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
 	}
 
+	if (pthread_mutex_init(&op_mutex, NULL)) {
+		silent_cerr("MultiThreadDataManager::MultiThreadDataManager(): "
+				"mutex init failed" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	if (pthread_cond_init(&op_cond, NULL)) {
+		silent_cerr("MultiThreadDataManager::MultiThreadDataManager(): "
+				"cond init failed" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
 	ThreadSpawn();
 }
 
@@ -189,6 +551,8 @@ MultiThreadDataManager::~MultiThreadDataManager(void)
 {
 	pthread_mutex_destroy(&thread_mutex);
 	pthread_cond_destroy(&thread_cond);
+	pthread_mutex_destroy(&op_mutex);
+	pthread_cond_destroy(&op_cond);
 }
 
 clock_t
@@ -200,13 +564,11 @@ MultiThreadDataManager::ThreadDestroy(void)
 
 	clock_t cputime = 0;
 
-	op = MultiThreadDataManager::OP_EXIT;
-	thread_count = nThreads - 1;
+	StartOp(MultiThreadDataManager::OP_EXIT);
 
 	for (unsigned i = 1; i < nThreads; i++) {
 		void *retval = NULL;
 
-		sem_post(&thread_data[i].sem);
 		if (pthread_join(thread_data[i].thread, &retval)) {
 			silent_cerr("pthread_join() failed on thread " << i
 					<< std::endl);
@@ -215,6 +577,19 @@ MultiThreadDataManager::ThreadDestroy(void)
 
 		cputime += thread_data[i].cputime;
 	}
+	mt_num_chunk_slots = 1;
+	(void)pthread_setspecific(mt_thread_key, NULL);
+
+	/* thread 0 is the main thread */
+	for (unsigned i = 0; i < nThreads; i++) {
+		doublereal dTot = thread_data[i].dBusyTime + thread_data[i].dIdleTime;
+		silent_cout("MultiThreadDataManager: thread " << i
+			<< " busy " << thread_data[i].dBusyTime << " s,"
+			<< " idle " << thread_data[i].dIdleTime << " s"
+			<< " (" << (dTot > 0. ? 100.*thread_data[i].dBusyTime/dTot : 0.) << "% busy,"
+			<< " " << thread_data[i].uNumOps << " ops)"
+			<< std::endl);
+	}
 
 	if (thread_data[0].lock) {
 		SAFEDELETEARR(thread_data[0].lock);
@@ -251,6 +626,9 @@ MultiThreadDataManager::thread(void *p)
 
 	(void)mbdyn_task2cpu(arg->threadNumber - 1);
 
+	(void)pthread_setspecific(mt_thread_key, arg);
+
+	doublereal dT0 = mt_wall_time();
 	while (bKeepGoing) {
 		/* stop here until told to start */
 		/*
@@ -259,7 +637,10 @@ MultiThreadDataManager::thread(void *p)
 		 * - the appropriate operation args must be set
 		 * - the thread_count must be set to nThreads - 1
 		 */
-		sem_wait(&arg->sem);
+		arg->pDM->WaitForOp(arg);
+
+		doublereal dT1 = mt_wall_time();
+		arg->dIdleTime += dT1 - dT0;
 
 		DEBUGCOUT("thread " << arg->threadNumber << ": "
 				"op " << arg->pDM->op << std::endl);
@@ -282,10 +663,18 @@ MultiThreadDataManager::thread(void *p)
 				mbdyn_test_and_set(&arg->pDM->propagate_ErrMatrixRebuild);
 
 			} catch (...) {
-				throw;
+				arg->pDM->CaughtException(0);
 			}
 			break;
 
+		case MultiThreadDataManager::OP_SUM_CC:
+			arg->pDM->CCSumPart(arg);
+			break;
+
+		case MultiThreadDataManager::OP_ASSJAC_COLOR:
+			arg->pDM->ColorAssJacPart(arg);
+			break;
+
 		case MultiThreadDataManager::OP_ASSJAC_NAIVE:
 #if 0
 			arg->ppNaiveJacHdl[arg->threadNumber]->Reset();
@@ -319,15 +708,52 @@ MultiThreadDataManager::thread(void *p)
 			break;
 		}
 
-#ifdef MBDYN_X_MT_ASSRES
 		case MultiThreadDataManager::OP_ASSRES:
-			arg->pResHdl->Reset();
-			arg->pDM->DataManager::AssRes(*arg->pResHdl,
-					arg->dCoef,
-					arg->ElemIter,
-					*arg->pWorkVec);
+		{
+			unsigned iChunk;
+			while (arg->pDM->ElemSched.bClaim(arg->threadNumber, iChunk)) {
+				arg->uChunkSlot = iChunk + 1;
+				arg->pDM->ResLogAssRes(arg->pDM->ChunkSlot[iChunk],
+					arg->pDM->ElemSched.ppGetFirst(iChunk),
+					arg->pDM->ElemSched.ppGetEnd(iChunk),
+					*arg->pWorkVec, arg->dCoef);
+			}
+			arg->uChunkSlot = 0;
+			break;
+		}
+
+		case MultiThreadDataManager::OP_SUM_RES:
+			arg->pDM->ResLogSum(*arg->pResHdl);
+			break;
+
+		case MultiThreadDataManager::OP_ASSJAC_LOG:
+		case MultiThreadDataManager::OP_ASSMATS:
+		{
+			unsigned iChunk;
+			while (arg->pDM->ElemSched.bClaim(arg->threadNumber, iChunk)) {
+				arg->pDM->MatLogAss(arg->pDM->ChunkSlot[iChunk],
+					arg->pDM->ElemSched.ppGetFirst(iChunk),
+					arg->pDM->ElemSched.ppGetEnd(iChunk),
+					*arg->pWorkMatA, *arg->pWorkMatB,
+					arg->dCoef);
+			}
+			break;
+		}
+
+		case MultiThreadDataManager::OP_SUM_MATS:
+			arg->pDM->MatLogSum();
+			break;
+
+		case MultiThreadDataManager::OP_BEFOREPREDICT:
+		case MultiThreadDataManager::OP_AFTERPREDICT:
+		case MultiThreadDataManager::OP_UPDATE:
+		case MultiThreadDataManager::OP_AFTERCONVERGENCE:
+			arg->pDM->PhasePart(arg->pDM->op);
+			break;
+
+		case MultiThreadDataManager::OP_TASKS:
+			arg->pDM->TaskPart();
 			break;
-#endif /* MBDYN_X_MT_ASSRES */
 
 		case MultiThreadDataManager::OP_EXIT:
 			/* cleanup */
@@ -341,6 +767,10 @@ MultiThreadDataManager::thread(void *p)
 			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
 		}
 
+		dT0 = mt_wall_time();
+		arg->dBusyTime += dT0 - dT1;
+		arg->uNumOps++;
+
 		/* decrease counter and signal if last
 		 * (mutex + cond) */
 		arg->pDM->EndOfOp();
@@ -361,7 +791,6 @@ MultiThreadDataManager::thread_cleanup(ThreadData *arg)
 		if (arg->pJacHdl) {
 			SAFEDELETE(arg->pJacHdl);
 		}
-		SAFEDELETE(arg->pResHdl);
 
 	} else {
 		if (arg->ppNaiveJacHdl) {
@@ -369,8 +798,6 @@ MultiThreadDataManager::thread_cleanup(ThreadData *arg)
 			SAFEDELETEARR(arg->ppNaiveJacHdl);
 		}
 	}
-	sem_destroy(&arg->sem);
-
 #ifdef HAVE_SYS_TIMES_H	
 	/* Tempo di CPU impiegato */
 	struct tms tmsbuf;
@@ -388,22 +815,147 @@ MultiThreadDataManager::thread_cleanup(ThreadData *arg)
 }
 
 void
-MultiThreadDataManager::EndOfOp(void)
+MultiThreadDataManager::StartOp(DataManagerOp o) const
 {
-	bool last;
-	
-	/* decrement the thread counter */
-	pthread_mutex_lock(&thread_mutex);
-	thread_count--;
-	last = (thread_count == 0);
+	dOpStartTime = mt_wall_time();
+
+	op = o;
+	AO_store_release(&thread_count, nThreads - 1);
+
+	/* the counter wakes up the spinning threads,
+	 * the broadcast those already parked */
+	pthread_mutex_lock(&op_mutex);
+	AO_store_release(&op_gen, AO_load(&op_gen) + 1);
+	pthread_cond_broadcast(&op_cond);
+	pthread_mutex_unlock(&op_mutex);
+}
+
+void
+MultiThreadDataManager::WaitForOp(ThreadData *arg)
+{
+	for (unsigned i = 0; i < MT_SPIN_COUNT; i++) {
+		AO_t gen = AO_load_acquire(&op_gen);
+		if (gen != arg->op_gen) {
+			arg->op_gen = gen;
+			return;
+		}
+		mt_cpu_relax();
+	}
+
+	pthread_mutex_lock(&op_mutex);
+	while (AO_load_acquire(&op_gen) == arg->op_gen) {
+		pthread_cond_wait(&op_cond, &op_mutex);
+	}
+	arg->op_gen = AO_load_acquire(&op_gen);
+	pthread_mutex_unlock(&op_mutex);
+}
 
-	/* if last thread, signal to restart */
-	if (last) {
+void
+MultiThreadDataManager::EndOfOp(void)
+{
+	/* decrement the thread counter;
+	 * if last thread, signal to restart */
+	if (AO_fetch_and_sub1_full(&thread_count) == 1) {
+		pthread_mutex_lock(&thread_mutex);
 		pthread_cond_signal(&thread_cond);
-		// pthread_cond_broadcast(&thread_cond);
+		pthread_mutex_unlock(&thread_mutex);
+	}
+}
+
+void
+MultiThreadDataManager::WaitForThreads(void) const
+{
+	doublereal dT = mt_wall_time();
+	thread_data[0].dBusyTime += dT - dOpStartTime;
+	thread_data[0].uNumOps++;
+
+	for (unsigned i = 0; i < MT_SPIN_COUNT; i++) {
+		if (AO_load_acquire(&thread_count) == 0) {
+			thread_data[0].dIdleTime += mt_wall_time() - dT;
+			return;
+		}
+		mt_cpu_relax();
 	}
 
+	pthread_mutex_lock(&thread_mutex);
+	while (AO_load_acquire(&thread_count) > 0) {
+		pthread_cond_wait(&thread_cond, &thread_mutex);
+	}
 	pthread_mutex_unlock(&thread_mutex);
+
+	thread_data[0].dIdleTime += mt_wall_time() - dT;
+}
+
+void
+MultiThreadDataManager::ClearExceptions(void) const
+{
+#ifdef MBDYN_MT_EXCEPTION_PTR
+	for (unsigned i = 0; i < nThreads; i++) {
+		thread_data[i].pException = std::exception_ptr();
+	}
+#endif /* MBDYN_MT_EXCEPTION_PTR */
+
+	AO_CLEAR(&propagate_ErrDivideByZero);
+	AO_CLEAR(&propagate_ErrGeneric);
+}
+
+/* must be called within a catch block */
+void
+MultiThreadDataManager::CaughtException(unsigned uKey) const
+{
+#ifdef MBDYN_MT_EXCEPTION_PTR
+	ThreadData *arg = (ThreadData *)pthread_getspecific(mt_thread_key);
+	if (arg == 0) {
+		arg = &thread_data[0];
+	}
+
+	if (!arg->pException || uKey < arg->uExceptionKey) {
+		arg->pException = std::current_exception();
+		arg->uExceptionKey = uKey;
+	}
+#else /* ! MBDYN_MT_EXCEPTION_PTR */
+	(void)uKey;
+
+	try {
+		throw;
+	}
+	catch (ErrDivideByZero) {
+		mbdyn_test_and_set(&propagate_ErrDivideByZero);
+	}
+	catch (...) {
+		mbdyn_test_and_set(&propagate_ErrGeneric);
+	}
+#endif /* ! MBDYN_MT_EXCEPTION_PTR */
+}
+
+/* must be called by the main thread, after the op completed */
+void
+MultiThreadDataManager::RethrowException(void) const
+{
+#ifdef MBDYN_MT_EXCEPTION_PTR
+	const ThreadData *pFirst = 0;
+	for (unsigned i = 0; i < nThreads; i++) {
+		if (thread_data[i].pException && (pFirst == 0
+			|| thread_data[i].uExceptionKey < pFirst->uExceptionKey))
+		{
+			pFirst = &thread_data[i];
+		}
+	}
+
+	if (pFirst != 0) {
+		std::exception_ptr p = pFirst->pException;
+		ClearExceptions();
+		std::rethrow_exception(p);
+	}
+#else /* ! MBDYN_MT_EXCEPTION_PTR */
+	if (propagate_ErrDivideByZero == AO_TS_SET) {
+		throw ErrDivideByZero(MBDYN_EXCEPT_ARGS);
+	}
+
+	if (propagate_ErrGeneric == AO_TS_SET) {
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+#endif /* ! MBDYN_MT_EXCEPTION_PTR */
 }
 
 /* starts the helper threads */
@@ -412,14 +964,127 @@ MultiThreadDataManager::ThreadSpawn(void)
 {
 	ASSERT(nThreads > 1);
 
+	/* elements of some types are processed by the main thread alone;
+	 * the chunks of the others must not span the runs of serial
+	 * elements, so that the logs can be summed in Elems order */
+	std::vector<unsigned> SerialRunPos;
+	std::vector<unsigned> Breaks;
+	bool bPrevSerial = false;
+	for (ElemVecType::iterator p = Elems.begin(); p != Elems.end(); ++p) {
+		if (ElemData[(*p)->GetElemType()].bMTSerial()) {
+			if (!bPrevSerial) {
+				SerialRun r;
+				r.iFirst = SerialElems.size();
+				r.iSlot = 0;
+				SerialRuns.push_back(r);
+				SerialRunPos.push_back(ParallelElems.size());
+			}
+			SerialElems.push_back(*p);
+			SerialRuns.back().iEnd = SerialElems.size();
+			bPrevSerial = true;
+
+		} else {
+			if (bPrevSerial) {
+				Breaks.push_back(ParallelElems.size());
+			}
+			ParallelElems.push_back(*p);
+			bPrevSerial = false;
+		}
+	}
+
+	if (!SerialElems.empty()) {
+		SerialElemIter.Init(&SerialElems[0], SerialElems.size());
+	}
+
+	for (ElemVecType::iterator p = SerialElems.begin(); p != SerialElems.end(); ++p) {
+		InducedVelocity *pIV = dynamic_cast<InducedVelocity *>(*p);
+		if (pIV != 0) {
+			IndVelElems.push_back(pIV);
+		}
+	}
+
+	/* nodes and elements for the per-step phases */
+	for (NodeVecType::iterator p = Nodes.begin(); p != Nodes.end(); ++p) {
+		if ((*p)->iGetNumDof() == 0) {
+			SerialPhaseNodes.push_back(*p);
+
+		} else {
+			PhaseNodes.push_back(*p);
+		}
+	}
+
+	for (ElemVecType::iterator p = Elems.begin(); p != Elems.end(); ++p) {
+		const ElemDataStructure& ed = ElemData[(*p)->GetElemType()];
+		bool bSerial = (ed.bMTSerial() || ed.bMTSerialPhases());
+		ElemVecType& v = bSerial ? SerialPhaseElems : PhaseElems;
+
+		if (PhaseRuns.empty() || PhaseRuns.back().bSerial != bSerial) {
+			PhaseRun r;
+			r.bSerial = bSerial;
+			r.iFirst = v.size();
+			PhaseRuns.push_back(r);
+		}
+		v.push_back(*p);
+		PhaseRuns.back().iEnd = v.size();
+	}
+
+	/* estimate the cost of each element from the size
+	 * of its contribution to the Jacobian matrix */
+	std::vector<doublereal> Cost(ParallelElems.size());
+	for (unsigned e = 0; e < ParallelElems.size(); e++) {
+		integer iNumRows = 0;
+		integer iNumCols = 0;
+
+		ParallelElems[e]->WorkSpaceDim(&iNumRows, &iNumCols);
+		iNumRows = std::abs(iNumRows);
+
+		Cost[e] = 1. + iNumRows*(iNumCols + 1);
+	}
+
+	ElemSched.Init(ParallelElems.empty() ? 0 : &ParallelElems[0],
+		Cost, Breaks, nThreads, MT_NUM_CHUNKS);
+
+	CCSumMats.resize(nThreads);
+
+	/* residual logs: one slot per chunk and per run
+	 * of serial elements, numbered in Elems order */
+	unsigned iSlot = 0;
+	unsigned r = 0;
+	ChunkSlot.resize(ElemSched.iGetNumChunks());
+	for (unsigned c = 0; c < ElemSched.iGetNumChunks(); c++) {
+		while (r < SerialRuns.size()
+			&& SerialRunPos[r] <= ElemSched.iGetChunkOffset(c))
+		{
+			SerialRuns[r++].iSlot = iSlot++;
+		}
+		ChunkSlot[c] = iSlot++;
+	}
+	while (r < SerialRuns.size()) {
+		SerialRuns[r++].iSlot = iSlot++;
+	}
+	nResLogSlots = iSlot;
+	nRowBlocks = MT_ROW_BLOCKS_PER_THREAD*nThreads;
+	iRowBlockSize = (iTotDofs + nRowBlocks - 1)/nRowBlocks;
+	if (iRowBlockSize == 0) {
+		iRowBlockSize = 1;
+	}
+	ResLog.resize(nResLogSlots*nRowBlocks);
+
 	SAFENEWARRNOFILL(thread_data, MultiThreadDataManager::ThreadData, nThreads);
+
+	/* before the threads are created */
+	(void)pthread_once(&mt_thread_key_once, mt_thread_key_create);
+	mt_num_chunk_slots = ElemSched.iGetNumChunks() + 1;
 	
 	for (unsigned i = 0; i < nThreads; i++) {
 		/* callback data */
 		thread_data[i].pDM = this;
-		sem_init(&thread_data[i].sem, 0, 0);
+		thread_data[i].op_gen = 0;
 		thread_data[i].threadNumber = i;
-		thread_data[i].ElemIter.Init(&Elems[0], Elems.size());
+		thread_data[i].dBusyTime = 0.;
+		thread_data[i].dIdleTime = 0.;
+		thread_data[i].uNumOps = 0;
+		thread_data[i].ElemIter.Init(&ElemSched, i);
 		thread_data[i].lock = 0;
 
 		/* SubMatrixHandlers */
@@ -450,20 +1115,21 @@ MultiThreadDataManager::ThreadSpawn(void)
 		/* set by AssJac when in Naive form */
 		thread_data[i].ppNaiveJacHdl = 0;
 
-		/* set below */
-		thread_data[i].pResHdl = 0;	
+		/* set by AssRes */
+		thread_data[i].pResHdl = 0;
 
 		/* to be sure... */
 		thread_data[i].pMatA = 0;
 		thread_data[i].pMatB = 0;
 
+		thread_data[i].uChunkSlot = 0;
+
 		if (i == 0) {
+			/* the main thread assembles chunks too */
+			(void)pthread_setspecific(mt_thread_key, &thread_data[0]);
 			continue;
 		}
 
-		SAFENEWWITHCONSTRUCTOR(thread_data[i].pResHdl,
-				MyVectorHandler, MyVectorHandler(iTotDofs));
-
 		/* create thread */
 		if (pthread_create(&thread_data[i].thread, NULL, thread,
 					&thread_data[i]) != 0) {
@@ -480,6 +1146,14 @@ MultiThreadDataManager::ThreadSpawn(void)
 void
 MultiThreadDataManager::AssJac(MatrixHandler& JacHdl, doublereal dCoef)
 {
+	/* full matrices (e.g. from eigenanalysis) are neither
+	 * compact nor naive; use logged assembly, which does not
+	 * interfere with the state of the compact matrices */
+	if (dynamic_cast<FullMatrixHandler *>(&JacHdl)) {
+		MatLogAssAll(&JacHdl, 0, dCoef);
+		return;
+	}
+
 retry:;
 	switch (AssMode) {
 	case ASS_CC:
@@ -588,6 +1262,7 @@ MultiThreadDataManager::CCAssJac(MatrixHandler& JacHdl, doublereal dCoef)
 	ASSERT(thread_data != NULL);
 
 	AO_CLEAR(&propagate_ErrMatrixRebuild);
+	ClearExceptions();
 
 	CompactSparseMatrixHandler *pMH
 		= dynamic_cast<CompactSparseMatrixHandler *>(&JacHdl);
@@ -605,9 +1280,18 @@ retry:;
 	case CC_NO:
 		DEBUGCERR("CC_NO => CC_FIRST" << std::endl);
 
+		if (pJacPattern) {
+			pJacPattern->Invalidate();
+		}
+
 		ASSERT(dynamic_cast<SpMapMatrixHandler *>(&JacHdl) != 0);
 
-		DataManager::AssJac(JacHdl, dCoef, ElemIter, *pWorkMat);
+		if (MTJacAssembly == MT_JAC_COLORING) {
+			RowsAssJac(JacHdl, dCoef);
+
+		} else {
+			DataManager::AssJac(JacHdl, dCoef, ElemIter, *pWorkMat);
+		}
 		CCReady = CC_FIRST;
 
 		return;
@@ -619,8 +1303,13 @@ retry:;
 
 		DEBUGCERR("CC_FIRST => CC_YES" << std::endl);
 
-		for (unsigned i = 1; i < nThreads; i++) {
-			thread_data[i].pJacHdl = pMH->Copy();
+		if (MTJacAssembly == MT_JAC_COLORING) {
+			ColorElems();
+
+		} else {
+			for (unsigned i = 1; i < nThreads; i++) {
+				thread_data[i].pJacHdl = pMH->Copy();
+			}
 		}
 
 		CCReady = CC_YES;
@@ -641,15 +1330,20 @@ retry:;
 
 	}
 
-	thread_data[0].ElemIter.ResetAccessData();
-	op = MultiThreadDataManager::OP_ASSJAC_CC;
-	thread_count = nThreads - 1;
+	if (pJacPattern) {
+		pJacPattern->pCheck(JacHdl, GetJacPatternGeneration());
+	}
+
+	if (MTJacAssembly == MT_JAC_COLORING) {
+		ColorAssJac(JacHdl, dCoef);
+		return;
+	}
 
+	ElemSched.Reset();
 	for (unsigned i = 1; i < nThreads; i++) {
 		thread_data[i].dCoef = dCoef;
-	
-		sem_post(&thread_data[i].sem);
 	}
+	StartOp(MultiThreadDataManager::OP_ASSJAC_CC);
 
 	try {
 		DataManager::AssJac(JacHdl, dCoef, thread_data[0].ElemIter,
@@ -663,14 +1357,23 @@ retry:;
 		mbdyn_test_and_set(&propagate_ErrMatrixRebuild);
 
 	} catch (...) {
-		throw;
+		CaughtException(0);
 	}
 
-	pthread_mutex_lock(&thread_mutex);
-	if (thread_count > 0) {
-		pthread_cond_wait(&thread_cond, &thread_mutex);
+	WaitForThreads();
+
+	RethrowException();
+
+	try {
+		SerialAssJac(JacHdl, dCoef, *thread_data[0].pWorkMat);
+
+	} catch (MatrixHandler::ErrRebuildMatrix) {
+		silent_cerr("thread " << thread_data[0].threadNumber
+				<< " caught ErrRebuildMatrix"
+				<< std::endl);
+
+		mbdyn_test_and_set(&propagate_ErrMatrixRebuild);
 	}
-	pthread_mutex_unlock(&thread_mutex);
 
 	if (propagate_ErrMatrixRebuild == AO_TS_SET) {
 		for (unsigned i = 1; i < nThreads; i++) {
@@ -678,12 +1381,316 @@ retry:;
 			thread_data[i].pJacHdl = 0;
 		}
 		CCReady = CC_NO;
+		JacPatternChanged();
 
 		throw MatrixHandler::ErrRebuildMatrix(MBDYN_EXCEPT_ARGS);
 	}
 
-	for (unsigned i = 1; i < nThreads; i++) {
-		pMH->AddUnchecked(*thread_data[i].pJacHdl);
+	CCSum(*pMH);
+}
+
+void
+MultiThreadDataManager::CCSum(CompactSparseMatrixHandler& JacHdl)
+{
+	MTJacobianSum s = MTJacSum;
+	if (s == MT_SUM_AUTO) {
+		s = (nThreads < MT_TREE_SUM_THREADS) ? MT_SUM_PARALLEL : MT_SUM_TREE;
+	}
+
+	switch (s) {
+	case MT_SUM_SERIAL:
+		for (unsigned i = 1; i < nThreads; i++) {
+			JacHdl.AddUnchecked(*thread_data[i].pJacHdl);
+		}
+		break;
+
+	case MT_SUM_PARALLEL:
+		iCCSumNz = JacHdl.Nz();
+		CCSumMats[0] = JacHdl.pdGetMat();
+		for (unsigned i = 1; i < nThreads; i++) {
+			CCSumMats[i] = thread_data[i].pJacHdl->pdGetMat();
+		}
+
+		uCCSumDist = 0;
+		StartOp(MultiThreadDataManager::OP_SUM_CC);
+		CCSumPart(&thread_data[0]);
+		WaitForThreads();
+		break;
+
+	case MT_SUM_TREE:
+		iCCSumNz = JacHdl.Nz();
+		CCSumMats[0] = JacHdl.pdGetMat();
+		for (unsigned i = 1; i < nThreads; i++) {
+			CCSumMats[i] = thread_data[i].pJacHdl->pdGetMat();
+		}
+
+		/* at each level, matrix i + d is summed into matrix i,
+		 * for i multiple of 2 d, by the 2 d threads starting at i */
+		for (uCCSumDist = 1; uCCSumDist < nThreads; uCCSumDist *= 2) {
+			StartOp(MultiThreadDataManager::OP_SUM_CC);
+			CCSumPart(&thread_data[0]);
+			WaitForThreads();
+		}
+		break;
+
+	default:
+		ASSERT(0);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+/* sums a slice of the nonzeros of the per-thread matrices */
+void
+MultiThreadDataManager::CCSumPart(ThreadData *arg)
+{
+	unsigned t = arg->threadNumber;
+
+	if (uCCSumDist == 0) {
+		/* flat: all matrices into the first one */
+		integer iFrom = (iCCSumNz*t)/nThreads;
+		integer iTo = (iCCSumNz*(t + 1))/nThreads;
+
+		doublereal *pdTo = CCSumMats[0];
+		for (unsigned m = 1; m < nThreads; m++) {
+			const doublereal *pdFrom = CCSumMats[m];
+			for (integer k = iFrom; k < iTo; k++) {
+				pdTo[k] += pdFrom[k];
+			}
+		}
+
+		return;
+	}
+
+	/* tree: one level */
+	unsigned uGroup = 2*uCCSumDist;
+	unsigned uFirst = t - t % uGroup;
+	if (uFirst + uCCSumDist >= nThreads) {
+		/* no matrix to sum at this level */
+		return;
+	}
+
+	unsigned uNum = std::min(uGroup, nThreads - uFirst);
+	integer iFrom = (iCCSumNz*(t - uFirst))/uNum;
+	integer iTo = (iCCSumNz*(t - uFirst + 1))/uNum;
+
+	doublereal *pdTo = CCSumMats[uFirst];
+	const doublereal *pdFrom = CCSumMats[uFirst + uCCSumDist];
+	for (integer k = iFrom; k < iTo; k++) {
+		pdTo[k] += pdFrom[k];
+	}
+}
+
+/*
+ * serial assembly that records the rows written by each element;
+ * the rows recorded by previous calls are kept, so that an element
+ * whose contribution changes back and forth is not recolored each time
+ */
+void
+MultiThreadDataManager::RowsAssJac(MatrixHandler& JacHdl, doublereal dCoef)
+{
+	JacHdl.Reset();
+
+	ElemRows.resize(ParallelElems.size());
+	for (unsigned e = 0; e < ParallelElems.size(); e++) {
+		Elem *pTmpEl = ParallelElems[e];
+		try {
+			VariableSubMatrixHandler& WM = pTmpEl->AssJac(*pWorkMat,
+				dCoef, *pXCurr, *pXPrimeCurr);
+
+			std::vector<integer>& Rows = ElemRows[e];
+			if (Rows.empty()) {
+				GetElemDofRows(pTmpEl, Rows);
+			}
+			GetSubMatrixRows(WM, Rows);
+			std::sort(Rows.begin(), Rows.end());
+			Rows.erase(std::unique(Rows.begin(), Rows.end()), Rows.end());
+
+			JacHdl += WM;
+		}
+		catch (ErrDivideByZero) {
+			silent_cerr("AssJac: divide by zero "
+				"in " << psElemNames[pTmpEl->GetElemType()]
+				<< "(" << pTmpEl->GetLabel() << ")"
+				<< std::endl);
+			throw ErrDivideByZero(MBDYN_EXCEPT_ARGS);
+		}
+	}
+
+	SerialAssJac(JacHdl, dCoef, *pWorkMat);
+}
+
+/* greedy, first-fit coloring of the elements by the rows they write */
+void
+MultiThreadDataManager::ColorElems(void)
+{
+	ASSERT(ElemRows.size() == ParallelElems.size());
+
+	std::vector<unsigned> RowColors(iTotDofs + 1, 0U);
+
+	Colors.clear();
+	Colors.resize(MT_MAX_COLORS);
+	UncoloredElems.clear();
+
+	for (unsigned e = 0; e < ParallelElems.size(); e++) {
+		const std::vector<integer>& Rows = ElemRows[e];
+
+		unsigned uUsed = 0U;
+		for (std::vector<integer>::const_iterator r = Rows.begin(); r != Rows.end(); ++r) {
+			uUsed |= RowColors[*r];
+		}
+
+		unsigned c = 0;
+		while (c < MT_MAX_COLORS && (uUsed & (1U << c))) {
+			c++;
+		}
+
+		if (c == MT_MAX_COLORS) {
+			UncoloredElems.push_back(e);
+			continue;
+		}
+
+		Colors[c].push_back(e);
+		for (std::vector<integer>::const_iterator r = Rows.begin(); r != Rows.end(); ++r) {
+			RowColors[*r] |= (1U << c);
+		}
+	}
+
+	while (!Colors.empty() && Colors.back().empty()) {
+		Colors.pop_back();
+	}
+
+	silent_cout("MultiThreadDataManager: " << ParallelElems.size()
+		<< " elements in " << Colors.size() << " colors");
+	for (unsigned c = 0; c < Colors.size(); c++) {
+		silent_cout((c == 0 ? " {" : ",") << Colors[c].size());
+	}
+	silent_cout((Colors.empty() ? "" : "}") << ", "
+		<< UncoloredElems.size() << " uncolored, "
+		<< SerialElems.size() << " serial" << std::endl);
+}
+
+void
+MultiThreadDataManager::ColorAssJac(MatrixHandler& JacHdl, doublereal dCoef)
+{
+	ClearExceptions();
+
+	JacHdl.Reset();
+
+	pColorJacHdl = &JacHdl;
+	pColorCCJacHdl = 0;
+	if (pJacPattern) {
+		pColorCCJacHdl = dynamic_cast<CompactSparseMatrixHandler *>(&JacHdl);
+	}
+	for (unsigned i = 0; i < nThreads; i++) {
+		thread_data[i].dCoef = dCoef;
+	}
+
+	/* colors are assembled one after the other */
+	for (unsigned c = 0; c < Colors.size(); c++) {
+		pCurrColor = &Colors[c];
+		AO_store_release(&color_next, 0);
+
+		if (Colors[c].size() < MT_MIN_COLOR_SIZE) {
+			ColorAssJacPart(&thread_data[0]);
+			continue;
+		}
+
+		StartOp(MultiThreadDataManager::OP_ASSJAC_COLOR);
+		ColorAssJacPart(&thread_data[0]);
+		WaitForThreads();
+	}
+
+	/* then what could not be colored */
+	pCurrColor = &UncoloredElems;
+	AO_store_release(&color_next, 0);
+	ColorAssJacPart(&thread_data[0]);
+
+	RethrowException();
+
+	try {
+		SerialAssJac(JacHdl, dCoef, *thread_data[0].pWorkMat);
+
+	} catch (MatrixHandler::ErrRebuildMatrix) {
+		mbdyn_test_and_set(&propagate_ErrMatrixRebuild);
+	}
+
+	if (propagate_ErrMatrixRebuild == AO_TS_SET) {
+		silent_cerr("colored assembly caught ErrRebuildMatrix"
+				<< std::endl);
+
+		CCReady = CC_NO;
+		JacPatternChanged();
+
+		throw MatrixHandler::ErrRebuildMatrix(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+/* assembles the elements of the current color, in small blocks */
+void
+MultiThreadDataManager::ColorAssJacPart(ThreadData *arg)
+{
+	const std::vector<unsigned>& Color = *pCurrColor;
+
+	/* uncolored elements are assembled by the main thread alone */
+	bool bCheckRows = (pCurrColor != &UncoloredElems);
+
+	while (true) {
+		AO_t e = AO_fetch_and_add_full(&color_next, MT_COLOR_BLOCK);
+		if (e >= Color.size()) {
+			break;
+		}
+
+		AO_t eEnd = std::min(AO_t(e + MT_COLOR_BLOCK), AO_t(Color.size()));
+		for (; e < eEnd; e++) {
+			Elem *pEl = ParallelElems[Color[e]];
+
+			ElemProfile::Ticks t0 = 0;
+			if (pElemProf) {
+				t0 = ElemProfile::GetTicks();
+			}
+
+			try {
+				VariableSubMatrixHandler& WM = pEl->AssJac(*arg->pWorkMat,
+					arg->dCoef, *pXCurr, *pXPrimeCurr);
+				if (bCheckRows && !bSubMatrixRowsIn(WM, ElemRows[Color[e]])) {
+					/* rows grew: do not race, recolor */
+					silent_cerr("AssJac: "
+						<< psElemNames[pEl->GetElemType()]
+						<< "(" << pEl->GetLabel() << ")"
+						" writes rows out of its color"
+						<< std::endl);
+					mbdyn_test_and_set(&propagate_ErrMatrixRebuild);
+
+				} else if (pColorCCJacHdl) {
+					pJacPattern->Add(*pColorCCJacHdl, pEl, WM);
+
+				} else {
+					*pColorJacHdl += WM;
+				}
+			}
+			catch (MatrixHandler::ErrRebuildMatrix) {
+				mbdyn_test_and_set(&propagate_ErrMatrixRebuild);
+			}
+			catch (ErrDivideByZero) {
+				silent_cerr("AssJac: divide by zero "
+					"in " << psElemNames[pEl->GetElemType()]
+					<< "(" << pEl->GetLabel() << ")"
+					<< std::endl);
+				CaughtException(Color[e]);
+			}
+			catch (...) {
+				silent_cerr("AssJac: error "
+					"in " << psElemNames[pEl->GetElemType()]
+					<< "(" << pEl->GetLabel() << ")"
+					<< std::endl);
+				CaughtException(Color[e]);
+			}
+
+			if (pElemProf) {
+				pElemProf->Add(ElemProfile::JAC, pEl,
+					ElemProfile::GetTicks() - t0);
+			}
+		}
 	}
 }
 
@@ -693,15 +1700,11 @@ MultiThreadDataManager::NaiveAssJac(MatrixHandler& JacHdl, doublereal dCoef)
 	ASSERT(thread_data != NULL);
 
 	/* Assemble per-thread matrix */
-	thread_data[0].ElemIter.ResetAccessData();
-	op = MultiThreadDataManager::OP_ASSJAC_NAIVE;
-	thread_count = nThreads - 1;
-
+	ElemSched.Reset();
 	for (unsigned i = 1; i < nThreads; i++) {
 		thread_data[i].dCoef = dCoef;
-	
-		sem_post(&thread_data[i].sem);
 	}
+	StartOp(MultiThreadDataManager::OP_ASSJAC_NAIVE);
 
 	/* FIXME Right now it's already done before calling AssJac;
 	 * needs be moved here to improve parallel performances... */
@@ -713,18 +1716,13 @@ MultiThreadDataManager::NaiveAssJac(MatrixHandler& JacHdl, doublereal dCoef)
 			thread_data[0].ElemIter,
 			*thread_data[0].pWorkMat);
 
-	pthread_mutex_lock(&thread_mutex);
-	if (thread_count > 0) {
-		pthread_cond_wait(&thread_cond, &thread_mutex);
-	}
-	pthread_mutex_unlock(&thread_mutex);
+	WaitForThreads();
+
+	SerialAssJac(*thread_data[0].ppNaiveJacHdl[0], dCoef,
+			*thread_data[0].pWorkMat);
 
 	/* Sum per-thread matrices */
-	op = MultiThreadDataManager::OP_SUM_NAIVE;
-	thread_count = nThreads - 1;
-	for (unsigned i = 1; i < nThreads; i++) {
-		sem_post(&thread_data[i].sem);
-	}
+	StartOp(MultiThreadDataManager::OP_SUM_NAIVE);
 
 	NaiveMatrixHandler* to = thread_data[0].ppNaiveJacHdl[0];
 	integer nn = to->iGetNumRows();
@@ -739,45 +1737,649 @@ MultiThreadDataManager::NaiveAssJac(MatrixHandler& JacHdl, doublereal dCoef)
 				iFrom, iTo, thread_data[0].lock);
 	}
 
-	pthread_mutex_lock(&thread_mutex);
-	if (thread_count > 0) {
-		pthread_cond_wait(&thread_cond, &thread_mutex);
+	WaitForThreads();
+}
+
+void
+MultiThreadDataManager::SerialAssJac(MatrixHandler& JacHdl, doublereal dCoef,
+	VariableSubMatrixHandler& WorkMat)
+{
+	CompactSparseMatrixHandler *pCCJacHdl = 0;
+	if (pJacPattern) {
+		pCCJacHdl = dynamic_cast<CompactSparseMatrixHandler *>(&JacHdl);
+	}
+
+	Elem* pTmpEl = 0;
+	if (SerialElemIter.bGetFirst(pTmpEl)) {
+		do {
+			ElemProfile::Ticks t0 = 0;
+			if (pElemProf) {
+				t0 = ElemProfile::GetTicks();
+			}
+
+			try {
+				VariableSubMatrixHandler& WM = pTmpEl->AssJac(WorkMat,
+						dCoef, *pXCurr, *pXPrimeCurr);
+				if (pCCJacHdl) {
+					pJacPattern->Add(*pCCJacHdl, pTmpEl, WM);
+
+				} else {
+					JacHdl += WM;
+				}
+			}
+			catch (ErrDivideByZero) {
+				silent_cerr("AssJac: divide by zero "
+					"in " << psElemNames[pTmpEl->GetElemType()]
+					<< "(" << pTmpEl->GetLabel() << ")"
+					<< std::endl);
+				throw ErrDivideByZero(MBDYN_EXCEPT_ARGS);
+			}
+
+			if (pElemProf) {
+				pElemProf->Add(ElemProfile::JAC, pTmpEl,
+					ElemProfile::GetTicks() - t0);
+			}
+		} while (SerialElemIter.bGetNext(pTmpEl));
+	}
+}
+
+void
+MultiThreadDataManager::ResLogReset(unsigned iSlot)
+{
+	for (unsigned b = 0; b < nRowBlocks; b++) {
+		/* keeps the capacity */
+		ResLog[iSlot*nRowBlocks + b].clear();
+	}
+}
+
+void
+MultiThreadDataManager::ResLogAdd(unsigned iSlot, const SubVectorHandler& WorkVec)
+{
+	ResLogEntry e;
+
+	for (integer i = 1; i <= WorkVec.iGetSize(); i++) {
+		e.iRow = WorkVec.iGetRowIndex(i);
+		e.d = WorkVec(i);
+
+		ASSERT(e.iRow > 0 && e.iRow <= iTotDofs);
+		ResLog[iSlot*nRowBlocks + (e.iRow - 1)/iRowBlockSize].push_back(e);
+	}
+}
+
+/*
+ * Assembles the residual of a range of elements into a log slot;
+ * errors are not thrown, since this may run in a helper thread:
+ * they are recorded with the slot, and the first one is rethrown
+ * by the main thread after all threads completed the op.
+ */
+void
+MultiThreadDataManager::ResLogAssRes(unsigned iSlot,
+	Elem **ppFirst, Elem **ppEnd,
+	SubVectorHandler& WorkVec, doublereal dCoef)
+{
+	ResLogReset(iSlot);
+
+	for (Elem **pp = ppFirst; pp != ppEnd; ++pp) {
+		ElemProfile::Ticks t0 = 0;
+		if (pElemProf) {
+			t0 = ElemProfile::GetTicks();
+		}
+
+		try {
+			ResLogAdd(iSlot, (*pp)->AssRes(WorkVec, dCoef,
+				*pXCurr, *pXPrimeCurr));
+		}
+		catch (Elem::ChangedEquationStructure) {
+			ResLogAdd(iSlot, WorkVec);
+			mbdyn_test_and_set(&propagate_ChangedEquationStructure);
+		}
+		catch (ErrDivideByZero) {
+			silent_cerr("AssRes: divide by zero "
+				"in " << psElemNames[(*pp)->GetElemType()]
+				<< "(" << (*pp)->GetLabel() << ")"
+				<< std::endl);
+			CaughtException(iSlot);
+		}
+		catch (...) {
+			silent_cerr("AssRes: error "
+				"in " << psElemNames[(*pp)->GetElemType()]
+				<< "(" << (*pp)->GetLabel() << ")"
+				<< std::endl);
+			CaughtException(iSlot);
+		}
+
+		if (pElemProf) {
+			pElemProf->Add(ElemProfile::RES, *pp,
+				ElemProfile::GetTicks() - t0);
+		}
+	}
+}
+
+void
+MultiThreadDataManager::ResLogSum(VectorHandler& ResHdl)
+{
+	while (true) {
+		AO_t b = AO_fetch_and_add1_full(&res_block);
+		if (b >= nRowBlocks) {
+			break;
+		}
+
+		for (unsigned iSlot = 0; iSlot < nResLogSlots; iSlot++) {
+			const ResLogType& l = ResLog[iSlot*nRowBlocks + b];
+			for (ResLogType::const_iterator i = l.begin(); i != l.end(); ++i) {
+				ResHdl.IncCoef(i->iRow, i->d);
+			}
+		}
 	}
-	
-	pthread_mutex_unlock(&thread_mutex);
 }
 
-#ifdef MBDYN_X_MT_ASSRES
 void
 MultiThreadDataManager::AssRes(VectorHandler& ResHdl, doublereal dCoef)
 	throw(ChangedEquationStructure)
 {
 	ASSERT(thread_data != NULL);
 
-	thread_data[0].ElemIter.ResetAccessData();
-	op = MultiThreadDataManager::OP_ASSRES;
-	thread_count = nThreads - 1;
+	AO_CLEAR(&propagate_ChangedEquationStructure);
+	ClearExceptions();
 
+	/* serial elements first, by the main thread alone */
+	for (std::vector<SerialRun>::const_iterator r = SerialRuns.begin();
+		r != SerialRuns.end(); ++r)
+	{
+		ResLogAssRes(r->iSlot, &SerialElems[r->iFirst],
+			&SerialElems[0] + r->iEnd,
+			*thread_data[0].pWorkVec, dCoef);
+	}
+
+	/* then the others, by chunks */
+	ElemSched.Reset();
 	for (unsigned i = 1; i < nThreads; i++) {
 		thread_data[i].dCoef = dCoef;
-	
-		sem_post(&thread_data[i].sem);
 	}
+	StartOp(MultiThreadDataManager::OP_ASSRES);
+
+	unsigned iChunk;
+	while (ElemSched.bClaim(0, iChunk)) {
+		thread_data[0].uChunkSlot = iChunk + 1;
+		ResLogAssRes(ChunkSlot[iChunk],
+			ElemSched.ppGetFirst(iChunk),
+			ElemSched.ppGetEnd(iChunk),
+			*thread_data[0].pWorkVec, dCoef);
+	}
+	thread_data[0].uChunkSlot = 0;
 
-	DataManager::AssRes(ResHdl, dCoef, thread_data[0].ElemIter,
-			*thread_data[0].pWorkVec);
+	WaitForThreads();
 
-	pthread_mutex_lock(&thread_mutex);
-	if (thread_count > 0) {
-		pthread_cond_wait(&thread_cond, &thread_mutex);
+	/* end of the residual phase: sum the partial resultants */
+	for (std::vector<InducedVelocity *>::iterator i = IndVelElems.begin();
+		i != IndVelElems.end(); ++i)
+	{
+		(*i)->ReduceForces();
+	}
+
+	RethrowException();
+
+	/* sum the logs in fixed order */
+	AO_store_release(&res_block, 0);
+	for (unsigned i = 0; i < nThreads; i++) {
+		thread_data[i].pResHdl = &ResHdl;
+	}
+	StartOp(MultiThreadDataManager::OP_SUM_RES);
+
+	ResLogSum(ResHdl);
+
+	WaitForThreads();
+
+	if (propagate_ChangedEquationStructure == AO_TS_SET) {
+		JacPatternChanged();
+		throw ChangedEquationStructure(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+void
+MultiThreadDataManager::MatLogReset(unsigned iSlot)
+{
+	for (unsigned m = 0; m < nMatLogMats; m++) {
+		for (unsigned b = 0; b < nRowBlocks; b++) {
+			/* keeps the capacity */
+			MatLog[m][iSlot*nRowBlocks + b].clear();
+		}
+	}
+}
+
+void
+MultiThreadDataManager::MatLogAdd(unsigned iMat, unsigned iSlot,
+	const VariableSubMatrixHandler& WorkMat)
+{
+	std::vector<MatLogType>& l = MatLog[iMat];
+	MatLogEntry e;
+
+	if (WorkMat.bIsFull()) {
+		const FullSubMatrixHandler& WM = WorkMat.GetFull();
+		for (integer i = 1; i <= WM.iGetNumRows(); i++) {
+			e.iRow = WM.iGetRowIndex(i);
+			ASSERT(e.iRow > 0 && e.iRow <= iTotDofs);
+			MatLogType& lb = l[iSlot*nRowBlocks + (e.iRow - 1)/iRowBlockSize];
+			for (integer j = 1; j <= WM.iGetNumCols(); j++) {
+				e.iCol = WM.iGetColIndex(j);
+				e.d = WM(i, j);
+				lb.push_back(e);
+			}
+		}
+
+	} else if (WorkMat.bIsSparse()) {
+		const SparseSubMatrixHandler& WM = WorkMat.GetSparse();
+		for (integer i = 1; i <= WM.iGetNumRows(); i++) {
+			e.iRow = WM.iGetRowIndex(i);
+			e.iCol = WM.iGetColIndex(i);
+			e.d = WM(i, 1);
+			ASSERT(e.iRow > 0 && e.iRow <= iTotDofs);
+			l[iSlot*nRowBlocks + (e.iRow - 1)/iRowBlockSize].push_back(e);
+		}
+	}
+}
+
+/*
+ * Assembles the matrices of a range of elements into a log slot:
+ * AssMats() when two matrices are logged, AssJac() otherwise;
+ * errors are recorded as in ResLogAssRes().
+ */
+void
+MultiThreadDataManager::MatLogAss(unsigned iSlot,
+	Elem **ppFirst, Elem **ppEnd,
+	VariableSubMatrixHandler& WorkMatA,
+	VariableSubMatrixHandler& WorkMatB,
+	doublereal dCoef)
+{
+	MatLogReset(iSlot);
+
+	for (Elem **pp = ppFirst; pp != ppEnd; ++pp) {
+		ElemProfile::Ticks t0 = 0;
+		if (pElemProf) {
+			t0 = ElemProfile::GetTicks();
+		}
+
+		try {
+			if (nMatLogMats == 2) {
+				(*pp)->AssMats(WorkMatA, WorkMatB,
+					*pXCurr, *pXPrimeCurr);
+				MatLogAdd(0, iSlot, WorkMatA);
+				MatLogAdd(1, iSlot, WorkMatB);
+
+			} else {
+				MatLogAdd(0, iSlot, (*pp)->AssJac(WorkMatA,
+					dCoef, *pXCurr, *pXPrimeCurr));
+			}
+		}
+		catch (ErrDivideByZero) {
+			silent_cerr("AssJac: divide by zero "
+				"in " << psElemNames[(*pp)->GetElemType()]
+				<< "(" << (*pp)->GetLabel() << ")"
+				<< std::endl);
+			CaughtException(iSlot);
+		}
+		catch (...) {
+			silent_cerr("AssJac: error "
+				"in " << psElemNames[(*pp)->GetElemType()]
+				<< "(" << (*pp)->GetLabel() << ")"
+				<< std::endl);
+			CaughtException(iSlot);
+		}
+
+		if (pElemProf) {
+			pElemProf->Add(nMatLogMats == 2
+				? ElemProfile::MATS : ElemProfile::JAC, *pp,
+				ElemProfile::GetTicks() - t0);
+		}
+	}
+}
+
+void
+MultiThreadDataManager::MatLogSum(void)
+{
+	while (true) {
+		AO_t b = AO_fetch_and_add1_full(&mat_block);
+		if (b >= nRowBlocks) {
+			break;
+		}
+
+		for (unsigned m = 0; m < nMatLogMats; m++) {
+			MatrixHandler& MH = *pMatLogHdl[m];
+			for (unsigned iSlot = 0; iSlot < nResLogSlots; iSlot++) {
+				const MatLogType& l = MatLog[m][iSlot*nRowBlocks + b];
+				for (MatLogType::const_iterator i = l.begin(); i != l.end(); ++i) {
+					MH.IncCoef(i->iRow, i->iCol, i->d);
+				}
+			}
+		}
+	}
+}
+
+void
+MultiThreadDataManager::MatLogAssAll(MatrixHandler *pA_Hdl,
+	MatrixHandler *pB_Hdl, doublereal dCoef)
+{
+	ASSERT(thread_data != NULL);
+
+	pMatLogHdl[0] = pA_Hdl;
+	pMatLogHdl[1] = pB_Hdl;
+	nMatLogMats = pB_Hdl ? 2 : 1;
+
+	/* allocated at first use */
+	for (unsigned m = 0; m < nMatLogMats; m++) {
+		if (MatLog[m].empty()) {
+			MatLog[m].resize(nResLogSlots*nRowBlocks);
+		}
 	}
-	pthread_mutex_unlock(&thread_mutex);
 
+	ClearExceptions();
+
+	/* serial elements first, by the main thread alone */
+	for (std::vector<SerialRun>::const_iterator r = SerialRuns.begin();
+		r != SerialRuns.end(); ++r)
+	{
+		MatLogAss(r->iSlot, &SerialElems[r->iFirst],
+			&SerialElems[0] + r->iEnd,
+			*thread_data[0].pWorkMatA, *thread_data[0].pWorkMatB,
+			dCoef);
+	}
+
+	/* then the others, by chunks */
+	ElemSched.Reset();
 	for (unsigned i = 1; i < nThreads; i++) {
-		ResHdl += *thread_data[i].pResHdl;
+		thread_data[i].dCoef = dCoef;
+	}
+	StartOp(nMatLogMats == 2
+		? MultiThreadDataManager::OP_ASSMATS
+		: MultiThreadDataManager::OP_ASSJAC_LOG);
+
+	unsigned iChunk;
+	while (ElemSched.bClaim(0, iChunk)) {
+		MatLogAss(ChunkSlot[iChunk],
+			ElemSched.ppGetFirst(iChunk),
+			ElemSched.ppGetEnd(iChunk),
+			*thread_data[0].pWorkMatA, *thread_data[0].pWorkMatB,
+			dCoef);
+	}
+
+	WaitForThreads();
+
+	RethrowException();
+
+	/* sum the logs in fixed order */
+	AO_store_release(&mat_block, 0);
+
+	bool bParallel = true;
+	for (unsigned m = 0; m < nMatLogMats; m++) {
+		if (dynamic_cast<FullMatrixHandler *>(pMatLogHdl[m]) == 0) {
+			bParallel = false;
+			break;
+		}
+	}
+
+	if (bParallel) {
+		StartOp(MultiThreadDataManager::OP_SUM_MATS);
+		MatLogSum();
+		WaitForThreads();
+
+	} else {
+		MatLogSum();
+	}
+}
+
+void
+MultiThreadDataManager::AssMats(MatrixHandler& A_Hdl, MatrixHandler& B_Hdl)
+{
+	DEBUGCOUT("Entering MultiThreadDataManager::AssMats()" << std::endl);
+
+	MatLogAssAll(&A_Hdl, &B_Hdl, 0.);
+}
+
+void
+MultiThreadDataManager::PhaseNode(DataManagerOp o, Node *pN) const
+{
+	switch (o) {
+	case OP_BEFOREPREDICT:
+		pN->BeforePredict(*pPhaseX, *pPhaseXP,
+			*pPhaseXPrev, *pPhaseXPPrev);
+		break;
+
+	case OP_AFTERPREDICT:
+		try {
+			pN->AfterPredict(*pXCurr, *pXPrimeCurr);
+		}
+		catch (Elem::ChangedEquationStructure e) {
+			// ignore by now
+		}
+		break;
+
+	case OP_UPDATE:
+		pN->Update(*pXCurr, *pXPrimeCurr);
+		break;
+
+	case OP_AFTERCONVERGENCE:
+		pN->AfterConvergence(*pXCurr, *pXPrimeCurr);
+		break;
+
+	default:
+		ASSERT(0);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
 	}
 }
-#endif /* MBDYN_X_MT_ASSRES */
+
+void
+MultiThreadDataManager::PhaseElem(DataManagerOp o, Elem *pE) const
+{
+	switch (o) {
+	case OP_BEFOREPREDICT:
+		pE->BeforePredict(*pPhaseX, *pPhaseXP,
+			*pPhaseXPrev, *pPhaseXPPrev);
+		break;
+
+	case OP_AFTERPREDICT:
+		try {
+			pE->AfterPredict(*pXCurr, *pXPrimeCurr);
+		}
+		catch (Elem::ChangedEquationStructure e) {
+			// ignore by now
+		}
+		break;
+
+	case OP_UPDATE:
+		pE->Update(*pXCurr, *pXPrimeCurr);
+		break;
+
+	case OP_AFTERCONVERGENCE:
+		pE->AfterConvergence(*pXCurr, *pXPrimeCurr);
+		break;
+
+	default:
+		ASSERT(0);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+/*
+ * Processes blocks of nodes or elements, according to the current stage,
+ * up to iPhaseEnd; errors are recorded with the position, and the first
+ * one is rethrown by the main thread, see RethrowException()
+ */
+void
+MultiThreadDataManager::PhasePart(DataManagerOp o) const
+{
+	unsigned n = iPhaseEnd;
+
+	while (true) {
+		AO_t b = AO_fetch_and_add_full(&phase_next, MT_PHASE_BLOCK);
+		if (b >= n) {
+			break;
+		}
+
+		unsigned e = std::min(unsigned(b) + MT_PHASE_BLOCK, n);
+		for (unsigned i = b; i < e; i++) {
+			if (CurrPhaseStage == PHASE_NODES) {
+				Node *pN = PhaseNodes[i];
+				try {
+					PhaseNode(o, pN);
+				}
+				catch (...) {
+					silent_cerr("error in "
+						<< psNodeNames[pN->GetNodeType()]
+						<< "(" << pN->GetLabel() << ")"
+						<< std::endl);
+					CaughtException(i);
+				}
+
+			} else {
+				Elem *pE = PhaseElems[i];
+				try {
+					PhaseElem(o, pE);
+				}
+				catch (...) {
+					silent_cerr("error in "
+						<< psElemNames[pE->GetElemType()]
+						<< "(" << pE->GetLabel() << ")"
+						<< std::endl);
+					CaughtException(i);
+				}
+			}
+		}
+	}
+}
+
+void
+MultiThreadDataManager::Phase(DataManagerOp o) const
+{
+	ASSERT(thread_data != NULL);
+
+	ClearExceptions();
+
+	/* nodes */
+	CurrPhaseStage = PHASE_NODES;
+	iPhaseEnd = PhaseNodes.size();
+	AO_store_release(&phase_next, 0);
+	StartOp(o);
+	PhasePart(o);
+	WaitForThreads();
+
+	RethrowException();
+
+	for (NodeVecType::const_iterator i = SerialPhaseNodes.begin();
+		i != SerialPhaseNodes.end(); ++i)
+	{
+		PhaseNode(o, *i);
+	}
+
+	/* elements, run by run in Elems order */
+	CurrPhaseStage = PHASE_ELEMS;
+	for (std::vector<PhaseRun>::const_iterator r = PhaseRuns.begin();
+		r != PhaseRuns.end(); ++r)
+	{
+		if (r->bSerial) {
+			for (unsigned i = r->iFirst; i < r->iEnd; i++) {
+				PhaseElem(o, SerialPhaseElems[i]);
+			}
+			continue;
+		}
+
+		iPhaseEnd = r->iEnd;
+		AO_store_release(&phase_next, r->iFirst);
+
+		/* short runs are not worth waking up the threads */
+		if (r->iEnd - r->iFirst <= MT_PHASE_BLOCK) {
+			PhasePart(o);
+
+		} else {
+			StartOp(o);
+			PhasePart(o);
+			WaitForThreads();
+		}
+
+		RethrowException();
+	}
+}
+
+void
+MultiThreadDataManager::BeforePredict(VectorHandler& X, VectorHandler& XP,
+	VectorHandler& XPrev,
+	VectorHandler& XPPrev) const
+{
+	pPhaseX = &X;
+	pPhaseXP = &XP;
+	pPhaseXPrev = &XPrev;
+	pPhaseXPPrev = &XPPrev;
+
+	Phase(OP_BEFOREPREDICT);
+}
+
+void
+MultiThreadDataManager::AfterPredict(void) const
+{
+	/* reset any external convergence requirement before starting
+	 * a new step */
+	for (Converged_t::iterator i = m_IsConverged.begin();
+		i != m_IsConverged.end(); ++i)
+	{
+		*i = Converged::NOT_CONVERGED;
+	}
+
+	Phase(OP_AFTERPREDICT);
+}
+
+void
+MultiThreadDataManager::Update(void) const
+{
+	Phase(OP_UPDATE);
+}
+
+void
+MultiThreadDataManager::AfterConvergence(void) const
+{
+	Phase(OP_AFTERCONVERGENCE);
+
+	AfterConvergenceRestart();
+}
+
+void
+MultiThreadDataManager::TaskPart(void) const
+{
+	while (true) {
+		AO_t i = AO_fetch_and_add1_full(&task_next);
+		if (i >= nTaskEnd) {
+			break;
+		}
+
+		try {
+			pTaskFunc(pTaskData, unsigned(i));
+		}
+		catch (...) {
+			CaughtException(unsigned(i));
+		}
+	}
+}
+
+void
+MultiThreadDataManager::RunTasks(void (*pTask)(void *, unsigned),
+	void *pData, unsigned nTasks) const
+{
+	/* a single task, or no threads left (see GetCPUTime()) */
+	if (nTasks < 2 || thread_data == 0) {
+		DataManager::RunTasks(pTask, pData, nTasks);
+		return;
+	}
+
+	pTaskFunc = pTask;
+	pTaskData = pData;
+	nTaskEnd = nTasks;
+	AO_store_release(&task_next, 0);
+	ClearExceptions();
+
+	StartOp(OP_TASKS);
+	TaskPart();
+	WaitForThreads();
+
+	RethrowException();
+}
 
 clock_t
 MultiThreadDataManager::GetCPUTime(void) const
@@ -785,5 +2387,27 @@ MultiThreadDataManager::GetCPUTime(void) const
 	return ((MultiThreadDataManager *)this)->ThreadDestroy();
 }
 
+unsigned
+MultiThreadDataManager::GetChunkSlot(void)
+{
+	if (mt_num_chunk_slots == 1) {
+		return 0;
+	}
+
+	const ThreadData *arg
+		= (const ThreadData *)pthread_getspecific(mt_thread_key);
+	if (arg == 0) {
+		return 0;
+	}
+
+	return arg->uChunkSlot;
+}
+
+unsigned
+MultiThreadDataManager::GetNumChunkSlots(void)
+{
+	return mt_num_chunk_slots;
+}
+
 #endif /* USE_MULTITHREAD */
 
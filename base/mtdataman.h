@@ -38,10 +38,19 @@
 
 #include "ac/pthread.h"		/* includes POSIX semaphores */
 
+#include <vector>
+#include <exception>
+
+/* the exceptions thrown by the helper threads keep their type */
+#if __cplusplus >= 201103L
+#define MBDYN_MT_EXCEPTION_PTR
+#endif
+
 #include "dataman.h"
 #include "spmh.h"
 #include "naivemh.h"
 class Solver;
+class InducedVelocity;
 
 /* MultiThreadDataManager - begin */
 
@@ -64,15 +73,266 @@ protected:
 		CC_YES
 	} CCReady;
 
+	/*
+	 * Cost-weighted chunk schedule of the elements.
+	 *
+	 * The elements are split in contiguous chunks of about the same
+	 * estimated cost; each thread initially owns a contiguous range
+	 * of chunks, which it consumes from the head.  When its range
+	 * is exhausted, it steals chunks from the tail of the ranges
+	 * of the other threads.  Each range is protected by a spinlock,
+	 * so contention occurs once per chunk rather than once per element.
+	 *
+	 * The split in chunks does not depend on the number of threads,
+	 * so that per-chunk results can be reduced in a fixed order.
+	 */
+	class ElemChunkSched {
+	protected:
+		struct Queue {
+			AO_TS_t lock;
+			unsigned iFirst;	/* initial range */
+			unsigned iLast;
+			unsigned iNext;		/* current range */
+			unsigned iEnd;
+			/* keep queues on separate cache lines */
+			char pad[64];
+		};
+
+		Elem **ppElems;
+		std::vector<unsigned> ChunkOffset;
+		Queue *pQueues;
+		unsigned nQueues;
+
+	public:
+		ElemChunkSched(void);
+		~ElemChunkSched(void);
+
+		void Init(Elem **pp, const std::vector<doublereal>& Cost,
+			const std::vector<unsigned>& Breaks,
+			unsigned nThreads, unsigned nChunks);
+		void Reset(void);
+		bool bClaim(unsigned iThread, unsigned& iChunk);
+
+		unsigned iGetNumChunks(void) const {
+			return ChunkOffset.size() - 1;
+		};
+		unsigned iGetChunkOffset(unsigned iChunk) const {
+			return ChunkOffset[iChunk];
+		};
+		Elem **ppGetFirst(unsigned iChunk) const {
+			return &ppElems[ChunkOffset[iChunk]];
+		};
+		Elem **ppGetEnd(unsigned iChunk) const {
+			return &ppElems[ChunkOffset[iChunk + 1]];
+		};
+	};
+
+	/* element iterator that walks the chunks claimed by one thread */
+	class ElemChunkIter : public VecIter<Elem *> {
+	protected:
+		ElemChunkSched *pSched;
+		unsigned iThread;
+		mutable Elem **ppCurr;
+		mutable Elem **ppEnd;
+
+	public:
+		ElemChunkIter(void);
+		virtual ~ElemChunkIter(void);
+
+		void Init(ElemChunkSched *p, unsigned i);
+
+		bool bGetFirst(Elem *& pE) const;
+		bool bGetNext(Elem *& pE) const;
+	};
+
+	/* elements that must be processed by the main thread alone
+	 * (see DataManager::ElemDataStructure::bMTSerial()) */
+	ElemVecType SerialElems;
+	mutable VecIter<Elem *> SerialElemIter;
+
+	/* runs of consecutive serial elements in Elems */
+	struct SerialRun {
+		unsigned iFirst;	/* range in SerialElems */
+		unsigned iEnd;
+		unsigned iSlot;		/* log slot */
+	};
+	std::vector<SerialRun> SerialRuns;
+
+	/* serial elements whose per-chunk partial resultants
+	 * are summed at the end of the residual phase */
+	std::vector<InducedVelocity *> IndVelElems;
+
+	/* all the other elements */
+	ElemVecType ParallelElems;
+	ElemChunkSched ElemSched;
+
+	/* log slot of each chunk */
+	std::vector<unsigned> ChunkSlot;
+
+	/*
+	 * Deterministic residual reduction.
+	 *
+	 * Each chunk and each run of serial elements logs
+	 * the contributions of its elements, split by blocks of rows.
+	 * Chunks do not span runs of serial elements, and slots
+	 * are numbered in the order of Elems.  The logs are then summed
+	 * by blocks of rows in parallel, in slot order, so that
+	 * each coefficient is summed in Elems order, regardless
+	 * of the schedule; the residual is reproducible from run to run
+	 * with the same number of threads (two or more).  It is not
+	 * guaranteed to match the single-threaded DataManager in the last
+	 * bits, since element state that is itself reduced by chunks
+	 * (e.g. the rotor resultants) feeds back into the residual.
+	 */
+	struct ResLogEntry {
+		integer iRow;
+		doublereal d;
+	};
+	typedef std::vector<ResLogEntry> ResLogType;
+	std::vector<ResLogType> ResLog;
+	unsigned nResLogSlots;
+	unsigned nRowBlocks;
+	integer iRowBlockSize;
+	AO_t res_block;
+
+	void ResLogReset(unsigned iSlot);
+	void ResLogAdd(unsigned iSlot, const SubVectorHandler& WorkVec);
+	void ResLogAssRes(unsigned iSlot, Elem **ppFirst, Elem **ppEnd,
+		SubVectorHandler& WorkVec, doublereal dCoef);
+	void ResLogSum(VectorHandler& ResHdl);
+
+	/*
+	 * Logged matrix assembly, for AssMats() and for the Jacobian
+	 * matrix when it is not in sparse form (e.g. eigenanalysis).
+	 *
+	 * Same as the residual: each chunk logs the coefficients
+	 * of its elements by blocks of rows, and the logs are summed
+	 * in slot order.  The sum is performed by blocks of rows
+	 * in parallel only when all the target matrices are full,
+	 * since adding a coefficient to other matrix handlers
+	 * may modify data shared by different rows.
+	 */
+	struct MatLogEntry {
+		integer iRow;
+		integer iCol;
+		doublereal d;
+	};
+	typedef std::vector<MatLogEntry> MatLogType;
+	std::vector<MatLogType> MatLog[2];
+	MatrixHandler *pMatLogHdl[2];
+	unsigned nMatLogMats;
+	AO_t mat_block;
+
+	void MatLogReset(unsigned iSlot);
+	void MatLogAdd(unsigned iMat, unsigned iSlot,
+		const VariableSubMatrixHandler& WorkMat);
+	void MatLogAss(unsigned iSlot, Elem **ppFirst, Elem **ppEnd,
+		VariableSubMatrixHandler& WorkMatA,
+		VariableSubMatrixHandler& WorkMatB,
+		doublereal dCoef);
+	void MatLogSum(void);
+	void MatLogAssAll(MatrixHandler *pA_Hdl, MatrixHandler *pB_Hdl,
+		doublereal dCoef);
+
+	/*
+	 * Parallel per-step phases (BeforePredict, AfterPredict,
+	 * Update, AfterConvergence).
+	 *
+	 * Nodes are processed first, then elements, since elements
+	 * read the state of the nodes.  Nodes without degrees of freedom
+	 * (e.g. dummy nodes) compute their state from other nodes,
+	 * so they are processed by the main thread after the others.
+	 * Elements whose type is flagged MTSerial or MTSerialPhases
+	 * are processed by the main thread, in Elems order with respect
+	 * to the runs of the other elements, which are processed
+	 * in parallel one run after the other.
+	 *
+	 * The phases are const in DataManager, so the state
+	 * of the phases and of the thread pool is mutable.
+	 */
+	NodeVecType PhaseNodes;
+	NodeVecType SerialPhaseNodes;
+	ElemVecType PhaseElems;
+	ElemVecType SerialPhaseElems;
+
+	/* runs of consecutive elements in Elems,
+	 * in PhaseElems or in SerialPhaseElems */
+	struct PhaseRun {
+		bool bSerial;
+		unsigned iFirst;
+		unsigned iEnd;
+	};
+	std::vector<PhaseRun> PhaseRuns;
+
+	enum PhaseStage {
+		PHASE_NODES,
+		PHASE_ELEMS
+	};
+	mutable PhaseStage CurrPhaseStage;
+	mutable AO_t phase_next;
+	mutable unsigned iPhaseEnd;
+
+	/* BeforePredict() args */
+	mutable VectorHandler *pPhaseX;
+	mutable VectorHandler *pPhaseXP;
+	mutable VectorHandler *pPhaseXPrev;
+	mutable VectorHandler *pPhaseXPPrev;
+
+	/* RunTasks() args; tasks are claimed one at a time */
+	mutable void (*pTaskFunc)(void *, unsigned);
+	mutable void *pTaskData;
+	mutable unsigned nTaskEnd;
+	mutable AO_t task_next;
+
+	/* serial part of the assembly, done by the main thread */
+	void SerialAssJac(MatrixHandler& JacHdl, doublereal dCoef,
+		VariableSubMatrixHandler& WorkMat);
+
+	/*
+	 * Colored Jacobian assembly (MT_JAC_COLORING).
+	 *
+	 * The elements are greedily colored so that no two elements
+	 * of the same color write the same rows.  The rows of an element
+	 * are those of its own degrees of freedom and of those
+	 * of its connected nodes, plus any other row it wrote
+	 * in the serial assemblies that determine the sparsity pattern.
+	 * The elements of each color are then assembled concurrently
+	 * directly into the compact matrix, without per-thread copies
+	 * and without locks.  Elements that cannot be colored within
+	 * the available colors are assembled by the main thread.
+	 *
+	 * Before a colored element is added to the matrix, its rows
+	 * are checked; if it writes any other row (e.g. a joint
+	 * that becomes active), it is not added, and ErrRebuildMatrix
+	 * is thrown, so that the rows are recorded again and
+	 * the elements are colored again.
+	 */
+	std::vector<std::vector<integer> > ElemRows;
+	std::vector<std::vector<unsigned> > Colors;
+	std::vector<unsigned> UncoloredElems;
+	const std::vector<unsigned> *pCurrColor;
+	MatrixHandler *pColorJacHdl;
+	CompactSparseMatrixHandler *pColorCCJacHdl;
+	AO_t color_next;
+
+	void RowsAssJac(MatrixHandler& JacHdl, doublereal dCoef);
+	void ColorElems(void);
+	void ColorAssJac(MatrixHandler& JacHdl, doublereal dCoef);
+
 	/* per-thread specific data */
 	struct ThreadData {
 		MultiThreadDataManager *pDM;
 		integer threadNumber;
 		pthread_t thread;
-		sem_t sem;
+		AO_t op_gen;
 		clock_t	cputime;
 
-		mutable MT_VecIter<Elem *> ElemIter;
+		/* wall-clock time spent within and between operations */
+		doublereal dBusyTime;
+		doublereal dIdleTime;
+		unsigned long uNumOps;
+
+		mutable ElemChunkIter ElemIter;
 	
 		VariableSubMatrixHandler *pWorkMatA;	/* Working SubMatrix */
 		VariableSubMatrixHandler *pWorkMatB;
@@ -90,42 +350,91 @@ protected:
 		MatrixHandler* pMatA;
 		MatrixHandler* pMatB;
 		doublereal dCoef;
+
+		/* chunk of elements being assembled in the residual
+		 * phase, plus one; 0 otherwise, see GetChunkSlot() */
+		unsigned uChunkSlot;
+
+#ifdef MBDYN_MT_EXCEPTION_PTR
+		/* first exception caught in the current op,
+		 * see CaughtException() */
+		std::exception_ptr pException;
+		unsigned uExceptionKey;
+#endif /* MBDYN_MT_EXCEPTION_PTR */
 	} *thread_data;
 
 	enum DataManagerOp {
 		OP_UNKNOWN = -1,
 
 		OP_ASSJAC_CC,
+		OP_SUM_CC,
+		OP_ASSJAC_COLOR,
 
 		OP_ASSJAC_NAIVE,
 		OP_SUM_NAIVE,
 
-		/* used only #ifdef MBDYN_X_MT_ASSRES */
 		OP_ASSRES,
+		OP_SUM_RES,
 
-		/* not used yet */
+		OP_ASSJAC_LOG,
 		OP_ASSMATS,
+		OP_SUM_MATS,
+
 		OP_BEFOREPREDICT,
 		OP_AFTERPREDICT,
+		OP_UPDATE,
 		OP_AFTERCONVERGENCE,
-		/* end of not used yet */
+
+		OP_TASKS,
 
 		OP_EXIT,
 
 		LAST_OP
-	} op;
+	};
+	mutable DataManagerOp op;
+
+	/* number of helper threads still busy with the current op */
+	mutable AO_t thread_count;
+
+	/* signalled by the last helper thread that completes an op */
+	mutable pthread_mutex_t	thread_mutex;
+	mutable pthread_cond_t	thread_cond;
 
-	/* will be replaced by barriers ... */
-	unsigned thread_count;
+	/* incremented any time a new op is started;
+	 * the helper threads spin on it for a while, then park */
+	mutable AO_t op_gen;
+	mutable pthread_mutex_t	op_mutex;
+	mutable pthread_cond_t	op_cond;
 
-	/* this can be replaced by a barrier ... */
-	pthread_mutex_t	thread_mutex;
-	pthread_cond_t	thread_cond;
+	/* time the main thread started the current op */
+	mutable doublereal dOpStartTime;
 
 	/* this is used to propagate ErrMatrixRebuild ... */
 	AO_TS_t	propagate_ErrMatrixRebuild;
 
+	/* these are used to propagate errors
+	 * from the residual assembly ... */
+	AO_TS_t	propagate_ChangedEquationStructure;
+	mutable AO_TS_t	propagate_ErrDivideByZero;
+	mutable AO_TS_t	propagate_ErrGeneric;
+
+	/*
+	 * any other exception caught while running an op is recorded
+	 * by the thread that caught it, with the position (uKey) of
+	 * the item that threw; after the op, the main thread rethrows
+	 * the one with the lowest position, with its own type
+	 * (without std::exception_ptr, only ErrDivideByZero keeps
+	 * its type, the others are thrown as ErrGeneric)
+	 */
+	void ClearExceptions(void) const;
+	void CaughtException(unsigned uKey) const;
+	void RethrowException(void) const;
+
+	/* start an op on all helper threads, and wait for its completion */
+	void StartOp(DataManagerOp o) const;
+	void WaitForOp(ThreadData *arg);
 	void EndOfOp(void);
+	void WaitForThreads(void) const;
 
 	/* thread function */
 	static void *thread(void *arg);
@@ -135,6 +444,27 @@ protected:
 	void ThreadSpawn(void);
 	clock_t ThreadDestroy(void);
 
+	/* parallel sum of the per-thread CC matrices,
+	 * by slices of the nonzeros (flat or by tree levels) */
+	std::vector<doublereal *> CCSumMats;
+	integer iCCSumNz;
+	unsigned uCCSumDist;
+
+	void CCSum(CompactSparseMatrixHandler& JacHdl);
+	void CCSumPart(ThreadData *arg);
+
+	/* colored assembly of the current color, see ColorAssJac() */
+	void ColorAssJacPart(ThreadData *arg);
+
+	/* per-step phases */
+	void PhaseNode(DataManagerOp o, Node *pN) const;
+	void PhaseElem(DataManagerOp o, Elem *pE) const;
+	void PhasePart(DataManagerOp o) const;
+	void Phase(DataManagerOp o) const;
+
+	/* generic tasks */
+	void TaskPart(void) const;
+
 	/* specialized assembly */
 	virtual void CCAssJac(MatrixHandler& JacHdl, doublereal dCoef);
 	virtual void NaiveAssJac(MatrixHandler& JacHdl, doublereal dCoef);
@@ -155,14 +485,36 @@ public:
 	/* Assembla lo jacobiano */
 	virtual void AssJac(MatrixHandler& JacHdl, doublereal dCoef);
 
-#ifdef MBDYN_X_MT_ASSRES
+	/* Assembla le matrici per gli autovalori */
+	virtual void AssMats(MatrixHandler& A_Hdl, MatrixHandler& B_Hdl);
+
 	/* Assembla il residuo */
 	virtual void AssRes(VectorHandler &ResHdl, doublereal dCoef)
 		throw(ChangedEquationStructure);
-#endif /* MBDYN_X_MT_ASSRES */
+
+	/* Funzioni di aggiornamento dati durante la simulazione */
+	using DataManager::Update;
+	virtual void BeforePredict(VectorHandler& X, VectorHandler& XP,
+			VectorHandler& XPrev, VectorHandler& XPPrev) const;
+	virtual void AfterPredict(void) const;
+	virtual void Update(void) const;
+	virtual void AfterConvergence(void) const;
+
+	virtual void RunTasks(void (*pTask)(void *, unsigned),
+			void *pData, unsigned nTasks) const;
 
 	/* additional CPU time, if any */
 	virtual clock_t GetCPUTime(void) const;
+
+	/* slot of the chunk of elements the calling thread is assembling
+	 * in the parallel residual phase (chunk + 1; 0 for the serial
+	 * elements, and outside of it), and number of slots, for elements
+	 * that keep partial results of the others; partials reduced
+	 * in slot order give the same result from run to run, with the
+	 * same number of threads; they are grouped differently from
+	 * the single-threaded sum, which may differ in the last bits */
+	static unsigned GetChunkSlot(void);
+	static unsigned GetNumChunkSlots(void);
 };
 
 /* MultiThreadDataManager - end */
@@ -0,0 +1,1198 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2014
+ *
+ * Pierangelo Masarati	<masarati@aero.polimi.it>
+ * Paolo Mantegazza	<mantegazza@aero.polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <time.h>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <queue>
+
+#include "ac/sys_sysinfo.h"
+#include "mtluwrap.h"
+#include "dataman.h"
+
+static doublereal
+mtlu_wall_time(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return doublereal(ts.tv_sec) + 1e-9*doublereal(ts.tv_nsec);
+}
+
+/* refinement defaults with double and single precision factors */
+static const integer MTLU_MAX_REFINE = 3;
+static const doublereal MTLU_REFINE_TOL = 1.e-12;
+static const integer MTLU_MAX_REFINE_MIXED = 10;
+static const doublereal MTLU_REFINE_TOL_MIXED = 1.e-14;
+
+/* MTLUSolutionManager - begin */
+
+MTLUSolutionManager::Params::Params(void)
+: nThreads(0),
+dPivotTol(std::sqrt(std::numeric_limits<doublereal>::epsilon())),
+iMaxRefine(-1),
+dRefineTol(-1.),
+bMixed(false),
+bVerbose(false)
+{
+	NO_OP;
+}
+
+MTLUSolutionManager::MTLUSolutionManager(integer Dim, const Params& p)
+: iSize(Dim),
+P(p),
+nThreads(p.nThreads),
+A(Dim),
+pAc(0),
+bCCReady(false),
+pPatDM(0),
+uCCGen(0),
+x(Dim),
+b(Dim),
+xVH(Dim, Dim ? &x[0] : 0),
+bVH(Dim, Dim ? &b[0] : 0),
+bSymbolic(false),
+bFactored(false),
+Y(Dim),
+R(Dim),
+bSingle(p.bMixed),
+dANorm(0.),
+uCurrPerturbed(0),
+iCurrPerturbed(-1),
+uSymbolic(0),
+uNumeric(0),
+uPivotRepl(0),
+uRefineSteps(0),
+uFallbacks(0),
+dSymbolicTime(0.),
+dNumericTime(0.),
+dSolveTime(0.)
+{
+#ifdef USE_MULTITHREAD
+	if (nThreads == 0) {
+		nThreads = get_nprocs();
+	}
+#else /* ! USE_MULTITHREAD */
+	nThreads = 1;
+#endif /* ! USE_MULTITHREAD */
+	if (nThreads < 1) {
+		nThreads = 1;
+	}
+
+	Work.resize(nThreads, std::vector<doublereal>(Dim, 0.));
+	uPerturbed.resize(nThreads, 0);
+	iFirstPerturbed.resize(nThreads, -1);
+
+#ifdef USE_MULTITHREAD
+	if (nThreads > 1) {
+		ThreadStart();
+	}
+#endif /* USE_MULTITHREAD */
+}
+
+MTLUSolutionManager::~MTLUSolutionManager(void)
+{
+#ifdef USE_MULTITHREAD
+	if (nThreads > 1) {
+		ThreadDestroy();
+	}
+#endif /* USE_MULTITHREAD */
+
+	if (P.bVerbose && uNumeric > 0) {
+		silent_cout("threaded LU (" << nThreads << " threads): "
+			<< uSymbolic << " symbolic analyses (" << dSymbolicTime << " s), "
+			<< uNumeric << " factorizations (" << dNumericTime << " s), "
+			"solve " << dSolveTime << " s, "
+			"fill " << (2*Lp[iSize] + iSize) << " nonzeros "
+			"in " << (bSingle ? "single" : "double") << " precision, "
+			<< uPivotRepl << " pivots replaced, "
+			<< uRefineSteps << " refinement steps, "
+			<< uFallbacks << " fallbacks to double precision"
+			<< std::endl);
+	}
+
+	if (pAc) {
+		SAFEDELETE(pAc);
+	}
+}
+
+#ifdef USE_MULTITHREAD
+void *
+MTLUSolutionManager::thread(void *arg)
+{
+	ThreadData *pTD = (ThreadData *)arg;
+	MTLUSolutionManager *pSM = pTD->pSM;
+	unsigned uGen = 0;
+
+	for (;;) {
+		pthread_mutex_lock(&pSM->thread_mutex);
+		while (pSM->uGeneration == uGen) {
+			pthread_cond_wait(&pSM->thread_start, &pSM->thread_mutex);
+		}
+		uGen = pSM->uGeneration;
+		Op op = pSM->CurrOp;
+		doublereal *pd = pSM->pdCurrVec;
+		pthread_mutex_unlock(&pSM->thread_mutex);
+
+		if (op == OP_EXIT) {
+			break;
+		}
+
+		pSM->DoOp(op, pTD->uId, pd);
+
+		pthread_mutex_lock(&pSM->thread_mutex);
+		if (--pSM->uPending == 0) {
+			pthread_cond_signal(&pSM->thread_done);
+		}
+		pthread_mutex_unlock(&pSM->thread_mutex);
+	}
+
+	return NULL;
+}
+
+void
+MTLUSolutionManager::ThreadStart(void)
+{
+	pthread_mutex_init(&thread_mutex, NULL);
+	pthread_cond_init(&thread_start, NULL);
+	pthread_cond_init(&thread_done, NULL);
+	CurrOp = OP_EXIT;
+	uGeneration = 0;
+	uPending = 0;
+	pdCurrVec = 0;
+
+	thread_data.resize(nThreads);
+	for (unsigned i = 1; i < nThreads; i++) {
+		thread_data[i].pSM = this;
+		thread_data[i].uId = i;
+
+		if (pthread_create(&thread_data[i].thread, NULL, thread,
+			&thread_data[i]) != 0)
+		{
+			silent_cerr("pthread_create() failed "
+				"for threaded LU thread " << i
+				<< " of " << nThreads << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+	}
+}
+
+void
+MTLUSolutionManager::ThreadDestroy(void)
+{
+	pthread_mutex_lock(&thread_mutex);
+	CurrOp = OP_EXIT;
+	uGeneration++;
+	pthread_cond_broadcast(&thread_start);
+	pthread_mutex_unlock(&thread_mutex);
+
+	for (unsigned i = 1; i < nThreads; i++) {
+		pthread_join(thread_data[i].thread, NULL);
+	}
+
+	pthread_cond_destroy(&thread_done);
+	pthread_cond_destroy(&thread_start);
+	pthread_mutex_destroy(&thread_mutex);
+}
+
+/* dispatches op to the helper threads, performs the share
+ * of thread 0 and waits for the others to complete */
+void
+MTLUSolutionManager::Run(Op op, doublereal *pd)
+{
+	pthread_mutex_lock(&thread_mutex);
+	CurrOp = op;
+	pdCurrVec = pd;
+	uPending = nThreads - 1;
+	uGeneration++;
+	pthread_cond_broadcast(&thread_start);
+	pthread_mutex_unlock(&thread_mutex);
+
+	DoOp(op, 0, pd);
+
+	pthread_mutex_lock(&thread_mutex);
+	while (uPending > 0) {
+		pthread_cond_wait(&thread_done, &thread_mutex);
+	}
+	pthread_mutex_unlock(&thread_mutex);
+}
+
+void
+MTLUSolutionManager::DoOp(Op op, unsigned uId, doublereal *pd)
+{
+	switch (op) {
+	case OP_FACTOR:
+		FactorRange(uId);
+		break;
+
+	case OP_FORWARD:
+		ForwardRange(uId, pd);
+		break;
+
+	case OP_BACKWARD:
+		BackwardRange(uId, pd);
+		break;
+
+	default:
+		break;
+	}
+}
+#endif /* USE_MULTITHREAD */
+
+/* doubly linked degree lists */
+static void
+mtlu_list_insert(std::vector<integer>& Head, std::vector<integer>& Next,
+	std::vector<integer>& Prev, integer k, integer i)
+{
+	Prev[i] = -1;
+	Next[i] = Head[k];
+	if (Head[k] != -1) {
+		Prev[Head[k]] = i;
+	}
+	Head[k] = i;
+}
+
+static void
+mtlu_list_remove(std::vector<integer>& Head, std::vector<integer>& Next,
+	std::vector<integer>& Prev, integer k, integer i)
+{
+	if (Prev[i] != -1) {
+		Next[Prev[i]] = Next[i];
+
+	} else {
+		Head[k] = Next[i];
+	}
+
+	if (Next[i] != -1) {
+		Prev[Next[i]] = Prev[i];
+	}
+}
+
+/*
+ * Approximate minimum degree ordering of the graph of A + A^T,
+ * on the quotient graph: each eliminated node becomes an element
+ * that stands for the clique of its uneliminated neighbors, so
+ * the storage never grows beyond that of the graph, and the elements
+ * covered by a newer one are absorbed.  The degree of the nodes
+ * of the new element L_p is replaced by the upper bound
+ * |A_i| + |L_p \ i| + sum_e |L_e \ L_p| (Amestoy, Davis and Duff).
+ * Nodes with a zero diagonal coefficient
+ * (e.g. the multipliers of algebraic constraints) are not eligible
+ * until one of their neighbors has been eliminated, since
+ * the elimination fills their diagonal.
+ */
+void
+MTLUSolutionManager::MinimumDegree(std::vector<integer>& Order) const
+{
+	const integer n = iSize;
+	std::vector<std::vector<integer> > Adj(n);
+	std::vector<bool> bDefer(n, true);
+
+	for (integer c = 0; c < n; c++) {
+		for (integer p = Ap[c]; p < Ap[c + 1]; p++) {
+			integer r = Ai[p];
+			if (r == c) {
+				if (Ax[p] != 0.) {
+					bDefer[c] = false;
+				}
+				continue;
+			}
+			Adj[r].push_back(c);
+			Adj[c].push_back(r);
+		}
+	}
+
+	/* degree lists, indexed by degree (+ n if deferred) */
+	std::vector<integer> Deg(n), Key(n);
+	std::vector<integer> Head(2*n, -1), Next(n, -1), Prev(n, -1);
+	integer iMinKey = 2*n;
+	for (integer i = n - 1; i >= 0; i--) {
+		std::sort(Adj[i].begin(), Adj[i].end());
+		Adj[i].erase(std::unique(Adj[i].begin(), Adj[i].end()), Adj[i].end());
+		Deg[i] = Adj[i].size();
+		Key[i] = Deg[i] + (bDefer[i] ? n : 0);
+		mtlu_list_insert(Head, Next, Prev, Key[i], i);
+		iMinKey = std::min(iMinKey, Key[i]);
+	}
+
+	/* elements adjacent to each node, and nodes of each element */
+	enum { VARIABLE, ELEMENT, ABSORBED };
+	std::vector<char> Status(n, VARIABLE);
+	std::vector<std::vector<integer> > Elt(n);
+	std::vector<std::vector<integer> > Lv(n);
+
+	/* Mark[i] == p if i is in L_p; W[e] = |L_e \ L_p| if WMark[e] == p */
+	std::vector<integer> Mark(n, -1);
+	std::vector<integer> W(n, 0), WMark(n, -1);
+	/* L_p of the element being formed (not the member Lp) */
+	std::vector<integer> Lnext;
+
+	Order.clear();
+	Order.reserve(n);
+
+	for (integer k = 0; k < n; k++) {
+		while (Head[iMinKey] == -1) {
+			iMinKey++;
+		}
+		integer p = Head[iMinKey];
+		mtlu_list_remove(Head, Next, Prev, iMinKey, p);
+		Order.push_back(p);
+
+		/* the new element: the neighbors of p,
+		 * and the nodes of the elements it absorbs */
+		Lnext.clear();
+		Mark[p] = p;
+		for (std::vector<integer>::const_iterator j = Adj[p].begin(); j != Adj[p].end(); ++j) {
+			if (Status[*j] == VARIABLE && Mark[*j] != p) {
+				Mark[*j] = p;
+				Lnext.push_back(*j);
+			}
+		}
+		for (std::vector<integer>::const_iterator e = Elt[p].begin(); e != Elt[p].end(); ++e) {
+			if (Status[*e] != ELEMENT) {
+				continue;
+			}
+			for (std::vector<integer>::const_iterator j = Lv[*e].begin(); j != Lv[*e].end(); ++j) {
+				if (Mark[*j] != p) {
+					Mark[*j] = p;
+					Lnext.push_back(*j);
+				}
+			}
+			Status[*e] = ABSORBED;
+			std::vector<integer>().swap(Lv[*e]);
+		}
+		Status[p] = ELEMENT;
+		std::vector<integer>().swap(Adj[p]);
+		std::vector<integer>().swap(Elt[p]);
+
+		/* |L_e \ L_p| for the other elements adjacent to L_p;
+		 * their nodes are all uneliminated, since the elements
+		 * of an eliminated node are absorbed */
+		for (std::vector<integer>::const_iterator i = Lnext.begin(); i != Lnext.end(); ++i) {
+			for (std::vector<integer>::const_iterator e = Elt[*i].begin(); e != Elt[*i].end(); ++e) {
+				if (Status[*e] != ELEMENT) {
+					continue;
+				}
+				if (WMark[*e] != p) {
+					WMark[*e] = p;
+					W[*e] = Lv[*e].size();
+				}
+				W[*e]--;
+			}
+		}
+
+		const integer iLnext = Lnext.size();
+		for (std::vector<integer>::const_iterator i = Lnext.begin(); i != Lnext.end(); ++i) {
+			mtlu_list_remove(Head, Next, Prev, Key[*i], *i);
+
+			integer d = iLnext - 1;
+
+			/* elements contained in L_p are absorbed */
+			std::vector<integer>& E = Elt[*i];
+			std::vector<integer>::size_type q = 0;
+			for (std::vector<integer>::size_type r = 0; r < E.size(); r++) {
+				integer e = E[r];
+				if (Status[e] != ELEMENT) {
+					continue;
+				}
+				if (W[e] == 0) {
+					Status[e] = ABSORBED;
+					std::vector<integer>().swap(Lv[e]);
+					continue;
+				}
+				d += W[e];
+				E[q++] = e;
+			}
+			E.resize(q);
+			E.push_back(p);
+
+			/* the neighbors in L_p are now reached through p */
+			std::vector<integer>& V = Adj[*i];
+			q = 0;
+			for (std::vector<integer>::size_type r = 0; r < V.size(); r++) {
+				integer j = V[r];
+				if (Status[j] == VARIABLE && Mark[j] != p) {
+					V[q++] = j;
+				}
+			}
+			V.resize(q);
+			d += integer(q);
+
+			d = std::min(d, Deg[*i] + iLnext - 1);
+			d = std::min(d, n - k - 2);
+			Deg[*i] = d;
+			Key[*i] = d;
+			bDefer[*i] = false;
+			mtlu_list_insert(Head, Next, Prev, Key[*i], *i);
+			iMinKey = std::min(iMinKey, Key[*i]);
+		}
+
+		Lv[p].swap(Lnext);
+	}
+}
+
+/* for each column i of the permuted A + A^T, the rows k < i */
+void
+MTLUSolutionManager::LowerPattern(std::vector<integer>& Sp, std::vector<integer>& Si) const
+{
+	const integer n = iSize;
+
+	Sp.assign(n + 1, 0);
+	for (integer c = 0; c < n; c++) {
+		for (integer p = Ap[c]; p < Ap[c + 1]; p++) {
+			if (Ai[p] != c) {
+				Sp[std::max(IPerm[Ai[p]], IPerm[c]) + 1]++;
+			}
+		}
+	}
+
+	for (integer i = 0; i < n; i++) {
+		Sp[i + 1] += Sp[i];
+	}
+
+	std::vector<integer> Next(Sp.begin(), Sp.end() - 1);
+	Si.resize(Sp[n]);
+	for (integer c = 0; c < n; c++) {
+		for (integer p = Ap[c]; p < Ap[c + 1]; p++) {
+			if (Ai[p] != c) {
+				integer r = IPerm[Ai[p]];
+				integer k = IPerm[c];
+				if (r > k) {
+					std::swap(r, k);
+				}
+				Si[Next[k]++] = r;
+			}
+		}
+	}
+}
+
+/* elimination tree of the permuted A + A^T (Liu's algorithm) */
+void
+MTLUSolutionManager::EliminationTree(const std::vector<integer>& Sp,
+	const std::vector<integer>& Si)
+{
+	const integer n = iSize;
+	std::vector<integer> Anc(n);
+
+	Parent.resize(n);
+	for (integer i = 0; i < n; i++) {
+		Parent[i] = -1;
+		Anc[i] = -1;
+		for (integer p = Sp[i]; p < Sp[i + 1]; p++) {
+			integer inext;
+			for (integer k = Si[p]; k != -1 && k < i; k = inext) {
+				inext = Anc[k];
+				Anc[k] = i;
+				if (inext == -1) {
+					Parent[k] = i;
+				}
+			}
+		}
+	}
+}
+
+void
+MTLUSolutionManager::Symbolic(void)
+{
+	doublereal dStart = mtlu_wall_time();
+	const integer n = iSize;
+
+	SymAi = Ai;
+	SymAp = Ap;
+
+	/* fill-reducing ordering */
+	MinimumDegree(Perm);
+	IPerm.resize(n);
+	for (integer i = 0; i < n; i++) {
+		IPerm[Perm[i]] = i;
+	}
+
+	std::vector<integer> Sp, Si;
+	LowerPattern(Sp, Si);
+	EliminationTree(Sp, Si);
+
+	/* postorder, so that each subtree is a contiguous range */
+	std::vector<integer> Head(n, -1), Next(n, -1);
+	for (integer j = n - 1; j >= 0; j--) {
+		if (Parent[j] != -1) {
+			Next[j] = Head[Parent[j]];
+			Head[Parent[j]] = j;
+		}
+	}
+
+	std::vector<integer> Post, Stack;
+	Post.reserve(n);
+	for (integer j = 0; j < n; j++) {
+		if (Parent[j] != -1) {
+			continue;
+		}
+
+		Stack.push_back(j);
+		while (!Stack.empty()) {
+			integer t = Stack.back();
+			integer c = Head[t];
+			if (c == -1) {
+				Post.push_back(t);
+				Stack.pop_back();
+
+			} else {
+				Head[t] = Next[c];
+				Stack.push_back(c);
+			}
+		}
+	}
+
+	std::vector<integer> OldPerm(Perm);
+	for (integer k = 0; k < n; k++) {
+		Perm[k] = OldPerm[Post[k]];
+		IPerm[Perm[k]] = k;
+	}
+
+	LowerPattern(Sp, Si);
+	EliminationTree(Sp, Si);
+
+	/* rows of L: row subtrees in the elimination tree */
+	std::vector<integer> Mark(n, -1);
+	Rp.resize(n + 1);
+	Rj.clear();
+	for (integer i = 0; i < n; i++) {
+		Rp[i] = Rj.size();
+		Mark[i] = i;
+		for (integer p = Sp[i]; p < Sp[i + 1]; p++) {
+			for (integer k = Si[p]; Mark[k] != i; k = Parent[k]) {
+				Rj.push_back(k);
+				Mark[k] = i;
+			}
+		}
+		std::sort(Rj.begin() + Rp[i], Rj.end());
+	}
+	Rp[n] = Rj.size();
+
+	/* columns of L */
+	Lp.assign(n + 1, 0);
+	for (std::vector<integer>::const_iterator k = Rj.begin(); k != Rj.end(); ++k) {
+		Lp[*k + 1]++;
+	}
+	for (integer k = 0; k < n; k++) {
+		Lp[k + 1] += Lp[k];
+	}
+
+	std::vector<integer> LNext(Lp.begin(), Lp.end() - 1);
+	Li.resize(Lp[n]);
+	RPos.resize(Rp[n]);
+	for (integer i = 0; i < n; i++) {
+		for (integer q = Rp[i]; q < Rp[i + 1]; q++) {
+			integer p = LNext[Rj[q]]++;
+			Li[p] = i;
+			RPos[q] = p;
+		}
+	}
+
+	/* split the elimination tree in independent subtrees */
+	Ranges.assign(nThreads, std::vector<integer>());
+	Top.clear();
+	if (nThreads == 1 || n == 0) {
+		if (n > 0) {
+			Ranges[0].push_back(0);
+			Ranges[0].push_back(n - 1);
+		}
+
+	} else {
+		/* estimated cost of each subtree */
+		std::vector<doublereal> W(n);
+		std::vector<integer> First(n);
+		for (integer j = 0; j < n; j++) {
+			W[j] += 1 + Lp[j + 1] - Lp[j];
+			for (integer q = Rp[j]; q < Rp[j + 1]; q++) {
+				W[j] += Lp[Rj[q] + 1] - Lp[Rj[q]];
+			}
+			First[j] = j;
+		}
+
+		doublereal dTotal = 0.;
+		for (integer j = 0; j < n; j++) {
+			if (Parent[j] != -1) {
+				W[Parent[j]] += W[j];
+				First[Parent[j]] = std::min(First[Parent[j]], First[j]);
+
+			} else {
+				dTotal += W[j];
+			}
+		}
+
+		std::fill(Head.begin(), Head.end(), -1);
+		for (integer j = n - 1; j >= 0; j--) {
+			if (Parent[j] != -1) {
+				Next[j] = Head[Parent[j]];
+				Head[Parent[j]] = j;
+			}
+		}
+
+		/* descend from the roots, moving the heaviest subtrees
+		 * to the top part until all are small enough */
+		std::priority_queue<std::pair<doublereal, integer> > Q;
+		for (integer j = 0; j < n; j++) {
+			if (Parent[j] == -1) {
+				Q.push(std::make_pair(W[j], j));
+			}
+		}
+
+		const doublereal dMaxSub = dTotal/(4*nThreads);
+		std::vector<bool> bTop(n, false);
+		std::vector<std::pair<doublereal, integer> > Sub;
+		while (!Q.empty()) {
+			std::pair<doublereal, integer> t = Q.top();
+			if (t.first <= dMaxSub) {
+				break;
+			}
+			Q.pop();
+
+			if (Head[t.second] == -1) {
+				Sub.push_back(t);
+				continue;
+			}
+
+			bTop[t.second] = true;
+			for (integer c = Head[t.second]; c != -1; c = Next[c]) {
+				Q.push(std::make_pair(W[c], c));
+			}
+		}
+
+		for (; !Q.empty(); Q.pop()) {
+			Sub.push_back(Q.top());
+		}
+
+		/* largest first to the least loaded thread */
+		std::sort(Sub.begin(), Sub.end());
+		std::vector<doublereal> Load(nThreads, 0.);
+		for (integer s = Sub.size() - 1; s >= 0; s--) {
+			unsigned t = std::min_element(Load.begin(), Load.end()) - Load.begin();
+			Ranges[t].push_back(First[Sub[s].second]);
+			Ranges[t].push_back(Sub[s].second);
+			Load[t] += Sub[s].first;
+		}
+
+		for (integer j = 0; j < n; j++) {
+			if (bTop[j]) {
+				Top.push_back(j);
+			}
+		}
+	}
+
+	bSymbolic = true;
+	uSymbolic++;
+	dSymbolicTime += mtlu_wall_time() - dStart;
+}
+
+template <class T>
+void
+MTLUSolutionManager::Factors<T>::Resize(integer iNz, integer iSize)
+{
+	Lx.resize(iNz);
+	Ux.resize(iNz);
+	D.resize(iSize);
+}
+
+template <class T>
+void
+MTLUSolutionManager::Factors<T>::Clear(void)
+{
+	std::vector<T>().swap(Lx);
+	std::vector<T>().swap(Ux);
+	std::vector<T>().swap(D);
+}
+
+/*
+ * Left-looking computation of column j of L and of U;
+ * the columns k of L it needs are in the subtree of j,
+ * so they are complete when the subtree has been processed.
+ * The work vector is in double precision regardless of T.
+ */
+template <class T>
+void
+MTLUSolutionManager::FactorColumn(integer j, unsigned uId, Factors<T>& F)
+{
+	doublereal *w = &Work[uId][0];
+	const integer o = Perm[j];
+
+	doublereal dMax = 0.;
+	for (integer p = Ap[o]; p < Ap[o + 1]; p++) {
+		w[IPerm[Ai[p]]] = Ax[p];
+		dMax = std::max(dMax, std::abs(Ax[p]));
+	}
+
+	for (integer q = Rp[j]; q < Rp[j + 1]; q++) {
+		integer k = Rj[q];
+		doublereal xk = w[k];
+		w[k] = 0.;
+		F.Ux[RPos[q]] = xk;
+		if (xk != 0.) {
+			for (integer p = Lp[k]; p < Lp[k + 1]; p++) {
+				w[Li[p]] -= F.Lx[p]*xk;
+			}
+		}
+	}
+
+	doublereal d = w[j];
+	w[j] = 0.;
+
+	/* static pivot replacement */
+	const doublereal dMin = P.dPivotTol*(dMax > 0. ? dMax : 1.);
+	if (std::abs(d) < dMin) {
+		d = (d < 0. ? -dMin : dMin);
+		if (uPerturbed[uId]++ == 0) {
+			iFirstPerturbed[uId] = j;
+		}
+	}
+	F.D[j] = d;
+
+	for (integer p = Lp[j]; p < Lp[j + 1]; p++) {
+		F.Lx[p] = w[Li[p]]/d;
+		w[Li[p]] = 0.;
+	}
+}
+
+template <class T>
+void
+MTLUSolutionManager::ForwardRow(integer i, doublereal *py, const Factors<T>& F) const
+{
+	doublereal s = py[i];
+	for (integer q = Rp[i]; q < Rp[i + 1]; q++) {
+		s -= F.Lx[RPos[q]]*py[Rj[q]];
+	}
+	py[i] = s;
+}
+
+template <class T>
+void
+MTLUSolutionManager::BackwardRow(integer k, doublereal *py, const Factors<T>& F) const
+{
+	doublereal s = py[k];
+	for (integer p = Lp[k]; p < Lp[k + 1]; p++) {
+		s -= F.Ux[p]*py[Li[p]];
+	}
+	py[k] = s/F.D[k];
+}
+
+template <class T>
+void
+MTLUSolutionManager::FactorRange(unsigned uId, Factors<T>& F)
+{
+	const std::vector<integer>& r = Ranges[uId];
+	for (unsigned s = 0; s < r.size(); s += 2) {
+		for (integer j = r[s]; j <= r[s + 1]; j++) {
+			FactorColumn(j, uId, F);
+		}
+	}
+}
+
+template <class T>
+void
+MTLUSolutionManager::ForwardRange(unsigned uId, doublereal *py, const Factors<T>& F) const
+{
+	const std::vector<integer>& r = Ranges[uId];
+	for (unsigned s = 0; s < r.size(); s += 2) {
+		for (integer i = r[s]; i <= r[s + 1]; i++) {
+			ForwardRow(i, py, F);
+		}
+	}
+}
+
+template <class T>
+void
+MTLUSolutionManager::BackwardRange(unsigned uId, doublereal *py, const Factors<T>& F) const
+{
+	const std::vector<integer>& r = Ranges[uId];
+	for (unsigned s = 0; s < r.size(); s += 2) {
+		for (integer k = r[s + 1]; k >= r[s]; k--) {
+			BackwardRow(k, py, F);
+		}
+	}
+}
+
+void
+MTLUSolutionManager::FactorRange(unsigned uId)
+{
+	if (bSingle) {
+		FactorRange(uId, SF);
+
+	} else {
+		FactorRange(uId, DF);
+	}
+}
+
+void
+MTLUSolutionManager::ForwardRange(unsigned uId, doublereal *py) const
+{
+	if (bSingle) {
+		ForwardRange(uId, py, SF);
+
+	} else {
+		ForwardRange(uId, py, DF);
+	}
+}
+
+void
+MTLUSolutionManager::BackwardRange(unsigned uId, doublereal *py) const
+{
+	if (bSingle) {
+		BackwardRange(uId, py, SF);
+
+	} else {
+		BackwardRange(uId, py, DF);
+	}
+}
+
+void
+MTLUSolutionManager::Factor(void)
+{
+	doublereal dStart = mtlu_wall_time();
+
+	std::fill(uPerturbed.begin(), uPerturbed.end(), 0);
+	std::fill(iFirstPerturbed.begin(), iFirstPerturbed.end(), -1);
+
+	/* only the factors in the current precision are kept */
+	if (bSingle) {
+		DF.Clear();
+		SF.Resize(Lp[iSize], iSize);
+
+	} else {
+		SF.Clear();
+		DF.Resize(Lp[iSize], iSize);
+	}
+
+#ifdef USE_MULTITHREAD
+	if (nThreads > 1) {
+		Run(OP_FACTOR, 0);
+	} else
+#endif /* USE_MULTITHREAD */
+	{
+		FactorRange(0);
+	}
+
+	for (std::vector<integer>::const_iterator j = Top.begin(); j != Top.end(); ++j) {
+		if (bSingle) {
+			FactorColumn(*j, 0, SF);
+
+		} else {
+			FactorColumn(*j, 0, DF);
+		}
+	}
+
+	uCurrPerturbed = 0;
+	iCurrPerturbed = -1;
+	for (unsigned t = 0; t < nThreads; t++) {
+		uCurrPerturbed += uPerturbed[t];
+		if (iFirstPerturbed[t] != -1
+			&& (iCurrPerturbed == -1 || iFirstPerturbed[t] < iCurrPerturbed))
+		{
+			iCurrPerturbed = iFirstPerturbed[t];
+		}
+	}
+	uPivotRepl += uCurrPerturbed;
+
+	/* infinity norm of the matrix, for the refinement test */
+	std::fill(R.begin(), R.end(), 0.);
+	for (std::vector<doublereal>::size_type p = 0; p < Ai.size(); p++) {
+		R[Ai[p]] += std::abs(Ax[p]);
+	}
+	dANorm = 0.;
+	for (integer i = 0; i < iSize; i++) {
+		dANorm = std::max(dANorm, R[i]);
+	}
+
+	bFactored = true;
+	uNumeric++;
+	dNumericTime += mtlu_wall_time() - dStart;
+}
+
+/* solves L U y = y in place, in the permuted ordering */
+template <class T>
+void
+MTLUSolutionManager::SolvePerm(doublereal *py, const Factors<T>& F)
+{
+#ifdef USE_MULTITHREAD
+	if (nThreads > 1) {
+		Run(OP_FORWARD, py);
+	} else
+#endif /* USE_MULTITHREAD */
+	{
+		ForwardRange(0, py, F);
+	}
+
+	for (std::vector<integer>::const_iterator i = Top.begin(); i != Top.end(); ++i) {
+		ForwardRow(*i, py, F);
+	}
+
+	for (std::vector<integer>::const_reverse_iterator k = Top.rbegin(); k != Top.rend(); ++k) {
+		BackwardRow(*k, py, F);
+	}
+
+#ifdef USE_MULTITHREAD
+	if (nThreads > 1) {
+		Run(OP_BACKWARD, py);
+	} else
+#endif /* USE_MULTITHREAD */
+	{
+		BackwardRange(0, py, F);
+	}
+}
+
+/* x += (LU)^-1 r */
+void
+MTLUSolutionManager::SolveAdd(const std::vector<doublereal>& r, bool bInit)
+{
+	const integer n = iSize;
+
+	if (n == 0) {
+		return;
+	}
+
+	for (integer i = 0; i < n; i++) {
+		Y[i] = r[Perm[i]];
+	}
+
+	if (bSingle) {
+		SolvePerm(&Y[0], SF);
+
+	} else {
+		SolvePerm(&Y[0], DF);
+	}
+
+	if (bInit) {
+		for (integer i = 0; i < n; i++) {
+			x[Perm[i]] = Y[i];
+		}
+
+	} else {
+		for (integer i = 0; i < n; i++) {
+			x[Perm[i]] += Y[i];
+		}
+	}
+}
+
+/*
+ * Iterative refinement against the double precision matrix,
+ * until the normwise backward error is below the tolerance;
+ * returns false if it stalls, i.e. if the residual does not
+ * at least halve at each iteration with single precision factors,
+ * or if it grows with double precision factors
+ */
+bool
+MTLUSolutionManager::Refine(void)
+{
+	const integer n = iSize;
+
+	const integer iMaxRefine = P.iMaxRefine >= 0 ? P.iMaxRefine
+		: (bSingle ? MTLU_MAX_REFINE_MIXED : MTLU_MAX_REFINE);
+	const doublereal dRefineTol = P.dRefineTol >= 0. ? P.dRefineTol
+		: (bSingle ? MTLU_REFINE_TOL_MIXED : MTLU_REFINE_TOL);
+
+	doublereal dBNorm = 0.;
+	for (integer i = 0; i < n; i++) {
+		dBNorm = std::max(dBNorm, std::abs(b[i]));
+	}
+
+	doublereal dPrevRNorm = -1.;
+	for (integer iIter = 0; ; iIter++) {
+		R = b;
+		doublereal dXNorm = 0.;
+		for (integer c = 0; c < n; c++) {
+			doublereal xc = x[c];
+			dXNorm = std::max(dXNorm, std::abs(xc));
+			if (xc != 0.) {
+				for (integer p = Ap[c]; p < Ap[c + 1]; p++) {
+					R[Ai[p]] -= Ax[p]*xc;
+				}
+			}
+		}
+
+		doublereal dRNorm = 0.;
+		for (integer i = 0; i < n; i++) {
+			dRNorm = std::max(dRNorm, std::abs(R[i]));
+		}
+
+		if (dRNorm <= dRefineTol*(dANorm*dXNorm + dBNorm)) {
+			return true;
+		}
+
+		if (iIter == iMaxRefine
+			|| (dPrevRNorm >= 0. && dRNorm > (bSingle ? .5 : 1.)*dPrevRNorm))
+		{
+			return false;
+		}
+		dPrevRNorm = dRNorm;
+
+		SolveAdd(R, false);
+		uRefineSteps++;
+	}
+}
+
+void
+MTLUSolutionManager::MakeCompressedColumnForm(void)
+{
+	A.MakeCompressedColumnForm(Ax, Ai, Ap, 0);
+
+	if (pAc) {
+		SAFEDELETE(pAc);
+		pAc = 0;
+	}
+	SAFENEWWITHCONSTRUCTOR(pAc, CColMatrixHandler<0>,
+		CColMatrixHandler<0>(Ax, Ai, Ap));
+
+	/* the symbolic analysis is kept if the pattern did not change */
+	if (bSymbolic && (Ap != SymAp || Ai != SymAi)) {
+		bSymbolic = false;
+	}
+
+	if (pPatDM) {
+		uCCGen = pPatDM->GetJacPatternGeneration();
+	}
+
+	bCCReady = true;
+}
+
+void
+MTLUSolutionManager::MatrReset(void)
+{
+	bFactored = false;
+}
+
+void
+MTLUSolutionManager::MatrInitialize(void)
+{
+	/* keep the compressed form (and the symbolic factorization)
+	 * if the pattern did not change since it was built */
+	if (!bCCReady || pPatDM == 0
+		|| pPatDM->GetJacPatternGeneration() != uCCGen)
+	{
+		bCCReady = false;
+	}
+
+	MatrReset();
+}
+
+void
+MTLUSolutionManager::Solve(void)
+{
+	if (!bCCReady) {
+		MakeCompressedColumnForm();
+	}
+
+	if (!bSymbolic) {
+		Symbolic();
+	}
+
+	if (!bFactored) {
+		Factor();
+	}
+
+	doublereal dStart = mtlu_wall_time();
+
+	SolveAdd(b, true);
+
+	/* iterative refinement, if the factors are in single precision
+	 * or pivots were replaced */
+	bool bRefined = true;
+	if (bSingle || uCurrPerturbed > 0) {
+		bRefined = Refine();
+		if (!bRefined && bSingle) {
+			silent_cout("threaded LU: mixed precision refinement stalled; "
+				"switching to double precision" << std::endl);
+
+			bSingle = false;
+			uFallbacks++;
+			Factor();
+
+			SolveAdd(b, true);
+			bRefined = (uCurrPerturbed == 0 || Refine());
+		}
+	}
+
+	dSolveTime += mtlu_wall_time() - dStart;
+
+	/* the replaced pivots spoil the solution: the matrix
+	 * is (nearly) singular, as far as static pivoting can tell */
+	if (!bRefined) {
+		silent_cerr("threaded LU: iterative refinement failed after "
+			<< uCurrPerturbed << " pivots were replaced, "
+			"the first one at column " << Perm[iCurrPerturbed] + 1
+			<< std::endl);
+		throw LinearSolver::ErrFactor(Perm[iCurrPerturbed] + 1, MBDYN_EXCEPT_ARGS);
+	}
+}
+
+MatrixHandler*
+MTLUSolutionManager::pMatHdl(void) const
+{
+	if (!bCCReady) {
+		return &A;
+	}
+
+	return pAc;
+}
+
+VectorHandler*
+MTLUSolutionManager::pResHdl(void) const
+{
+	return &bVH;
+}
+
+VectorHandler*
+MTLUSolutionManager::pSolHdl(void) const
+{
+	return &xVH;
+}
+
+void
+MTLUSolutionManager::SetPatternSource(const DataManager *pDM)
+{
+	pPatDM = pDM;
+	if (pPatDM) {
+		uCCGen = pPatDM->GetJacPatternGeneration();
+	}
+}
+
+unsigned
+MTLUSolutionManager::GetSymbolicCount(void) const
+{
+	return uSymbolic;
+}
+
+unsigned
+MTLUSolutionManager::GetNumericCount(void) const
+{
+	return uNumeric;
+}
+
+/* MTLUSolutionManager - end */
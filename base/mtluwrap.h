@@ -0,0 +1,287 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2014
+ *
+ * Pierangelo Masarati	<masarati@aero.polimi.it>
+ * Paolo Mantegazza	<mantegazza@aero.polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* threaded sparse LU solution manager */
+
+#ifndef MTLUWRAP_H
+#define MTLUWRAP_H
+
+#ifdef USE_MULTITHREAD
+#include "ac/pthread.h"
+#endif /* USE_MULTITHREAD */
+
+#include <vector>
+
+#include "solman.h"
+#include "spmapmh.h"
+#include "ccmh.h"
+#include "patsolman.h"
+
+/*
+ * MTLUSolutionManager - begin
+ *
+ * Sparse LU factorization with static pivoting on the structure
+ * of A + A^T.  The symbolic analysis (minimum degree ordering,
+ * elimination tree, pattern of the factors and the split of the
+ * elimination tree in independent subtrees) is computed once,
+ * and reused as long as the pattern of the matrix does not change.
+ *
+ * The numerical factorization and the triangular solves
+ * process the independent subtrees in parallel; the nodes
+ * above them (the separators) are processed by the main thread.
+ * Pivots that become too small are replaced by a small multiple
+ * of the norm of the column; in that case, the solution is improved
+ * by iterative refinement; if the refinement does not converge,
+ * LinearSolver::ErrFactor is thrown for the first replaced pivot.
+ *
+ * In mixed precision mode, the factors are stored in single precision
+ * (the elimination is still accumulated in double precision), and
+ * the solution is refined against the double precision matrix;
+ * if the refinement stalls, the solver switches to double precision
+ * for the rest of its life.
+ *
+ * The matrix is assembled in SpMapMatrixHandler form the first time,
+ * and then directly in the column-compressed form, so that it
+ * can be used with multithreaded assembly.  When the DataManager
+ * is set as pattern source, the compressed form is kept
+ * by MatrInitialize() as long as the pattern does not change.
+ */
+
+class MTLUSolutionManager : public SolutionManager,
+	public PatternSolutionManager {
+public:
+	struct Params {
+		/* 0: use all the available CPUs */
+		unsigned nThreads;
+		/* relative threshold for static pivot replacement */
+		doublereal dPivotTol;
+		/* max iterative refinement steps, and tolerance
+		 * on the normwise backward error; if negative,
+		 * the defaults of the precision of the factors */
+		integer iMaxRefine;
+		doublereal dRefineTol;
+		/* single precision factors */
+		bool bMixed;
+		/* print the statistics at exit */
+		bool bVerbose;
+
+		Params(void);
+	};
+
+protected:
+	integer iSize;
+	Params P;
+	unsigned nThreads;
+
+	/* matrix */
+	mutable SpMapMatrixHandler A;
+	CColMatrixHandler<0> *pAc;
+	bool bCCReady;
+	std::vector<doublereal> Ax;
+	std::vector<integer> Ai;
+	std::vector<integer> Ap;
+
+	/* pattern generation the compressed form refers to */
+	const DataManager *pPatDM;
+	unsigned uCCGen;
+
+	/* rhs and solution */
+	std::vector<doublereal> x;
+	std::vector<doublereal> b;
+	mutable MyVectorHandler xVH;
+	mutable MyVectorHandler bVH;
+
+	/* pattern the symbolic analysis refers to */
+	std::vector<integer> SymAi;
+	std::vector<integer> SymAp;
+	bool bSymbolic;
+	bool bFactored;
+
+	/* permuted rhs and residual for refinement */
+	std::vector<doublereal> Y;
+	std::vector<doublereal> R;
+
+	/* new -> old and old -> new permutation */
+	std::vector<integer> Perm;
+	std::vector<integer> IPerm;
+	std::vector<integer> Parent;
+
+	/* strictly lower part of L by columns (unit diagonal);
+	 * the values are in Factors::Lx; Factors::Ux is aligned with Lx
+	 * and contains the strictly upper part of U by rows:
+	 * Ux[p] = U(k, Li[p]) for p in column k */
+	std::vector<integer> Lp;
+	std::vector<integer> Li;
+
+	template <class T>
+	struct Factors {
+		std::vector<T> Lx;
+		std::vector<T> Ux;
+		std::vector<T> D;
+
+		void Resize(integer iNz, integer iSize);
+		void Clear(void);
+	};
+
+	Factors<doublereal> DF;
+	Factors<float> SF;
+
+	/* the current factors are SF */
+	bool bSingle;
+	/* infinity norm of the factored matrix */
+	doublereal dANorm;
+
+	/* strictly lower part of L by rows; RPos maps into Lx */
+	std::vector<integer> Rp;
+	std::vector<integer> Rj;
+	std::vector<integer> RPos;
+
+	/* independent subtrees, as ranges [first, last] of contiguous
+	 * (postordered) columns, assigned to each thread */
+	std::vector<std::vector<integer> > Ranges;
+	/* columns above the subtrees, in ascending order */
+	std::vector<integer> Top;
+
+	/* per-thread dense work vectors and counters */
+	std::vector<std::vector<doublereal> > Work;
+	std::vector<unsigned> uPerturbed;
+	std::vector<integer> iFirstPerturbed;
+
+	/* statistics */
+	unsigned uCurrPerturbed;
+	integer iCurrPerturbed;
+	unsigned uSymbolic;
+	unsigned uNumeric;
+	unsigned uPivotRepl;
+	unsigned uRefineSteps;
+	unsigned uFallbacks;
+	doublereal dSymbolicTime;
+	doublereal dNumericTime;
+	doublereal dSolveTime;
+
+#ifdef USE_MULTITHREAD
+	enum Op {
+		OP_FACTOR,
+		OP_FORWARD,
+		OP_BACKWARD,
+		OP_EXIT
+	};
+
+	struct ThreadData {
+		MTLUSolutionManager *pSM;
+		unsigned uId;
+		pthread_t thread;
+	};
+
+	std::vector<ThreadData> thread_data;
+	pthread_mutex_t thread_mutex;
+	pthread_cond_t thread_start;
+	pthread_cond_t thread_done;
+	Op CurrOp;
+	unsigned uGeneration;
+	unsigned uPending;
+	doublereal *pdCurrVec;
+
+	static void *thread(void *arg);
+	void ThreadStart(void);
+	void ThreadDestroy(void);
+	void Run(Op op, doublereal *pd);
+	void DoOp(Op op, unsigned uId, doublereal *pd);
+#endif /* USE_MULTITHREAD */
+
+	void MakeCompressedColumnForm(void);
+
+	/* symbolic analysis */
+	void MinimumDegree(std::vector<integer>& Order) const;
+	void LowerPattern(std::vector<integer>& Sp, std::vector<integer>& Si) const;
+	void EliminationTree(const std::vector<integer>& Sp,
+		const std::vector<integer>& Si);
+	void Symbolic(void);
+
+	/* numerical factorization and solution */
+	template <class T>
+	void FactorColumn(integer j, unsigned uId, Factors<T>& F);
+	template <class T>
+	void ForwardRow(integer i, doublereal *py, const Factors<T>& F) const;
+	template <class T>
+	void BackwardRow(integer k, doublereal *py, const Factors<T>& F) const;
+	template <class T>
+	void FactorRange(unsigned uId, Factors<T>& F);
+	template <class T>
+	void ForwardRange(unsigned uId, doublereal *py, const Factors<T>& F) const;
+	template <class T>
+	void BackwardRange(unsigned uId, doublereal *py, const Factors<T>& F) const;
+	template <class T>
+	void SolvePerm(doublereal *py, const Factors<T>& F);
+
+	/* dispatch on the precision of the current factors */
+	void FactorRange(unsigned uId);
+	void ForwardRange(unsigned uId, doublereal *py) const;
+	void BackwardRange(unsigned uId, doublereal *py) const;
+
+	void Factor(void);
+	void SolveAdd(const std::vector<doublereal>& r, bool bInit);
+	bool Refine(void);
+
+public:
+	MTLUSolutionManager(integer Dim, const Params& p = Params());
+	virtual ~MTLUSolutionManager(void);
+
+#ifdef DEBUG
+	virtual void IsValid(void) const {
+		NO_OP;
+	};
+#endif /* DEBUG */
+
+	/* Inizializzatore generico */
+	virtual void MatrReset(void);
+	virtual void MatrInitialize(void);
+
+	/* Risolve il sistema */
+	virtual void Solve(void);
+
+	/* Rende disponibile l'handler per la matrice */
+	virtual MatrixHandler* pMatHdl(void) const;
+
+	/* Rende disponibile l'handler per il termine noto */
+	virtual VectorHandler* pResHdl(void) const;
+
+	/* Rende disponibile l'handler per la soluzione */
+	virtual VectorHandler* pSolHdl(void) const;
+
+	virtual void SetPatternSource(const DataManager *pDM);
+	virtual unsigned GetSymbolicCount(void) const;
+	virtual unsigned GetNumericCount(void) const;
+};
+
+/* MTLUSolutionManager - end */
+
+#endif /* MTLUWRAP_H */
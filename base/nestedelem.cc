@@ -205,6 +205,27 @@ NestedElem::AfterConvergence(const VectorHandler& X, const VectorHandler& XP)
 	pElem->AfterConvergence(X, XP);
 }
 
+void
+NestedElem::Checkpoint(std::ostream& out) const
+{
+	ASSERT(pElem != NULL);
+	pElem->Checkpoint(out);
+}
+
+void
+NestedElem::Resume(std::istream& in)
+{
+	ASSERT(pElem != NULL);
+	pElem->Resume(in);
+}
+
+bool
+NestedElem::bCheckpointable(void) const
+{
+	ASSERT(pElem != NULL);
+	return pElem->bCheckpointable();
+}
+
 /* assemblaggio jacobiano */
 VariableSubMatrixHandler& 
 NestedElem::AssJac(VariableSubMatrixHandler& WorkMat,
@@ -130,6 +130,10 @@ public:
 	virtual void AfterConvergence(const VectorHandler& X,
      			const VectorHandler& XP);
 
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+	virtual bool bCheckpointable(void) const;
+
 	/* assemblaggio jacobiano */
 	virtual VariableSubMatrixHandler&
 	AssJac(VariableSubMatrixHandler& WorkMat,
@@ -52,13 +52,243 @@
 #include <limits>
 #include <unistd.h>
 
+
 /* NonlinearSolverTest - begin */
 
+/*
+ * Fused convergence measure.
+ *
+ * The generic MakeTest() calls a virtual TestOne() and a virtual
+ * DataManager::GetEqType() for each entry, and TestOne() a second time
+ * for the differential-only measure.  When the test is a plain norm
+ * or max (possibly scaled) and the vectors are contiguous, the overall
+ * and the differential measures are computed in one pass by the kernel
+ * below; the equation type is applied from a cached 0/1 mask by selects,
+ * so the loop has no branches and independent accumulators, and vectorizes.
+ * Very large vectors are split in chunks of fixed size, which are run
+ * by the thread pool of the DataManager, if any; partial results
+ * are merged in chunk order, so the result depends neither on timing
+ * nor on the number of threads.
+ */
+
+struct NonlinearSolverTestChunk {
+	const doublereal *pV;
+	const doublereal *pScl;
+	const doublereal *pMask;
+	doublereal dScaleAlgEqu;
+	integer iFirst;
+	integer iLast;
+	bool bNorm;
+
+	doublereal dRes;
+	doublereal dResDiff;
+};
+
+static const int NLST_NACC = 4;
+
+template <bool bNorm, bool bScale>
+static inline void
+TestEntry(const doublereal *pV, const doublereal *pScl, const doublereal *pMask,
+	doublereal dAlg, integer i, doublereal& dAcc, doublereal& dAccDiff)
+{
+	/* selects rather than products with the mask,
+	 * which would turn an infinite entry into a NaN */
+	const bool bDiff = (pMask[i] != 0.);
+	doublereal d = bDiff ? pV[i] : pV[i]*dAlg;
+	if (bScale) {
+		d *= pScl[i];
+	}
+
+	if (bNorm) {
+		const doublereal dd = bDiff ? d : 0.;
+		dAcc += d*d;
+		dAccDiff += dd*dd;
+
+	} else {
+		const doublereal a = std::abs(d);
+		const doublereal ad = bDiff ? a : 0.;
+		dAcc = a > dAcc ? a : dAcc;
+		dAccDiff = ad > dAccDiff ? ad : dAccDiff;
+	}
+}
+
+template <bool bNorm, bool bScale>
+static void
+TestChunk(NonlinearSolverTestChunk& c)
+{
+	const doublereal *const pV = c.pV;
+	const doublereal *const pScl = c.pScl;
+	const doublereal *const pMask = c.pMask;
+	const doublereal dAlg = c.dScaleAlgEqu;
+
+	doublereal dAcc[NLST_NACC], dAccDiff[NLST_NACC];
+	for (int j = 0; j < NLST_NACC; j++) {
+		dAcc[j] = 0.;
+		dAccDiff[j] = 0.;
+	}
+
+	integer i = c.iFirst;
+	for (; i + NLST_NACC <= c.iLast; i += NLST_NACC) {
+		for (int j = 0; j < NLST_NACC; j++) {
+			TestEntry<bNorm, bScale>(pV, pScl, pMask, dAlg, i + j,
+				dAcc[j], dAccDiff[j]);
+		}
+	}
+
+	for (; i < c.iLast; i++) {
+		TestEntry<bNorm, bScale>(pV, pScl, pMask, dAlg, i,
+			dAcc[0], dAccDiff[0]);
+	}
+
+	c.dRes = dAcc[0];
+	c.dResDiff = dAccDiff[0];
+	for (int j = 1; j < NLST_NACC; j++) {
+		if (bNorm) {
+			c.dRes += dAcc[j];
+			c.dResDiff += dAccDiff[j];
+
+		} else {
+			c.dRes = dAcc[j] > c.dRes ? dAcc[j] : c.dRes;
+			c.dResDiff = dAccDiff[j] > c.dResDiff ? dAccDiff[j] : c.dResDiff;
+		}
+	}
+}
+
+static void
+TestChunkRun(NonlinearSolverTestChunk& c)
+{
+	if (c.bNorm) {
+		if (c.pScl) {
+			TestChunk<true, true>(c);
+		} else {
+			TestChunk<true, false>(c);
+		}
+
+	} else {
+		if (c.pScl) {
+			TestChunk<false, true>(c);
+		} else {
+			TestChunk<false, false>(c);
+		}
+	}
+}
+
+/* DataManager::RunTasks() callback */
+static void
+TestChunkTask(void *pData, unsigned iTask)
+{
+	TestChunkRun(static_cast<NonlinearSolverTestChunk *>(pData)[iTask]);
+}
+
+/* size of the chunks; below it, waking up the threads
+ * costs more than it saves */
+static const integer NLST_CHUNK = 1 << 18;
+
+NonlinearSolverTest::NonlinearSolverTest(void)
+: pEqTypeDM(0),
+uEqTypeGen(0)
+{
+	NO_OP;
+}
+
 NonlinearSolverTest::~NonlinearSolverTest(void)
 {
 	NO_OP;
 }
 
+NonlinearSolverTest::MeasureType
+NonlinearSolverTest::GetMeasureType(void) const
+{
+	return MEASURE_NONE;
+}
+
+const VectorHandler *
+NonlinearSolverTest::pGetScale(void) const
+{
+	return 0;
+}
+
+const doublereal *
+NonlinearSolverTest::pGetEqTypeMask(const DataManager *pDM, integer Size)
+{
+	if (pDM != pEqTypeDM
+		|| pDM->GetJacPatternGeneration() != uEqTypeGen
+		|| EqTypeMask.size() != std::vector<doublereal>::size_type(Size))
+	{
+		EqTypeMask.resize(Size);
+		for (integer iCnt = 0; iCnt < Size; iCnt++) {
+			EqTypeMask[iCnt] = (pDM->GetEqType(iCnt + 1) == DofOrder::DIFFERENTIAL) ? 1. : 0.;
+		}
+		pEqTypeDM = pDM;
+		uEqTypeGen = pDM->GetJacPatternGeneration();
+	}
+
+	return &EqTypeMask[0];
+}
+
+bool
+NonlinearSolverTest::FastTest(Solver *pS, const integer& Size,
+		const VectorHandler& Vec, doublereal dScaleAlgEqu,
+		doublereal& dTest, doublereal* pTestDiff)
+{
+	const MeasureType type = GetMeasureType();
+	if (type == MEASURE_NONE || Size <= 0) {
+		return false;
+	}
+
+	const MyVectorHandler *pMyVec = dynamic_cast<const MyVectorHandler *>(&Vec);
+	if (pMyVec == 0) {
+		return false;
+	}
+
+	const doublereal *pScl = 0;
+	const VectorHandler *pScale = pGetScale();
+	if (pScale != 0) {
+		const MyVectorHandler *pMyScale = dynamic_cast<const MyVectorHandler *>(pScale);
+		if (pMyScale == 0 || pMyScale->iGetSize() < Size) {
+			return false;
+		}
+		pScl = pMyScale->pdGetVec();
+	}
+
+	NonlinearSolverTestChunk c;
+	c.pV = pMyVec->pdGetVec();
+	c.pScl = pScl;
+	c.pMask = pGetEqTypeMask(pS->pGetDataManager(), Size);
+	c.dScaleAlgEqu = dScaleAlgEqu;
+	c.bNorm = (type == MEASURE_NORM);
+	c.iFirst = 0;
+	c.iLast = Size;
+
+	unsigned nChunks = unsigned(Size/NLST_CHUNK);
+	if (nChunks > 1) {
+		std::vector<NonlinearSolverTestChunk> chunks(nChunks, c);
+		for (unsigned t = 0; t < nChunks; t++) {
+			chunks[t].iFirst = integer((Size*(long long)t)/nChunks);
+			chunks[t].iLast = integer((Size*(long long)(t + 1))/nChunks);
+		}
+
+		pS->pGetDataManager()->RunTasks(TestChunkTask, &chunks[0], nChunks);
+
+		c.dRes = chunks[0].dRes;
+		c.dResDiff = chunks[0].dResDiff;
+		for (unsigned t = 1; t < nChunks; t++) {
+			TestMerge(c.dRes, chunks[t].dRes);
+			TestMerge(c.dResDiff, chunks[t].dResDiff);
+		}
+
+	} else {
+		TestChunkRun(c);
+	}
+
+	dTest = c.dRes;
+	if (pTestDiff) {
+		*pTestDiff = c.dResDiff;
+	}
+
+	return true;
+}
+
 doublereal
 NonlinearSolverTest::MakeTest(Solver *pS, const integer& Size,
 		const VectorHandler& Vec, bool bResidual,
@@ -130,16 +360,19 @@ NonlinearSolverTest::MakeTest(Solver *pS, const integer& Size,
 #endif // USE_SCHUR
 	{
 		ASSERT(Vec.iGetSize() == Size);
-		const DataManager* const pDM = pS->pGetDataManager();
 
- 	  	for (int iCntp1 = 1; iCntp1 <= Size; iCntp1++) {
- 	  		const DofOrder::Order order = pDM->GetEqType(iCntp1);
- 	  		const doublereal dCoef = order == DofOrder::DIFFERENTIAL ? 1. : dScaleAlgEqu;
+		if (!FastTest(pS, Size, Vec, dScaleAlgEqu, dTest, pTestDiff)) {
+			const DataManager* const pDM = pS->pGetDataManager();
+
+			for (int iCntp1 = 1; iCntp1 <= Size; iCntp1++) {
+				const DofOrder::Order order = pDM->GetEqType(iCntp1);
+				const doublereal dCoef = order == DofOrder::DIFFERENTIAL ? 1. : dScaleAlgEqu;
 
-			TestOne(dTest, Vec, iCntp1, dCoef);
+				TestOne(dTest, Vec, iCntp1, dCoef);
 
-			if (pTestDiff && order == DofOrder::DIFFERENTIAL) {
-				TestOne(*pTestDiff, Vec, iCntp1, dCoef);
+				if (pTestDiff && order == DofOrder::DIFFERENTIAL) {
+					TestOne(*pTestDiff, Vec, iCntp1, dCoef);
+				}
 			}
 		}
 	}
@@ -205,6 +438,12 @@ NonlinearSolverTestNone::TestMerge(doublereal& dResCurr,
 
 /* NonlinearSolverTestNorm - begin */
 
+NonlinearSolverTest::MeasureType
+NonlinearSolverTestNorm::GetMeasureType(void) const
+{
+	return MEASURE_NORM;
+}
+
 void
 NonlinearSolverTestNorm::TestOne(doublereal& dRes, 
 		const VectorHandler& Vec, const integer& iIndex, doublereal dCoef) const
@@ -236,6 +475,12 @@ NonlinearSolverTestNorm::TestPost(const doublereal& dRes) const
 
 /* NonlinearSolverTestMinMax */
 
+NonlinearSolverTest::MeasureType
+NonlinearSolverTestMinMax::GetMeasureType(void) const
+{
+	return MEASURE_MINMAX;
+}
+
 void
 NonlinearSolverTestMinMax::TestOne(doublereal& dRes,
 		const VectorHandler& Vec, const integer& iIndex, doublereal dCoef) const
@@ -280,6 +525,12 @@ NonlinearSolverTestScale::SetScale(const VectorHandler* pScl)
 	pScale = pScl;
 }
 
+const VectorHandler *
+NonlinearSolverTestScale::pGetScale(void) const
+{
+	return pScale;
+}
+
 const doublereal&
 NonlinearSolverTestScale::dScaleCoef(const integer& iIndex) const
 {
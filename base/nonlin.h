@@ -70,6 +70,7 @@
 /* Needed for callback declaration; defined in <mbdyn/base/solver.h> */
 class Solver;
 class InverseSolver;
+class DataManager;
  
 class NonlinearSolverTest {
 public:
@@ -81,8 +82,36 @@ public:
 		LASTNONLINEARSOLVERTEST
 	};
 
+	/* reduction performed by TestOne()/TestMerge(), if any;
+	 * allows MakeTest() to use a single vectorized pass */
+	enum MeasureType {
+		MEASURE_NONE,		/* only TestOne() is meaningful */
+		MEASURE_NORM,		/* sum of squares */
+		MEASURE_MINMAX		/* max of absolute values */
+	};
+
+protected:
+	/* 1. for differential equations, 0. otherwise;
+	 * cached from the DataManager, until the equation structure
+	 * changes (see DataManager::GetJacPatternGeneration()) */
+	const DataManager *pEqTypeDM;
+	unsigned uEqTypeGen;
+	std::vector<doublereal> EqTypeMask;
+
+	const doublereal *pGetEqTypeMask(const DataManager *pDM, integer Size);
+
+	/* single pass on contiguous vectors; returns false if not applicable */
+	bool FastTest(Solver *pS, const integer& Size,
+			const VectorHandler& Vec, doublereal dScaleAlgEqu,
+			doublereal& dTest, doublereal* pTestDiff);
+
+public:
+	NonlinearSolverTest(void);
 	virtual ~NonlinearSolverTest(void);
 
+	virtual MeasureType GetMeasureType(void) const;
+	virtual const VectorHandler *pGetScale(void) const;
+
 	/* loops over the vector Vec */
 	virtual doublereal MakeTest(Solver *pS, const integer& Size,
 			const VectorHandler& Vec, bool bResidual = false,
@@ -117,6 +146,7 @@ public:
 
 class NonlinearSolverTestNorm : virtual public NonlinearSolverTest {
 public:
+	virtual MeasureType GetMeasureType(void) const;
 	virtual void TestOne(doublereal& dRes, const VectorHandler& Vec,
 			const integer& iIndex, doublereal dCoef) const;
 	virtual void TestMerge(doublereal& dResCurr,
@@ -126,6 +156,7 @@ public:
 
 class NonlinearSolverTestMinMax : virtual public NonlinearSolverTest {
 public:
+	virtual MeasureType GetMeasureType(void) const;
 	virtual void TestOne(doublereal& dRes, const VectorHandler& Vec,
 			const integer& iIndex, doublereal dCoef) const;
 	virtual void TestMerge(doublereal& dResCurr,
@@ -140,6 +171,7 @@ public:
 	NonlinearSolverTestScale(const VectorHandler* pScl = 0);
 	virtual ~NonlinearSolverTestScale(void);
 	virtual void SetScale(const VectorHandler* pScl);
+	virtual const VectorHandler *pGetScale(void) const;
 	virtual const doublereal& dScaleCoef(const integer& iIndex) const;
 };
 
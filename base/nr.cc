@@ -55,17 +55,33 @@
 #include <cmath>
 #include <cstdlib>
 
+NewtonRaphsonAdaptiveParameters::NewtonRaphsonAdaptiveParameters(void)
+: bEnabled(false),
+dMaxContraction(.5),
+dMaxTimeStepChange(.2),
+iMaxAge(0)
+{
+	NO_OP;
+}
+
 NewtonRaphsonSolver::NewtonRaphsonSolver(const bool bTNR,
 		const bool bKJ, 
 		const integer IterBfAss,
-		const NonlinearSolverOptions& options)
+		const NonlinearSolverOptions& options,
+		const NewtonRaphsonAdaptiveParameters& adaptive)
 : NonlinearSolver(options), pRes(NULL),
 pSol(NULL),
 bTrueNewtonRaphson(bTNR),
 IterationBeforeAssembly(IterBfAss),
 bKeepJac(bKJ),
 iPerformedIterations(0),
-pPrevNLP(0)
+pPrevNLP(0),
+Adaptive(adaptive),
+bJacValid(false),
+iJacAge(0),
+iJacSize(0),
+dJacTimeStep(0.),
+dLastContraction(0.)
 {
 	NO_OP;
 }
@@ -87,11 +103,15 @@ NewtonRaphsonSolver::Solve(const NonlinearProblem *pNLP,
 {
 	ASSERT(pS != NULL);
 	SolutionManager *pSM = pS->pGetSolutionManager();
+	SolverStats *pStats = pS->pGetSolverStats();
 	
 	iIterCnt = 0;
 	if ((!bKeepJac) || (pNLP != pPrevNLP)) {
 		iPerformedIterations = 0;
 	}
+	if (pNLP != pPrevNLP) {
+		bJacValid = false;
+	}
 	pPrevNLP = pNLP;
 	dSolErr = 0.;
 
@@ -100,6 +120,14 @@ NewtonRaphsonSolver::Solve(const NonlinearProblem *pNLP,
 	doublereal dErrDiff = 0.;
 	bool bJacBuilt = false;
 
+	/* the first iteration relies on the contraction
+	 * observed at the end of the previous step */
+	doublereal dContraction = dLastContraction;
+	doublereal dTimeStep = 0.;
+	if (Adaptive.bEnabled) {
+		dTimeStep = pS->pGetDataManager()->pGetDrvHdl()->dGetTimeStep();
+	}
+
 	while (true) {
 		pRes = pSM->pResHdl();
 		pSol = pSM->pSolHdl();
@@ -112,10 +140,11 @@ NewtonRaphsonSolver::Solve(const NonlinearProblem *pNLP,
 		pRes->Reset();
 		bool forceJacobian(false);
 		try {
+			SolverStats::Timer timer(pStats, SolverStats::RESIDUAL);
 	      		pNLP->Residual(pRes);
 		}
 		catch (SolutionDataManager::ChangedEquationStructure) {
-			if (bHonorJacRequest) {
+			if (bHonorJacRequest || Adaptive.bEnabled) {
 				forceJacobian = true;
 			}
 		}
@@ -133,6 +162,10 @@ NewtonRaphsonSolver::Solve(const NonlinearProblem *pNLP,
 		bool bTest = MakeResTest(pS, pNLP, *pRes, Tol, dErr, dErrDiff);
 		if (iIterCnt > 0) {
 			dErrFactor *= dErr/dOldErr;
+			if (dOldErr > 0.) {
+				dContraction = dErr/dOldErr;
+				dLastContraction = dContraction;
+			}
 		}
 		dOldErr = dErr;
 
@@ -180,16 +213,34 @@ NewtonRaphsonSolver::Solve(const NonlinearProblem *pNLP,
 			if (outputBailout()) {
 				pS->PrintResidual(*pRes, iIterCnt);
 			}
+			bJacValid = false;
 			throw NoConvergence(MBDYN_EXCEPT_ARGS);
 		}
           
       	iIterCnt++;
       	bJacBuilt = false;
+		if (pStats) {
+			pStats->Inc(SolverStats::ITERATIONS);
+		}
 
-		if (bTrueNewtonRaphson
-			|| (iPerformedIterations%IterationBeforeAssembly == 0)
-			|| forceJacobian)
-		{
+		bool bAssemble;
+		if (Adaptive.bEnabled) {
+			/* reuse while the iteration contracts fast enough */
+			bAssemble = forceJacobian
+				|| !bJacValid
+				|| Size != iJacSize
+				|| dContraction > Adaptive.dMaxContraction
+				|| std::abs(dTimeStep - dJacTimeStep) > Adaptive.dMaxTimeStepChange*std::abs(dJacTimeStep)
+				|| (Adaptive.iMaxAge > 0 && iJacAge >= Adaptive.iMaxAge);
+
+		} else {
+			bAssemble = bTrueNewtonRaphson
+				|| (iPerformedIterations%IterationBeforeAssembly == 0)
+				|| forceJacobian;
+		}
+
+		if (bAssemble) {
+			SolverStats::Timer timer(pStats, SolverStats::JACOBIAN);
       			pSM->MatrReset();
 rebuild_matrix:;
 			try {
@@ -210,9 +261,18 @@ rebuild_matrix:;
 
 			TotJac++;
 			bJacBuilt = true;
+
+			bJacValid = true;
+			iJacAge = 0;
+			iJacSize = Size;
+			dJacTimeStep = dTimeStep;
+
+			/* no contraction measured yet with the new matrix */
+			dContraction = 0.;
 		}
 		
 		iPerformedIterations++;
+		iJacAge++;
 		
 #ifdef USE_MPI
 		if (!bParallel || MBDynComm.Get_rank() == 0)
@@ -232,7 +292,10 @@ rebuild_matrix:;
 			}
 		}
 
-		pSM->Solve();
+		{
+			SolverStats::Timer timer(pStats, SolverStats::SOLVE);
+			pSM->Solve();
+		}
 
       	if (outputSol()) {
 			pS->PrintSolution(*pSol, iIterCnt);
@@ -43,6 +43,22 @@
 #include <vector>
 #include "nonlin.h"
 
+/*
+ * Adaptive reuse of the Jacobian matrix: the factorization is kept
+ * across iterations and time steps as long as the residual contraction
+ * ratio stays below dMaxContraction and the time step does not change
+ * by more than dMaxTimeStepChange (relative); iMaxAge, if positive,
+ * limits the number of iterations a matrix can be used for.
+ */
+struct NewtonRaphsonAdaptiveParameters
+{
+	bool bEnabled;
+	doublereal dMaxContraction;
+	doublereal dMaxTimeStepChange;
+	integer iMaxAge;
+	NewtonRaphsonAdaptiveParameters();
+};
+
 class NewtonRaphsonSolver : public NonlinearSolver
 {
 	VectorHandler* 	pRes;
@@ -53,11 +69,21 @@ class NewtonRaphsonSolver : public NonlinearSolver
 	integer iPerformedIterations;
 	const NonlinearProblem* pPrevNLP;	
 
+	/* adaptive reuse */
+	NewtonRaphsonAdaptiveParameters Adaptive;
+	bool bJacValid;
+	integer iJacAge;
+	integer iJacSize;
+	doublereal dJacTimeStep;
+	doublereal dLastContraction;
+
 public:
 	NewtonRaphsonSolver(const bool bTNR,
 			const bool bKJ, 
 			const integer IterBfAss,
-			const NonlinearSolverOptions& options);
+			const NonlinearSolverOptions& options,
+			const NewtonRaphsonAdaptiveParameters& adaptive
+				= NewtonRaphsonAdaptiveParameters());
 	
 	~NewtonRaphsonSolver(void);
 	
@@ -0,0 +1,951 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2014
+ *
+ * Pierangelo Masarati	<masarati@aero.polimi.it>
+ * Paolo Mantegazza	<mantegazza@aero.polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <cstring>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <locale>
+#include <string>
+
+#include "myassert.h"
+#include "except.h"
+#include "outbuf.h"
+
+/* OutputBuf - begin */
+
+const char OutputBuf::sMagic[] = "MBDynBin";
+const unsigned OutputBuf::uVersion = 1;
+
+OutputBuf::OutputBuf(void)
+: buf(DEFAULT_SIZE), mode(MODE_TEXT), bDefer(false),
+pWriter(0), bWriteFailed(false)
+{
+	SetPut(0);
+}
+
+OutputBuf::~OutputBuf(void)
+{
+	close();
+}
+
+void
+OutputBuf::SetPut(std::streamsize nKeep)
+{
+	setp(&buf[0], &buf[0] + buf.size());
+	pbump(int(nKeep));
+}
+
+OutputBuf *
+OutputBuf::open(const char *sName, std::ios::openmode m)
+{
+	if (fb.is_open()) {
+		return 0;
+	}
+
+	/* our buffer is the only one */
+	fb.pubsetbuf(0, 0);
+	if (fb.open(sName, m | std::ios::out | std::ios::binary) == 0) {
+		return 0;
+	}
+
+	SetPut(0);
+	bWriteFailed = false;
+
+	if (mode == MODE_BINARY) {
+		fb.sputn(sMagic, sizeof(sMagic) - 1);
+		fb.sputn((const char *)&uVersion, sizeof(uVersion));
+	}
+
+	return this;
+}
+
+bool
+OutputBuf::is_open(void) const
+{
+	return fb.is_open();
+}
+
+OutputBuf *
+OutputBuf::close(void)
+{
+	if (!fb.is_open()) {
+		return 0;
+	}
+
+	bool bOK = Drain(true);
+#ifdef USE_MULTITHREAD
+	if (pWriter != 0) {
+		pWriter->Wait();
+		if (pWriter->bFailed(this, true)) {
+			bOK = false;
+		}
+	}
+#endif /* USE_MULTITHREAD */
+	if (bWriteFailed) {
+		bOK = false;
+	}
+	if (fb.close() == 0) {
+		bOK = false;
+	}
+
+	SetPut(0);
+
+	return bOK ? this : 0;
+}
+
+void
+OutputBuf::SetMode(Mode m)
+{
+	ASSERT(!fb.is_open());
+	mode = m;
+}
+
+OutputBuf::Mode
+OutputBuf::GetMode(void) const
+{
+	return mode;
+}
+
+void
+OutputBuf::SetSize(size_t size)
+{
+	if (size < 1024) {
+		size = 1024;
+	}
+
+	Flush();
+
+	/* a partial binary line may still be pending */
+	std::streamsize nKeep = pptr() - pbase();
+	if (size < size_t(nKeep)) {
+		size = nKeep;
+	}
+
+	std::vector<char> tmp(size);
+	std::memcpy(&tmp[0], pbase(), nKeep);
+	buf.swap(tmp);
+	SetPut(nKeep);
+}
+
+void
+OutputBuf::SetDefer(bool b)
+{
+	bDefer = b;
+}
+
+void
+OutputBuf::SetWriter(OutputWriter *p)
+{
+	if (p == pWriter) {
+		return;
+	}
+
+	Flush();
+#ifdef USE_MULTITHREAD
+	if (pWriter != 0) {
+		pWriter->Wait();
+		if (pWriter->bFailed(this, true)) {
+			bWriteFailed = true;
+		}
+	}
+#endif /* USE_MULTITHREAD */
+
+	pWriter = p;
+}
+
+bool
+OutputBuf::WriteOut(const char *s, std::streamsize n)
+{
+	return fb.sputn(s, n) == n;
+}
+
+bool
+OutputBuf::SyncOut(void)
+{
+	return fb.pubsync() != -1;
+}
+
+/*
+ * Writes the first n chars of v; with a writer, v is swapped
+ * with an empty buffer of the same size and queued.
+ */
+bool
+OutputBuf::Write(std::vector<char>& v, std::streamsize n)
+{
+#ifdef USE_MULTITHREAD
+	if (pWriter != 0) {
+		std::vector<char> *pData = pWriter->pGetBuf();
+		pData->resize(v.size());
+		v.swap(*pData);
+		pData->resize(n);
+		pWriter->Submit(this, pData);
+		return !pWriter->bFailed(this);
+	}
+#endif /* USE_MULTITHREAD */
+
+	return fb.sputn(&v[0], n) == n;
+}
+
+bool
+OutputBuf::Flush(void)
+{
+	if (!fb.is_open()) {
+		return true;
+	}
+
+	bool bOK = Drain(false);
+#ifdef USE_MULTITHREAD
+	if (pWriter != 0) {
+		/* the file belongs to the writer thread */
+		pWriter->SubmitSync(this);
+		return bOK;
+	}
+#endif /* USE_MULTITHREAD */
+	if (!SyncOut()) {
+		bOK = false;
+	}
+
+	return bOK;
+}
+
+/*
+ * Writes the buffer to the file.  In binary mode only complete lines
+ * are encoded, unless bAll; the trailing partial line is moved to the
+ * beginning of the buffer.
+ */
+bool
+OutputBuf::Drain(bool bAll)
+{
+	char *b = pbase();
+	char *e = pptr();
+
+	if (b == e && Vals.empty()) {
+		return true;
+	}
+
+	if (!fb.is_open()) {
+		/* nowhere to go */
+		SetPut(0);
+		Vals.clear();
+		return false;
+	}
+
+	bool bOK = true;
+	if (mode == MODE_TEXT) {
+		bOK = Write(buf, e - b);
+		SetPut(0);
+		return bOK;
+	}
+
+	char *p = b;
+	size_t iVal = 0;
+	for (;;) {
+		char *nl = (char *)std::memchr(p, '\n', e - p);
+		if (nl == 0) {
+			break;
+		}
+		EncodeLine(p, nl, iVal);
+		p = nl + 1;
+	}
+
+	if (bAll && (p < e || iVal < Vals.size())) {
+		EncodeLine(p, e, iVal);
+		p = e;
+	}
+
+	/* the values of the trailing partial line move with it */
+	Vals.erase(Vals.begin(), Vals.begin() + iVal);
+	for (std::vector<Value>::iterator i = Vals.begin(); i != Vals.end(); ++i) {
+		i->off -= p - b;
+	}
+
+	if (!bin.empty()) {
+		bOK = Write(bin, bin.size());
+		bin.clear();
+	}
+
+	std::streamsize nKeep = e - p;
+	if (nKeep > 0 && p > b) {
+		std::memmove(b, p, nKeep);
+	}
+	SetPut(nKeep);
+
+	return bOK;
+}
+
+/*
+ * Encodes the line [b, e) and the values put in it, starting from
+ * Vals[iVal]; iVal is moved past them.  A line of values separated
+ * by blanks is encoded as is; anything else is formatted, and parsed
+ * as text.
+ */
+void
+OutputBuf::EncodeLine(const char *b, const char *e, size_t& iVal)
+{
+	const std::streamsize off = e - pbase();
+	size_t iEnd = iVal;
+	while (iEnd < Vals.size() && Vals[iEnd].off <= off) {
+		iEnd++;
+	}
+
+	bool bValues = (iEnd - iVal < 0xFFFFU);
+	for (const char *p = b; bValues && p < e; p++) {
+		if (*p != ' ' && *p != '\t' && *p != '\r') {
+			bValues = false;
+		}
+	}
+	for (size_t i = iVal + 1; bValues && i < iEnd; i++) {
+		if (Vals[i].off == Vals[i - 1].off) {
+			/* no blank in between */
+			bValues = false;
+		}
+	}
+
+	if (bValues) {
+		unsigned short n = iEnd - iVal;
+		bin.push_back(char(REC_VALUES));
+		bin.insert(bin.end(), (const char *)&n, (const char *)&n + sizeof(n));
+		if (n > 0) {
+			std::vector<char>::size_type iMask = bin.size();
+			bin.insert(bin.end(), (n + 7)/8, 0);
+			for (unsigned short i = 0; i < n; i++) {
+				const Value& v = Vals[iVal + i];
+				double d = v.d;
+				if (v.type == Value::LONG) {
+					d = v.l;
+				} else if (v.type == Value::ULONG) {
+					d = v.ul;
+				}
+				if (v.type != Value::DOUBLE && std::abs(d) < 9007199254740992.) {
+					bin[iMask + i/8] |= char(1U << (i % 8));
+				}
+				bin.insert(bin.end(), (const char *)&d, (const char *)&d + sizeof(d));
+			}
+		}
+
+		iVal = iEnd;
+		return;
+	}
+
+	if (iVal == iEnd) {
+		EncodeText(b, e);
+		return;
+	}
+
+	/* format the values in place */
+	std::string line;
+	const char *p = b;
+	for (; iVal < iEnd; iVal++) {
+		const Value& v = Vals[iVal];
+		const char *q = pbase() + v.off;
+		line.append(p, q - p);
+		p = q;
+
+		fmt.str(std::string());
+		fmt.flags(v.flags);
+		fmt.precision(v.prec);
+		fmt.width(v.width);
+		fmt.fill(v.fill);
+		switch (v.type) {
+		case Value::DOUBLE:
+			fmt << v.d;
+			break;
+
+		case Value::LONG:
+			fmt << v.l;
+			break;
+
+		case Value::ULONG:
+			fmt << v.ul;
+			break;
+		}
+		line += fmt.str();
+	}
+	line.append(p, e - p);
+
+	EncodeText(line.data(), line.data() + line.size());
+}
+
+/* Encodes a line of text, parsing the numbers back, if any */
+void
+OutputBuf::EncodeText(const char *b, const char *e)
+{
+	std::vector<double> dv;
+	std::vector<unsigned char> mask;
+	std::string tok;
+	bool bValues = true;
+
+	for (const char *p = b; p < e; ) {
+		while (p < e && (*p == ' ' || *p == '\t' || *p == '\r')) {
+			p++;
+		}
+		if (p == e) {
+			break;
+		}
+
+		const char *t = p;
+		while (p < e && *p != ' ' && *p != '\t' && *p != '\r') {
+			p++;
+		}
+		tok.assign(t, p - t);
+
+		char *next;
+		double d = std::strtod(tok.c_str(), &next);
+		if (*next != '\0' || dv.size() == 0xFFFFU) {
+			bValues = false;
+			break;
+		}
+
+		/* integer if only sign and digits */
+		bool bInt = true;
+		for (std::string::size_type i = 0; i < tok.size(); i++) {
+			char c = tok[i];
+			if ((c < '0' || c > '9') && !(i == 0 && (c == '-' || c == '+'))) {
+				bInt = false;
+				break;
+			}
+		}
+
+		if (dv.size() % 8 == 0) {
+			mask.push_back(0);
+		}
+		if (bInt && std::abs(d) < 9007199254740992.) {
+			mask.back() |= 1U << (dv.size() % 8);
+		}
+		dv.push_back(d);
+	}
+
+	if (bValues) {
+		unsigned short n = dv.size();
+		bin.push_back(char(REC_VALUES));
+		bin.insert(bin.end(), (const char *)&n, (const char *)&n + sizeof(n));
+		if (n > 0) {
+			bin.insert(bin.end(), (const char *)&mask[0],
+				(const char *)&mask[0] + mask.size());
+			bin.insert(bin.end(), (const char *)&dv[0],
+				(const char *)&dv[0] + n*sizeof(double));
+		}
+
+	} else {
+		unsigned len = e - b;
+		bin.push_back(char(REC_TEXT));
+		bin.insert(bin.end(), (const char *)&len, (const char *)&len + sizeof(len));
+		bin.insert(bin.end(), b, e);
+	}
+}
+
+void
+OutputBuf::PutValue(Value& v, std::ios_base& f, char fill)
+{
+	v.off = pptr() - pbase();
+	v.flags = f.flags();
+	v.prec = f.precision();
+	v.width = f.width();
+	v.fill = fill;
+	f.width(0);
+
+	Vals.push_back(v);
+}
+
+void
+OutputBuf::PutValue(double d, std::ios_base& f, char fill)
+{
+	Value v;
+	v.type = Value::DOUBLE;
+	v.d = d;
+	PutValue(v, f, fill);
+}
+
+void
+OutputBuf::PutValue(long l, std::ios_base& f, char fill)
+{
+	Value v;
+	v.type = Value::LONG;
+	v.l = l;
+	PutValue(v, f, fill);
+}
+
+void
+OutputBuf::PutValue(unsigned long ul, std::ios_base& f, char fill)
+{
+	Value v;
+	v.type = Value::ULONG;
+	v.ul = ul;
+	PutValue(v, f, fill);
+}
+
+OutputBuf::int_type
+OutputBuf::overflow(int_type c)
+{
+	if (!Drain(false)) {
+		return traits_type::eof();
+	}
+
+	if (traits_type::eq_int_type(c, traits_type::eof())) {
+		return traits_type::not_eof(c);
+	}
+
+	if (pptr() == epptr()) {
+		/* binary line longer than the buffer */
+		std::streamsize nKeep = pptr() - pbase();
+		buf.resize(2*buf.size());
+		SetPut(nKeep);
+	}
+
+	*pptr() = traits_type::to_char_type(c);
+	pbump(1);
+
+	return c;
+}
+
+std::streamsize
+OutputBuf::xsputn(const char *s, std::streamsize n)
+{
+	std::streamsize nDone = 0;
+
+	while (nDone < n) {
+		std::streamsize nAvail = epptr() - pptr();
+		if (nAvail == 0) {
+			if (traits_type::eq_int_type(overflow(traits_type::to_int_type(s[nDone])), traits_type::eof())) {
+				break;
+			}
+			nDone++;
+			continue;
+		}
+
+		std::streamsize nCopy = std::min(nAvail, n - nDone);
+		std::memcpy(pptr(), &s[nDone], nCopy);
+		pbump(int(nCopy));
+		nDone += nCopy;
+	}
+
+	return nDone;
+}
+
+int
+OutputBuf::sync(void)
+{
+	if (bDefer) {
+		return 0;
+	}
+
+	return Flush() ? 0 : -1;
+}
+
+bool
+OutputBuf::ConvertToText(const char *sName, std::ostream& out)
+{
+	std::ifstream in(sName, std::ios::in | std::ios::binary);
+	if (!in) {
+		silent_cerr("unable to open file \"" << sName << "\"" << std::endl);
+		return false;
+	}
+
+	char magic[sizeof(sMagic) - 1];
+	unsigned uVer;
+	in.read(magic, sizeof(magic));
+	in.read((char *)&uVer, sizeof(uVer));
+	if (!in || std::memcmp(magic, sMagic, sizeof(magic)) != 0) {
+		silent_cerr("file \"" << sName << "\" "
+			"is not an MBDyn binary output file" << std::endl);
+		return false;
+	}
+
+	if (uVer != uVersion) {
+		silent_cerr("file \"" << sName << "\": "
+			"unsupported version " << uVer
+			<< " (or wrong byte order)" << std::endl);
+		return false;
+	}
+
+	std::vector<double> dv;
+	std::vector<unsigned char> mask;
+	std::string line;
+
+	out.precision(std::numeric_limits<double>::digits10 + 1);
+
+	for (;;) {
+		int c = in.get();
+		if (c == EOF) {
+			break;
+		}
+
+		switch (c) {
+		case REC_VALUES: {
+			unsigned short n;
+			in.read((char *)&n, sizeof(n));
+			mask.resize((n + 7)/8);
+			dv.resize(n);
+			if (n > 0) {
+				in.read((char *)&mask[0], mask.size());
+				in.read((char *)&dv[0], n*sizeof(double));
+			}
+			if (!in) {
+				break;
+			}
+
+			for (unsigned i = 0; i < n; i++) {
+				if (i > 0) {
+					out << ' ';
+				}
+				if (mask[i/8] & (1U << (i % 8))) {
+					out << (long long)dv[i];
+				} else {
+					out << dv[i];
+				}
+			}
+			out << '\n';
+			} break;
+
+		case REC_TEXT: {
+			unsigned len;
+			in.read((char *)&len, sizeof(len));
+			line.resize(len);
+			if (len > 0) {
+				in.read(&line[0], len);
+			}
+			if (!in) {
+				break;
+			}
+			out << line << '\n';
+			} break;
+
+		default:
+			silent_cerr("file \"" << sName << "\": "
+				"unknown record type " << c
+				<< " at offset " << (long)in.tellg() - 1 << std::endl);
+			return false;
+		}
+
+		if (!in) {
+			silent_cerr("file \"" << sName << "\": "
+				"truncated record" << std::endl);
+			return false;
+		}
+	}
+
+	out.flush();
+
+	return true;
+}
+
+/* OutputBuf - end */
+
+#ifdef USE_MULTITHREAD
+
+/* OutputWriter - begin */
+
+OutputWriter::OutputWriter(size_t uMaxQueued)
+: uQueued(0), uMaxQueued(uMaxQueued), bBusy(false), bStop(false)
+{
+	if (uMaxQueued == 0) {
+		this->uMaxQueued = DEFAULT_MAX_QUEUED;
+	}
+
+	if (pthread_mutex_init(&mutex, NULL)) {
+		silent_cerr("OutputWriter::OutputWriter(): "
+				"mutex init failed" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	if (pthread_cond_init(&job_cond, NULL)
+		|| pthread_cond_init(&done_cond, NULL))
+	{
+		silent_cerr("OutputWriter::OutputWriter(): "
+				"cond init failed" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	if (pthread_create(&thread, NULL, Run, this) != 0) {
+		silent_cerr("OutputWriter::OutputWriter(): "
+				"pthread_create() failed" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+OutputWriter::~OutputWriter(void)
+{
+	pthread_mutex_lock(&mutex);
+	bStop = true;
+	pthread_cond_signal(&job_cond);
+	pthread_mutex_unlock(&mutex);
+
+	/* the writer empties the queue before exiting */
+	pthread_join(thread, NULL);
+
+	for (std::vector<std::vector<char> *>::iterator i = Free.begin();
+		i != Free.end(); ++i)
+	{
+		delete *i;
+	}
+
+	pthread_mutex_destroy(&mutex);
+	pthread_cond_destroy(&job_cond);
+	pthread_cond_destroy(&done_cond);
+}
+
+void *
+OutputWriter::Run(void *arg)
+{
+	((OutputWriter *)arg)->Loop();
+
+	return NULL;
+}
+
+void
+OutputWriter::Loop(void)
+{
+	pthread_mutex_lock(&mutex);
+	for (;;) {
+		while (Jobs.empty() && !bStop) {
+			pthread_cond_wait(&job_cond, &mutex);
+		}
+
+		if (Jobs.empty()) {
+			break;
+		}
+
+		Job j = Jobs.front();
+		Jobs.pop_front();
+		bBusy = true;
+		pthread_mutex_unlock(&mutex);
+
+		bool bOK = true;
+		size_t n = 0;
+		if (j.pData == 0) {
+			bOK = j.pOB->SyncOut();
+
+		} else {
+			n = j.pData->size();
+			if (n > 0) {
+				bOK = j.pOB->WriteOut(&(*j.pData)[0], n);
+			}
+			j.pData->clear();
+		}
+
+		pthread_mutex_lock(&mutex);
+		if (!bOK) {
+			Failed.insert(j.pOB);
+		}
+		if (j.pData != 0) {
+			uQueued -= n;
+			Free.push_back(j.pData);
+		}
+		bBusy = false;
+		pthread_cond_broadcast(&done_cond);
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+std::vector<char> *
+OutputWriter::pGetBuf(void)
+{
+	std::vector<char> *p = 0;
+
+	pthread_mutex_lock(&mutex);
+	if (!Free.empty()) {
+		p = Free.back();
+		Free.pop_back();
+	}
+	pthread_mutex_unlock(&mutex);
+
+	if (p == 0) {
+		p = new std::vector<char>;
+	}
+
+	return p;
+}
+
+void
+OutputWriter::Submit(OutputBuf *pOB, std::vector<char> *pData)
+{
+	size_t n = pData->size();
+	Job j = { pOB, pData };
+
+	pthread_mutex_lock(&mutex);
+	/* backpressure; a single job larger than the limit is let through */
+	while (!Jobs.empty() && uQueued + n > uMaxQueued) {
+		pthread_cond_wait(&done_cond, &mutex);
+	}
+	Jobs.push_back(j);
+	uQueued += n;
+	pthread_cond_signal(&job_cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+void
+OutputWriter::SubmitSync(OutputBuf *pOB)
+{
+	Job j = { pOB, 0 };
+
+	pthread_mutex_lock(&mutex);
+	Jobs.push_back(j);
+	pthread_cond_signal(&job_cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+bool
+OutputWriter::bFailed(const OutputBuf *pOB, bool bClear)
+{
+	pthread_mutex_lock(&mutex);
+	std::set<const OutputBuf *>::iterator i = Failed.find(pOB);
+	bool b = (i != Failed.end());
+	if (b && bClear) {
+		Failed.erase(i);
+	}
+	pthread_mutex_unlock(&mutex);
+
+	return b;
+}
+
+void
+OutputWriter::Wait(void)
+{
+	pthread_mutex_lock(&mutex);
+	while (!Jobs.empty() || bBusy) {
+		pthread_cond_wait(&done_cond, &mutex);
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+/* OutputWriter - end */
+
+#endif /* USE_MULTITHREAD */
+
+/* OutputStream - begin */
+
+/*
+ * Hands the numbers to the buffer, in binary mode; numbers in bases
+ * other than decimal, booleans as words and the like are formatted
+ * as usual, and thus stored as text.
+ */
+class OutputNumPut : public std::num_put<char> {
+protected:
+	OutputBuf *pOB;
+
+	static bool bDec(std::ios_base& f) {
+		std::ios_base::fmtflags b = f.flags() & std::ios_base::basefield;
+		return b == std::ios_base::dec || b == 0;
+	};
+
+	virtual iter_type
+	do_put(iter_type s, std::ios_base& f, char_type fill, bool v) const {
+		if (f.flags() & std::ios_base::boolalpha) {
+			return std::num_put<char>::do_put(s, f, fill, v);
+		}
+		pOB->PutValue(long(v), f, fill);
+		return s;
+	};
+
+	virtual iter_type
+	do_put(iter_type s, std::ios_base& f, char_type fill, long v) const {
+		if (!bDec(f)) {
+			return std::num_put<char>::do_put(s, f, fill, v);
+		}
+		pOB->PutValue(v, f, fill);
+		return s;
+	};
+
+	virtual iter_type
+	do_put(iter_type s, std::ios_base& f, char_type fill, unsigned long v) const {
+		if (!bDec(f)) {
+			return std::num_put<char>::do_put(s, f, fill, v);
+		}
+		pOB->PutValue(v, f, fill);
+		return s;
+	};
+
+	virtual iter_type
+	do_put(iter_type s, std::ios_base& f, char_type fill, double v) const {
+		pOB->PutValue(v, f, fill);
+		return s;
+	};
+
+public:
+	OutputNumPut(OutputBuf *p) : pOB(p) {};
+};
+
+OutputStream::OutputStream(void)
+: std::ostream(0)
+{
+	init(&ob);
+}
+
+OutputStream::~OutputStream(void)
+{
+	NO_OP;
+}
+
+void
+OutputStream::open(const char *sName, std::ios::openmode m)
+{
+	if (ob.open(sName, m) == 0) {
+		setstate(std::ios::failbit);
+
+	} else {
+		clear();
+	}
+
+	/* the locale takes ownership of the facet */
+	if (ob.GetMode() == OutputBuf::MODE_BINARY) {
+		imbue(std::locale(std::locale(), new OutputNumPut(&ob)));
+
+	} else {
+		imbue(std::locale());
+	}
+}
+
+bool
+OutputStream::is_open(void) const
+{
+	return ob.is_open();
+}
+
+void
+OutputStream::close(void)
+{
+	if (ob.close() == 0) {
+		setstate(std::ios::failbit);
+	}
+}
+
+OutputBuf&
+OutputStream::Buf(void)
+{
+	return ob;
+}
+
+/* OutputStream - end */
+
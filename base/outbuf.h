@@ -0,0 +1,238 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2014
+ *
+ * Pierangelo Masarati	<masarati@aero.polimi.it>
+ * Paolo Mantegazza	<mantegazza@aero.polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* buffered output streams */
+
+#ifndef OUTBUF_H
+#define OUTBUF_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#ifdef USE_MULTITHREAD
+#include <pthread.h>
+#include <deque>
+#include <set>
+#endif /* USE_MULTITHREAD */
+
+class OutputWriter;
+
+/*
+ * Stream buffer for the output files.  Data are collected in a
+ * user-space buffer and handed to the file only when the buffer fills
+ * up or when Flush() is called; if flushes are deferred, sync()
+ * (i.e. std::endl, std::flush) is a no-op, so the output is written
+ * at step boundaries rather than line by line.
+ *
+ * In binary mode, complete lines are packed into records: lines made
+ * of numbers only become a vector of doubles, with a bitmask telling
+ * which values were integers (labels and the like); any other line
+ * is stored verbatim.  The numbers written with operator<<() reach
+ * the buffer as values (see PutValue()), and are only formatted
+ * if their line turns out to be text; numbers written as text
+ * are parsed back.  ConvertToText() turns such a file back
+ * into text.
+ *
+ * If a writer is set, the filled buffer is handed to the writer
+ * thread instead of being written in place, and a fresh one is used;
+ * the file is then only accessed by the writer thread, and write
+ * errors are recorded by the writer until it is detached.
+ */
+class OutputBuf : public std::streambuf {
+public:
+	enum Mode {
+		MODE_TEXT,
+		MODE_BINARY
+	};
+
+	enum {
+		DEFAULT_SIZE = 1 << 16
+	};
+
+	/* binary format */
+	static const char sMagic[];
+	static const unsigned uVersion;
+	enum {
+		REC_VALUES = 'R',
+		REC_TEXT = 'T'
+	};
+
+protected:
+	std::filebuf fb;
+	std::vector<char> buf;
+	std::vector<char> bin;
+	Mode mode;
+	bool bDefer;
+	OutputWriter *pWriter;
+	bool bWriteFailed;
+
+	/* binary mode: values put in the pending lines, in order,
+	 * with what is needed to format them, if required */
+	struct Value {
+		enum { DOUBLE, LONG, ULONG } type;
+		double d;
+		long l;
+		unsigned long ul;
+		std::streamsize off;	/* in the put area */
+		std::ios_base::fmtflags flags;
+		std::streamsize prec;
+		std::streamsize width;
+		char fill;
+	};
+	std::vector<Value> Vals;
+	std::ostringstream fmt;
+
+	void SetPut(std::streamsize nKeep);
+	void PutValue(Value& v, std::ios_base& f, char fill);
+	void EncodeLine(const char *b, const char *e, size_t& iVal);
+	void EncodeText(const char *b, const char *e);
+	bool Drain(bool bAll);
+	bool Write(std::vector<char>& v, std::streamsize n);
+
+	virtual int_type overflow(int_type c);
+	virtual std::streamsize xsputn(const char *s, std::streamsize n);
+	virtual int sync(void);
+
+public:
+	OutputBuf(void);
+	virtual ~OutputBuf(void);
+
+	OutputBuf *open(const char *sName, std::ios::openmode m);
+	bool is_open(void) const;
+	OutputBuf *close(void);
+
+	/* must be called before open() */
+	void SetMode(Mode m);
+	Mode GetMode(void) const;
+
+	/* flushes any pending data */
+	void SetSize(size_t size);
+	void SetDefer(bool b);
+
+	/* pending data are written first */
+	void SetWriter(OutputWriter *p);
+
+	/* writes pending data to the file (or to the writer) */
+	bool Flush(void);
+
+	/* called by the writer thread */
+	bool WriteOut(const char *s, std::streamsize n);
+	bool SyncOut(void);
+
+	/* binary mode: a number written at the current position;
+	 * called by the num_put facet of OutputStream */
+	void PutValue(double d, std::ios_base& f, char fill);
+	void PutValue(long l, std::ios_base& f, char fill);
+	void PutValue(unsigned long ul, std::ios_base& f, char fill);
+
+	static bool ConvertToText(const char *sName, std::ostream& out);
+};
+
+#ifdef USE_MULTITHREAD
+/*
+ * Background thread that performs the actual file I/O of the output
+ * buffers, so that the solver only pays for formatting.  Only the
+ * I/O system calls are offloaded: Output() still formats on the
+ * solver thread, and NetCDF output is written synchronously, so it
+ * gains nothing from it.  Buffers are
+ * recycled through a free list; at most uMaxQueued bytes may be
+ * waiting, otherwise Submit() blocks until the writer catches up.
+ * Jobs are written in order, so each file gets its data in sequence.
+ */
+class OutputWriter {
+protected:
+	/* no data means sync */
+	struct Job {
+		OutputBuf *pOB;
+		std::vector<char> *pData;
+	};
+
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t job_cond;
+	pthread_cond_t done_cond;
+
+	std::deque<Job> Jobs;
+	std::vector<std::vector<char> *> Free;
+	std::set<const OutputBuf *> Failed;
+	size_t uQueued;
+	size_t uMaxQueued;
+	bool bBusy;
+	bool bStop;
+
+	static void *Run(void *arg);
+	void Loop(void);
+
+public:
+	enum {
+		DEFAULT_MAX_QUEUED = 1 << 24
+	};
+
+	/* 0 means DEFAULT_MAX_QUEUED */
+	OutputWriter(size_t uMaxQueued = 0);
+	virtual ~OutputWriter(void);
+
+	/* an empty buffer from the free list */
+	std::vector<char> *pGetBuf(void);
+
+	/* takes ownership of pData; may block */
+	void Submit(OutputBuf *pOB, std::vector<char> *pData);
+
+	/* syncs the file of pOB after the data queued so far */
+	void SubmitSync(OutputBuf *pOB);
+
+	/* until all queued data are written */
+	void Wait(void);
+
+	/* whether writing to the file of pOB failed so far */
+	bool bFailed(const OutputBuf *pOB, bool bClear = false);
+};
+#endif /* USE_MULTITHREAD */
+
+class OutputStream : public std::ostream {
+protected:
+	OutputBuf ob;
+
+public:
+	OutputStream(void);
+	virtual ~OutputStream(void);
+
+	void open(const char *sName, std::ios::openmode m = std::ios::out);
+	bool is_open(void) const;
+	void close(void);
+
+	OutputBuf& Buf(void);
+};
+
+#endif /* OUTBUF_H */
+
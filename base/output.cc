@@ -33,6 +33,8 @@
 
 #include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
 
+#include <cstdio>
+
 #include "output.h"
 
 /* OutputHandler - begin */
@@ -79,7 +81,10 @@ const char* psExt[] = {
 	".dof",
 	".drv",
 	".trc",
-	NULL		// 34
+	".prf",
+	".chk",		// 35
+	".sst",
+	NULL
 };
 
 /* Costruttore senza inizializzazione */
@@ -93,7 +98,14 @@ m_pBinFile(0),
 #endif /* USE_NETCDF */
 iCurrWidth(iDefaultWidth),
 iCurrPrecision(iDefaultPrecision),
-nCurrRestartFile(0)
+nCurrRestartFile(0),
+uBufSize(OutputBuf::DEFAULT_SIZE),
+CurrFlushPolicy(FLUSH_LINE),
+lFlushSteps(1),
+lStepsSinceFlush(0)
+#ifdef USE_MULTITHREAD
+, pWriter(0)
+#endif /* USE_MULTITHREAD */
 {
 	OutputHandler_int();
 }
@@ -109,7 +121,14 @@ m_pBinFile(0),
 #endif /* USE_NETCDF */
 iCurrWidth(iDefaultWidth),
 iCurrPrecision(iDefaultPrecision),
-nCurrRestartFile(0)
+nCurrRestartFile(0),
+uBufSize(OutputBuf::DEFAULT_SIZE),
+CurrFlushPolicy(FLUSH_LINE),
+lFlushSteps(1),
+lStepsSinceFlush(0)
+#ifdef USE_MULTITHREAD
+, pWriter(0)
+#endif /* USE_MULTITHREAD */
 {
 	OutputHandler_int();
 	Init(sFName, iExtNum);
@@ -125,7 +144,8 @@ OutputHandler::OutputHandler_int(void)
 
 	OutData[STRNODES].flags = OUTPUT_USE_DEFAULT_PRECISION | OUTPUT_USE_SCIENTIFIC
 		| OUTPUT_MAY_USE_TEXT | OUTPUT_USE_TEXT
-		| OUTPUT_MAY_USE_NETCDF;
+		| OUTPUT_MAY_USE_NETCDF
+		| OUTPUT_MAY_USE_BINARY;
 	OutData[STRNODES].pof = &ofStrNodes;
 
 	OutData[ELECTRIC].flags = OUTPUT_USE_DEFAULT_PRECISION | OUTPUT_USE_SCIENTIFIC
@@ -151,12 +171,14 @@ OutputHandler::OutputHandler_int(void)
 
 	OutData[JOINTS].flags = OUTPUT_USE_DEFAULT_PRECISION | OUTPUT_USE_SCIENTIFIC
 		| OUTPUT_MAY_USE_TEXT | OUTPUT_USE_TEXT
-		| OUTPUT_MAY_USE_NETCDF;
+		| OUTPUT_MAY_USE_NETCDF
+		| OUTPUT_MAY_USE_BINARY;
 	OutData[JOINTS].pof = &ofJoints;
 
 	OutData[FORCES].flags = OUTPUT_USE_DEFAULT_PRECISION | OUTPUT_USE_SCIENTIFIC
 		| OUTPUT_MAY_USE_TEXT | OUTPUT_USE_TEXT
-		| OUTPUT_MAY_USE_NETCDF;
+		| OUTPUT_MAY_USE_NETCDF
+		| OUTPUT_MAY_USE_BINARY;
 	OutData[FORCES].pof = &ofForces;
 
 	OutData[BEAMS].flags = OUTPUT_USE_DEFAULT_PRECISION | OUTPUT_USE_SCIENTIFIC
@@ -258,6 +280,19 @@ OutputHandler::OutputHandler_int(void)
 			| OUTPUT_MAY_USE_TEXT | OUTPUT_USE_TEXT;
 	OutData[TRACES].pof = &ofTraces;
 
+	OutData[PROFILE].flags = OUTPUT_USE_DEFAULT_PRECISION | OUTPUT_USE_SCIENTIFIC
+			| OUTPUT_MAY_USE_TEXT | OUTPUT_USE_TEXT;
+	OutData[PROFILE].pof = &ofProfile;
+
+	// binary
+	OutData[CHECKPOINT].flags = 0;
+	OutData[CHECKPOINT].pof = &ofCheckpoint;
+
+	OutData[SOLVERSTATS].flags = OUTPUT_USE_DEFAULT_PRECISION | OUTPUT_USE_SCIENTIFIC
+			| OUTPUT_MAY_USE_TEXT | OUTPUT_USE_TEXT
+			| OUTPUT_MAY_USE_BINARY;
+	OutData[SOLVERSTATS].pof = &ofSolverStats;
+
 	OutData[NETCDF].flags = 0
 		| OUTPUT_MAY_USE_NETCDF;
 	OutData[NETCDF].pof = 0;
@@ -291,6 +326,12 @@ OutputHandler::~OutputHandler(void)
 			}
 		}
 	}
+
+#ifdef USE_MULTITHREAD
+	if (pWriter != 0) {
+		delete pWriter;
+	}
+#endif /* USE_MULTITHREAD */
 }
 
 /* Aggiungere qui le funzioni che aprono i singoli stream */
@@ -319,6 +360,8 @@ OutputHandler::Open(const OutputHandler::OutFiles out)
 			const char *fname = _sPutExt(psExt[out]);
 
 			// Apre lo stream
+			OutData[out].pof->Buf().SetMode(UseBinary(out)
+				? OutputBuf::MODE_BINARY : OutputBuf::MODE_TEXT);
 			OutData[out].pof->open(fname);
 
 			if (!(*OutData[out].pof)) {
@@ -326,6 +369,8 @@ OutputHandler::Open(const OutputHandler::OutFiles out)
 					"\"" << fname << "\"" << std::endl);
 				throw ErrFile(MBDYN_EXCEPT_ARGS);
 			}
+
+			SetBuf(out);
 		}
 
 		if (UseText(out)) {
@@ -442,6 +487,131 @@ OutputHandler::UseText(const OutputHandler::OutFiles out) const
 	return (OutData[out].flags & OUTPUT_USE_TEXT);
 }
 
+bool
+OutputHandler::UseBinary(int out) const
+{
+	ASSERT(out > OutputHandler::UNKNOWN);
+	ASSERT(out < OutputHandler::LASTFILE);
+
+	return UseBinary(OutputHandler::OutFiles(out));
+}
+
+void
+OutputHandler::SetBinary(const OutputHandler::OutFiles out)
+{
+	if (!(OutData[out].flags & OUTPUT_MAY_USE_BINARY)) {
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	OutData[out].flags |= OUTPUT_USE_BINARY;
+}
+
+bool
+OutputHandler::UseBinary(const OutputHandler::OutFiles out) const
+{
+	return (OutData[out].flags & OUTPUT_USE_BINARY);
+}
+
+void
+OutputHandler::SetBuf(int out)
+{
+	OutputBuf& ob = OutData[out].pof->Buf();
+
+	ob.SetSize(uBufSize);
+
+	// the log is always flushed, to be useful in case of crash
+	ob.SetDefer(CurrFlushPolicy != FLUSH_LINE && out != LOG);
+#ifdef USE_MULTITHREAD
+	ob.SetWriter(out != LOG ? pWriter : 0);
+#endif /* USE_MULTITHREAD */
+}
+
+void
+OutputHandler::SetBufferSize(size_t size)
+{
+	uBufSize = size;
+	for (int iCnt = 0; iCnt < LASTFILE; iCnt++) {
+		if (OutData[iCnt].pof != 0 && IsOpen(iCnt)) {
+			SetBuf(iCnt);
+		}
+	}
+}
+
+void
+OutputHandler::SetFlushPolicy(FlushPolicy fp, long lSteps)
+{
+	ASSERT(lSteps > 0);
+
+	CurrFlushPolicy = fp;
+	lFlushSteps = lSteps;
+	lStepsSinceFlush = 0;
+	for (int iCnt = 0; iCnt < LASTFILE; iCnt++) {
+		if (OutData[iCnt].pof != 0 && IsOpen(iCnt)) {
+			SetBuf(iCnt);
+		}
+	}
+}
+
+void
+OutputHandler::SetAsync(bool bAsync, size_t uMaxQueued)
+{
+#ifdef USE_MULTITHREAD
+	OutputWriter *pOld = pWriter;
+
+	pWriter = 0;
+	if (bAsync) {
+		pWriter = new OutputWriter(uMaxQueued);
+	}
+
+	// detach the streams from the old writer before deleting it
+	for (int iCnt = 0; iCnt < LASTFILE; iCnt++) {
+		if (OutData[iCnt].pof != 0 && IsOpen(iCnt)) {
+			SetBuf(iCnt);
+		}
+	}
+
+	if (pOld != 0) {
+		delete pOld;
+	}
+#else /* ! USE_MULTITHREAD */
+	if (bAsync) {
+		silent_cerr("asynchronous output requires multithread support"
+			<< std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+#endif /* ! USE_MULTITHREAD */
+}
+
+void
+OutputHandler::StepFlush(void)
+{
+	if (CurrFlushPolicy != FLUSH_STEP) {
+		return;
+	}
+
+	if (++lStepsSinceFlush < lFlushSteps) {
+		return;
+	}
+
+	lStepsSinceFlush = 0;
+	Flush();
+}
+
+bool
+OutputHandler::Flush(void)
+{
+	bool bOK = true;
+	for (int iCnt = 0; iCnt < LASTFILE; iCnt++) {
+		if (OutData[iCnt].pof != 0 && IsOpen(iCnt)) {
+			if (!OutData[iCnt].pof->Buf().Flush()) {
+				bOK = false;
+			}
+		}
+	}
+
+	return bOK;
+}
+
 bool
 OutputHandler::UseNetCDF(int out) const
 {
@@ -581,6 +751,52 @@ OutputHandler::RestartOpen(bool openResXSol)
 	return true;
 }
 
+std::string
+OutputHandler::sCheckpointName(void)
+{
+	return std::string(_sPutExt(psExt[CHECKPOINT]));
+}
+
+bool
+OutputHandler::CheckpointOpen(void)
+{
+	if (IsOpen(CHECKPOINT)) {
+		return false;
+	}
+
+	std::string sTmp = sCheckpointName() + ".tmp";
+	OutData[CHECKPOINT].pof->open(sTmp.c_str());
+	if (!(*OutData[CHECKPOINT].pof)) {
+		silent_cerr("Unable to open file "
+			"\"" << sTmp << "\"" << std::endl);
+		throw ErrFile(MBDYN_EXCEPT_ARGS);
+	}
+
+	return true;
+}
+
+bool
+OutputHandler::CheckpointClose(void)
+{
+	if (!IsOpen(CHECKPOINT)) {
+		return false;
+	}
+
+	OutData[CHECKPOINT].pof->close();
+
+	std::string sName = sCheckpointName();
+	std::string sTmp = sName + ".tmp";
+	if (!(*OutData[CHECKPOINT].pof)
+		|| rename(sTmp.c_str(), sName.c_str()) != 0)
+	{
+		silent_cerr("Unable to write checkpoint file "
+			"\"" << sName << "\"" << std::endl);
+		throw ErrFile(MBDYN_EXCEPT_ARGS);
+	}
+
+	return true;
+}
+
 bool
 OutputHandler::PartitionOpen(void)
 {
@@ -45,6 +45,7 @@
 #include <iomanip>
 #include <fstream>
 #include <vector>
+#include <string>
 #include <typeinfo>
 
 #ifdef USE_NETCDF
@@ -59,6 +60,7 @@
 #include "except.h"
 #include "solman.h"
 #include "filename.h"
+#include "outbuf.h"
 
 /* OutputHandler - begin */
 
@@ -101,7 +103,17 @@ public:
 		DOFSTATS,
 		DRIVECALLERS,
 		TRACES,
-		LASTFILE			// 34
+		PROFILE,
+		CHECKPOINT,			// 35
+		SOLVERSTATS,
+		LASTFILE
+	};
+
+	/* when buffered output is handed to the files */
+	enum FlushPolicy {
+		FLUSH_LINE,		// at each std::endl (default)
+		FLUSH_STEP,		// every lFlushSteps output steps
+		FLUSH_NONE		// only when buffers are full
 	};
 
 private:
@@ -130,13 +142,15 @@ private:
 		OUTPUT_USE_TEXT			= 0x20U,
 		OUTPUT_MAY_USE_NETCDF		= 0x40U,
 		OUTPUT_USE_NETCDF		= 0x80U,
+		OUTPUT_MAY_USE_BINARY		= 0x100U,
+		OUTPUT_USE_BINARY		= 0x200U,
 
 		LAST
 	};
 
 	/* Aggiungere qui i files che si desidera avere a disposizione */
 	struct {
-		std::ofstream*	pof;
+		OutputStream*	pof;
 		unsigned	flags;
 	} OutData[LASTFILE];
 		
@@ -149,44 +163,56 @@ private:
 #endif /* USE_NETCDF */
 
 	/* handlers to streams */
-	std::ofstream ofOutput;      		/*  0 */
-	std::ofstream ofStrNodes;
-	std::ofstream ofElectric;
-	std::ofstream ofAbstract;
-	std::ofstream ofInertia;
-	std::ofstream ofJoints;      		/*  5 */
-	std::ofstream ofForces;
-	std::ofstream ofBeams;
-	std::ofstream ofRotors;
-	std::ofstream ofRestart;
-	std::ofstream ofRestartXSol; 		/* 10 */
-	std::ofstream ofAerodynamic;
-	std::ofstream ofHydraulic;
-	std::ofstream ofPresNodes;
-	std::ofstream ofLoadable;
-	std::ofstream ofGenels;			/* 15 */
-	std::ofstream ofPartition;
-	std::ofstream ofAdamsRes;
-	std::ofstream ofAdamsCmd;
-	std::ofstream ofAeroModals;
-	std::ofstream ofReferenceFrames;	/* 20 */
-	std::ofstream ofLog;
-	std::ofstream ofAirProps;
-	std::ofstream ofParameters;
-	std::ofstream ofExternals;
-	std::ofstream ofModal;
-	std::ofstream ofThermalNodes;
-	std::ofstream ofThermalElements;
-	std::ofstream ofPlates;
-	std::ofstream ofGravity;
-	std::ofstream ofDofStats;
-	std::ofstream ofDriveCallers;
-	std::ofstream ofTraces;
+	OutputStream ofOutput;      		/*  0 */
+	OutputStream ofStrNodes;
+	OutputStream ofElectric;
+	OutputStream ofAbstract;
+	OutputStream ofInertia;
+	OutputStream ofJoints;      		/*  5 */
+	OutputStream ofForces;
+	OutputStream ofBeams;
+	OutputStream ofRotors;
+	OutputStream ofRestart;
+	OutputStream ofRestartXSol; 		/* 10 */
+	OutputStream ofAerodynamic;
+	OutputStream ofHydraulic;
+	OutputStream ofPresNodes;
+	OutputStream ofLoadable;
+	OutputStream ofGenels;			/* 15 */
+	OutputStream ofPartition;
+	OutputStream ofAdamsRes;
+	OutputStream ofAdamsCmd;
+	OutputStream ofAeroModals;
+	OutputStream ofReferenceFrames;	/* 20 */
+	OutputStream ofLog;
+	OutputStream ofAirProps;
+	OutputStream ofParameters;
+	OutputStream ofExternals;
+	OutputStream ofModal;
+	OutputStream ofThermalNodes;
+	OutputStream ofThermalElements;
+	OutputStream ofPlates;
+	OutputStream ofGravity;
+	OutputStream ofDofStats;
+	OutputStream ofDriveCallers;
+	OutputStream ofTraces;
+	OutputStream ofProfile;
+	OutputStream ofCheckpoint;		/* 35 */
+	OutputStream ofSolverStats;
 
 	int iCurrWidth;
 	int iCurrPrecision;
 	int nCurrRestartFile;
 
+	// buffering of the output streams
+	size_t uBufSize;
+	FlushPolicy CurrFlushPolicy;
+	long lFlushSteps;
+	long lStepsSinceFlush;
+#ifdef USE_MULTITHREAD
+	OutputWriter *pWriter;
+#endif /* USE_MULTITHREAD */
+
 	// private because we know we're using valid out index
 	bool IsOpen(int out) const;
 	bool UseDefaultPrecision(int out) const;
@@ -194,6 +220,10 @@ private:
 
 	bool UseText(int out) const;
 	bool UseNetCDF(int out) const;
+	bool UseBinary(int out) const;
+
+	// applies the buffering policy to an open stream
+	void SetBuf(int out);
 
 	// Pseudo-constructor
 	void OutputHandler_int(void);
@@ -224,11 +254,34 @@ public:
 	void ClearNetCDF(const OutputHandler::OutFiles out);
 	bool UseNetCDF(const OutputHandler::OutFiles out) const;
 
+	// compact binary records; only affects files opened later
+	void SetBinary(const OutputHandler::OutFiles out);
+	bool UseBinary(const OutputHandler::OutFiles out) const;
+
+	void SetBufferSize(size_t size);
+	void SetFlushPolicy(FlushPolicy fp, long lSteps = 1);
+
+	// only the write()/fsync() calls of the text and binary streams
+	// move to a background thread: formatting stays on the solver
+	// thread, the log is synchronous, and NetCDF output does not
+	// benefit; 0 means default queue size
+	void SetAsync(bool bAsync, size_t uMaxQueued = 0);
+
+	// called at the end of each output step
+	void StepFlush(void);
+	bool Flush(void);
+
 	bool Close(const OutputHandler::OutFiles out);
 
 	bool OutputOpen(void);
 	bool RestartOpen(bool openResXSol = false);
 
+	// the checkpoint is written to a temporary file,
+	// which replaces the previous one when closed
+	bool CheckpointOpen(void);
+	bool CheckpointClose(void);
+	std::string sCheckpointName(void);
+
 	bool PartitionOpen(void);
 	bool AdamsResOpen(void);
 	bool AdamsCmdOpen(void);
@@ -270,6 +323,9 @@ public:
 	inline std::ostream& DofStats(void) const;
 	inline std::ostream& DriveCallers(void) const;
 	inline std::ostream& Traces(void) const;
+	inline std::ostream& Profile(void) const;
+	inline std::ostream& Checkpoint(void) const;
+	inline std::ostream& SolverStats(void) const;
 
 	inline int iW(void) const;
 	inline int iP(void) const;
@@ -627,6 +683,27 @@ OutputHandler::Traces(void) const
 	return const_cast<std::ostream &>(dynamic_cast<const std::ostream &>(ofTraces));
 }
 
+inline std::ostream&
+OutputHandler::Profile(void) const
+{
+	ASSERT(IsOpen(PROFILE));
+	return const_cast<std::ostream &>(dynamic_cast<const std::ostream &>(ofProfile));
+}
+
+inline std::ostream&
+OutputHandler::Checkpoint(void) const
+{
+	ASSERT(IsOpen(CHECKPOINT));
+	return const_cast<std::ostream &>(dynamic_cast<const std::ostream &>(ofCheckpoint));
+}
+
+inline std::ostream&
+OutputHandler::SolverStats(void) const
+{
+	ASSERT(IsOpen(SOLVERSTATS));
+	return const_cast<std::ostream &>(dynamic_cast<const std::ostream &>(ofSolverStats));
+}
+
 inline int
 OutputHandler::iW(void) const
 {
@@ -0,0 +1,60 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2014
+ *
+ * Pierangelo Masarati	<masarati@aero.polimi.it>
+ * Paolo Mantegazza	<mantegazza@aero.polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PATSOLMAN_H
+#define PATSOLMAN_H
+
+class DataManager;
+
+/*
+ * Optional interface of the solution managers that can keep
+ * the symbolic factorization of the matrix (ordering, pattern
+ * of the factors) across reassemblies; detected by dynamic_cast.
+ *
+ * The DataManager tells when the pattern of the Jacobian matrix
+ * changes; as long as its pattern generation does not change,
+ * MatrInitialize() only invalidates the numerical factorization.
+ */
+class PatternSolutionManager {
+public:
+	virtual ~PatternSolutionManager(void) {
+		NO_OP;
+	};
+
+	/* source of the pattern generation */
+	virtual void SetPatternSource(const DataManager *pDM) = 0;
+
+	/* number of symbolic and numerical factorizations */
+	virtual unsigned GetSymbolicCount(void) const = 0;
+	virtual unsigned GetNumericCount(void) const = 0;
+};
+
+#endif /* PATSOLMAN_H */
@@ -38,8 +38,15 @@
   */
   
 #include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
-  
+
+#include <time.h>
+#include <cmath>
+#include <algorithm>
+
 #include "precond_.h"  
+#include "spmh.h"
+#include "naivemh.h"
+#include "dataman.h"
 
 Preconditioner::~Preconditioner(void)
 {
@@ -89,3 +96,628 @@ FullJacobianPr::Precond(VectorHandler& b, VectorHandler& x,
 	}
 }
 
+
+void
+Preconditioner::MatrReset(const DataManager * /* pDM */ )
+{
+	NO_OP;
+}
+
+static doublereal
+precond_wall_time(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return doublereal(ts.tv_sec) + 1e-9*doublereal(ts.tv_nsec);
+}
+
+SparseFactorPr::SparseFactorPr(void)
+: pDM(0),
+bValid(false),
+iSize(0),
+uBuilds(0),
+uFixedPivots(0),
+dBuildTime(0.)
+{
+	NO_OP;
+}
+
+SparseFactorPr::~SparseFactorPr(void)
+{
+	NO_OP;
+}
+
+void
+SparseFactorPr::MatrReset(const DataManager *pDataMan)
+{
+	pDM = pDataMan;
+	bValid = false;
+}
+
+/* copies the matrix in compressed row form, 0-based,
+ * with the columns of each row in ascending order */
+void
+SparseFactorPr::GetCSR(const MatrixHandler& MH) const
+{
+	iSize = MH.iGetNumRows();
+
+	std::vector<integer> Ri, Ci;
+	std::vector<doublereal> V;
+
+	const SparseMatrixHandler *pSpMH = dynamic_cast<const SparseMatrixHandler *>(&MH);
+	const NaiveMatrixHandler *pNaMH = dynamic_cast<const NaiveMatrixHandler *>(&MH);
+	if (pSpMH != 0) {
+		std::vector<doublereal> Cx;
+		std::vector<integer> Cr, Cp;
+		pSpMH->MakeCompressedColumnForm(Cx, Cr, Cp, 0);
+		for (integer c = 0; c < iSize; c++) {
+			for (integer p = Cp[c]; p < Cp[c + 1]; p++) {
+				if (Cx[p] != 0.) {
+					Ri.push_back(Cr[p]);
+					Ci.push_back(c);
+					V.push_back(Cx[p]);
+				}
+			}
+		}
+
+	} else if (pNaMH != 0) {
+		for (NaiveMatrixHandler::const_iterator i = pNaMH->begin();
+			i != pNaMH->end(); ++i)
+		{
+			if (i->dCoef != 0.) {
+				Ri.push_back(i->iRow);
+				Ci.push_back(i->iCol);
+				V.push_back(i->dCoef);
+			}
+		}
+
+	} else {
+		/* dense storage */
+		for (integer c = 1; c <= iSize; c++) {
+			for (integer r = 1; r <= iSize; r++) {
+				doublereal d = MH(r, c);
+				if (d != 0.) {
+					Ri.push_back(r - 1);
+					Ci.push_back(c - 1);
+					V.push_back(d);
+				}
+			}
+		}
+	}
+
+	/* counting sort by row */
+	Ap.assign(iSize + 1, 0);
+	for (unsigned k = 0; k < Ri.size(); k++) {
+		Ap[Ri[k] + 1]++;
+	}
+	for (integer r = 0; r < iSize; r++) {
+		Ap[r + 1] += Ap[r];
+	}
+
+	Aj.resize(Ri.size());
+	Ax.resize(Ri.size());
+	std::vector<integer> Pos(Ap.begin(), Ap.end() - 1);
+	for (unsigned k = 0; k < Ri.size(); k++) {
+		integer p = Pos[Ri[k]]++;
+		Aj[p] = Ci[k];
+		Ax[p] = V[k];
+	}
+
+	/* insertion sort of each row, a no-op when
+	 * the entries came ordered by column */
+	for (integer r = 0; r < iSize; r++) {
+		for (integer p = Ap[r] + 1; p < Ap[r + 1]; p++) {
+			integer j = Aj[p];
+			doublereal d = Ax[p];
+			integer q = p;
+			for (; q > Ap[r] && Aj[q - 1] > j; q--) {
+				Aj[q] = Aj[q - 1];
+				Ax[q] = Ax[q - 1];
+			}
+			Aj[q] = j;
+			Ax[q] = d;
+		}
+	}
+}
+
+/* zero pivots are typical of the rows of algebraic constraints;
+ * they are replaced by a small fraction of the row magnitude */
+doublereal
+SparseFactorPr::dFixPivot(doublereal d, doublereal dNorm) const
+{
+	doublereal dMin = 1.e-4*(dNorm > 0. ? dNorm : 1.);
+	if (std::abs(d) < dMin) {
+		uFixedPivots++;
+		return d < 0. ? -dMin : dMin;
+	}
+
+	return d;
+}
+
+void
+SparseFactorPr::Precond(VectorHandler& b, VectorHandler& x, 
+		SolutionManager* pSM) const
+{
+	if (!bValid) {
+		doublereal dStart = precond_wall_time();
+		unsigned uFixed = uFixedPivots;
+
+		GetCSR(*pSM->pMatHdl());
+		Factor();
+
+		doublereal dTime = precond_wall_time() - dStart;
+		dBuildTime += dTime;
+		uBuilds++;
+		bValid = true;
+
+		if (pDM != 0) {
+			pDM->GetLogFile() << sGetName() << " preconditioner"
+				<< " build " << uBuilds
+				<< ": size " << iSize
+				<< ", nonzeros " << Aj.size()
+				<< ", factor nonzeros " << ulGetFactorNZ()
+				<< ", fixed pivots " << uFixedPivots - uFixed
+				<< ", time " << dTime << " s"
+				<< " (total " << dBuildTime << " s)"
+				<< std::endl;
+		}
+	}
+
+	if (&x != &b) {
+		x = b;
+	}
+	Solve(x.pdGetVec());
+}
+
+IncompleteLUPr::~IncompleteLUPr(void)
+{
+	NO_OP;
+}
+
+unsigned long
+IncompleteLUPr::ulGetFactorNZ(void) const
+{
+	return Lx.size() + Ux.size() + Dinv.size();
+}
+
+void
+IncompleteLUPr::Solve(doublereal *px) const
+{
+	for (integer i = 0; i < iSize; i++) {
+		doublereal d = px[i];
+		for (integer p = Lp[i]; p < Lp[i + 1]; p++) {
+			d -= Lx[p]*px[Lj[p]];
+		}
+		px[i] = d;
+	}
+
+	for (integer i = iSize - 1; i >= 0; i--) {
+		doublereal d = px[i];
+		for (integer p = Up[i]; p < Up[i + 1]; p++) {
+			d -= Ux[p]*px[Uj[p]];
+		}
+		px[i] = d*Dinv[i];
+	}
+}
+
+ILUPr::ILUPr(integer iLev)
+: iLevel(iLev)
+{
+	NO_OP;
+}
+
+ILUPr::~ILUPr(void)
+{
+	NO_OP;
+}
+
+const char *
+ILUPr::sGetName(void) const
+{
+	return "ILU";
+}
+
+/*
+ * Row-wise (IKJ) ILU(k); the working row is kept in a linked list
+ * ordered by column, so that fill-in is eliminated in order.
+ */
+void
+ILUPr::Factor(void) const
+{
+	const integer n = iSize;
+
+	Lp.assign(1, 0);
+	Lj.clear();
+	Lx.clear();
+	Up.assign(1, 0);
+	Uj.clear();
+	Ux.clear();
+	Dinv.resize(n);
+
+	std::vector<integer> ULev;
+	std::vector<doublereal> w(n, 0.);
+	std::vector<integer> lev(n, -1);
+	std::vector<integer> next(n, -1);
+	std::vector<integer> Row;
+
+	for (integer i = 0; i < n; i++) {
+		doublereal dNorm = 0.;
+		bool bDiag = false;
+
+		Row.clear();
+		for (integer p = Ap[i]; p < Ap[i + 1]; p++) {
+			integer j = Aj[p];
+			if (!bDiag && j >= i) {
+				if (j != i) {
+					Row.push_back(i);
+				}
+				bDiag = true;
+			}
+			Row.push_back(j);
+			w[j] = Ax[p];
+			dNorm = std::max(dNorm, std::abs(Ax[p]));
+		}
+		if (!bDiag) {
+			Row.push_back(i);
+		}
+
+		for (unsigned q = 0; q < Row.size(); q++) {
+			lev[Row[q]] = 0;
+			next[Row[q]] = q + 1 < Row.size() ? Row[q + 1] : -1;
+		}
+		integer head = Row[0];
+
+		for (integer k = head; k != -1 && k < i; k = next[k]) {
+			doublereal dMul = w[k]*Dinv[k];
+			w[k] = dMul;
+
+			integer pos = k;
+			for (integer p = Up[k]; p < Up[k + 1]; p++) {
+				integer j = Uj[p];
+				integer nl = lev[k] + ULev[p] + 1;
+
+				if (lev[j] < 0) {
+					if (nl > iLevel) {
+						continue;
+					}
+					while (next[pos] != -1 && next[pos] < j) {
+						pos = next[pos];
+					}
+					next[j] = next[pos];
+					next[pos] = j;
+					lev[j] = nl;
+					w[j] = -dMul*Ux[p];
+
+				} else {
+					w[j] -= dMul*Ux[p];
+					if (nl < lev[j]) {
+						lev[j] = nl;
+					}
+				}
+				pos = j;
+			}
+		}
+
+		for (integer k = head; k != -1; ) {
+			if (k < i) {
+				Lj.push_back(k);
+				Lx.push_back(w[k]);
+
+			} else if (k > i) {
+				Uj.push_back(k);
+				Ux.push_back(w[k]);
+				ULev.push_back(lev[k]);
+			}
+
+			integer kn = next[k];
+			if (k != i) {
+				w[k] = 0.;
+			}
+			lev[k] = -1;
+			next[k] = -1;
+			k = kn;
+		}
+
+		Dinv[i] = 1./dFixPivot(w[i], dNorm);
+		w[i] = 0.;
+
+		Lp.push_back(Lj.size());
+		Up.push_back(Uj.size());
+	}
+}
+
+ILUTPr::ILUTPr(doublereal dT, integer iF)
+: dTau(dT),
+iFill(iF)
+{
+	NO_OP;
+}
+
+ILUTPr::~ILUTPr(void)
+{
+	NO_OP;
+}
+
+const char *
+ILUTPr::sGetName(void) const
+{
+	return "ILUT";
+}
+
+typedef std::pair<doublereal, integer> IlutEntry;
+
+static bool
+ilut_larger(const IlutEntry& a, const IlutEntry& b)
+{
+	return std::abs(a.first) > std::abs(b.first);
+}
+
+static bool
+ilut_column(const IlutEntry& a, const IlutEntry& b)
+{
+	return a.second < b.second;
+}
+
+/* keeps the iFill largest entries, ordered by column */
+static void
+ilut_select(std::vector<IlutEntry>& v, integer iFill)
+{
+	if (v.size() > unsigned(iFill)) {
+		std::nth_element(v.begin(), v.begin() + iFill, v.end(), ilut_larger);
+		v.resize(iFill);
+	}
+	std::sort(v.begin(), v.end(), ilut_column);
+}
+
+/*
+ * ILUT(tau, p): entries smaller than tau times the norm of the row
+ * are dropped, both during the elimination and when storing;
+ * at most p entries are kept in each row of L and U
+ * (Y. Saad, "ILUT: a dual threshold incomplete LU factorization", 1994)
+ */
+void
+ILUTPr::Factor(void) const
+{
+	const integer n = iSize;
+
+	Lp.assign(1, 0);
+	Lj.clear();
+	Lx.clear();
+	Up.assign(1, 0);
+	Uj.clear();
+	Ux.clear();
+	Dinv.resize(n);
+
+	std::vector<doublereal> w(n, 0.);
+	std::vector<integer> mark(n, -1);
+	std::vector<integer> next(n, -1);
+	std::vector<integer> Row;
+	std::vector<IlutEntry> LRow, URow;
+
+	for (integer i = 0; i < n; i++) {
+		doublereal dNorm2 = 0., dMax = 0.;
+		bool bDiag = false;
+
+		Row.clear();
+		for (integer p = Ap[i]; p < Ap[i + 1]; p++) {
+			integer j = Aj[p];
+			if (!bDiag && j >= i) {
+				if (j != i) {
+					Row.push_back(i);
+				}
+				bDiag = true;
+			}
+			Row.push_back(j);
+			w[j] = Ax[p];
+			dNorm2 += Ax[p]*Ax[p];
+			dMax = std::max(dMax, std::abs(Ax[p]));
+		}
+		if (!bDiag) {
+			Row.push_back(i);
+		}
+
+		for (unsigned q = 0; q < Row.size(); q++) {
+			mark[Row[q]] = i;
+			next[Row[q]] = q + 1 < Row.size() ? Row[q + 1] : -1;
+		}
+		integer head = Row[0];
+
+		doublereal dDrop = dTau*std::sqrt(dNorm2/(Ap[i + 1] - Ap[i] + 1));
+
+		for (integer k = head; k != -1 && k < i; k = next[k]) {
+			doublereal dMul = w[k]*Dinv[k];
+			if (std::abs(dMul) < dDrop) {
+				w[k] = 0.;
+				continue;
+			}
+			w[k] = dMul;
+
+			integer pos = k;
+			for (integer p = Up[k]; p < Up[k + 1]; p++) {
+				integer j = Uj[p];
+
+				if (mark[j] != i) {
+					while (next[pos] != -1 && next[pos] < j) {
+						pos = next[pos];
+					}
+					next[j] = next[pos];
+					next[pos] = j;
+					mark[j] = i;
+					w[j] = -dMul*Ux[p];
+
+				} else {
+					w[j] -= dMul*Ux[p];
+				}
+				pos = j;
+			}
+		}
+
+		LRow.clear();
+		URow.clear();
+		doublereal dDiag = 0.;
+		for (integer k = head; k != -1; ) {
+			if (k == i) {
+				dDiag = w[k];
+
+			} else if (std::abs(w[k]) >= dDrop && w[k] != 0.) {
+				if (k < i) {
+					LRow.push_back(IlutEntry(w[k], k));
+				} else {
+					URow.push_back(IlutEntry(w[k], k));
+				}
+			}
+
+			integer kn = next[k];
+			w[k] = 0.;
+			next[k] = -1;
+			k = kn;
+		}
+
+		ilut_select(LRow, iFill);
+		ilut_select(URow, iFill);
+
+		for (unsigned q = 0; q < LRow.size(); q++) {
+			Lj.push_back(LRow[q].second);
+			Lx.push_back(LRow[q].first);
+		}
+		for (unsigned q = 0; q < URow.size(); q++) {
+			Uj.push_back(URow[q].second);
+			Ux.push_back(URow[q].first);
+		}
+
+		Dinv[i] = 1./dFixPivot(dDiag, dMax);
+
+		Lp.push_back(Lj.size());
+		Up.push_back(Uj.size());
+	}
+}
+
+BlockJacobiPr::BlockJacobiPr(void)
+{
+	NO_OP;
+}
+
+BlockJacobiPr::~BlockJacobiPr(void)
+{
+	NO_OP;
+}
+
+const char *
+BlockJacobiPr::sGetName(void) const
+{
+	return "block Jacobi";
+}
+
+unsigned long
+BlockJacobiPr::ulGetFactorNZ(void) const
+{
+	return LU.size();
+}
+
+/* dense LU with partial pivoting of each diagonal block,
+ * column-major; blocks are the dofs of each DofOwner */
+void
+BlockJacobiPr::Factor(void) const
+{
+	Blocks.clear();
+	if (pDM != 0) {
+		pDM->GetDofBlocks(Blocks);
+	}
+
+	/* e.g. local matrices of parallel solvers: point Jacobi */
+	if (Blocks.empty() || Blocks.back() != iSize) {
+		Blocks.resize(iSize + 1);
+		for (integer i = 0; i <= iSize; i++) {
+			Blocks[i] = i;
+		}
+	}
+
+	const unsigned nb = Blocks.size() - 1;
+	Offsets.resize(nb + 1);
+	Offsets[0] = 0;
+	for (unsigned b = 0; b < nb; b++) {
+		integer m = Blocks[b + 1] - Blocks[b];
+		Offsets[b + 1] = Offsets[b] + m*m;
+	}
+
+	LU.assign(Offsets[nb], 0.);
+	Piv.resize(iSize);
+
+	for (unsigned b = 0; b < nb; b++) {
+		const integer s = Blocks[b];
+		const integer m = Blocks[b + 1] - s;
+		doublereal *pA = &LU[Offsets[b]];
+		doublereal dNorm = 0.;
+
+		for (integer r = 0; r < m; r++) {
+			for (integer p = Ap[s + r]; p < Ap[s + r + 1]; p++) {
+				integer c = Aj[p] - s;
+				if (c >= 0 && c < m) {
+					pA[r + m*c] = Ax[p];
+					dNorm = std::max(dNorm, std::abs(Ax[p]));
+				}
+			}
+		}
+
+		for (integer k = 0; k < m; k++) {
+			integer ip = k;
+			for (integer r = k + 1; r < m; r++) {
+				if (std::abs(pA[r + m*k]) > std::abs(pA[ip + m*k])) {
+					ip = r;
+				}
+			}
+			Piv[s + k] = ip;
+			if (ip != k) {
+				for (integer c = 0; c < m; c++) {
+					std::swap(pA[k + m*c], pA[ip + m*c]);
+				}
+			}
+
+			pA[k + m*k] = dFixPivot(pA[k + m*k], dNorm);
+			doublereal dInv = 1./pA[k + m*k];
+			for (integer r = k + 1; r < m; r++) {
+				pA[r + m*k] *= dInv;
+			}
+			for (integer c = k + 1; c < m; c++) {
+				doublereal d = pA[k + m*c];
+				if (d != 0.) {
+					for (integer r = k + 1; r < m; r++) {
+						pA[r + m*c] -= pA[r + m*k]*d;
+					}
+				}
+			}
+		}
+	}
+}
+
+void
+BlockJacobiPr::Solve(doublereal *px) const
+{
+	const unsigned nb = Blocks.size() - 1;
+
+	for (unsigned b = 0; b < nb; b++) {
+		const integer s = Blocks[b];
+		const integer m = Blocks[b + 1] - s;
+		const doublereal *pA = &LU[Offsets[b]];
+		doublereal *py = px + s;
+
+		for (integer k = 0; k < m; k++) {
+			if (Piv[s + k] != k) {
+				std::swap(py[k], py[Piv[s + k]]);
+			}
+		}
+
+		for (integer c = 0; c < m; c++) {
+			for (integer r = c + 1; r < m; r++) {
+				py[r] -= pA[r + m*c]*py[c];
+			}
+		}
+
+		for (integer c = m - 1; c >= 0; c--) {
+			py[c] /= pA[c + m*c];
+			for (integer r = 0; r < c; r++) {
+				py[r] -= pA[r + m*c]*py[c];
+			}
+		}
+	}
+}
@@ -42,16 +42,35 @@
 
 #include <solman.h>
 
+class DataManager;
+
 class Preconditioner
 {
 public: 
 
 	enum PrecondType {
 		UNKNOWN = -1,
-		FULLJACOBIANMATRIX
+		FULLJACOBIANMATRIX,
+		ILU,
+		ILUT,
+		BLOCKJACOBI
+	};
+
+	/* ILU: iFill is the level of fill;
+	 * ILUT: iFill is the max number of entries kept per row
+	 * in each factor, dDropTol the relative drop tolerance */
+	struct Parameters {
+		integer iFill;
+		doublereal dDropTol;
+
+		Parameters(void) : iFill(0), dDropTol(1.e-3) {};
 	};
 	
 	virtual ~Preconditioner(void);
+
+	/* the Jacobian matrix has been reassembled; preconditioners
+	 * that factor it on their own rebuild at the next Precond() */
+	virtual void MatrReset(const DataManager *pDM);
 	
 	virtual void Precond(VectorHandler& b,
 			VectorHandler& x, 
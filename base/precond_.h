@@ -40,6 +40,8 @@
 #ifndef PRECOND__H
 #define PRECOND__H
 
+#include <vector>
+
 #include <precond.h>
 
 class FullJacobianPr : public Preconditioner
@@ -52,5 +54,106 @@ public:
 			SolutionManager* pSM) const;
 };
 
+/*
+ * Base for preconditioners that factor their own copy
+ * of the Jacobian matrix, without calling the linear solver;
+ * the matrix is copied in compressed row form (0-based)
+ * at the first Precond() after MatrReset().
+ */
+class SparseFactorPr : public Preconditioner
+{
+protected:
+	const DataManager *pDM;
+	mutable bool bValid;
+
+	mutable integer iSize;
+	mutable std::vector<integer> Ap, Aj;
+	mutable std::vector<doublereal> Ax;
+
+	/* statistics, logged at each build */
+	mutable unsigned uBuilds;
+	mutable unsigned uFixedPivots;
+	mutable doublereal dBuildTime;
+
+	void GetCSR(const MatrixHandler& MH) const;
+	doublereal dFixPivot(doublereal d, doublereal dNorm) const;
+
+	virtual void Factor(void) const = 0;
+	virtual void Solve(doublereal *px) const = 0;
+	virtual const char *sGetName(void) const = 0;
+	virtual unsigned long ulGetFactorNZ(void) const = 0;
+
+public:
+	SparseFactorPr(void);
+	virtual ~SparseFactorPr(void);
+
+	virtual void MatrReset(const DataManager *pDM);
+	virtual void Precond(VectorHandler& b, VectorHandler& x, 
+			SolutionManager* pSM) const;
+};
+
+/* incomplete LU factors in compressed row form; the diagonal
+ * of U is stored inverted, so the solve only multiplies */
+class IncompleteLUPr : public SparseFactorPr
+{
+protected:
+	mutable std::vector<integer> Lp, Lj, Up, Uj;
+	mutable std::vector<doublereal> Lx, Ux, Dinv;
+
+	virtual void Solve(doublereal *px) const;
+	virtual unsigned long ulGetFactorNZ(void) const;
+
+public:
+	virtual ~IncompleteLUPr(void);
+};
+
+/* ILU(k): level of fill based */
+class ILUPr : public IncompleteLUPr
+{
+protected:
+	integer iLevel;
+
+	virtual void Factor(void) const;
+	virtual const char *sGetName(void) const;
+
+public:
+	ILUPr(integer iLev);
+	virtual ~ILUPr(void);
+};
+
+/* ILUT(tau, p): dual threshold (Saad) */
+class ILUTPr : public IncompleteLUPr
+{
+protected:
+	doublereal dTau;
+	integer iFill;
+
+	virtual void Factor(void) const;
+	virtual const char *sGetName(void) const;
+
+public:
+	ILUTPr(doublereal dT, integer iF);
+	virtual ~ILUTPr(void);
+};
+
+/* block Jacobi, one dense LU per DofOwner (node or element with dofs) */
+class BlockJacobiPr : public SparseFactorPr
+{
+protected:
+	mutable std::vector<integer> Blocks;
+	mutable std::vector<integer> Offsets;
+	mutable std::vector<doublereal> LU;
+	mutable std::vector<integer> Piv;
+
+	virtual void Factor(void) const;
+	virtual void Solve(doublereal *px) const;
+	virtual const char *sGetName(void) const;
+	virtual unsigned long ulGetFactorNZ(void) const;
+
+public:
+	BlockJacobiPr(void);
+	virtual ~BlockJacobiPr(void);
+};
+
 #endif /* PRECOND__H */
 
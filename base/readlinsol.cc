@@ -662,3 +662,86 @@ std::ostream & RestartLinSol(std::ostream& out, const LinSol& cs)
 	out << ";" << std::endl;
 	return out;
 }
+
+void
+ReadMTLU(MTLUSolutionManager::Params& p, HighParser &HP)
+{
+	DEBUGLCOUT(MYDEBUG_INPUT,
+			"Using threaded sparse LU solver" << std::endl);
+
+	if (HP.IsKeyWord("multi" "thread") || HP.IsKeyWord("mt")) {
+		int nThreads = HP.GetInt();
+		if (nThreads < 1) {
+			silent_cerr("illegal thread number, using 1" << std::endl);
+			nThreads = 1;
+		}
+		p.nThreads = nThreads;
+	}
+
+	if (HP.IsKeyWord("mixed" "precision")) {
+		p.bMixed = true;
+		DEBUGLCOUT(MYDEBUG_INPUT,
+				"single precision factors "
+				"with iterative refinement" << std::endl);
+	}
+
+	if (HP.IsKeyWord("pivot" "tolerance")) {
+		doublereal dPivotTol = HP.GetReal();
+		if (dPivotTol <= 0. || dPivotTol >= 1.) {
+			silent_cerr("pivot tolerance " << dPivotTol
+				<< " is out of bounds at line "
+				<< HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		p.dPivotTol = dPivotTol;
+	}
+
+	if (HP.IsKeyWord("max" "iterations")) {
+		integer iMaxRefine = HP.GetInt();
+		if (iMaxRefine < 0) {
+			silent_cerr("illegal number of refinement iterations "
+				<< iMaxRefine << " at line "
+				<< HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		p.iMaxRefine = iMaxRefine;
+	}
+
+	if (HP.IsKeyWord("refinement" "tolerance")) {
+		doublereal dRefineTol = HP.GetReal();
+		if (dRefineTol < 0.) {
+			silent_cerr("illegal refinement tolerance "
+				<< dRefineTol << " at line "
+				<< HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		p.dRefineTol = dRefineTol;
+	}
+
+	if (HP.IsKeyWord("verbose")) {
+		p.bVerbose = HP.GetYesNoOrBool();
+	}
+}
+
+std::ostream & RestartMTLU(std::ostream& out, const MTLUSolutionManager::Params& p)
+{
+	out << "threaded lu";
+	if (p.nThreads > 0) {
+		out << ", mt, " << p.nThreads;
+	}
+	if (p.bMixed) {
+		out << ", mixed precision";
+	}
+	out << ", pivot tolerance, " << p.dPivotTol;
+	if (p.iMaxRefine >= 0) {
+		out << ", max iterations, " << p.iMaxRefine;
+	}
+	if (p.dRefineTol >= 0.) {
+		out << ", refinement tolerance, " << p.dRefineTol;
+	}
+	if (p.bVerbose) {
+		out << ", verbose, yes";
+	}
+	out << ";" << std::endl;
+	return out;
+}
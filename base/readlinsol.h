@@ -33,10 +33,16 @@
 #define READLINSOL_H
 
 #include "linsol.h"
+#include "mtluwrap.h"
 
 void
 ReadLinSol(LinSol& cs, HighParser &HP, bool bAllowEmpty = false);
 std::ostream 
 & RestartLinSol(std::ostream& out, const LinSol& cs);
 
+void
+ReadMTLU(MTLUSolutionManager::Params& p, HighParser &HP);
+std::ostream
+& RestartMTLU(std::ostream& out, const MTLUSolutionManager::Params& p);
+
 #endif /* READLINSOL_H */
@@ -163,5 +163,23 @@ void SimulationEntity::ReadInitialState(MBDynParser& HP)
 	NO_OP;
 }
 
+void
+SimulationEntity::Checkpoint(std::ostream& out) const
+{
+	NO_OP;
+}
+
+void
+SimulationEntity::Resume(std::istream& in)
+{
+	NO_OP;
+}
+
+bool
+SimulationEntity::bCheckpointable(void) const
+{
+	return true;
+}
+
 /* SimulationEntity - end */
 
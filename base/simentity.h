@@ -223,6 +223,19 @@ public:
 	virtual std::ostream& OutputAppend(std::ostream& out) const;
 	virtual void ReadInitialState(MBDynParser& HP);
 
+	/*
+	 * Binary checkpoint of the state that is not contained
+	 * in the solution vectors; by default there is none
+	 */
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
+	/*
+	 * False if the entity keeps state that Checkpoint()
+	 * cannot save, so that it cannot be resumed exactly
+	 */
+	virtual bool bCheckpointable(void) const;
+
 };
 
 /* SimulationEntity - end */
@@ -61,6 +61,7 @@
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <fstream>
 #include "ac/sys_sysinfo.h"
 
 #include "solver.h"
@@ -77,6 +78,7 @@
 #include "naivewrap.h"
 #include "Rot.hh"
 #include "cleanup.h"
+#include "checkpoint.h"
 #include "drive_.h"
 
 #include "solver_impl.h"
@@ -272,6 +274,7 @@ sInputFileName(sInFName),
 sOutputFileName(sOutFName),
 HP(HPar),
 pStrategyChangeDrive(NULL),
+dLocalError(-1.),
 EigAn(),
 pRTSolver(0),
 iNumPreviousVectors(2),
@@ -300,6 +303,9 @@ iWeightedPerformedIters(0),
 bLastChance(false),
 RegularType(INT_UNKNOWN),
 DummyType(INT_UNKNOWN),
+iPredictorOrder(0),
+iPredictorWindow(0),
+bPredictorLog(false),
 pDerivativeSteps(0),
 pFirstDummyStep(0),
 pDummySteps(0),
@@ -311,9 +317,13 @@ pRhoAlgebraicRegular(NULL),
 pRhoDummy(NULL),
 pRhoAlgebraicDummy(NULL),
 dDerivativesCoef(::dDefaultDerivativesCoefficient),
+bMTLU(false),
 ResTest(NonlinearSolverTest::NORM),
 SolTest(NonlinearSolverTest::NONE),
 bScale(false),
+bSolverStats(false),
+SolverStatsFormat(SolverStats::FORMAT_CSV),
+pSolverStats(0),
 bTrueNewtonRaphson(true),
 bKeepJac(false),
 iIterationsBeforeAssembly(0),
@@ -347,6 +357,13 @@ dCurrTimeStep(0.)
 
 	StrategyFactor.iMinIters = 1;
 	StrategyFactor.iMaxIters = 0;
+
+	StrategyError.dRelTol = 0.;
+	StrategyError.dAbsTol = 0.;
+	StrategyError.dSafety = .9;
+	StrategyError.dMinFactor = .2;
+	StrategyError.dMaxFactor = 2.;
+	StrategyError.iOrder = 2;
 }
 
 void
@@ -405,7 +422,8 @@ Solver::Run(void)
 		/* chiama il gestore dei dati generali della simulazione */
 #ifdef USE_MULTITHREAD
 		if (nThreads > 1) {
-			if (!(CurrLinearSolver.GetSolverFlags() & LinSol::SOLVER_FLAGS_ALLOWS_MT_ASS)) {
+			/* the threaded LU is assembled in CC form */
+			if (!bMTLU && !(CurrLinearSolver.GetSolverFlags() & LinSol::SOLVER_FLAGS_ALLOWS_MT_ASS)) {
 				/* conservative: dir may use too much memory */
 				if (!CurrLinearSolver.AddSolverFlags(LinSol::SOLVER_FLAGS_ALLOWS_MT_ASS)) {
 					bool b;
@@ -430,7 +448,7 @@ Solver::Run(void)
 			silent_cout("Creating multithread solver "
 					"with " << nThreads << " threads "
 					"and "
-					<< CurrLinearSolver.GetSolverName()
+					<< (bMTLU ? "threaded lu" : CurrLinearSolver.GetSolverName())
 					<< " linear solver"
 					<< std::endl);
 
@@ -453,7 +471,7 @@ Solver::Run(void)
 
 			silent_cout("Creating scalar solver "
 					"with "
-					<< CurrLinearSolver.GetSolverName()
+					<< (bMTLU ? "threaded lu" : CurrLinearSolver.GetSolverName())
 					<< " linear solver"
 					<< std::endl);
 
@@ -503,6 +521,16 @@ Solver::Run(void)
 		return;
 	}
 
+	if (bSolverStats) {
+		OutputHandler *pOH = pDM->pGetOutHdl();
+		if (SolverStatsFormat == SolverStats::FORMAT_BINARY) {
+			pOH->SetBinary(OutputHandler::SOLVERSTATS);
+		}
+		pOH->Open(OutputHandler::SOLVERSTATS);
+		SAFENEWWITHCONSTRUCTOR(pSolverStats, SolverStats,
+			SolverStats(pOH->SolverStats(), SolverStatsFormat));
+	}
+
 #ifdef USE_SCHUR
 	/* Qui crea le partizioni: principale fra i processi, se parallelo  */
 	if (bParallel) {
@@ -731,6 +759,8 @@ Solver::Run(void)
 	integer iTotIter = 0;
 	integer iStIter = 0;
 	doublereal dTotErr = 0.;
+	long lStep = 1;
+	StepIntegrator::StepChange CurrStep = StepIntegrator::NEWSTEP;
 	doublereal dTest = std::numeric_limits<double>::max();
 	doublereal dSolTest = std::numeric_limits<double>::max();
 	bool bSolConv = false;
@@ -774,6 +804,12 @@ Solver::Run(void)
 #ifdef USE_EXTERNAL
 	pNLS->SetExternal(External::EMPTY);
 #endif /* USE_EXTERNAL */
+	/* the checkpoint contains the state after a regular step */
+	if (!sResumeFileName.empty()) {
+		ResumeCheckpoint(lStep, iTotIter, dTotErr);
+		goto ResumedFromCheckpoint;
+	}
+
 	/* Setup SolutionManager(s) */
 	SetupSolmans(pDerivativeSteps->GetIntegratorNumUnknownStates());
 
@@ -889,7 +925,7 @@ Solver::Run(void)
 	}
 
 	/* Dati comuni a passi fittizi e normali */
-	long lStep = 1;
+	lStep = 1;
 
 	if (iDummyStepsNumber > 0) {
 		/* passi fittizi */
@@ -1159,8 +1195,7 @@ Solver::Run(void)
 	dCurrTimeStep = dRefTimeStep;
 
 	ASSERT(pFirstRegularStep!= NULL);
-	StepIntegrator::StepChange CurrStep
-			= StepIntegrator::NEWSTEP;
+	CurrStep = StepIntegrator::NEWSTEP;
 
 	/* Setup SolutionManager(s) */
 	SetupSolmans(pFirstRegularStep->GetIntegratorNumUnknownStates(), true);
@@ -1282,6 +1317,7 @@ IfFirstStepIsToBeRepeated:
 		EigAn.currAnalysis++;
 	}
 
+ResumedFromCheckpoint:;
 	if (pRTSolver) {
 		pRTSolver->Init();
 	}
@@ -1300,7 +1336,15 @@ IfFirstStepIsToBeRepeated:
 		StepIntegrator::StepChange CurrStep
 				= StepIntegrator::NEWSTEP;
 
+		if (pDM->bCheckpointRequested()) {
+			MakeCheckpoint(lStep, iTotIter, dTotErr);
+		}
+
 		if (pDM->EndOfSimulation() || dTime >= dFinalTime) {
+			if (pDM->bCheckpointRequested(true)) {
+				MakeCheckpoint(lStep, iTotIter, dTotErr);
+			}
+
 			if (pRTSolver) {
 				pRTSolver->StopCommanded();
 			}
@@ -1313,6 +1357,15 @@ IfFirstStepIsToBeRepeated:
 				<< "total Jacobian matrices: " << pNLS->TotalAssembledJacobian() << std::endl
 				<< "total error: " << dTotErr << std::endl);
 
+			const PatternSolutionManager *pPSM
+				= dynamic_cast<const PatternSolutionManager *>(pLocalSM ? pLocalSM : pSM);
+			if (pPSM) {
+				silent_cout("total symbolic factorizations: "
+					<< pPSM->GetSymbolicCount() << std::endl
+					<< "total numeric factorizations: "
+					<< pPSM->GetNumericCount() << std::endl);
+			}
+
 			if (pRTSolver) {
 				pRTSolver->Log();
 			}
@@ -1366,11 +1419,23 @@ IfFirstStepIsToBeRepeated:
 			pRTSolver->Wait();
 		}
 
+		integer iStatsJac = 0;
+		integer iStatsFact = 0;
+		if (pSolverStats) {
+			pSolverStats->BeginStep();
+			iStatsJac = pNLS->TotalAssembledJacobian();
+			iStatsFact = GetNumericFactorizations(iStatsJac);
+		}
+
 		int retries = -1;
 IfStepIsToBeRepeated:
 		try {
 			retries++;
-			pDM->SetTime(dTime + dCurrTimeStep, dCurrTimeStep, lStep);
+			dLocalError = -1.;
+			{
+				SolverStats::Timer timer(pSolverStats, SolverStats::DRIVES);
+				pDM->SetTime(dTime + dCurrTimeStep, dCurrTimeStep, lStep);
+			}
 			if (outputStep()) {
 				if (outputCounter()) {
 					silent_cout(std::endl);
@@ -1459,6 +1524,22 @@ IfStepIsToBeRepeated:
 				"aborting..." << std::endl);
 			throw SimulationDiverged(MBDYN_EXCEPT_ARGS);
 		}
+		catch (StepIntegrator::LocalErrorTooLarge) {
+			/* the integrator does not reject at the minimum step */
+			pRegularSteps->GetLocalError(*pX, dLocalError);
+			CurrStep = StepIntegrator::REPEATSTEP;
+			doublereal dOldCurrTimeStep = dCurrTimeStep;
+			dCurrTimeStep = NewTimeStep(dOldCurrTimeStep,
+					iStIter,
+					CurrStep);
+			DEBUGCOUT("Changing time step"
+				" from " << dOldCurrTimeStep
+				<< " to " << dCurrTimeStep
+				<< " during step "
+				<< lStep << " because of local error "
+				<< dLocalError << std::endl);
+			goto IfStepIsToBeRepeated;
+		}
 		catch (NonlinearSolver::ConvergenceOnSolution) {
 			bSolConv = true;
 		}
@@ -1490,7 +1571,25 @@ IfStepIsToBeRepeated:
 		dTotErr += dTest;
 		iTotIter += iStIter;
 
-		bOut = pDM->Output(lStep, dTime + dCurrTimeStep, dCurrTimeStep);
+		if (CurrStrategy == LOCALERROR
+			&& !pRegularSteps->GetLocalError(*pX, dLocalError))
+		{
+			dLocalError = -1.;
+		}
+
+		{
+			SolverStats::Timer timer(pSolverStats, SolverStats::OUTPUT);
+			bOut = pDM->Output(lStep, dTime + dCurrTimeStep, dCurrTimeStep);
+		}
+
+		if (pSolverStats) {
+			integer iJac = pNLS->TotalAssembledJacobian();
+			pSolverStats->Inc(SolverStats::JACOBIANS, iJac - iStatsJac);
+			pSolverStats->Inc(SolverStats::FACTORIZATIONS,
+				GetNumericFactorizations(iJac) - iStatsFact);
+			pSolverStats->Inc(SolverStats::REJECTED, retries);
+			pSolverStats->EndStep(lStep, dTime + dCurrTimeStep, dCurrTimeStep);
+		}
 
 		if (outputMsg()) {
 			Out << "Step " << lStep
@@ -1502,6 +1601,15 @@ IfStepIsToBeRepeated:
 				<< " " << bSolConv
 				<< " " << bOut
 				<< std::endl;
+
+			/* predictor quality vs. iterations */
+			doublereal dPredErr;
+			if (pRegularSteps->GetPredictionError(*pX, dPredErr)) {
+				Out << "Predictor " << lStep
+					<< " " << dPredErr
+					<< " " << iStIter
+					<< std::endl;
+			}
 		}
 
 		if (bOutputCounter) {
@@ -1539,11 +1647,144 @@ IfStepIsToBeRepeated:
 		}
 
 		/* Calcola il nuovo timestep */
+		if (CurrStrategy == LOCALERROR) {
+			/* the step has been accepted, whatever it took */
+			CurrStep = StepIntegrator::NEWSTEP;
+		}
 		dCurrTimeStep = NewTimeStep(dCurrTimeStep, iStIter, CurrStep);
 		DEBUGCOUT("Current time step: " << dCurrTimeStep << std::endl);
 	} // while (true)  END OF ENDLESS-LOOP
 }  // Solver::Run()
 
+void
+Solver::MakeCheckpoint(long lStep, integer iTotIter, doublereal dTotErr)
+{
+	silent_cout("Making checkpoint at time " << dTime
+		<< " after " << lStep << " steps ..." << std::endl);
+
+	std::ostream& out = pDM->CheckpointOpen();
+
+	out.write(sCheckpointMagic, sizeof(sCheckpointMagic) - 1);
+	ChkWrite(out, uCheckpointVersion);
+
+	ChkWrite(out, lStep);
+	ChkWrite(out, iTotIter);
+	ChkWrite(out, dTotErr);
+	ChkWrite(out, dTime);
+	ChkWrite(out, dRefTimeStep);
+	ChkWrite(out, dCurrTimeStep);
+	ChkWrite(out, iStepsAfterReduction);
+	ChkWrite(out, iStepsAfterRaise);
+	ChkWrite(out, iWeightedPerformedIters);
+	ChkWrite(out, bLastChance);
+	ChkWrite(out, dLocalError);
+
+	/* current solution and integrator history */
+	ChkWrite(out, iNumPreviousVectors);
+	ChkWriteVector(out, *pX);
+	ChkWriteVector(out, *pXPrime);
+	for (int ivec = 0; ivec < iNumPreviousVectors; ivec++) {
+		ChkWriteVector(out, *qX[ivec]);
+		ChkWriteVector(out, *qXPrime[ivec]);
+	}
+	pRegularSteps->Checkpoint(out);
+
+	pDM->Checkpoint(out);
+
+	pDM->CheckpointClose();
+}
+
+void
+Solver::ResumeCheckpoint(long& lStep, integer& iTotIter, doublereal& dTotErr)
+{
+	std::ifstream in(sResumeFileName.c_str(), std::ios::in | std::ios::binary);
+	if (!in) {
+		silent_cerr("Unable to open checkpoint file "
+			"\"" << sResumeFileName << "\"" << std::endl);
+		throw ErrCheckpoint(MBDYN_EXCEPT_ARGS);
+	}
+
+	/* the part being read, for the error messages;
+	 * the entities of the model are reported by ChkReadTag() */
+	const char *sWhat = "header";
+	try {
+		char magic[sizeof(sCheckpointMagic) - 1];
+		unsigned uVer = 0;
+		ChkRead(in, magic);
+		if (memcmp(magic, sCheckpointMagic, sizeof(magic)) != 0) {
+			silent_cerr("checkpoint: bad magic" << std::endl);
+			throw ErrCheckpoint(MBDYN_EXCEPT_ARGS);
+		}
+		ChkRead(in, uVer);
+		if (uVer != uCheckpointVersion) {
+			silent_cerr("checkpoint: version " << uVer
+				<< " while expecting " << uCheckpointVersion
+				<< std::endl);
+			throw ErrCheckpoint(MBDYN_EXCEPT_ARGS);
+		}
+
+		sWhat = "solver status";
+		ChkRead(in, lStep);
+		ChkRead(in, iTotIter);
+		ChkRead(in, dTotErr);
+		ChkRead(in, dTime);
+		ChkRead(in, dRefTimeStep);
+		ChkRead(in, dCurrTimeStep);
+		ChkRead(in, iStepsAfterReduction);
+		ChkRead(in, iStepsAfterRaise);
+		ChkRead(in, iWeightedPerformedIters);
+		ChkRead(in, bLastChance);
+		ChkRead(in, dLocalError);
+
+		integer n;
+		ChkRead(in, n);
+		if (n != iNumPreviousVectors) {
+			silent_cerr("checkpoint: made with " << n
+				<< " previous steps, while the integrator needs "
+				<< iNumPreviousVectors << std::endl);
+			throw ErrCheckpoint(MBDYN_EXCEPT_ARGS);
+		}
+
+		sWhat = "state vectors";
+		ChkReadVector(in, *pX);
+		ChkReadVector(in, *pXPrime);
+		for (int ivec = 0; ivec < iNumPreviousVectors; ivec++) {
+			ChkReadVector(in, *qX[ivec]);
+			ChkReadVector(in, *qXPrime[ivec]);
+		}
+
+		sWhat = "integrator";
+		pRegularSteps->Resume(in);
+
+		sWhat = "model";
+		pDM->Resume(in);
+	}
+	catch (ErrCheckpoint) {
+		silent_cerr("Unable to resume from checkpoint file "
+			"\"" << sResumeFileName << "\" (" << sWhat << ")"
+			<< std::endl);
+		throw;
+	}
+
+	/* skip eigenanalyses that precede the resume time */
+	if (EigAn.bAnalysis) {
+		EigAn.currAnalysis = std::find_if(EigAn.Analyses.begin(),
+			EigAn.Analyses.end(), bind2nd(std::greater<doublereal>(), dTime));
+	}
+
+	if (pDerivativeSteps != 0) {
+		SAFEDELETE(pDerivativeSteps);
+		pDerivativeSteps = 0;
+	}
+	if (pFirstRegularStep != 0) {
+		SAFEDELETE(pFirstRegularStep);
+		pFirstRegularStep = 0;
+	}
+
+	silent_cout("Resuming from checkpoint \"" << sResumeFileName << "\" "
+		"at time " << dTime << " after " << lStep << " steps" << std::endl);
+}
+
 /* Distruttore */
 Solver::~Solver(void)
 {
@@ -1569,6 +1810,13 @@ Solver::~Solver(void)
 		SAFEDELETEARR(pdWorkSpace);
 	}
 
+	if (pSolverStats) {
+		if (pDM != NULL) {
+			pSolverStats->Report(pDM->GetLogFile());
+		}
+		SAFEDELETE(pSolverStats);
+	}
+
 	if (pDM != NULL) {
 		SAFEDELETE(pDM);
 	}
@@ -1685,6 +1933,45 @@ Solver::NewTimeStep(doublereal dCurrTimeStep,
 		}
 		break;
 
+	case LOCALERROR: {
+		/*
+		 * h_new = h * safety * (1/err)^(1/(order + 1)),
+		 * bounded by the min and max factors; no raise
+		 * right after a reduction.  Without an estimate
+		 * (e.g. no convergence) the step is cut by the min factor.
+		 */
+		doublereal dFactor = 1.;
+		if (dLocalError > 0.) {
+			dFactor = StrategyError.dSafety
+				*std::pow(dLocalError, -1./(StrategyError.iOrder + 1));
+			dFactor = std::max(std::min(dFactor, StrategyError.dMaxFactor),
+				StrategyError.dMinFactor);
+
+		} else if (dLocalError == 0.) {
+			dFactor = StrategyError.dMaxFactor;
+		}
+
+		if (Why == StepIntegrator::REPEATSTEP) {
+			iStepsAfterReduction = 0;
+			if (dLocalError < 0.) {
+				dFactor = StrategyError.dMinFactor;
+			}
+			dFactor = std::min(dFactor, StrategyError.dSafety);
+			if (dCurrTimeStep*dFactor < dMinTimeStep) {
+				/* one last attempt at the minimum time step */
+				return dMinTimeStep;
+			}
+
+		} else {
+			if (iStepsAfterReduction == 0) {
+				dFactor = std::min(dFactor, 1.);
+			}
+			iStepsAfterReduction++;
+		}
+
+		return std::max(std::min(dCurrTimeStep*dFactor, MaxTimeStep.dGet()), dMinTimeStep);
+		}
+
 	default:
 		silent_cerr("You shouldn't have reached this point!" << std::endl);
 		throw Solver::ErrGeneric(MBDYN_EXCEPT_ARGS);
@@ -1750,6 +2037,21 @@ Solver::Restart(std::ostream& out,DataManager::eRestart type) const
 		ASSERT(0);
 	}
 
+	if (iPredictorOrder > 0 || bPredictorLog) {
+		out << "  predictor: ";
+		if (iPredictorOrder > 0) {
+			out << "extrapolation"
+				<< ", order, " << iPredictorOrder
+				<< ", window, " << iPredictorWindow;
+		} else {
+			out << "default";
+		}
+		if (bPredictorLog) {
+			out << ", log";
+		}
+		out << ";" << std::endl;
+	}
+
 	integer iMI = pRegularSteps->GetIntegratorMaxIters();
 	out << "  max iterations: " << std::abs(iMI);
 	if (iMI < 0) out << ", at most";
@@ -1812,7 +2114,16 @@ Solver::Restart(std::ostream& out,DataManager::eRestart type) const
 	case NonlinearSolver::NEWTONRAPHSON:
 	default :
 		out << "  nonlinear solver: newton raphson";
-		if (!bTrueNewtonRaphson) {
+		if (NRAdaptive.bEnabled) {
+			out << ", adaptive"
+				<< ", contraction, " << NRAdaptive.dMaxContraction
+				<< ", time step change, " << NRAdaptive.dMaxTimeStepChange
+				<< ", max age, " << NRAdaptive.iMaxAge;
+			if (bHonorJacRequest) {
+				out << ", honor element requests";
+			}
+
+		} else if (!bTrueNewtonRaphson) {
 			out << ", modified, " << iIterationsBeforeAssembly;
 			if (bKeepJac) {
 				out << ", keep jacobian matrix";
@@ -1824,7 +2135,12 @@ Solver::Restart(std::ostream& out,DataManager::eRestart type) const
 		out << ";" << std::endl;
 	}
 	out << "  solver: ";
-	RestartLinSol(out, CurrLinearSolver);
+	if (bMTLU) {
+		RestartMTLU(out, MTLUParams);
+
+	} else {
+		RestartLinSol(out, CurrLinearSolver);
+	}
 	out << "end: initial value;" << std::endl << std::endl;
 	return out;
 }
@@ -1884,6 +2200,7 @@ Solver::ReadData(MBDynParser& HP)
 			"counter",
 			"matrix" "condition" "number",
 			"solver" "condition" "number",
+			"statistics",
 		"output" "meter",
 
 		"method",
@@ -1912,6 +2229,7 @@ Solver::ReadData(MBDynParser& HP)
 			"factor",
 			"no" "change",
 			"change",
+			"error",
 
 		"pod",
 		"eigen" "analysis",
@@ -1936,6 +2254,9 @@ Solver::ReadData(MBDynParser& HP)
 				"gmres",
 					/* DEPRECATED */ "full" "jacobian" /* END OF DEPRECATED */ ,
 					"full" "jacobian" "matrix",
+					"ilu",
+					"ilut",
+					"block" "jacobi",
 
 		/* RTAI stuff */
 		"real" "time",
@@ -1943,6 +2264,10 @@ Solver::ReadData(MBDynParser& HP)
 		/* multithread stuff */
 		"threads",
 
+		"resume" "from" "checkpoint",
+
+		"predictor",
+
 		NULL
 	};
 
@@ -1993,6 +2318,7 @@ Solver::ReadData(MBDynParser& HP)
 			COUNTER,
 			MATRIX_COND_NUM,
 			SOLVER_COND_NUM,
+			STATISTICS,
 		OUTPUTMETER,
 
 		METHOD,
@@ -2020,6 +2346,7 @@ Solver::ReadData(MBDynParser& HP)
 		STRATEGYFACTOR,
 		STRATEGYNOCHANGE,
 		STRATEGYCHANGE,
+		STRATEGYERROR,
 
 		POD,
 		EIGENANALYSIS,
@@ -2044,12 +2371,19 @@ Solver::ReadData(MBDynParser& HP)
 				GMRES,
 					FULLJACOBIAN,
 					FULLJACOBIANMATRIX,
+					ILU,
+					ILUT,
+					BLOCKJACOBI,
 
 		/* RTAI stuff */
 		REALTIME,
 
 		THREADS,
 
+		RESUMEFROMCHECKPOINT,
+
+		PREDICTOR,
+
 		LASTKEYWORD
 	};
 
@@ -2363,6 +2697,23 @@ Solver::ReadData(MBDynParser& HP)
 					}
 					break;
 
+				case STATISTICS:
+					bSolverStats = true;
+					if (HP.IsKeyWord("format")) {
+						if (HP.IsKeyWord("csv")) {
+							SolverStatsFormat = SolverStats::FORMAT_CSV;
+
+						} else if (HP.IsKeyWord("binary")) {
+							SolverStatsFormat = SolverStats::FORMAT_BINARY;
+
+						} else {
+							silent_cerr("unknown statistics format "
+								"at line " << HP.GetLineData() << std::endl);
+							throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+						}
+					}
+					break;
+
 				default:
 					silent_cerr("Warning, unknown output flag "
 						"at line " << HP.GetLineData()
@@ -2990,6 +3341,91 @@ Solver::ReadData(MBDynParser& HP)
 				break;
 			}
 
+			case STRATEGYERROR: {
+				CurrStrategy = LOCALERROR;
+
+				/*
+				 * strategy: error ,
+				 *     <relative tolerance>
+				 *     [ , absolute tolerance , <atol> ]
+				 *     [ , safety factor , <safety> ]
+				 *     [ , min factor , <min> ]
+				 *     [ , max factor , <max> ]
+				 *     [ , order , <order> ] ;
+				 */
+
+				StrategyError.dRelTol = HP.GetReal();
+				if (StrategyError.dRelTol <= 0.) {
+					silent_cerr("illegal relative tolerance "
+						<< StrategyError.dRelTol
+						<< " at line " << HP.GetLineData()
+						<< std::endl);
+					throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+				}
+				StrategyError.dAbsTol = StrategyError.dRelTol;
+
+				while (HP.IsArg()) {
+					if (HP.IsKeyWord("absolute" "tolerance")) {
+						StrategyError.dAbsTol = HP.GetReal();
+						if (StrategyError.dAbsTol < 0.) {
+							silent_cerr("illegal absolute tolerance "
+								"at line " << HP.GetLineData()
+								<< std::endl);
+							throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+						}
+
+					} else if (HP.IsKeyWord("safety" "factor")) {
+						StrategyError.dSafety = HP.GetReal();
+						if (StrategyError.dSafety <= 0. || StrategyError.dSafety > 1.) {
+							silent_cerr("safety factor must be "
+								"in ]0,1] at line "
+								<< HP.GetLineData() << std::endl);
+							throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+						}
+
+					} else if (HP.IsKeyWord("min" "factor")) {
+						StrategyError.dMinFactor = HP.GetReal();
+						if (StrategyError.dMinFactor <= 0. || StrategyError.dMinFactor >= 1.) {
+							silent_cerr("min factor must be "
+								"in ]0,1[ at line "
+								<< HP.GetLineData() << std::endl);
+							throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+						}
+
+					} else if (HP.IsKeyWord("max" "factor")) {
+						StrategyError.dMaxFactor = HP.GetReal();
+						if (StrategyError.dMaxFactor <= 1.) {
+							silent_cerr("max factor must be "
+								"greater than 1 at line "
+								<< HP.GetLineData() << std::endl);
+							throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+						}
+
+					} else if (HP.IsKeyWord("order")) {
+						StrategyError.iOrder = HP.GetInt();
+						if (StrategyError.iOrder < 1) {
+							silent_cerr("illegal order "
+								"at line " << HP.GetLineData()
+								<< std::endl);
+							throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+						}
+
+					} else {
+						break;
+					}
+				}
+
+				DEBUGLCOUT(MYDEBUG_INPUT,
+						"Time step control strategy: "
+						"Error" << std::endl
+						<< "Relative tolerance: "
+						<< StrategyError.dRelTol
+						<< "Absolute tolerance: "
+						<< StrategyError.dAbsTol
+						<< std::endl);
+				break;
+			}
+
 			default:
 				silent_cerr("unknown time step control "
 					"strategy at line "
@@ -3324,7 +3760,14 @@ Solver::ReadData(MBDynParser& HP)
 					"use \"linear solver\" instead"
 					<< std::endl);
 		case LINEARSOLVER:
-			ReadLinSol(CurrLinearSolver, HP);
+			if (HP.IsKeyWord("threaded" "lu")) {
+				bMTLU = true;
+				ReadMTLU(MTLUParams, HP);
+
+			} else {
+				bMTLU = false;
+				ReadLinSol(CurrLinearSolver, HP);
+			}
 			break;
 
 		case INTERFACESOLVER:
@@ -3378,6 +3821,51 @@ Solver::ReadData(MBDynParser& HP)
 					break;
 				}
 
+				if (NonlinearSolverType == NonlinearSolver::NEWTONRAPHSON && HP.IsKeyWord("adaptive")) {
+					bTrueNewtonRaphson = false;
+					NRAdaptive.bEnabled = true;
+
+					while (HP.IsArg()) {
+						if (HP.IsKeyWord("contraction")) {
+							NRAdaptive.dMaxContraction = HP.GetReal();
+							if (NRAdaptive.dMaxContraction <= 0. || NRAdaptive.dMaxContraction >= 1.) {
+								silent_cerr("contraction must be between 0 and 1 at line " << HP.GetLineData() << std::endl);
+								throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+							}
+
+						} else if (HP.IsKeyWord("time" "step" "change")) {
+							NRAdaptive.dMaxTimeStepChange = HP.GetReal();
+							if (NRAdaptive.dMaxTimeStepChange < 0.) {
+								silent_cerr("time step change must be greater than or equal to zero at line " << HP.GetLineData() << std::endl);
+								throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+							}
+
+						} else if (HP.IsKeyWord("max" "age")) {
+							NRAdaptive.iMaxAge = HP.GetInt();
+							if (NRAdaptive.iMaxAge < 0) {
+								silent_cerr("max age must be greater than or equal to zero at line " << HP.GetLineData() << std::endl);
+								throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+							}
+
+						} else if (HP.IsKeyWord("honor" "element" "requests")) {
+							bHonorJacRequest = true;
+
+						} else {
+							break;
+						}
+					}
+
+					DEBUGLCOUT(MYDEBUG_INPUT, "adaptive "
+							"Newton-Raphson "
+							"will be used; "
+							"matrix will be "
+							"reused while the "
+							"contraction is below "
+							<< NRAdaptive.dMaxContraction
+							<< std::endl);
+					break;
+				}
+
 				if (HP.IsKeyWord("modified")) {
 					bTrueNewtonRaphson = false;
 					iIterationsBeforeAssembly = HP.GetInt();
@@ -3616,25 +4104,49 @@ Solver::ReadData(MBDynParser& HP)
 					case FULLJACOBIAN:
 					case FULLJACOBIANMATRIX:
 						PcType = Preconditioner::FULLJACOBIANMATRIX;
-						if (HP.IsKeyWord("steps")) {
-							iPrecondSteps = HP.GetInt();
-							DEBUGLCOUT(MYDEBUG_INPUT,
-									"number of steps "
-									"before recomputing "
-									"the preconditioner: "
-									<< iPrecondSteps
+						break;
+
+					case ILU:
+						PcType = Preconditioner::ILU;
+						PcParams.iFill = 0;
+						if (HP.IsKeyWord("fill")) {
+							PcParams.iFill = HP.GetInt();
+							if (PcParams.iFill < 0) {
+								silent_cerr("invalid ILU level of fill "
+									"at line " << HP.GetLineData()
 									<< std::endl);
+								throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+							}
 						}
-						if (HP.IsKeyWord("honor" "element" "requests")) {
-							bHonorJacRequest = true;
-							DEBUGLCOUT(MYDEBUG_INPUT,
-									"honor elements' "
-									"request to update "
-									"the preconditioner"
+						break;
+
+					case ILUT:
+						PcType = Preconditioner::ILUT;
+						PcParams.iFill = 10;
+						if (HP.IsKeyWord("drop" "tolerance")) {
+							PcParams.dDropTol = HP.GetReal();
+							if (PcParams.dDropTol < 0.) {
+								silent_cerr("invalid ILUT drop tolerance "
+									"at line " << HP.GetLineData()
+									<< std::endl);
+								throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+							}
+						}
+						if (HP.IsKeyWord("fill")) {
+							PcParams.iFill = HP.GetInt();
+							if (PcParams.iFill < 0) {
+								silent_cerr("invalid ILUT fill "
+									"at line " << HP.GetLineData()
 									<< std::endl);
+								throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+							}
 						}
 						break;
 
+					case BLOCKJACOBI:
+						PcType = Preconditioner::BLOCKJACOBI;
+						break;
+
 						/* add other preconditioners
 						 * here */
 
@@ -3646,6 +4158,24 @@ Solver::ReadData(MBDynParser& HP)
 							<< std::endl);
 						throw ErrGeneric(MBDYN_EXCEPT_ARGS);
 					}
+
+					if (HP.IsKeyWord("steps")) {
+						iPrecondSteps = HP.GetInt();
+						DEBUGLCOUT(MYDEBUG_INPUT,
+								"number of steps "
+								"before recomputing "
+								"the preconditioner: "
+								<< iPrecondSteps
+								<< std::endl);
+					}
+					if (HP.IsKeyWord("honor" "element" "requests")) {
+						bHonorJacRequest = true;
+						DEBUGLCOUT(MYDEBUG_INPUT,
+								"honor elements' "
+								"request to update "
+								"the preconditioner"
+								<< std::endl);
+					}
 					break;
 				}
 				break;
@@ -3730,6 +4260,49 @@ Solver::ReadData(MBDynParser& HP)
 			}
 			break;
 
+		case RESUMEFROMCHECKPOINT:
+			sResumeFileName = HP.GetFileName();
+			break;
+
+		case PREDICTOR:
+			if (HP.IsKeyWord("default")) {
+				iPredictorOrder = 0;
+				iPredictorWindow = 0;
+
+			} else if (HP.IsKeyWord("extrapolation")) {
+				iPredictorOrder = 2;
+				iPredictorWindow = 0;
+				if (HP.IsKeyWord("order")) {
+					iPredictorOrder = HP.GetInt();
+					if (iPredictorOrder < 1 || iPredictorOrder > 4) {
+						silent_cerr("extrapolation predictor order "
+							"must be between 1 and 4 at line "
+							<< HP.GetLineData() << std::endl);
+						throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+					}
+				}
+
+				iPredictorWindow = iPredictorOrder + 1;
+				if (HP.IsKeyWord("window")) {
+					iPredictorWindow = HP.GetInt();
+					if (iPredictorWindow <= iPredictorOrder) {
+						silent_cerr("extrapolation predictor window "
+							"must be larger than the order at line "
+							<< HP.GetLineData() << std::endl);
+						throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+					}
+				}
+
+			} else {
+				silent_cerr("unknown predictor at line "
+					<< HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+
+			if (HP.IsKeyWord("log")) {
+				bPredictorLog = true;
+			}
+			break;
 
 		default:
 			silent_cerr("unknown description at line "
@@ -3803,6 +4376,7 @@ EndOfCycle: /* esce dal ciclo di lettura */
 		break;
 
 	case CHANGE:
+	case LOCALERROR:
 		if (dMinTimeStep > dGetInitialMaxTimeStep()) {
 			silent_cerr("inconsistent min/max time step"
 				<< std::endl);
@@ -4020,12 +4594,43 @@ EndOfCycle: /* esce dal ciclo di lettura */
 		break;
 	}
 
+	if (CurrStrategy == LOCALERROR) {
+		StepNIntegrator *pSN = dynamic_cast<StepNIntegrator *>(pRegularSteps);
+		if (pSN == 0) {
+			silent_cerr("the integration method does not support "
+				"strategy \"error\"" << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		pSN->SetErrorControl(StrategyError.dRelTol,
+			StrategyError.dAbsTol, dMinTimeStep);
+	}
+
+	if (iPredictorOrder > 0 || bPredictorLog) {
+		StepNIntegrator *pSN = dynamic_cast<StepNIntegrator *>(pRegularSteps);
+		if (pSN != 0) {
+			pSN->SetPredictor(iPredictorOrder, iPredictorWindow, bPredictorLog);
+
+		} else {
+			silent_cerr("warning: the integration method "
+				"does not support the extrapolation predictor; "
+				"using its own" << std::endl);
+			iPredictorOrder = 0;
+			bPredictorLog = false;
+		}
+	}
+
 	if (bSetScaleAlgebraic) {
 		dScaleAlgebraic = 1. / dInitialTimeStep;
 	}
 
 #ifdef USE_MULTITHREAD
-	if (bSolverThreads) {
+	if (bSolverThreads && bMTLU) {
+		/* "threads: solver" unless set by the linear solver */
+		if (MTLUParams.nThreads == 0) {
+			MTLUParams.nThreads = nSolverThreads;
+		}
+
+	} else if (bSolverThreads) {
 		if (CurrLinearSolver.SetNumThreads(nSolverThreads)) {
 			silent_cerr("linear solver "
 					<< CurrLinearSolver.GetSolverName()
@@ -5455,7 +6060,17 @@ doublereal Solver::dGetInitialMaxTimeStep() const
 SolutionManager *const
 Solver::AllocateSolman(integer iNLD, integer iLWS)
 {
-	SolutionManager *pCurrSM = CurrLinearSolver.GetSolutionManager(iNLD, iLWS);
+	SolutionManager *pCurrSM = 0;
+
+	if (bMTLU) {
+		SAFENEWWITHCONSTRUCTOR(pCurrSM,
+			MTLUSolutionManager,
+			MTLUSolutionManager(iNLD, MTLUParams));
+
+		return pCurrSM;
+	}
+
+	pCurrSM = CurrLinearSolver.GetSolutionManager(iNLD, iLWS);
 
 	/* special extra parameters if required */
 	switch (CurrLinearSolver.GetSolver()) {
@@ -5541,7 +6156,8 @@ Solver::AllocateNonlinearSolver()
 						iIterativeMaxSteps,
 						dIterertiveEtaMax,
 						dIterertiveTau,
-						*this));
+						*this,
+						PcParams));
 			break;
 
 		default:
@@ -5558,7 +6174,8 @@ Solver::AllocateNonlinearSolver()
 						iIterativeMaxSteps,
 						dIterertiveEtaMax,
 						dIterertiveTau,
-						*this));
+						*this,
+						PcParams));
 			break;
 		}
 		break;
@@ -5573,7 +6190,8 @@ Solver::AllocateNonlinearSolver()
 				NewtonRaphsonSolver(bTrueNewtonRaphson,
 					bKeepJac,
 					iIterationsBeforeAssembly,
-					*this));
+					*this,
+					NRAdaptive));
 		break;
 	case NonlinearSolver::LINESEARCH:
 		SAFENEWWITHCONSTRUCTOR(pNLS,
@@ -5616,6 +6234,12 @@ Solver::SetupSolmans(integer iStates, bool bCanBeParallel)
 
 	SolutionManager *pCurrSM = AllocateSolman(iNLD, iLWS);
 
+	/* tell the solution manager when the pattern changes */
+	PatternSolutionManager *pPSM = dynamic_cast<PatternSolutionManager *>(pCurrSM);
+	if (pPSM) {
+		pPSM->SetPatternSource(pDM);
+	}
+
 	/*
 	 * This is the LOCAL solver if instantiating a parallel
 	 * integrator; otherwise it is the MAIN solver
@@ -5645,6 +6269,20 @@ Solver::GetCPUTime(void) const
 	return pDM->GetCPUTime();
 }
 
+/* solution managers that do not count numeric factorizations
+ * refactor once for each assembled Jacobian matrix */
+integer
+Solver::GetNumericFactorizations(integer iJac) const
+{
+	const PatternSolutionManager *pPSM
+		= dynamic_cast<const PatternSolutionManager *>(pLocalSM ? pLocalSM : pSM);
+	if (pPSM) {
+		return pPSM->GetNumericCount();
+	}
+
+	return iJac;
+}
+
 void
 Solver::PrintResidual(const VectorHandler& Res, integer iIterCnt) const
 {
@@ -61,12 +61,15 @@ class Solver;
 #include "schsolman.h"
 #include <deque>
 #include "linsol.h"
+#include "mtluwrap.h"
 #include "stepsol.h"
 #include "nonlin.h"
 #include "linesearch.h"
+#include "nr.h"
 #include "mfree.h"
 #include "precond.h"
 #include "rtsolver.h"
+#include "solverstats.h"
 
 extern "C" int mbdyn_stop_at_end_of_iteration(void);
 extern "C" int mbdyn_stop_at_end_of_time_step(void);
@@ -103,7 +106,8 @@ protected:
    	enum Strategy {
 		NOCHANGE,
 		CHANGE,
-		FACTOR
+		FACTOR,
+		LOCALERROR
 	} CurrStrategy;
 
 	std::string sInputFileName;
@@ -123,6 +127,18 @@ protected:
    	/* Dati per strategia DRIVER_CHANGE */
 	DriveCaller* pStrategyChangeDrive;
 
+	/* Dati per strategia LOCALERROR */
+	struct {
+		doublereal dRelTol;
+		doublereal dAbsTol;
+		doublereal dSafety;
+		doublereal dMinFactor;
+		doublereal dMaxFactor;
+		integer iOrder;
+	} StrategyError;
+	/* last local error estimate; < 0 when not available */
+	doublereal dLocalError;
+
 public:
    	/* Dati per esecuzione di eigenanalysis */
 	struct EigenAnalysis {
@@ -261,6 +277,9 @@ protected:
 	};
 	AbortAfter eAbortAfter;
 
+	/* binary checkpoint to resume from, if any */
+	std::string sResumeFileName;
+
 	/* Parametri per la variazione passo */
    	integer iStepsAfterReduction;
    	integer iStepsAfterRaise;
@@ -278,6 +297,12 @@ protected:
 			INT_UNKNOWN
 	};
 	StepIntegratorType RegularType, DummyType;
+
+	/* extrapolation predictor for the regular steps
+	 * (order 0: the method's own predictor) */
+	integer iPredictorOrder;
+	integer iPredictorWindow;
+	bool bPredictorLog;
 	
    	StepIntegrator* pDerivativeSteps;
    	StepIntegrator* pFirstDummyStep;
@@ -294,12 +319,20 @@ protected:
 	doublereal dDerivativesCoef;
 	/* Type of linear solver */
 	LinSol CurrLinearSolver;
+	/* threaded LU; when selected, it replaces CurrLinearSolver */
+	bool bMTLU;
+	MTLUSolutionManager::Params MTLUParams;
 
 	/* Parameters for convergence tests */
 	NonlinearSolverTest::Type ResTest;
 	NonlinearSolverTest::Type SolTest;
 	bool bScale;
 
+	/* per-step statistics ("output: statistics") */
+	bool bSolverStats;
+	SolverStats::Format SolverStatsFormat;
+	SolverStats *pSolverStats;
+
    	/* Parametri per solutore nonlineare */
    	bool bTrueNewtonRaphson;
    	bool bKeepJac;
@@ -308,11 +341,13 @@ protected:
 	MatrixFreeSolver::SolverType MFSolverType;
 	doublereal dIterTol;
 	Preconditioner::PrecondType PcType;
+	Preconditioner::Parameters PcParams;
 	integer iPrecondSteps;
 	integer iIterativeMaxSteps;
 	doublereal dIterertiveEtaMax;
 	doublereal dIterertiveTau;
 	struct LineSearchParameters LineSearch;
+	struct NewtonRaphsonAdaptiveParameters NRAdaptive;
 
 /* FOR PARALLEL SOLVERS */
 	bool bParallel;
@@ -355,6 +390,10 @@ protected:
 	/* Alloca tutti i solman*/
 	void SetupSolmans(integer iStates, bool bCanBeParallel = false);
 
+	/* binary checkpoint of the state at the end of a step */
+	void MakeCheckpoint(long lStep, integer iTotIter, doublereal dTotErr);
+	void ResumeCheckpoint(long& lStep, integer& iTotIter, doublereal& dTotErr);
+
 	/* Workaround: call this function instead of MaxTimeStep.dGet()
 	 * until all postponed drive callers have been instantiated */
 	doublereal dGetInitialMaxTimeStep() const;
@@ -398,7 +437,16 @@ public:
 	virtual doublereal GetDInitialTimeStep(void) const {
 		return dInitialTimeStep;
 	};
+	virtual SolverStats *pGetSolverStats(void) const {
+		return pSolverStats;
+	};
+#ifdef USE_MULTITHREAD
+	virtual unsigned GetNumThreads(void) const {
+		return nThreads;
+	};
+#endif /* USE_MULTITHREAD */
 	virtual clock_t GetCPUTime(void) const;
+	integer GetNumericFactorizations(integer iJac) const;
 
 	virtual void PrintResidual(const VectorHandler& Res, integer iIterCnt) const;
 	virtual void PrintSolution(const VectorHandler& Sol, integer iIterCnt) const;
@@ -0,0 +1,195 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2014
+ *
+ * Pierangelo Masarati	<masarati@aero.polimi.it>
+ * Paolo Mantegazza	<mantegazza@aero.polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <iomanip>
+#include <limits>
+
+#include "myassert.h"
+#include "solverstats.h"
+
+static const char *psCounterNames[] = {
+	"iterations",
+	"jacobians",
+	"factorizations",
+	"backtracks",
+	"rejected",
+	0
+};
+
+static const char *psPhaseNames[] = {
+	"residual",
+	"jacobian",
+	"solve",
+	"output",
+	"drives",
+	0
+};
+
+SolverStats::SolverStats(std::ostream& o, Format f)
+: out(o),
+cSep(f == FORMAT_CSV ? ',' : ' '),
+dStepStart(dGetTime()),
+dRunStart(dStepStart),
+lSteps(0),
+lMaxIter(0),
+dMinTimeStep(std::numeric_limits<double>::max()),
+dMaxTimeStep(0.),
+dStepTime(0.),
+dMaxStepTime(0.)
+{
+	Reset(Curr);
+	Reset(Total);
+
+	/* in binary mode the header is stored verbatim */
+	out << "# step" << cSep << "time" << cSep << "dt";
+	for (unsigned c = 0; c < LASTCOUNTER; c++) {
+		out << cSep << psCounterNames[c];
+	}
+	for (unsigned p = 0; p < LASTPHASE; p++) {
+		out << cSep << psPhaseNames[p];
+	}
+	out << cSep << "step" << std::endl;
+}
+
+SolverStats::~SolverStats(void)
+{
+	NO_OP;
+}
+
+void
+SolverStats::Reset(Record& r)
+{
+	for (unsigned c = 0; c < LASTCOUNTER; c++) {
+		r.lCount[c] = 0;
+	}
+	for (unsigned p = 0; p < LASTPHASE; p++) {
+		r.dTime[p] = 0.;
+	}
+}
+
+void
+SolverStats::BeginStep(void)
+{
+	Reset(Curr);
+	dStepStart = dGetTime();
+}
+
+void
+SolverStats::EndStep(long lStep, doublereal dTime, doublereal dTimeStep)
+{
+	double dStep = dGetTime() - dStepStart;
+
+	out << lStep << cSep << dTime << cSep << dTimeStep;
+	for (unsigned c = 0; c < LASTCOUNTER; c++) {
+		out << cSep << Curr.lCount[c];
+		Total.lCount[c] += Curr.lCount[c];
+	}
+	for (unsigned p = 0; p < LASTPHASE; p++) {
+		out << cSep << Curr.dTime[p];
+		Total.dTime[p] += Curr.dTime[p];
+	}
+	out << cSep << dStep << std::endl;
+
+	lSteps++;
+	if (Curr.lCount[ITERATIONS] > lMaxIter) {
+		lMaxIter = Curr.lCount[ITERATIONS];
+	}
+	if (dTimeStep < dMinTimeStep) {
+		dMinTimeStep = dTimeStep;
+	}
+	if (dTimeStep > dMaxTimeStep) {
+		dMaxTimeStep = dTimeStep;
+	}
+	dStepTime += dStep;
+	if (dStep > dMaxStepTime) {
+		dMaxStepTime = dStep;
+	}
+
+	Reset(Curr);
+}
+
+void
+SolverStats::Report(std::ostream& log) const
+{
+	std::ios::fmtflags flags = log.flags();
+	std::streamsize precision = log.precision();
+
+	log << "solver statistics: " << lSteps << " steps in "
+		<< dStepTime << " s (run " << dGetTime() - dRunStart << " s)";
+	if (lSteps > 0) {
+		log << "; time step " << dMinTimeStep << " to " << dMaxTimeStep
+			<< "; max step " << dMaxStepTime << " s";
+	}
+	log << std::endl;
+
+	double dSteps = lSteps > 0 ? double(lSteps) : 1.;
+
+	log << std::setw(16) << "counter"
+		<< std::setw(12) << "total"
+		<< std::setw(14) << "per step" << std::endl;
+	for (unsigned c = 0; c < LASTCOUNTER; c++) {
+		log << std::setw(16) << psCounterNames[c]
+			<< std::setw(12) << Total.lCount[c]
+			<< std::setw(14) << Total.lCount[c]/dSteps;
+		if (c == ITERATIONS) {
+			log << " (max " << lMaxIter << ")";
+		}
+		log << std::endl;
+	}
+
+	double dOther = dStepTime;
+	log << std::setw(16) << "phase"
+		<< std::setw(12) << "time [s]"
+		<< std::setw(14) << "per step [s]"
+		<< std::setw(8) << "%" << std::endl;
+	for (unsigned p = 0; p <= LASTPHASE; p++) {
+		double d;
+		if (p < LASTPHASE) {
+			d = Total.dTime[p];
+			dOther -= d;
+		} else {
+			d = dOther > 0. ? dOther : 0.;
+		}
+
+		log << std::setw(16) << (p < LASTPHASE ? psPhaseNames[p] : "other")
+			<< std::setw(12) << d
+			<< std::setw(14) << d/dSteps
+			<< std::setw(8) << std::fixed << std::setprecision(2)
+				<< (dStepTime > 0. ? 100.*d/dStepTime : 0.)
+			<< std::resetiosflags(std::ios::fixed) << std::setprecision(6)
+			<< std::endl;
+	}
+
+	log.flags(flags);
+	log.precision(precision);
+}
@@ -0,0 +1,156 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2014
+ *
+ * Pierangelo Masarati	<masarati@aero.polimi.it>
+ * Paolo Mantegazza	<mantegazza@aero.polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* per-step solver statistics */
+
+#ifndef SOLVERSTATS_H
+#define SOLVERSTATS_H
+
+#include <time.h>
+#include <iostream>
+
+#include "ac/f2c.h"
+
+/*
+ * Collects counters and wall-clock times of each regular time step;
+ * one record per step is written to the .sst output file, either as
+ * comma-separated values or as binary records (see OutputBuf), and a
+ * summary table is written to the .log file at the end of the run.
+ * All calls come from the solver thread.
+ */
+class SolverStats {
+public:
+	enum Counter {
+		ITERATIONS = 0,
+		JACOBIANS,
+		FACTORIZATIONS,
+		BACKTRACKS,
+		REJECTED,
+
+		LASTCOUNTER
+	};
+
+	enum Phase {
+		RESIDUAL = 0,
+		JACOBIAN,
+		SOLVE,
+		OUTPUT,
+		DRIVES,
+
+		LASTPHASE
+	};
+
+	enum Format {
+		FORMAT_CSV,
+		FORMAT_BINARY
+	};
+
+	static inline double dGetTime(void);
+
+	/* accumulates the time spent in a phase by the enclosing scope;
+	 * does nothing if statistics are disabled */
+	class Timer {
+	protected:
+		SolverStats *pStats;
+		Phase p;
+		double dStart;
+
+	public:
+		Timer(SolverStats *pS, Phase ph)
+		: pStats(pS), p(ph), dStart(pS ? dGetTime() : 0.) {};
+		~Timer(void) {
+			if (pStats) {
+				pStats->Add(p, dGetTime() - dStart);
+			}
+		};
+	};
+
+protected:
+	struct Record {
+		long lCount[LASTCOUNTER];
+		double dTime[LASTPHASE];
+	};
+
+	std::ostream& out;
+	char cSep;
+
+	Record Curr;
+	Record Total;
+	double dStepStart;
+	double dRunStart;
+
+	long lSteps;
+	long lMaxIter;
+	double dMinTimeStep;
+	double dMaxTimeStep;
+	double dStepTime;
+	double dMaxStepTime;
+
+	static void Reset(Record& r);
+
+public:
+	SolverStats(std::ostream& o, Format f);
+	virtual ~SolverStats(void);
+
+	inline void Inc(Counter c, long n = 1);
+	inline void Add(Phase p, double dt);
+
+	/* called before the first attempt of each step */
+	void BeginStep(void);
+
+	/* writes the record of a converged step */
+	void EndStep(long lStep, doublereal dTime, doublereal dTimeStep);
+
+	/* summary table */
+	void Report(std::ostream& log) const;
+};
+
+inline double
+SolverStats::dGetTime(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return double(ts.tv_sec) + 1e-9*double(ts.tv_nsec);
+}
+
+inline void
+SolverStats::Inc(Counter c, long n)
+{
+	Curr.lCount[c] += n;
+}
+
+inline void
+SolverStats::Add(Phase p, double dt)
+{
+	Curr.dTime[p] += dt;
+}
+
+#endif /* SOLVERSTATS_H */
@@ -40,12 +40,14 @@
 #include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
 
 #include <limits>
+#include <algorithm>
 
 #include "schurdataman.h"
 #include "external.h"
 #include "solver.h"
 #include "invsolver.h"
 #include "stepsol.h"
+#include "checkpoint.h"
 
 StepIntegrator::StepIntegrator(const integer MaxIt,
 		const doublereal dT,
@@ -118,6 +120,32 @@ StepIntegrator::SetDriveHandler(const DriveHandler* /* pDH */ )
 	NO_OP;
 }
 
+void
+StepIntegrator::Checkpoint(std::ostream& /* out */ ) const
+{
+	NO_OP;
+}
+
+void
+StepIntegrator::Resume(std::istream& /* in */ )
+{
+	NO_OP;
+}
+
+bool
+StepIntegrator::GetPredictionError(const VectorHandler& /* X */ ,
+	doublereal& /* dErr */ ) const
+{
+	return false;
+}
+
+bool
+StepIntegrator::GetLocalError(const VectorHandler& /* X */ ,
+	doublereal& /* dErr */ ) const
+{
+	return false;
+}
+
 #include "stepsol.hc"
 
 ImplicitStepIntegrator::ImplicitStepIntegrator(const integer MaxIt,
@@ -351,14 +379,310 @@ StepNIntegrator::StepNIntegrator(const integer MaxIt,
 		const bool bmod_res_test)
 : ImplicitStepIntegrator(MaxIt, dT, dSolutionTol, stp, 1, bmod_res_test),
 db0Differential(0.),
-db0Algebraic(0.)
+db0Algebraic(0.),
+iPredOrder(0),
+iPredWindow(0),
+bPredLog(false),
+bPredExtrap(false),
+dErrRelTol(0.),
+dErrAbsTol(0.),
+dErrMinStep(0.),
+dErrSum(0.),
+iErrCount(0)
 {
 	NO_OP;
 }
 
 StepNIntegrator::~StepNIntegrator(void)
 {
-	NO_OP;
+	for (unsigned i = 0; i < PredX.size(); i++) {
+		SAFEDELETE(PredX[i]);
+		SAFEDELETE(PredXPrime[i]);
+	}
+}
+
+void
+StepNIntegrator::SetPredictor(integer iOrder, integer iWindow, bool bLog)
+{
+	ASSERT(iOrder >= 0);
+	ASSERT(iOrder == 0 || iWindow > iOrder);
+
+	iPredOrder = iOrder;
+	iPredWindow = iOrder > 0 ? iWindow : 0;
+	bPredLog = bLog;
+
+	while (PredX.size() > unsigned(iPredWindow)) {
+		SAFEDELETE(PredX.back());
+		SAFEDELETE(PredXPrime.back());
+		PredX.pop_back();
+		PredXPrime.pop_back();
+		PredTime.pop_back();
+	}
+	PredCoef.resize(iPredWindow);
+}
+
+/* records the last converged step; called at each Advance(),
+ * so repeated steps and the first call are detected by time */
+void
+StepNIntegrator::PredHistory(const doublereal dT, const doublereal dStep,
+	const VectorHandler& X, const VectorHandler& XP)
+{
+	if (iPredOrder == 0) {
+		return;
+	}
+
+	if (!PredTime.empty()) {
+		if (std::abs(dT - PredTime.front()) <= 1.e-6*dStep) {
+			return;
+		}
+
+		/* going back in time, or the problem changed size:
+		 * the history is no longer valid */
+		if (dT < PredTime.front()
+			|| X.iGetSize() != PredX.front()->iGetSize())
+		{
+			for (unsigned i = 0; i < PredX.size(); i++) {
+				SAFEDELETE(PredX[i]);
+				SAFEDELETE(PredXPrime[i]);
+			}
+			PredX.clear();
+			PredXPrime.clear();
+			PredTime.clear();
+		}
+	}
+
+	MyVectorHandler *pXH = 0, *pXPH = 0;
+	if (PredTime.size() == unsigned(iPredWindow)) {
+		pXH = PredX.back();
+		pXPH = PredXPrime.back();
+		PredX.pop_back();
+		PredXPrime.pop_back();
+		PredTime.pop_back();
+
+	} else {
+		SAFENEWWITHCONSTRUCTOR(pXH, MyVectorHandler,
+			MyVectorHandler(X.iGetSize()));
+		SAFENEWWITHCONSTRUCTOR(pXPH, MyVectorHandler,
+			MyVectorHandler(X.iGetSize()));
+	}
+
+	*pXH = X;
+	*pXPH = XP;
+	PredX.push_front(pXH);
+	PredXPrime.push_front(pXPH);
+	PredTime.push_front(dT);
+}
+
+/* least squares fit of a polynomial of order iPredOrder
+ * on the history; the weights give its value at time dT */
+bool
+StepNIntegrator::PredSetCoef(const doublereal dT)
+{
+	bPredExtrap = false;
+
+	if (iPredOrder == 0 || PredTime.size() < unsigned(iPredWindow)) {
+		return false;
+	}
+
+	/* abscissae are scaled by the last step to keep
+	 * the normal equations well conditioned */
+	doublereal dh = dT - PredTime[0];
+	if (dh <= 0.) {
+		return false;
+	}
+
+	const int m = iPredWindow;
+	const int n = iPredOrder + 1;
+	std::vector<doublereal> V(m*n), A(n*n, 0.), y(n, 0.);
+
+	for (int j = 0; j < m; j++) {
+		doublereal s = (PredTime[j] - dT)/dh;
+		doublereal p = 1.;
+		for (int k = 0; k < n; k++) {
+			V[j*n + k] = p;
+			p *= s;
+		}
+	}
+
+	for (int k = 0; k < n; k++) {
+		for (int l = 0; l < n; l++) {
+			for (int j = 0; j < m; j++) {
+				A[k*n + l] += V[j*n + k]*V[j*n + l];
+			}
+		}
+	}
+
+	/* A y = e_0, Gauss elimination with partial pivoting */
+	y[0] = 1.;
+	for (int k = 0; k < n; k++) {
+		int ip = k;
+		for (int i = k + 1; i < n; i++) {
+			if (std::abs(A[i*n + k]) > std::abs(A[ip*n + k])) {
+				ip = i;
+			}
+		}
+		if (std::abs(A[ip*n + k]) < std::numeric_limits<doublereal>::epsilon()) {
+			return false;
+		}
+		if (ip != k) {
+			for (int l = 0; l < n; l++) {
+				std::swap(A[k*n + l], A[ip*n + l]);
+			}
+			std::swap(y[k], y[ip]);
+		}
+		for (int i = k + 1; i < n; i++) {
+			doublereal f = A[i*n + k]/A[k*n + k];
+			for (int l = k; l < n; l++) {
+				A[i*n + l] -= f*A[k*n + l];
+			}
+			y[i] -= f*y[k];
+		}
+	}
+	for (int k = n - 1; k >= 0; k--) {
+		for (int l = k + 1; l < n; l++) {
+			y[k] -= A[k*n + l]*y[l];
+		}
+		y[k] /= A[k*n + k];
+	}
+
+	for (int j = 0; j < m; j++) {
+		doublereal d = 0.;
+		for (int k = 0; k < n; k++) {
+			d += V[j*n + k]*y[k];
+		}
+		PredCoef[j] = d;
+	}
+
+	bPredExtrap = true;
+
+	return true;
+}
+
+void
+StepNIntegrator::PredSave(void)
+{
+	if (bPredLog || dErrRelTol > 0.) {
+		if (XPred.iGetSize() != pXCurr->iGetSize()) {
+			XPred.Resize(pXCurr->iGetSize());
+		}
+		XPred = *pXCurr;
+	}
+}
+
+bool
+StepNIntegrator::GetPredictionError(const VectorHandler& X,
+	doublereal& dErr) const
+{
+	if (!bPredLog || XPred.iGetSize() != X.iGetSize()) {
+		return false;
+	}
+
+	doublereal dDiff = 0., dNorm = 0.;
+	for (integer i = 1; i <= X.iGetSize(); i++) {
+		doublereal d = X(i) - XPred(i);
+		dDiff += d*d;
+		dNorm += X(i)*X(i);
+	}
+
+	dErr = std::sqrt(dDiff)/(1. + std::sqrt(dNorm));
+
+	return true;
+}
+
+void
+StepNIntegrator::SetErrorControl(doublereal dRelTol, doublereal dAbsTol,
+	doublereal dMinStep)
+{
+	ASSERT(dRelTol > 0.);
+	ASSERT(dAbsTol >= 0.);
+
+	dErrRelTol = dRelTol;
+	dErrAbsTol = dAbsTol;
+	dErrMinStep = dMinStep;
+}
+
+/* only differential dofs contribute: algebraic unknowns
+ * (reactions, multipliers) do not carry truncation error */
+void
+StepNIntegrator::ErrDof(const int DCount,
+	const DofOrder::Order Order,
+	const VectorHandler* const pSol) const
+{
+	if (Order == DofOrder::DIFFERENTIAL) {
+		doublereal dX = pSol->operator()(DCount);
+		doublereal d = (dX - XPred(DCount))
+			/(dErrAbsTol + dErrRelTol*std::abs(dX));
+		dErrSum += d*d;
+		iErrCount++;
+	}
+}
+
+bool
+StepNIntegrator::GetLocalError(const VectorHandler& X,
+	doublereal& dErr) const
+{
+	if (dErrRelTol == 0. || XPred.iGetSize() != X.iGetSize()) {
+		return false;
+	}
+
+	dErrSum = 0.;
+	iErrCount = 0;
+	UpdateLoop(this, &StepNIntegrator::ErrDof, &X);
+
+	dErr = iErrCount > 0 ? std::sqrt(dErrSum/iErrCount) : 0.;
+
+	return true;
+}
+
+/* called after convergence, before the step is committed */
+void
+StepNIntegrator::CheckLocalError(const doublereal dStep) const
+{
+	doublereal dErr;
+	if (dStep > dErrMinStep*(1. + 1.e-9)
+		&& GetLocalError(*pXCurr, dErr) && dErr > 1.)
+	{
+		throw LocalErrorTooLarge(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+void
+StepNIntegrator::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, PredTime.size());
+	for (unsigned i = 0; i < PredTime.size(); i++) {
+		ChkWrite(out, PredTime[i]);
+		ChkWriteVector(out, *PredX[i]);
+		ChkWriteVector(out, *PredXPrime[i]);
+	}
+}
+
+void
+StepNIntegrator::Resume(std::istream& in)
+{
+	std::deque<doublereal>::size_type n;
+	ChkRead(in, n);
+	if (n > unsigned(iPredWindow)) {
+		silent_cerr("checkpoint: predictor history of " << n << " steps "
+			"exceeds the window of " << iPredWindow << std::endl);
+		throw ErrCheckpoint(MBDYN_EXCEPT_ARGS);
+	}
+
+	integer iSize = pDM->iGetNumDofs();
+	for (unsigned i = 0; i < n; i++) {
+		doublereal dT;
+		ChkRead(in, dT);
+		MyVectorHandler *pXH = 0, *pXPH = 0;
+		SAFENEWWITHCONSTRUCTOR(pXH, MyVectorHandler,
+			MyVectorHandler(iSize));
+		SAFENEWWITHCONSTRUCTOR(pXPH, MyVectorHandler,
+			MyVectorHandler(iSize));
+		ChkReadVector(in, *pXH);
+		ChkReadVector(in, *pXPH);
+		PredTime.push_back(dT);
+		PredX.push_back(pXH);
+		PredXPrime.push_back(pXPH);
+	}
 }
 
 void
@@ -486,7 +810,9 @@ void Step1Integrator::PredictDof(const int DCount,
 	if (Order == DofOrder::DIFFERENTIAL) {
 		doublereal dXnm1 = pXPrev->operator()(DCount);
 		doublereal dXPnm1 = pXPrimePrev->operator()(DCount);
-		doublereal dXPn = dPredDer(dXnm1, dXPnm1);
+		doublereal dXPn = bPredExtrap
+			? dPredExtrap(PredXPrime, DCount)
+			: dPredDer(dXnm1, dXPnm1);
 		doublereal dXn = dPredState(dXnm1, dXPn, dXPnm1);
 		pXPrimeCurr->PutCoef(DCount, dXPn);
 		pXCurr->PutCoef(DCount, dXn);
@@ -496,7 +822,9 @@ void Step1Integrator::PredictDof(const int DCount,
 		doublereal dXInm1 =
 			pXPrimePrev->operator()(DCount);
 
-		doublereal dXn = dPredDerAlg(dXInm1, dXnm1);
+		doublereal dXn = bPredExtrap
+			? dPredExtrap(PredX, DCount)
+			: dPredDerAlg(dXInm1, dXnm1);
 		doublereal dXIn = dPredStateAlg(dXInm1, dXn, dXnm1);
 
 		pXCurr->PutCoef(DCount, dXn);
@@ -539,9 +867,14 @@ Step1Integrator::Advance(Solver* pS,
 	pXPrimeCurr  = pXPrime;
 	pXPrimePrev  = qXPrime[0];
 
+	PredHistory(pDM->dGetTime() - TStep*dAph, TStep*dAph,
+		*pXPrev, *pXPrimePrev);
+
 	SetCoef(TStep, dAph, StType);
+	PredSetCoef(pDM->dGetTime());
 	/* predizione */
 	Predict();
+	PredSave();
 	pDM->LinkToSolution(*pXCurr, *pXPrimeCurr);
       	pDM->AfterPredict();
 
@@ -579,6 +912,8 @@ Step1Integrator::Advance(Solver* pS,
 	pS->pGetNonlinearSolver()->Solve(this, pS, MaxIters, dTol,
     			EffIter, Err, dSolTol, SolErr);
 
+	CheckLocalError(TStep*dAph);
+
 	/* if it gets here, it surely converged */
 	pDM->AfterConvergence();
 
@@ -623,8 +958,9 @@ void Step2Integrator::PredictDof(const int DCount,
 
 		doublereal dXPnm2 =
 			pXPrimePrev2->operator()(DCount);
-		doublereal dXPn = dPredDer(dXnm1, dXnm2,
-				dXPnm1, dXPnm2);
+		doublereal dXPn = bPredExtrap
+			? dPredExtrap(PredXPrime, DCount)
+			: dPredDer(dXnm1, dXnm2, dXPnm1, dXPnm2);
 		doublereal dXn = dPredState(dXnm1, dXnm2,
 				dXPn, dXPnm1, dXPnm2);
 
@@ -637,8 +973,9 @@ void Step2Integrator::PredictDof(const int DCount,
 		doublereal dXInm1 =
 			pXPrimePrev->operator()(DCount);
 
-		doublereal dXn = dPredDerAlg(dXInm1,
-				dXnm1, dXnm2);
+		doublereal dXn = bPredExtrap
+			? dPredExtrap(PredX, DCount)
+			: dPredDerAlg(dXInm1, dXnm1, dXnm2);
 		doublereal dXIn = dPredStateAlg(dXInm1,
 				dXn, dXnm1, dXnm2);
 
@@ -683,11 +1020,16 @@ Step2Integrator::Advance(Solver* pS,
 	pXPrimePrev  = qXPrime[0];
 	pXPrimePrev2 = qXPrime[1];
 
+	PredHistory(pDM->dGetTime() - TStep*dAph, TStep*dAph,
+		*pXPrev, *pXPrimePrev);
+
 	SetCoef(TStep, dAph, StType);
+	PredSetCoef(pDM->dGetTime());
 
 	/* predizione */
 
 	Predict();
+	PredSave();
 
 	pDM->LinkToSolution(*pXCurr, *pXPrimeCurr);
 
@@ -728,6 +1070,8 @@ Step2Integrator::Advance(Solver* pS,
 	pS->pGetNonlinearSolver()->Solve(this, pS, MaxIters, dTol,
     			EffIter, Err, dSolTol, SolErr);
 
+	CheckLocalError(TStep*dAph);
+
 	/* if it gets here, it surely converged */
 	pDM->AfterConvergence();
 
@@ -1096,6 +1440,20 @@ HopeSolver::~HopeSolver(void)
 	NO_OP;
 }
 
+void
+HopeSolver::Checkpoint(std::ostream& out) const
+{
+	StepNIntegrator::Checkpoint(out);
+	ChkWrite(out, bStep);
+}
+
+void
+HopeSolver::Resume(std::istream& in)
+{
+	StepNIntegrator::Resume(in);
+	ChkRead(in, bStep);
+}
+
 void
 HopeSolver::SetDriveHandler(const DriveHandler* pDH)
 {
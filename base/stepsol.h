@@ -61,6 +61,7 @@
 #include <cfloat>
 #include <cmath>
 #include <deque>
+#include <vector>
 
 /* per il debugging */
 #include "myassert.h"
@@ -86,6 +87,13 @@ public:
 		ErrGeneric(MBDYN_EXCEPT_ARGS_DECL) : MBDynErrBase(MBDYN_EXCEPT_ARGS_PASSTHRU) {};
 	};
 	
+	/* thrown by Advance() when the estimated local error
+	 * requires the step to be repeated with a smaller time step */
+	class LocalErrorTooLarge: public MBDynErrBase {
+	public:
+		LocalErrorTooLarge(MBDYN_EXCEPT_ARGS_DECL) : MBDynErrBase(MBDYN_EXCEPT_ARGS_PASSTHRU) {};
+	};
+
 	enum { DIFFERENTIAL = 0, ALGEBRAIC = 1 };
 	enum StepChange { NEWSTEP, REPEATSTEP };   
 
@@ -134,6 +142,21 @@ public:
 	
 	virtual void SetDriveHandler(const DriveHandler* pDH);
 
+	/* binary checkpoint of the state kept between steps */
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
+	/* distance of the converged solution from the last prediction;
+	 * returns false if the integrator does not keep track of it */
+	virtual bool GetPredictionError(const VectorHandler& X,
+		doublereal& dErr) const;
+
+	/* local error estimate from the predictor-corrector difference,
+	 * as weighted RMS norm (<= 1 means within tolerance);
+	 * returns false if the integrator cannot estimate it */
+	virtual bool GetLocalError(const VectorHandler& X,
+		doublereal& dErr) const;
+
 	virtual doublereal
 	Advance(Solver* pS, 
 			const doublereal TStep, 
@@ -232,6 +255,46 @@ public:
 	doublereal db0Algebraic;
 
 protected:
+	/*
+	 * Extrapolation predictor: the derivatives of the differential dofs
+	 * and the algebraic dofs are predicted by a polynomial of order
+	 * iPredOrder, fitted in the least squares sense to the last
+	 * iPredWindow converged steps (exact interpolation when
+	 * iPredWindow == iPredOrder + 1); the states follow from the
+	 * method's own formulas, so the prediction is consistent
+	 * with the integrator.  Variable time step is handled by fitting
+	 * on the actual times.  Until enough history is available
+	 * the method's predictor is used.
+	 */
+	integer iPredOrder;
+	integer iPredWindow;
+	bool bPredLog;
+	std::deque<doublereal> PredTime;
+	std::deque<MyVectorHandler*> PredX;
+	std::deque<MyVectorHandler*> PredXPrime;
+	std::vector<doublereal> PredCoef;
+	bool bPredExtrap;
+	MyVectorHandler XPred;
+
+	/* local error control; dErrRelTol == 0 disables it */
+	doublereal dErrRelTol;
+	doublereal dErrAbsTol;
+	doublereal dErrMinStep;
+	mutable doublereal dErrSum;
+	mutable integer iErrCount;
+
+	void ErrDof(const int DCount,
+		const DofOrder::Order Order,
+		const VectorHandler* const pSol) const;
+	void CheckLocalError(const doublereal dStep) const;
+
+	void PredHistory(const doublereal dT, const doublereal dStep,
+		const VectorHandler& X, const VectorHandler& XP);
+	bool PredSetCoef(const doublereal dT);
+	inline doublereal
+	dPredExtrap(const std::deque<MyVectorHandler*>& q, int DCount) const;
+	void PredSave(void);
+
 	void UpdateDof(const int DCount,
 		const DofOrder::Order Order,
 		const VectorHandler* const pSol = 0) const;
@@ -244,6 +307,24 @@ public:
 
 	virtual ~StepNIntegrator(void);
 
+	/* iOrder == 0 restores the method's predictor;
+	 * bLog keeps a copy of the prediction to evaluate its error */
+	void SetPredictor(integer iOrder, integer iWindow, bool bLog);
+
+	virtual bool GetPredictionError(const VectorHandler& X,
+		doublereal& dErr) const;
+
+	/* steps with local error larger than the tolerance
+	 * are rejected, unless already at dMinStep */
+	void SetErrorControl(doublereal dRelTol, doublereal dAbsTol,
+		doublereal dMinStep);
+
+	virtual bool GetLocalError(const VectorHandler& X,
+		doublereal& dErr) const;
+
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
 	virtual void Residual(VectorHandler* pRes) const;
 
 	virtual void Jacobian(MatrixHandler* pJac) const;
@@ -258,6 +339,17 @@ protected:
 			enum StepChange NewStep) = 0;
 };
 
+inline doublereal
+StepNIntegrator::dPredExtrap(const std::deque<MyVectorHandler*>& q,
+	int DCount) const
+{
+	doublereal d = 0.;
+	for (unsigned i = 0; i < PredCoef.size(); i++) {
+		d += PredCoef[i]*q[i]->operator()(DCount);
+	}
+	return d;
+}
+
 /* classe di base per gli integratori del second'ordine */ 
 class Step1Integrator :   
 	public StepNIntegrator
@@ -606,6 +698,9 @@ public:
 
 	~HopeSolver(void);
 
+	void Checkpoint(std::ostream& out) const;
+	void Resume(std::istream& in);
+
 protected:
 	void SetCoef(doublereal dT,
 			doublereal dAlpha,
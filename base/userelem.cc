@@ -191,3 +191,9 @@ UserDefinedElem::GetAerodynamicElemType(void) const
 	return AerodynamicElem::AERODYNAMICLOADABLE;
 }
 
+bool
+UserDefinedElem::bCheckpointable(void) const
+{
+	return false;
+}
+
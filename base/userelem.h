@@ -56,6 +56,10 @@ public:
 
    	virtual Elem::Type GetElemType(void) const;
    	virtual AerodynamicElem::Type GetAerodynamicElemType(void) const;
+
+	/* modules must implement Checkpoint() and Resume()
+	 * and override this to allow a binary restart */
+	virtual bool bCheckpointable(void) const;
 };
 
 class MBDynParser;
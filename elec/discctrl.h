@@ -304,6 +304,11 @@ public:
 	virtual void
 	AfterConvergence(const VectorHandler& X, const VectorHandler& XP);
 
+	/* the controllers keep their own history */
+	virtual bool bCheckpointable(void) const {
+		return false;
+	};
+
 	/* ritorna il numero di Dofs per gli elementi che sono anche DofOwners */
 	virtual unsigned int iGetNumDof(void) const;
 
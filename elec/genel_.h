@@ -177,6 +177,19 @@ public:
 	/* Scrive il contributo dell'elemento al file di restart */
 	virtual std::ostream& Restart(std::ostream& out) const;
 
+	/* state of the constitutive law */
+	virtual void Checkpoint(std::ostream& out) const {
+		ConstitutiveLaw1DOwner::Checkpoint(out);
+	};
+
+	virtual void Resume(std::istream& in) {
+		ConstitutiveLaw1DOwner::Resume(in);
+	};
+
+	virtual bool bCheckpointable(void) const {
+		return ConstitutiveLaw1DOwner::bCheckpointable();
+	};
+
 	virtual void AfterConvergence(const VectorHandler& X,
 		const VectorHandler& XP);
 
@@ -228,6 +241,19 @@ public:
 	/* Scrive il contributo dell'elemento al file di restart */
 	virtual std::ostream& Restart(std::ostream& out) const;
 
+	/* state of the constitutive law */
+	virtual void Checkpoint(std::ostream& out) const {
+		ConstitutiveLaw1DOwner::Checkpoint(out);
+	};
+
+	virtual void Resume(std::istream& in) {
+		ConstitutiveLaw1DOwner::Resume(in);
+	};
+
+	virtual bool bCheckpointable(void) const {
+		return ConstitutiveLaw1DOwner::bCheckpointable();
+	};
+
 	virtual void AfterConvergence(const VectorHandler& X,
 		const VectorHandler& XP);
 
@@ -286,6 +312,19 @@ public:
 	/* Scrive il contributo dell'elemento al file di restart */
 	virtual std::ostream& Restart(std::ostream& out) const;
 
+	/* state of the constitutive law */
+	virtual void Checkpoint(std::ostream& out) const {
+		ConstitutiveLaw1DOwner::Checkpoint(out);
+	};
+
+	virtual void Resume(std::istream& in) {
+		ConstitutiveLaw1DOwner::Resume(in);
+	};
+
+	virtual bool bCheckpointable(void) const {
+		return ConstitutiveLaw1DOwner::bCheckpointable();
+	};
+
 	virtual void AfterConvergence(const VectorHandler& X,
 		const VectorHandler& XP);
 
@@ -341,6 +380,19 @@ public:
 	/* Scrive il contributo dell'elemento al file di restart */
 	virtual std::ostream& Restart(std::ostream& out) const;
 
+	/* state of the constitutive law */
+	virtual void Checkpoint(std::ostream& out) const {
+		ConstitutiveLaw1DOwner::Checkpoint(out);
+	};
+
+	virtual void Resume(std::istream& in) {
+		ConstitutiveLaw1DOwner::Resume(in);
+	};
+
+	virtual bool bCheckpointable(void) const {
+		return ConstitutiveLaw1DOwner::bCheckpointable();
+	};
+
 	virtual void AfterConvergence(const VectorHandler& X,
 		const VectorHandler& XP);
 
@@ -393,6 +445,19 @@ public:
 	/* Scrive il contributo dell'elemento al file di restart */
 	virtual std::ostream& Restart(std::ostream& out) const;
 
+	/* state of the constitutive law */
+	virtual void Checkpoint(std::ostream& out) const {
+		ConstitutiveLaw1DOwner::Checkpoint(out);
+	};
+
+	virtual void Resume(std::istream& in) {
+		ConstitutiveLaw1DOwner::Resume(in);
+	};
+
+	virtual bool bCheckpointable(void) const {
+		return ConstitutiveLaw1DOwner::bCheckpointable();
+	};
+
 	virtual void AfterConvergence(const VectorHandler& X,
 		const VectorHandler& XP);
 
@@ -40,6 +40,7 @@
 #include <limits>
 
 #include "pipe.h"
+#include "checkpoint.h"
 
 /* Pipe - begin */
 
@@ -442,6 +443,18 @@ Pipe::AfterConvergence(const VectorHandler& X, const VectorHandler& XP)
 #endif /* HYDR_DEVEL */
    }
 }
+
+void
+Pipe::Checkpoint(std::ostream& out) const
+{
+   ChkWrite(out, turbulent);
+}
+
+void
+Pipe::Resume(std::istream& in)
+{
+   ChkRead(in, turbulent);
+}
    
 void Pipe::Output(OutputHandler& OH) const
 {
@@ -965,6 +978,18 @@ Dynamic_pipe::AfterConvergence(const VectorHandler& X, const VectorHandler& XP)
 #endif /* HYDR_DEVEL */
 }
 
+void
+Dynamic_pipe::Checkpoint(std::ostream& out) const
+{
+   ChkWrite(out, turbulent);
+}
+
+void
+Dynamic_pipe::Resume(std::istream& in)
+{
+   ChkRead(in, turbulent);
+}
+
 void Dynamic_pipe::Output(OutputHandler& OH) const
 {
    if (fToBeOutput()) { 
@@ -1364,6 +1389,18 @@ DynamicPipe::AfterConvergence(const VectorHandler& X, const VectorHandler& XP)
 #endif /* HYDR_DEVEL */
 }
 
+void
+DynamicPipe::Checkpoint(std::ostream& out) const
+{
+   ChkWrite(out, turbulent);
+}
+
+void
+DynamicPipe::Resume(std::istream& in)
+{
+   ChkRead(in, turbulent);
+}
+
 void DynamicPipe::Output(OutputHandler& OH) const
 {
    if (fToBeOutput()) {
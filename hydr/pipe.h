@@ -92,6 +92,8 @@ class Pipe : virtual public Elem, public HydraulicElem {
    
    virtual void AfterConvergence(const VectorHandler& X, 
 		   const VectorHandler& XP);
+   virtual void Checkpoint(std::ostream& out) const;
+   virtual void Resume(std::istream& in);
    virtual void Output(OutputHandler& OH) const;
    
    virtual void SetValue(DataManager *pDM,
@@ -176,6 +178,8 @@ class Dynamic_pipe : virtual public Elem, public HydraulicElem {
    
    virtual void AfterConvergence(const VectorHandler& X, 
 		   const VectorHandler& XP);
+   virtual void Checkpoint(std::ostream& out) const;
+   virtual void Resume(std::istream& in);
    virtual void Output(OutputHandler& OH) const;
    
    virtual void SetValue(DataManager *pDM,
@@ -267,6 +271,8 @@ class DynamicPipe : virtual public Elem, public HydraulicElem {
    
    virtual void AfterConvergence(const VectorHandler& X, 
 		   const VectorHandler& XP);
+   virtual void Checkpoint(std::ostream& out) const;
+   virtual void Resume(std::istream& in);
    virtual void Output(OutputHandler& OH) const;
    
    virtual void SetValue(DataManager *pDM,
@@ -121,6 +121,7 @@ const char sDefaultOutputFileName[] = "MBDyn";
 #include "except.h"
 
 #include "solver.h"
+#include "outbuf.h"
 #include "invsolver.h"
 #include "modules.h"
 #include "legalese.h"
@@ -231,7 +232,9 @@ mbdyn_usage(const char *sShortOpts)
 		   "                                any" << std::endl);
 #endif /* DEBUG */
 	silent_cout(
-		   "  -e, --exceptions          don't trap exceptions to ease debugging" << std::endl
+		   "  -B, --binary-to-text {file}  writes the binary output file 'file'" << std::endl
+		<< "                            as text to stdout and exits" << std::endl
+		<< "  -e, --exceptions          don't trap exceptions to ease debugging" << std::endl
 		<< "  -E, --fp-mask[=...]       enable some floating point checks" << std::endl
 		<< "  -h, --help                prints this message" << std::endl
 		<< "  -H, --show-table          print symbol table and exit" << std::endl
@@ -289,10 +292,11 @@ mbdyn_welcome(void)
 }
 
 /* Dati di getopt */
-static char sShortOpts[] = "d:eE::f:hHlN:o:pPrRsS:tTvwW:";
+static char sShortOpts[] = "B:d:eE::f:hHlN:o:pPrRsS:tTvwW:";
 
 #ifdef HAVE_GETOPT_LONG
 static struct option LongOpts[] = {
+	{ "binary-to-text", required_argument, NULL,           int('B') },
 	{ "debug",          required_argument, NULL,           int('d') },
 	{ "exceptions",     no_argument,       NULL,           int('e') },
 	{ "fp-mask",        optional_argument, NULL,           int('E') },
@@ -466,6 +470,12 @@ mbdyn_parse_arguments(mbdyn_proc_t& mbp, int argc, char *argv[], int& currarg)
 			mbp.pIn = dynamic_cast<std::istream *>(&mbp.FileStreamIn);
 			break;
 
+		case int('B'):
+			if (!OutputBuf::ConvertToText(optarg, std::cout)) {
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+			throw NoErr(MBDYN_EXCEPT_ARGS);
+
 		case int('h'):
 			mbdyn_usage(sShortOpts);
 			throw NoErr(MBDYN_EXCEPT_ARGS);
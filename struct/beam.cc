@@ -46,6 +46,7 @@
 #include "beam.h"
 #include "pzbeam.h"
 #include "Rot.hh"
+#include "checkpoint.h"
 
 /*
  * Nota: non e' ancora stato implementato il contributo
@@ -598,6 +599,38 @@ Beam::AfterConvergence(const VectorHandler& X, const VectorHandler& XP)
 	}
 }
 
+void
+Beam::Checkpoint(std::ostream& out) const
+{
+	for (unsigned i = 0; i < NUMSEZ; i++) {
+		ChkWrite(out, RPrev[i]);
+		ChkWrite(out, DefLocPrev[i]);
+		pD[i]->Checkpoint(out);
+	}
+}
+
+void
+Beam::Resume(std::istream& in)
+{
+	for (unsigned i = 0; i < NUMSEZ; i++) {
+		ChkRead(in, RPrev[i]);
+		ChkRead(in, DefLocPrev[i]);
+		pD[i]->Resume(in);
+	}
+}
+
+bool
+Beam::bCheckpointable(void) const
+{
+	for (unsigned i = 0; i < NUMSEZ; i++) {
+		if (!pD[i]->bCheckpointable()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 /* Inverse Dynamics: */
 void
 Beam::AfterConvergence(const VectorHandler& X, const VectorHandler& XP, const VectorHandler& XPP)
@@ -47,6 +47,7 @@
 #include "beam2.h"
 #include "pzbeam2.h"
 #include "Rot.hh"
+#include "checkpoint.h"
 
 /*
  * Nota: non e' ancora stato implementato il contributo 
@@ -323,6 +324,28 @@ Beam2::AfterConvergence(const VectorHandler& X, const VectorHandler& XP)
 	pD->AfterConvergence(DefLoc);
 }
 
+void
+Beam2::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, RPrev);
+	ChkWrite(out, DefLocPrev);
+	pD->Checkpoint(out);
+}
+
+void
+Beam2::Resume(std::istream& in)
+{
+	ChkRead(in, RPrev);
+	ChkRead(in, DefLocPrev);
+	pD->Resume(in);
+}
+
+bool
+Beam2::bCheckpointable(void) const
+{
+	return pD->bCheckpointable();
+}
+
 /* Assembla la matrice */
 void
 Beam2::AssStiffnessMat(FullSubMatrixHandler& WMA,
@@ -34,6 +34,7 @@
 #include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
 
 #include "brake.h"
+#include "checkpoint.h"
 
 /* Brake - begin */
 
@@ -110,6 +111,20 @@ Brake::AfterConvergence(const VectorHandler& X,
 	fc->AfterConvergence(modF, v, X, XP, iGetFirstIndex() + NumSelfDof);
 }
 
+void
+Brake::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, dTheta);
+	fc->Checkpoint(out);
+}
+
+void
+Brake::Resume(std::istream& in)
+{
+	ChkRead(in, dTheta);
+	fc->Resume(in);
+}
+
 
 /* Contributo al file di restart */
 std::ostream& Brake::Restart(std::ostream& out) const
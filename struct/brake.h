@@ -121,6 +121,9 @@ class Brake : virtual public Elem, public Joint {
    virtual void AfterConvergence(const VectorHandler& X, 
 			const VectorHandler& XP);
 
+   virtual void Checkpoint(std::ostream& out) const;
+   virtual void Resume(std::istream& in);
+
    void WorkSpaceDim(integer* piNumRows, integer* piNumCols) const { 
       *piNumRows = NumDof;
       *piNumCols = NumDof;
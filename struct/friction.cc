@@ -38,6 +38,7 @@
 #include "datamanforward.h"
 #include "friction.h"
 #include "submat.h"
+#include "checkpoint.h"
 
 int sign(const doublereal x) {
 	if (x >= 0.) {
@@ -370,6 +371,36 @@ void DiscreteCoulombFriction::AfterConvergence(
 //* 	std::cerr << "CONVERGENZA; v = " << v << "; f = " << f << std::endl;
 };
 
+void DiscreteCoulombFriction::Checkpoint(std::ostream& out) const {
+	ChkWrite(out, converged_sticked);
+	ChkWrite(out, status);
+	ChkWrite(out, transition_type);
+	ChkWrite(out, converged_v);
+	ChkWrite(out, first_iter);
+	ChkWrite(out, first_switch);
+	ChkWrite(out, previous_switch_v);
+	ChkWrite(out, current_velocity);
+	ChkWrite(out, saved_sliding_velocity);
+	ChkWrite(out, saved_sliding_friction);
+	ChkWrite(out, current_friction_force);
+	ChkWrite(out, f);
+};
+
+void DiscreteCoulombFriction::Resume(std::istream& in) {
+	ChkRead(in, converged_sticked);
+	ChkRead(in, status);
+	ChkRead(in, transition_type);
+	ChkRead(in, converged_v);
+	ChkRead(in, first_iter);
+	ChkRead(in, first_switch);
+	ChkRead(in, previous_switch_v);
+	ChkRead(in, current_velocity);
+	ChkRead(in, saved_sliding_velocity);
+	ChkRead(in, saved_sliding_friction);
+	ChkRead(in, current_friction_force);
+	ChkRead(in, f);
+};
+
 
 void DiscreteCoulombFriction::AssRes(
 	SubVectorHandler& WorkVec,
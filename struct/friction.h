@@ -267,6 +267,8 @@ public:
 		const VectorHandler&X, 
 		const VectorHandler&XP,
 		const unsigned int solution_startdof);
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
 	void AssRes(
 		SubVectorHandler& WorkVec,
 		const unsigned int startdof,
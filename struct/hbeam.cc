@@ -45,6 +45,7 @@
 #include "shapefnc.h"
 #include "beam.h"
 #include "hbeam.h"
+#include "checkpoint.h"
 #if 0	/* not implemented yet */
 #include <pzhbeam.h>
 #endif
@@ -349,6 +350,24 @@ HBeam::AfterConvergence(const VectorHandler& X, const VectorHandler& XP)
 	pD->AfterConvergence(DefLoc);
 }
 
+void
+HBeam::Checkpoint(std::ostream& out) const
+{
+	pD->Checkpoint(out);
+}
+
+void
+HBeam::Resume(std::istream& in)
+{
+	pD->Resume(in);
+}
+
+bool
+HBeam::bCheckpointable(void) const
+{
+	return pD->bCheckpointable();
+}
+
 /* Assembla la matrice */
 void
 HBeam::AssStiffnessMat(FullSubMatrixHandler& WMA,
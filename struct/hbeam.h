@@ -201,6 +201,10 @@ class HBeam
    
     /* Contributo al file di restart */
     virtual std::ostream& Restart(std::ostream& out) const;
+
+    virtual void Checkpoint(std::ostream& out) const;
+    virtual void Resume(std::istream& in);
+    virtual bool bCheckpointable(void) const;
    
     virtual void
     AfterConvergence(const VectorHandler& X, const VectorHandler& XP);
@@ -42,6 +42,7 @@
 #include "constltp_impl.h"
 #include "tpldrive_impl.h"
 #include "membraneeas.h"
+#include "checkpoint.h"
 #include "mynewmem.h"
 
 #include "shell.hc"
@@ -529,6 +530,34 @@ Membrane4EAS::Restart(std::ostream& out) const
 	return out << "# not implemented yet" << std::endl;
 }
 
+void
+Membrane4EAS::Checkpoint(std::ostream& out) const
+{
+	for (unsigned i = 0; i < NUMIP; i++) {
+		pD[i]->Checkpoint(out);
+	}
+}
+
+void
+Membrane4EAS::Resume(std::istream& in)
+{
+	for (unsigned i = 0; i < NUMIP; i++) {
+		pD[i]->Resume(in);
+	}
+}
+
+bool
+Membrane4EAS::bCheckpointable(void) const
+{
+	for (unsigned i = 0; i < NUMIP; i++) {
+		if (!pD[i]->bCheckpointable()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 // Initial settings
 void
 Membrane4EAS::SetValue(DataManager *pDM,
@@ -226,6 +226,10 @@ public:
 	// Contribution to restart file
 	virtual std::ostream& Restart(std::ostream& out) const;
 
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+	virtual bool bCheckpointable(void) const;
+
 #if 0
 	virtual void
 	AfterConvergence(const VectorHandler& X, const VectorHandler& XP);
@@ -39,6 +39,7 @@
 #include "planej.h"
 #include "Rot.hh"
 #include "hint_impl.h"
+#include "checkpoint.h"
 
 /* PlaneHingeJoint - begin */
 
@@ -505,6 +506,28 @@ PlaneHingeJoint::AfterConvergence(const VectorHandler& X,
 	}
 }
 
+void
+PlaneHingeJoint::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, NTheta);
+	ChkWrite(out, dTheta);
+	ChkWrite(out, dThetaWrapped);
+	if (fc) {
+		fc->Checkpoint(out);
+	}
+}
+
+void
+PlaneHingeJoint::Resume(std::istream& in)
+{
+	ChkRead(in, NTheta);
+	ChkRead(in, dTheta);
+	ChkRead(in, dThetaWrapped);
+	if (fc) {
+		fc->Resume(in);
+	}
+}
+
 /* Funzione che legge lo stato iniziale dal file di input */
 void
 PlaneHingeJoint::ReadInitialState(MBDynParser& HP)
@@ -1791,6 +1814,22 @@ PlaneRotationJoint::AfterConvergence(const VectorHandler& X,
 	dTheta = 2*M_PI*NTheta + dThetaWrapped;
 }
 
+void
+PlaneRotationJoint::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, NTheta);
+	ChkWrite(out, dTheta);
+	ChkWrite(out, dThetaWrapped);
+}
+
+void
+PlaneRotationJoint::Resume(std::istream& in)
+{
+	ChkRead(in, NTheta);
+	ChkRead(in, dTheta);
+	ChkRead(in, dThetaWrapped);
+}
+
 
 /* Contributo al file di restart */
 std::ostream& PlaneRotationJoint::Restart(std::ostream& out) const
@@ -2984,6 +3023,28 @@ AxialRotationJoint::AfterConvergence(const VectorHandler& X,
 	}
 }
 
+void
+AxialRotationJoint::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, NTheta);
+	ChkWrite(out, dTheta);
+	ChkWrite(out, dThetaWrapped);
+	if (fc) {
+		fc->Checkpoint(out);
+	}
+}
+
+void
+AxialRotationJoint::Resume(std::istream& in)
+{
+	ChkRead(in, NTheta);
+	ChkRead(in, dTheta);
+	ChkRead(in, dThetaWrapped);
+	if (fc) {
+		fc->Resume(in);
+	}
+}
+
 
 /* Contributo al file di restart */
 std::ostream& AxialRotationJoint::Restart(std::ostream& out) const
@@ -4325,6 +4386,22 @@ PlanePinJoint::AfterConvergence(const VectorHandler& X,
 
 }
 
+void
+PlanePinJoint::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, NTheta);
+	ChkWrite(out, dTheta);
+	ChkWrite(out, dThetaWrapped);
+}
+
+void
+PlanePinJoint::Resume(std::istream& in)
+{
+	ChkRead(in, NTheta);
+	ChkRead(in, dTheta);
+	ChkRead(in, dThetaWrapped);
+}
+
 void
 PlanePinJoint::ReadInitialState(MBDynParser& HP)
 {
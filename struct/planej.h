@@ -138,6 +138,9 @@ class PlaneHingeJoint : virtual public Elem, public Joint {
    virtual void AfterConvergence(const VectorHandler& X, 
 			const VectorHandler& XP);
 
+   virtual void Checkpoint(std::ostream& out) const;
+   virtual void Resume(std::istream& in);
+
    void WorkSpaceDim(integer* piNumRows, integer* piNumCols) const { 
       *piNumRows = NumDof;
       *piNumCols = NumDof;
@@ -280,6 +283,9 @@ class PlaneRotationJoint : virtual public Elem, public Joint {
 	virtual void AfterConvergence(const VectorHandler& X, 
 			const VectorHandler& XP);
 
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
    void WorkSpaceDim(integer* piNumRows, integer* piNumCols) const { 
       *piNumRows = 3+3+2;
       *piNumCols = 3+3+2; 
@@ -451,6 +457,9 @@ public Joint, public DriveOwner {
 	virtual void AfterConvergence(const VectorHandler& X, 
 			const VectorHandler& XP);
 
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
    void WorkSpaceDim(integer* piNumRows, integer* piNumCols) const { 
       *piNumRows = NumDof;
       *piNumCols = NumDof;
@@ -588,6 +597,9 @@ class PlanePinJoint : virtual public Elem, public Joint {
 	virtual void AfterConvergence(const VectorHandler& X, 
 			const VectorHandler& XP);
 
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
    virtual void WorkSpaceDim(integer* piNumRows, integer* piNumCols) const { 
       *piNumRows = 11; 
       *piNumCols = 11;
@@ -85,6 +85,19 @@ public:
 	/* Contributo al file di restart */
 	virtual std::ostream& Restart(std::ostream& out) const;
 
+	/* state of the constitutive law */
+	virtual void Checkpoint(std::ostream& out) const {
+		ConstitutiveLaw1DOwner::Checkpoint(out);
+	};
+
+	virtual void Resume(std::istream& in) {
+		ConstitutiveLaw1DOwner::Resume(in);
+	};
+
+	virtual bool bCheckpointable(void) const {
+		return ConstitutiveLaw1DOwner::bCheckpointable();
+	};
+
 	virtual void
 	AfterConvergence(const VectorHandler& X, const VectorHandler& XP);
 
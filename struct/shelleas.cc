@@ -41,6 +41,7 @@
 #include "constltp_impl.h"
 #include "tpldrive_impl.h"
 #include "shelleas.h"
+#include "checkpoint.h"
 #include "mynewmem.h"
 
 #include "shell.hc"
@@ -1207,6 +1208,34 @@ Shell4EAS::Restart(std::ostream& out) const
 	return out << "# not implemented yet" << std::endl;
 }
 
+void
+Shell4EAS::Checkpoint(std::ostream& out) const
+{
+	for (unsigned i = 0; i < NUMIP; i++) {
+		pD[i]->Checkpoint(out);
+	}
+}
+
+void
+Shell4EAS::Resume(std::istream& in)
+{
+	for (unsigned i = 0; i < NUMIP; i++) {
+		pD[i]->Resume(in);
+	}
+}
+
+bool
+Shell4EAS::bCheckpointable(void) const
+{
+	for (unsigned i = 0; i < NUMIP; i++) {
+		if (!pD[i]->bCheckpointable()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 // Initial settings
 void
 Shell4EAS::SetValue(DataManager *pDM,
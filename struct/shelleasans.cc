@@ -41,6 +41,7 @@
 #include "constltp_impl.h"
 #include "tpldrive_impl.h"
 #include "shelleasans.h"
+#include "checkpoint.h"
 #include "mynewmem.h"
 
 #include "shell.hc"
@@ -804,6 +805,34 @@ Shell4EASANS::Restart(std::ostream& out) const
 	return out << "# not implemented yet" << std::endl;
 }
 
+void
+Shell4EASANS::Checkpoint(std::ostream& out) const
+{
+	for (unsigned i = 0; i < NUMIP; i++) {
+		pD[i]->Checkpoint(out);
+	}
+}
+
+void
+Shell4EASANS::Resume(std::istream& in)
+{
+	for (unsigned i = 0; i < NUMIP; i++) {
+		pD[i]->Resume(in);
+	}
+}
+
+bool
+Shell4EASANS::bCheckpointable(void) const
+{
+	for (unsigned i = 0; i < NUMIP; i++) {
+		if (!pD[i]->bCheckpointable()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 // Initial settings
 void
 Shell4EASANS::SetValue(DataManager *pDM,
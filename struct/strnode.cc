@@ -40,6 +40,7 @@
 #include "body.h"
 #include "autostr.h"
 #include "dataman.h"
+#include "checkpoint.h"
 
 #include "matvecexp.h"
 #include "Rot.hh"
@@ -336,6 +337,28 @@ StructDispNode::DescribeEq(std::vector<std::string>& desc, bool bInitial, int i)
 	}
 }
 
+void
+StructDispNode::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, XPrev);
+	ChkWrite(out, XCurr);
+	ChkWrite(out, VPrev);
+	ChkWrite(out, VCurr);
+	ChkWrite(out, XPPCurr);
+	ChkWrite(out, XPPPrev);
+}
+
+void
+StructDispNode::Resume(std::istream& in)
+{
+	ChkRead(in, XPrev);
+	ChkRead(in, XCurr);
+	ChkRead(in, VPrev);
+	ChkRead(in, VCurr);
+	ChkRead(in, XPPCurr);
+	ChkRead(in, XPPPrev);
+}
+
 /* Contributo del nodo strutturale al file di restart */
 std::ostream&
 StructDispNode::Restart(std::ostream& out) const
@@ -1647,6 +1670,44 @@ StructNode::DescribeEq(std::vector<std::string>& desc, bool bInitial, int i) con
 	}
 }
 
+void
+StructNode::Checkpoint(std::ostream& out) const
+{
+	StructDispNode::Checkpoint(out);
+
+	ChkWrite(out, RPrev);
+	ChkWrite(out, RRef);
+	ChkWrite(out, RCurr);
+	ChkWrite(out, gRef);
+	ChkWrite(out, gCurr);
+	ChkWrite(out, gPRef);
+	ChkWrite(out, gPCurr);
+	ChkWrite(out, WPrev);
+	ChkWrite(out, WRef);
+	ChkWrite(out, WCurr);
+	ChkWrite(out, WPCurr);
+	ChkWrite(out, WPPrev);
+}
+
+void
+StructNode::Resume(std::istream& in)
+{
+	StructDispNode::Resume(in);
+
+	ChkRead(in, RPrev);
+	ChkRead(in, RRef);
+	ChkRead(in, RCurr);
+	ChkRead(in, gRef);
+	ChkRead(in, gCurr);
+	ChkRead(in, gPRef);
+	ChkRead(in, gPCurr);
+	ChkRead(in, WPrev);
+	ChkRead(in, WRef);
+	ChkRead(in, WCurr);
+	ChkRead(in, WPCurr);
+	ChkRead(in, WPPrev);
+}
+
 /* Contributo del nodo strutturale al file di restart */
 std::ostream&
 StructNode::Restart(std::ostream& out) const
@@ -170,6 +170,10 @@ public:
 	/* Contributo del nodo strutturale al file di restart */
 	virtual std::ostream& Restart(std::ostream& out) const;
 
+	/* Stato privato per il checkpoint binario */
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
 	virtual std::ostream& DescribeDof(std::ostream& out,
 		const char *prefix = "",
 		bool bInitial = false) const;
@@ -808,6 +812,10 @@ public:
 	/* Contributo del nodo strutturale al file di restart */
 	virtual std::ostream& Restart(std::ostream& out) const;
 
+	/* Stato privato per il checkpoint binario */
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
 	virtual std::ostream& DescribeDof(std::ostream& out,
 		const char *prefix = "",
 		bool bInitial = false) const;
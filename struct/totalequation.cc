@@ -36,6 +36,7 @@
 #include "totalequation.h"
 #include "Rot.hh"
 #include "hint_impl.h"
+#include "checkpoint.h"
 
 static const char idx2xyz[] = { 'x', 'y', 'z' };
 
@@ -567,6 +568,18 @@ TotalEquation::AfterConvergence(const VectorHandler& /* X */ ,
 	ThetaDeltaPrev = Unwrap(ThetaDeltaPrev, ThetaDelta);
 }
 
+void
+TotalEquation::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, ThetaDeltaPrev);
+}
+
+void
+TotalEquation::Resume(std::istream& in)
+{
+	ChkRead(in, ThetaDeltaPrev);
+}
+
 void
 TotalEquation::AfterConvergence(const VectorHandler& /* X */ ,
 		const VectorHandler& /* XP */, const VectorHandler& /* XP */)
@@ -1546,6 +1559,18 @@ TotalReaction::AfterConvergence(const VectorHandler& /* X */ ,
 	ThetaDeltaPrev = Unwrap(ThetaDeltaPrev, ThetaDelta);
 }
 
+void
+TotalReaction::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, ThetaDeltaPrev);
+}
+
+void
+TotalReaction::Resume(std::istream& in)
+{
+	ChkRead(in, ThetaDeltaPrev);
+}
+
 void
 TotalReaction::AfterConvergence(const VectorHandler& /* X */ ,
 		const VectorHandler& /* XP */, const VectorHandler& /* XP */)
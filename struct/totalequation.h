@@ -161,6 +161,9 @@ public:
 	AfterConvergence(const VectorHandler& X,
 		const VectorHandler& XP);
 
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
 	/* Inverse Dynamics: */
 	virtual void
 	AfterConvergence(const VectorHandler& X,
@@ -345,6 +348,9 @@ public:
 	AfterConvergence(const VectorHandler& X,
 		const VectorHandler& XP);
 
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
 	virtual void
 	AfterConvergence(const VectorHandler& X,
 		const VectorHandler& XP, const VectorHandler& XPP);
@@ -43,6 +43,7 @@
 #include "Rot.hh"
 #include "hint_impl.h"
 #include "invdyn.h"
+#include "checkpoint.h"
 
 static const char idx2xyz[] = { 'x', 'y', 'z' };
 
@@ -742,6 +743,22 @@ TotalJoint::AfterConvergence(const VectorHandler& /* X */ ,
 	ThetaDeltaTrue = Unwrap(ThetaDeltaTrue, RotManip::VecRot((pNode1->GetRCurr()*R1hr).MulTM(pNode2->GetRCurr()*R2hr)));
 }
 
+void
+TotalJoint::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, ThetaDeltaPrev);
+	ChkWrite(out, ThetaDeltaRemnant);
+	ChkWrite(out, ThetaDeltaTrue);
+}
+
+void
+TotalJoint::Resume(std::istream& in)
+{
+	ChkRead(in, ThetaDeltaPrev);
+	ChkRead(in, ThetaDeltaRemnant);
+	ChkRead(in, ThetaDeltaTrue);
+}
+
 void
 TotalJoint::AfterConvergence(const VectorHandler& X,
 	const VectorHandler& XP, const VectorHandler& XPP)
@@ -2750,6 +2767,22 @@ TotalPinJoint::AfterConvergence(const VectorHandler& X,
 	ThetaDeltaTrue = Unwrap(ThetaDeltaTrue, RotManip::VecRot(RchT*pNode->GetRCurr()*tilde_Rnhr));
 }
 
+void
+TotalPinJoint::Checkpoint(std::ostream& out) const
+{
+	ChkWrite(out, ThetaDeltaPrev);
+	ChkWrite(out, ThetaDeltaRemnant);
+	ChkWrite(out, ThetaDeltaTrue);
+}
+
+void
+TotalPinJoint::Resume(std::istream& in)
+{
+	ChkRead(in, ThetaDeltaPrev);
+	ChkRead(in, ThetaDeltaRemnant);
+	ChkRead(in, ThetaDeltaTrue);
+}
+
 /* Inverse Dynamics: */
 void
 TotalPinJoint::AfterConvergence(const VectorHandler& X,
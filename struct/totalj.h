@@ -168,6 +168,9 @@ public:
 	AfterConvergence(const VectorHandler& X,
 		const VectorHandler& XP);
 
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
+
 	/* Inverse Dynamics: */
 	virtual void
 	AfterConvergence(const VectorHandler& X,
@@ -380,6 +383,9 @@ public:
 	virtual void
 	AfterConvergence(const VectorHandler& X,
 		const VectorHandler& XP);
+
+	virtual void Checkpoint(std::ostream& out) const;
+	virtual void Resume(std::istream& in);
 	
 	virtual void
 	AfterConvergence(const VectorHandler& X,
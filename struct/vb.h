@@ -86,6 +86,19 @@ public:
 	/* Contributo al file di restart */
 	virtual std::ostream& Restart(std::ostream& out) const;
 
+	/* state of the constitutive law */
+	virtual void Checkpoint(std::ostream& out) const {
+		ConstitutiveLaw6DOwner::Checkpoint(out);
+	};
+
+	virtual void Resume(std::istream& in) {
+		ConstitutiveLaw6DOwner::Resume(in);
+	};
+
+	virtual bool bCheckpointable(void) const {
+		return ConstitutiveLaw6DOwner::bCheckpointable();
+	};
+
 	virtual void Output(OutputHandler& OH) const;
 
 	void SetValue(DataManager *pDM,
@@ -119,6 +119,19 @@ public:
 	/* Contributo al file di restart */
 	virtual std::ostream& Restart(std::ostream& out) const;
 
+	/* state of the constitutive law */
+	virtual void Checkpoint(std::ostream& out) const {
+		ConstitutiveLaw3DOwner::Checkpoint(out);
+	};
+
+	virtual void Resume(std::istream& in) {
+		ConstitutiveLaw3DOwner::Resume(in);
+	};
+
+	virtual bool bCheckpointable(void) const {
+		return ConstitutiveLaw3DOwner::bCheckpointable();
+	};
+
 	void OutputPrepare(OutputHandler &OH);
 	virtual void Output(OutputHandler& OH) const;
 
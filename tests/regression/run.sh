@@ -0,0 +1,211 @@
+#!/bin/sh
+#
+# Regression checks of the solver and assembly options: each case runs
+# the same model with different settings, and compares the motion
+# (.mov) of each variant with that of the reference run.
+#
+#   linsol      naive vs. umfpack vs. threaded lu (1, 4 threads, mixed
+#               precision)
+#   precond     Newton-Raphson vs. matrix free with ilu (fill 0, 1),
+#               ilut and block jacobi preconditioners
+#   threads     assembly with 1 vs. 2 and 4 threads, copy and coloring;
+#               two runs with the same number of threads must match
+#               exactly
+#   checkpoint  binary checkpoint at t = 0.1, then resume up to the end;
+#               the final step must match the uninterrupted run exactly
+#   c81grid     C81 tables vs. their uniform alpha x Mach resampling
+#   c81jac      analytical vs. forward difference section Jacobian,
+#               steady and Bielawa
+#
+# usage: run.sh [case ...]
+# MBDYN is the mbdyn executable (default: mbdyn in PATH);
+# work files go in WORKDIR (default: a temporary directory).
+
+MBDYN=${MBDYN:-mbdyn}
+SRCDIR=`cd \`dirname "$0"\` && pwd`
+WORKDIR=${WORKDIR:-`mktemp -d "${TMPDIR:-/tmp}/mbdyn-regression.XXXXXX"`}
+
+cp "$SRCDIR/beam.mbd" "$SRCDIR/wing.mbd" "$SRCDIR/thin.c81" "$WORKDIR" || exit 1
+cd "$WORKDIR" || exit 1
+
+NFAIL=0
+
+# writes $3 from input $1, replacing the placeholder line "#@$2" with $4
+subst() {
+	awk -v tag="#@$2" -v text="$4" '$0 == tag { print text; next } { print }' \
+		"$1" > "$3"
+}
+
+# runs mbdyn on input $1.mbd, output $1.*
+run() {
+	"$MBDYN" -s -f "$1.mbd" -o "$1" > "$1.stdout" 2>&1
+}
+
+# compares $1 and $2 field by field: |a - b| <= atol + rtol*max(|a|, |b|)
+compare() {
+	awk -v rtol="$3" -v atol="$4" '
+		function abs(x) { return x < 0 ? -x : x }
+		NR == FNR { a[FNR] = $0; n = FNR; next }
+		{
+			if (!(FNR in a)) { bad = 1; exit }
+			na = split(a[FNR], x); nb = split($0, y);
+			if (na != nb) { bad = 1; exit }
+			for (i = 1; i <= na; i++) {
+				m = abs(x[i]) > abs(y[i]) ? abs(x[i]) : abs(y[i]);
+				if (abs(x[i] - y[i]) > atol + rtol*m) {
+					print "  line " FNR ", field " i ": " x[i] " vs. " y[i];
+					bad = 1; exit
+				}
+			}
+			m2 = FNR
+		}
+		END { if (bad || m2 != n) exit 1 }
+	' "$1" "$2"
+}
+
+pass() {
+	echo "PASS: $1"
+}
+
+fail() {
+	echo "FAIL: $1"
+	NFAIL=`expr $NFAIL + 1`
+}
+
+# runs variant $2 of case $1 and compares it with the reference $3
+check() {
+	if ! run "$2"; then
+		fail "$1: $2 did not run (see $WORKDIR/$2.stdout)"
+	elif compare "$3.mov" "$2.mov" "$4" "$5"; then
+		pass "$1: $2"
+	else
+		fail "$1: $2 differs from $3"
+	fi
+}
+
+# reference run $2 of case $1
+reference() {
+	if ! run "$2"; then
+		fail "$1: reference $2 did not run (see $WORKDIR/$2.stdout)"
+		return 1
+	fi
+	return 0
+}
+
+case_linsol() {
+	subst beam.mbd SOLVER linsol_naive.mbd "	linear solver: naive, colamd;"
+	reference linsol linsol_naive || return
+
+	subst beam.mbd SOLVER linsol_umfpack.mbd "	linear solver: umfpack;"
+	subst beam.mbd SOLVER linsol_mtlu1.mbd "	linear solver: threaded lu, mt, 1;"
+	subst beam.mbd SOLVER linsol_mtlu4.mbd "	linear solver: threaded lu, mt, 4;"
+	subst beam.mbd SOLVER linsol_mtlu_mixed.mbd "	linear solver: threaded lu, mt, 4, mixed precision;"
+
+	if ! run linsol_umfpack; then
+		echo "SKIP: linsol: linsol_umfpack (umfpack not available?)"
+	elif compare linsol_naive.mov linsol_umfpack.mov 1e-8 1e-12; then
+		pass "linsol: linsol_umfpack"
+	else
+		fail "linsol: linsol_umfpack differs from linsol_naive"
+	fi
+
+	for v in mtlu1 mtlu4 mtlu_mixed; do
+		check linsol linsol_$v linsol_naive 1e-8 1e-12
+	done
+}
+
+case_precond() {
+	subst beam.mbd SOLVER precond_nr.mbd "	linear solver: naive, colamd;"
+	reference precond precond_nr || return
+
+	MF="	nonlinear solver: matrix free, gmres, tolerance, 1e-12, steps, 200, preconditioner"
+	subst beam.mbd SOLVER precond_ilu0.mbd "$MF, ilu, fill, 0;"
+	subst beam.mbd SOLVER precond_ilu1.mbd "$MF, ilu, fill, 1;"
+	subst beam.mbd SOLVER precond_ilut.mbd "$MF, ilut, drop tolerance, 1e-4, fill, 10;"
+	subst beam.mbd SOLVER precond_bj.mbd "$MF, block jacobi;"
+
+	for v in ilu0 ilu1 ilut bj; do
+		check precond precond_$v precond_nr 1e-6 1e-9
+	done
+}
+
+case_threads() {
+	subst beam.mbd SOLVER threads_1.mbd "	threads: assembly, 1;"
+	reference threads threads_1 || return
+
+	for n in 2 4; do
+		subst beam.mbd SOLVER threads_$n.mbd "	threads: assembly, $n;"
+		check threads threads_$n threads_1 1e-9 1e-12
+
+		subst beam.mbd SOLVER threads_${n}_color.tmp "	threads: assembly, $n;"
+		subst threads_${n}_color.tmp CONTROL threads_${n}_color.mbd "	multithread: jacobian, coloring;"
+		check threads threads_${n}_color threads_1 1e-9 1e-12
+	done
+
+	# same thread count, same result
+	cp threads_4.mbd threads_4_again.mbd
+	if ! run threads_4_again; then
+		fail "threads: threads_4_again did not run"
+	elif cmp -s threads_4.mov threads_4_again.mov; then
+		pass "threads: threads_4_again"
+	else
+		fail "threads: threads_4_again differs from threads_4"
+	fi
+}
+
+case_checkpoint() {
+	subst beam.mbd CONTROL chk_full.mbd "	make restart file: times, 1, 0.1, binary;"
+	reference checkpoint chk_full || return
+
+	if ! test -f chk_full.chk; then
+		fail "checkpoint: chk_full.chk not written"
+		return
+	fi
+
+	subst beam.mbd SOLVER chk_resume.mbd "	resume from checkpoint: \"chk_full.chk\";"
+	if ! run chk_resume; then
+		fail "checkpoint: chk_resume did not run (see $WORKDIR/chk_resume.stdout)"
+		return
+	fi
+
+	# the last step, one line per node
+	n=`awk '{ print $1 }' chk_full.mov | sort -un | wc -l`
+	tail -n $n chk_full.mov > chk_full.last
+	tail -n $n chk_resume.mov > chk_resume.last
+	if cmp -s chk_full.last chk_resume.last; then
+		pass "checkpoint: chk_resume"
+	else
+		fail "checkpoint: last step of chk_resume differs from chk_full"
+	fi
+}
+
+case_c81grid() {
+	cp wing.mbd c81_tables.mbd
+	reference c81grid c81_tables || return
+
+	subst wing.mbd C81 c81_grid.mbd "		, uniform grid, alpha step, .25, mach step, .01"
+	check c81grid c81_grid c81_tables 1e-2 1e-6
+}
+
+case_c81jac() {
+	for m in steady bielawa; do
+		subst wing.mbd AERO c81jac_${m}_fd.mbd "		, unsteady, $m, jacobian, yes, forward difference"
+		reference c81jac c81jac_${m}_fd || continue
+
+		subst wing.mbd AERO c81jac_${m}_an.mbd "		, unsteady, $m, jacobian, yes, analytical"
+		check c81jac c81jac_${m}_an c81jac_${m}_fd 1e-7 1e-10
+	done
+}
+
+CASES=${*:-"linsol precond threads checkpoint c81grid c81jac"}
+for c in $CASES; do
+	case_$c
+done
+
+echo "work files in $WORKDIR"
+if test $NFAIL -gt 0; then
+	echo "$NFAIL check(s) failed"
+	exit 1
+fi
+
+exit 0